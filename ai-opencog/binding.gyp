@@ -0,0 +1,14 @@
+{
+  "targets": [{
+    "target_name": "opencog_native",
+    "sources": [ "native/opencog_addon.c" ],
+    "include_dirs": [ "../opencog-core/include" ],
+    "libraries": [
+      "<(module_root_dir)/../opencog-core/lib/libopencog_core.a",
+      "-lpthread",
+      "-lrt",
+      "-lm"
+    ],
+    "cflags": [ "-O3", "-std=gnu11" ]
+  }]
+}
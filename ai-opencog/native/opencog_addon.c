@@ -0,0 +1,627 @@
+/*
+ * OpenCog Node.js Addon
+ * N-API bindings over libopencog_core: typed-array inputs, native-memory results
+ */
+
+#define NAPI_VERSION 8
+#include <stdlib.h>
+#include <string.h>
+#include <node_api.h>
+#include "atom.h"
+
+/*
+ * One AtomSpace per JS object. Async queries hold the space open, so
+ * close() and garbage collection only destroy it once they finish.
+ */
+typedef struct {
+    atomspace_t* space;
+    uint32_t pending;         /* Async queries still running */
+    bool closed;
+    bool finalized;           /* JS object collected */
+} addon_space_t;
+
+typedef struct {
+    napi_async_work work;
+    napi_deferred deferred;
+    addon_space_t* owner;
+    atom_type_t type;
+    char* name;               /* NULL for type queries */
+    bool values;
+    void* block;
+    size_t count;
+} query_work_t;
+
+#define NAPI_CALL(env, call)                                                  \
+    do {                                                                      \
+        if ((call) != napi_ok) {                                              \
+            throw_last_error(env);                                            \
+            return NULL;                                                      \
+        }                                                                     \
+    } while (0)
+
+static void throw_last_error(napi_env env) {
+    bool pending;
+    napi_is_exception_pending(env, &pending);
+    if (pending) return;
+    const napi_extended_error_info* info;
+    napi_get_last_error_info(env, &info);
+    napi_throw_error(env, NULL, info && info->error_message ? info->error_message : "N-API call failed");
+}
+
+static void space_release(addon_space_t* addon) {
+    if (addon->pending > 0) return;
+    if (addon->closed && addon->space) {
+        atomspace_destroy(addon->space);
+        addon->space = NULL;
+    }
+    if (addon->finalized) free(addon);
+}
+
+static void space_finalize(napi_env env, void* data, void* hint) {
+    (void)env;
+    (void)hint;
+    addon_space_t* addon = (addon_space_t*)data;
+    addon->closed = true;
+    addon->finalized = true;
+    space_release(addon);
+}
+
+/* Fetch `this` and up to `argc` arguments; NULL (with an exception) if closed */
+static addon_space_t* unwrap_args(napi_env env, napi_callback_info info, size_t argc, napi_value* argv) {
+    napi_value self;
+    size_t given = argc;
+    if (napi_get_cb_info(env, info, &given, argv, &self, NULL) != napi_ok) return NULL;
+    for (size_t i = given; i < argc; i++) napi_get_undefined(env, &argv[i]);
+
+    addon_space_t* addon;
+    if (napi_unwrap(env, self, (void**)&addon) != napi_ok) return NULL;
+    if (addon->closed) {
+        napi_throw_error(env, NULL, "AtomSpace is closed");
+        return NULL;
+    }
+    return addon;
+}
+
+/* Argument helpers; each throws and returns false on bad input */
+static bool get_type(napi_env env, napi_value value, atom_type_t* type) {
+    uint32_t raw;
+    if (napi_get_value_uint32(env, value, &raw) != napi_ok || !atom_type_valid((atom_type_t)raw)) {
+        napi_throw_range_error(env, NULL, "Invalid atom type");
+        return false;
+    }
+    *type = (atom_type_t)raw;
+    return true;
+}
+
+static bool get_id(napi_env env, napi_value value, uint64_t* id) {
+    bool lossless;
+    if (napi_get_value_bigint_uint64(env, value, id, &lossless) != napi_ok || !lossless) {
+        napi_throw_type_error(env, NULL, "Atom IDs are unsigned 64-bit BigInts");
+        return false;
+    }
+    return true;
+}
+
+static char* get_string(napi_env env, napi_value value) {
+    size_t length;
+    if (napi_get_value_string_utf8(env, value, NULL, 0, &length) != napi_ok) {
+        napi_throw_type_error(env, NULL, "Expected a string");
+        return NULL;
+    }
+    char* text = malloc(length + 1);
+    napi_get_value_string_utf8(env, value, text, length + 1, &length);
+    return text;
+}
+
+/* Typed arrays are read in place; `length` is in elements */
+static bool get_typed(napi_env env, napi_value value, napi_typedarray_type want,
+                      const char* what, void** data, size_t* length) {
+    bool is_typed = false;
+    napi_typedarray_type type;
+    napi_is_typedarray(env, value, &is_typed);
+    if (!is_typed || napi_get_typedarray_info(env, value, &type, length, data, NULL, NULL) != napi_ok ||
+        type != want) {
+        napi_throw_type_error(env, NULL, what);
+        return false;
+    }
+    return true;
+}
+
+static napi_value make_id(napi_env env, uint64_t id) {
+    napi_value result;
+    NAPI_CALL(env, napi_create_bigint_uint64(env, id, &result));
+    return result;
+}
+
+/*
+ * Results. A block holds `count` IDs followed, if `values`, by strength,
+ * confidence, sti, lti and vlti columns; JS sees it as one ArrayBuffer
+ * (native memory freed by the GC) with a typed array view per column.
+ */
+#define ROW_BYTES(values) (sizeof(uint64_t) + ((values) ? 2 * sizeof(double) + 3 * sizeof(int16_t) : 0))
+
+static void* block_alloc(size_t count, bool values) {
+    size_t bytes = count * ROW_BYTES(values);
+    return malloc(bytes ? bytes : sizeof(uint64_t));
+}
+
+/* Byte offset of column `index` (0 = ids) in a block of `count` rows */
+static size_t column_offset(size_t count, int index) {
+    static const size_t widths[] = { sizeof(uint64_t), sizeof(double), sizeof(double),
+                                     sizeof(int16_t), sizeof(int16_t), sizeof(int16_t) };
+    size_t offset = 0;
+    for (int i = 0; i < index; i++) offset += widths[i] * count;
+    return offset;
+}
+
+static void* block_column(void* block, size_t count, int index) {
+    return (char*)block + column_offset(count, index);
+}
+
+static void block_set(void* block, size_t count, bool values, size_t row, uint64_t id,
+                      truth_value_t tv, attention_value_t av) {
+    ((uint64_t*)block)[row] = id;
+    if (!values) return;
+    ((double*)block_column(block, count, 1))[row] = tv.strength;
+    ((double*)block_column(block, count, 2))[row] = tv.confidence;
+    ((int16_t*)block_column(block, count, 3))[row] = av.sti;
+    ((int16_t*)block_column(block, count, 4))[row] = av.lti;
+    ((int16_t*)block_column(block, count, 5))[row] = av.vlti;
+}
+
+static void block_free(napi_env env, void* data, void* hint) {
+    (void)env;
+    (void)hint;
+    free(data);
+}
+
+/* Hands `block` to JS; hosts that forbid external buffers (Electron) get a copy */
+static napi_value make_columns(napi_env env, void* block, size_t count, bool values) {
+    size_t bytes = count * ROW_BYTES(values);
+    napi_value buffer;
+    if (napi_create_external_arraybuffer(env, block, bytes, block_free, NULL, &buffer) != napi_ok) {
+        void* copy;
+        if (napi_create_arraybuffer(env, bytes, &copy, &buffer) != napi_ok) {
+            free(block);
+            throw_last_error(env);
+            return NULL;
+        }
+        memcpy(copy, block, bytes);
+        free(block);
+    }
+
+    static const char* names[] = { "ids", "strength", "confidence", "sti", "lti", "vlti" };
+    static const napi_typedarray_type types[] = { napi_biguint64_array, napi_float64_array,
+                                                 napi_float64_array, napi_int16_array,
+                                                 napi_int16_array, napi_int16_array };
+    napi_value result;
+    NAPI_CALL(env, napi_create_object(env, &result));
+    for (int i = 0; i < (values ? 6 : 1); i++) {
+        napi_value column;
+        NAPI_CALL(env, napi_create_typedarray(env, types[i], count, buffer, column_offset(count, i), &column));
+        NAPI_CALL(env, napi_set_named_property(env, result, names[i], column));
+    }
+    return result;
+}
+
+/* The ids column alone, as a BigUint64Array */
+static napi_value make_ids(napi_env env, uint64_t* ids, size_t count) {
+    napi_value columns, result;
+    if (!(columns = make_columns(env, ids, count, false))) return NULL;
+    NAPI_CALL(env, napi_get_named_property(env, columns, "ids", &result));
+    return result;
+}
+
+/* Copy query results into a block, reading values at the snapshot's version */
+static void* block_from_handles(atomspace_snapshot_t* snapshot, atom_handle_t** handles,
+                                size_t count, bool values) {
+    void* block = block_alloc(count, values);
+    truth_value_t tv = { 0.0, 0.0 };
+    attention_value_t av = { 0, 0, 0 };
+    for (size_t i = 0; i < count; i++) {
+        if (values) {
+            tv = atomspace_snapshot_get_tv(snapshot, handles[i]);
+            av = atomspace_snapshot_get_av(snapshot, handles[i]);
+        }
+        block_set(block, count, values, i, handles[i]->id, tv, av);
+    }
+    return block;
+}
+
+static void* run_query(atomspace_t* space, atom_type_t type, const char* name, bool values, size_t* count) {
+    atomspace_snapshot_t* snapshot = atomspace_snapshot_begin(space);
+    atom_handle_t** handles = name ? atomspace_snapshot_get_atoms_by_name(snapshot, name, count)
+                                   : atomspace_snapshot_get_atoms_by_type(snapshot, type, count);
+    void* block = block_from_handles(snapshot, handles, *count, values);
+    free(handles);
+    atomspace_snapshot_end(snapshot);
+    return block;
+}
+
+/* new AtomSpace(nodeId = 1) */
+static napi_value space_new(napi_env env, napi_callback_info info) {
+    napi_value self, argv[1];
+    size_t argc = 1;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, &self, NULL));
+
+    uint32_t node_id = 1;
+    if (argc > 0 && napi_get_value_uint32(env, argv[0], &node_id) != napi_ok) {
+        napi_throw_type_error(env, NULL, "nodeId must be a number");
+        return NULL;
+    }
+    if (node_id > ATOM_ID_MAX_NODE) {
+        napi_throw_range_error(env, NULL, "nodeId out of range");
+        return NULL;
+    }
+
+    addon_space_t* addon = calloc(1, sizeof(addon_space_t));
+    addon->space = atomspace_create(node_id);
+    if (napi_wrap(env, self, addon, space_finalize, NULL, NULL) != napi_ok) {
+        atomspace_destroy(addon->space);
+        free(addon);
+        throw_last_error(env);
+        return NULL;
+    }
+    return self;
+}
+
+/* close(): frees the space once running async queries finish */
+static napi_value space_close(napi_env env, napi_callback_info info) {
+    napi_value self;
+    NAPI_CALL(env, napi_get_cb_info(env, info, NULL, NULL, &self, NULL));
+    addon_space_t* addon;
+    NAPI_CALL(env, napi_unwrap(env, self, (void**)&addon));
+    addon->closed = true;
+    space_release(addon);
+    return NULL;
+}
+
+/* size(): live atoms */
+static napi_value space_size(napi_env env, napi_callback_info info) {
+    addon_space_t* addon = unwrap_args(env, info, 0, NULL);
+    if (!addon) return NULL;
+    napi_value result;
+    NAPI_CALL(env, napi_create_double(env, (double)(addon->space->total_atoms_created -
+                                                    addon->space->total_atoms_deleted), &result));
+    return result;
+}
+
+/* createNode(type, name): bigint */
+static napi_value space_create_node(napi_env env, napi_callback_info info) {
+    napi_value argv[2];
+    addon_space_t* addon = unwrap_args(env, info, 2, argv);
+    atom_type_t type;
+    if (!addon || !get_type(env, argv[0], &type)) return NULL;
+    char* name = get_string(env, argv[1]);
+    if (!name) return NULL;
+
+    atom_handle_t* handle = atom_create(addon->space, type, name);
+    free(name);
+    return make_id(env, handle->id);
+}
+
+/*
+ * createNodes(type, bytes: Uint8Array, offsets: Uint32Array): BigUint64Array
+ * Name i is UTF-8 bytes[offsets[i], offsets[i + 1]).
+ */
+static napi_value space_create_nodes(napi_env env, napi_callback_info info) {
+    napi_value argv[3];
+    addon_space_t* addon = unwrap_args(env, info, 3, argv);
+    atom_type_t type;
+    uint8_t* bytes;
+    uint32_t* offsets;
+    size_t byte_count, offset_count;
+    if (!addon || !get_type(env, argv[0], &type) ||
+        !get_typed(env, argv[1], napi_uint8_array, "bytes must be a Uint8Array", (void**)&bytes, &byte_count) ||
+        !get_typed(env, argv[2], napi_uint32_array, "offsets must be a Uint32Array", (void**)&offsets, &offset_count)) {
+        return NULL;
+    }
+    size_t count = offset_count ? offset_count - 1 : 0;
+    for (size_t i = 0; i < count; i++) {
+        if (offsets[i] > offsets[i + 1] || offsets[i + 1] > byte_count) {
+            napi_throw_range_error(env, NULL, "offsets must be ascending and within bytes");
+            return NULL;
+        }
+    }
+    if (count == 0) return make_ids(env, block_alloc(0, false), 0);
+
+    /* Names need terminators; copy them once into one buffer */
+    size_t span = offsets[count] - offsets[0];
+    char* text = malloc(span + count);
+    const char** names = malloc(count * sizeof(char*));
+    char* cursor = text;
+    for (size_t i = 0; i < count; i++) {
+        size_t length = offsets[i + 1] - offsets[i];
+        memcpy(cursor, bytes + offsets[i], length);
+        cursor[length] = '\0';
+        names[i] = cursor;
+        cursor += length + 1;
+    }
+
+    atom_handle_t** handles = malloc(count * sizeof(atom_handle_t*));
+    atom_create_batch(addon->space, type, names, count, handles);
+    uint64_t* ids = block_alloc(count, false);
+    for (size_t i = 0; i < count; i++) ids[i] = handles[i]->id;
+    free(handles);
+    free(names);
+    free(text);
+    return make_ids(env, ids, count);
+}
+
+/* Resolve IDs to handles; throws on unknown IDs. Caller is in a read section. */
+static atom_handle_t** resolve_ids(napi_env env, atomspace_t* space, const uint64_t* ids, size_t count) {
+    atom_handle_t** handles = malloc((count ? count : 1) * sizeof(atom_handle_t*));
+    for (size_t i = 0; i < count; i++) {
+        if (!(handles[i] = atomspace_get_atom(space, ids[i]))) {
+            free(handles);
+            napi_throw_range_error(env, NULL, "Unknown atom ID");
+            return NULL;
+        }
+    }
+    return handles;
+}
+
+/*
+ * createLinks(type, targets: BigUint64Array, arities: Uint32Array): BigUint64Array
+ * Link i takes the next arities[i] IDs of `targets`.
+ */
+static napi_value space_create_links(napi_env env, napi_callback_info info) {
+    napi_value argv[3];
+    addon_space_t* addon = unwrap_args(env, info, 3, argv);
+    atom_type_t type;
+    uint64_t* targets;
+    uint32_t* arities;
+    size_t target_count, count;
+    if (!addon || !get_type(env, argv[0], &type) ||
+        !get_typed(env, argv[1], napi_biguint64_array, "targets must be a BigUint64Array", (void**)&targets, &target_count) ||
+        !get_typed(env, argv[2], napi_uint32_array, "arities must be a Uint32Array", (void**)&arities, &count)) {
+        return NULL;
+    }
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) total += arities[i];
+    if (total != target_count) {
+        napi_throw_range_error(env, NULL, "arities must sum to the number of targets");
+        return NULL;
+    }
+    if (count == 0) return make_ids(env, block_alloc(0, false), 0);
+
+    atomspace_read_begin(addon->space);
+    atom_handle_t** outgoing = resolve_ids(env, addon->space, targets, target_count);
+    if (!outgoing) {
+        atomspace_read_end(addon->space);
+        return NULL;
+    }
+    size_t* sizes = malloc(count * sizeof(size_t));
+    for (size_t i = 0; i < count; i++) sizes[i] = arities[i];
+    atom_handle_t** handles = malloc(count * sizeof(atom_handle_t*));
+    atom_create_link_batch(addon->space, type, outgoing, sizes, count, handles);
+    atomspace_read_end(addon->space);
+
+    uint64_t* ids = block_alloc(count, false);
+    for (size_t i = 0; i < count; i++) ids[i] = handles[i]->id;
+    free(handles);
+    free(sizes);
+    free(outgoing);
+    return make_ids(env, ids, count);
+}
+
+/* createLink(type, targets: BigUint64Array): bigint */
+static napi_value space_create_link(napi_env env, napi_callback_info info) {
+    napi_value argv[2];
+    addon_space_t* addon = unwrap_args(env, info, 2, argv);
+    atom_type_t type;
+    uint64_t* targets;
+    size_t count;
+    if (!addon || !get_type(env, argv[0], &type) ||
+        !get_typed(env, argv[1], napi_biguint64_array, "targets must be a BigUint64Array", (void**)&targets, &count)) {
+        return NULL;
+    }
+
+    atomspace_read_begin(addon->space);
+    atom_handle_t** outgoing = resolve_ids(env, addon->space, targets, count);
+    atom_handle_t* handle = outgoing ? atom_create_link(addon->space, type, outgoing, count) : NULL;
+    atomspace_read_end(addon->space);
+    free(outgoing);
+    return handle ? make_id(env, handle->id) : NULL;
+}
+
+/* setTruthValues(ids: BigUint64Array, strength: Float64Array, confidence: Float64Array) */
+static napi_value space_set_truth_values(napi_env env, napi_callback_info info) {
+    napi_value argv[3];
+    addon_space_t* addon = unwrap_args(env, info, 3, argv);
+    uint64_t* ids;
+    double* strength;
+    double* confidence;
+    size_t count, strength_count, confidence_count;
+    if (!addon ||
+        !get_typed(env, argv[0], napi_biguint64_array, "ids must be a BigUint64Array", (void**)&ids, &count) ||
+        !get_typed(env, argv[1], napi_float64_array, "strength must be a Float64Array", (void**)&strength, &strength_count) ||
+        !get_typed(env, argv[2], napi_float64_array, "confidence must be a Float64Array", (void**)&confidence, &confidence_count)) {
+        return NULL;
+    }
+    if (strength_count != count || confidence_count != count) {
+        napi_throw_range_error(env, NULL, "ids, strength and confidence must have equal length");
+        return NULL;
+    }
+
+    atomspace_read_begin(addon->space);
+    atom_handle_t** handles = resolve_ids(env, addon->space, ids, count);
+    for (size_t i = 0; handles && i < count; i++) {
+        atom_set_tv(handles[i], strength[i], confidence[i]);
+    }
+    atomspace_read_end(addon->space);
+    free(handles);
+    return NULL;
+}
+
+/* getValues(ids: BigUint64Array): columns with TV/AV */
+static napi_value space_get_values(napi_env env, napi_callback_info info) {
+    napi_value argv[1];
+    addon_space_t* addon = unwrap_args(env, info, 1, argv);
+    uint64_t* ids;
+    size_t count;
+    if (!addon ||
+        !get_typed(env, argv[0], napi_biguint64_array, "ids must be a BigUint64Array", (void**)&ids, &count)) {
+        return NULL;
+    }
+
+    atomspace_snapshot_t* snapshot = atomspace_snapshot_begin(addon->space);
+    atom_handle_t** handles = resolve_ids(env, addon->space, ids, count);
+    void* block = handles ? block_from_handles(snapshot, handles, count, true) : NULL;
+    atomspace_snapshot_end(snapshot);
+    free(handles);
+    return block ? make_columns(env, block, count, true) : NULL;
+}
+
+/* remove(id: bigint): boolean */
+static napi_value space_remove(napi_env env, napi_callback_info info) {
+    napi_value argv[1];
+    addon_space_t* addon = unwrap_args(env, info, 1, argv);
+    uint64_t id;
+    if (!addon || !get_id(env, argv[0], &id)) return NULL;
+
+    atomspace_read_begin(addon->space);
+    atom_handle_t* handle = atomspace_get_atom(addon->space, id);
+    bool removed = handle && atomspace_remove_atom(addon->space, handle) == 0;
+    atomspace_read_end(addon->space);
+
+    napi_value result;
+    NAPI_CALL(env, napi_get_boolean(env, removed, &result));
+    return result;
+}
+
+/* Query arguments: (type | name, withValues = false) */
+static bool get_query(napi_env env, napi_value* argv, bool by_name, atom_type_t* type,
+                      char** name, bool* values) {
+    *name = NULL;
+    *values = false;
+    if (by_name) {
+        if (!(*name = get_string(env, argv[0]))) return false;
+    } else if (!get_type(env, argv[0], type)) {
+        return false;
+    }
+    napi_valuetype kind;
+    napi_typeof(env, argv[1], &kind);
+    if (kind == napi_boolean) napi_get_value_bool(env, argv[1], values);
+    return true;
+}
+
+static napi_value query_sync(napi_env env, napi_callback_info info, bool by_name) {
+    napi_value argv[2];
+    addon_space_t* addon = unwrap_args(env, info, 2, argv);
+    atom_type_t type = ATOM_TYPE_CONCEPT;
+    char* name;
+    bool values;
+    if (!addon || !get_query(env, argv, by_name, &type, &name, &values)) return NULL;
+
+    size_t count;
+    void* block = run_query(addon->space, type, name, values, &count);
+    free(name);
+    return make_columns(env, block, count, values);
+}
+
+static napi_value space_query_by_type(napi_env env, napi_callback_info info) {
+    return query_sync(env, info, false);
+}
+
+static napi_value space_query_by_name(napi_env env, napi_callback_info info) {
+    return query_sync(env, info, true);
+}
+
+/* Async queries scan on a libuv worker thread inside one snapshot */
+static void query_execute(napi_env env, void* data) {
+    (void)env;
+    query_work_t* work = (query_work_t*)data;
+    work->block = run_query(work->owner->space, work->type, work->name, work->values, &work->count);
+}
+
+static void query_complete(napi_env env, napi_status status, void* data) {
+    query_work_t* work = (query_work_t*)data;
+    napi_value result = NULL;
+    if (status == napi_ok) {
+        result = make_columns(env, work->block, work->count, work->values);
+    } else {
+        free(work->block);
+    }
+
+    if (result) {
+        napi_resolve_deferred(env, work->deferred, result);
+    } else {
+        napi_value error, message;
+        bool pending;
+        napi_is_exception_pending(env, &pending);
+        if (pending) {
+            napi_get_and_clear_last_exception(env, &error);
+        } else {
+            napi_create_string_utf8(env, "Query failed", NAPI_AUTO_LENGTH, &message);
+            napi_create_error(env, NULL, message, &error);
+        }
+        napi_reject_deferred(env, work->deferred, error);
+    }
+
+    napi_delete_async_work(env, work->work);
+    work->owner->pending--;
+    space_release(work->owner);
+    free(work->name);
+    free(work);
+}
+
+static napi_value query_async(napi_env env, napi_callback_info info, bool by_name) {
+    napi_value argv[2];
+    addon_space_t* addon = unwrap_args(env, info, 2, argv);
+    query_work_t* work = calloc(1, sizeof(query_work_t));
+    if (!addon || !get_query(env, argv, by_name, &work->type, &work->name, &work->values)) {
+        free(work);
+        return NULL;
+    }
+    work->owner = addon;
+
+    napi_value promise, resource_name;
+    napi_create_string_utf8(env, by_name ? "opencog.queryByName" : "opencog.queryByType",
+                            NAPI_AUTO_LENGTH, &resource_name);
+    if (napi_create_promise(env, &work->deferred, &promise) != napi_ok ||
+        napi_create_async_work(env, NULL, resource_name, query_execute, query_complete, work,
+                               &work->work) != napi_ok ||
+        napi_queue_async_work(env, work->work) != napi_ok) {
+        free(work->name);
+        free(work);
+        throw_last_error(env);
+        return NULL;
+    }
+    addon->pending++;
+    return promise;
+}
+
+static napi_value space_query_by_type_async(napi_env env, napi_callback_info info) {
+    return query_async(env, info, false);
+}
+
+static napi_value space_query_by_name_async(napi_env env, napi_callback_info info) {
+    return query_async(env, info, true);
+}
+
+static napi_value addon_init(napi_env env, napi_value exports) {
+    napi_property_descriptor methods[] = {
+        { "close", NULL, space_close, NULL, NULL, NULL, napi_default, NULL },
+        { "size", NULL, space_size, NULL, NULL, NULL, napi_default, NULL },
+        { "createNode", NULL, space_create_node, NULL, NULL, NULL, napi_default, NULL },
+        { "createNodes", NULL, space_create_nodes, NULL, NULL, NULL, napi_default, NULL },
+        { "createLink", NULL, space_create_link, NULL, NULL, NULL, napi_default, NULL },
+        { "createLinks", NULL, space_create_links, NULL, NULL, NULL, napi_default, NULL },
+        { "setTruthValues", NULL, space_set_truth_values, NULL, NULL, NULL, napi_default, NULL },
+        { "getValues", NULL, space_get_values, NULL, NULL, NULL, napi_default, NULL },
+        { "remove", NULL, space_remove, NULL, NULL, NULL, napi_default, NULL },
+        { "queryByType", NULL, space_query_by_type, NULL, NULL, NULL, napi_default, NULL },
+        { "queryByName", NULL, space_query_by_name, NULL, NULL, NULL, napi_default, NULL },
+        { "queryByTypeAsync", NULL, space_query_by_type_async, NULL, NULL, NULL, napi_default, NULL },
+        { "queryByNameAsync", NULL, space_query_by_name_async, NULL, NULL, NULL, napi_default, NULL },
+    };
+
+    napi_value constructor;
+    NAPI_CALL(env, napi_define_class(env, "AtomSpace", NAPI_AUTO_LENGTH, space_new, NULL,
+                                     sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "AtomSpace", constructor));
+    return exports;
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, addon_init)
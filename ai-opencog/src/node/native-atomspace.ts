@@ -0,0 +1,110 @@
+// *****************************************************************************
+// Copyright (C) 2024 Eclipse Foundation and others.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Eclipse Public License v. 2.0 which is available at
+// http://www.eclipse.org/legal/epl-2.0.
+//
+// This Source Code may also be made available under the following Secondary
+// Licenses when the conditions for such availability set forth in the Eclipse
+// Public License v. 2.0 are satisfied: GNU General Public License, version 2
+// with the GNU Classpath Exception which is available at
+// https://www.gnu.org/software/classpath/license.html.
+//
+// SPDX-License-Identifier: EPL-2.0 OR GPL-2.0-only WITH Classpath-exception-2.0
+// *****************************************************************************
+
+import * as path from 'path';
+
+/**
+ * Atom types of libopencog_core (`atom_type_t` in opencog-core/include/atom.h).
+ */
+export enum NativeAtomType {
+    Concept = 0,
+    Predicate = 1,
+    Link = 2,
+    Node = 3,
+    Variable = 4,
+    Evaluation = 5,
+    Execution = 6,
+    Custom = 7,
+    And = 8,
+    Or = 9,
+    Not = 10,
+    Implication = 11,
+    Equivalence = 12
+}
+
+/**
+ * Query result in columnar form. All columns are views over one block of
+ * native memory; the value columns are present only when requested.
+ */
+export interface AtomColumns {
+    ids: BigUint64Array;
+    strength?: Float64Array;
+    confidence?: Float64Array;
+    sti?: Int16Array;
+    lti?: Int16Array;
+    vlti?: Int16Array;
+}
+
+/**
+ * An AtomSpace owned by the native addon (native/opencog_addon.c). Atom IDs
+ * are 64-bit and therefore BigInts. Batched calls take typed arrays, which
+ * the addon reads in place; the async queries scan on a libuv worker thread
+ * inside a snapshot, so the main thread can keep writing meanwhile.
+ */
+export interface NativeAtomSpace {
+    size(): number;
+    createNode(type: NativeAtomType, name: string): bigint;
+    /** Name i is the UTF-8 bytes[offsets[i], offsets[i + 1]); see encodeAtomNames */
+    createNodes(type: NativeAtomType, bytes: Uint8Array, offsets: Uint32Array): BigUint64Array;
+    createLink(type: NativeAtomType, targets: BigUint64Array): bigint;
+    /** Link i takes the next arities[i] IDs of targets */
+    createLinks(type: NativeAtomType, targets: BigUint64Array, arities: Uint32Array): BigUint64Array;
+    setTruthValues(ids: BigUint64Array, strength: Float64Array, confidence: Float64Array): void;
+    getValues(ids: BigUint64Array): Required<AtomColumns>;
+    remove(id: bigint): boolean;
+    queryByType(type: NativeAtomType, withValues?: boolean): AtomColumns;
+    queryByName(name: string, withValues?: boolean): AtomColumns;
+    queryByTypeAsync(type: NativeAtomType, withValues?: boolean): Promise<AtomColumns>;
+    queryByNameAsync(name: string, withValues?: boolean): Promise<AtomColumns>;
+    /** Frees the space once running async queries finish; later calls throw */
+    close(): void;
+}
+
+export interface NativeAtomSpaceConstructor {
+    new (nodeId?: number): NativeAtomSpace;
+}
+
+let cached: NativeAtomSpaceConstructor | null | undefined;
+
+/**
+ * Loads the addon built by `npm run build:native`, or returns undefined when
+ * it is not available so callers can fall back to the TypeScript AtomSpace.
+ */
+export function loadNativeAtomSpace(): NativeAtomSpaceConstructor | undefined {
+    if (cached === undefined) {
+        try {
+            // eslint-disable-next-line @typescript-eslint/no-var-requires
+            cached = require(path.join(__dirname, '..', '..', 'build', 'Release', 'opencog_native.node')).AtomSpace;
+        } catch {
+            cached = null;
+        }
+    }
+    return cached ?? undefined;
+}
+
+/**
+ * Packs names for createNodes: one UTF-8 buffer plus count + 1 offsets.
+ */
+export function encodeAtomNames(names: readonly string[]): { bytes: Uint8Array; offsets: Uint32Array } {
+    const encoder = new TextEncoder();
+    const encoded = names.map(name => encoder.encode(name));
+    const offsets = new Uint32Array(names.length + 1);
+    encoded.forEach((bytes, i) => { offsets[i + 1] = offsets[i] + bytes.length; });
+
+    const bytes = new Uint8Array(offsets[names.length]);
+    encoded.forEach((chunk, i) => bytes.set(chunk, offsets[i]));
+    return { bytes, offsets };
+}
@@ -0,0 +1,94 @@
+#!/usr/bin/env node
+/**
+ * Native Addon Validator
+ *
+ * Exercises the opencog_native N-API addon built from native/ against
+ * libopencog_core: batched creation from typed arrays, columnar results
+ * backed by native memory, and queries on worker threads.
+ */
+
+const path = require('path');
+const assert = require('assert');
+
+const addonPath = path.join(__dirname, '..', 'build', 'Release', 'opencog_native.node');
+let native;
+try {
+    native = require(addonPath);
+} catch (error) {
+    console.log(`⚠️  Native addon not built (${addonPath}); run npm run build:native`);
+    process.exit(0);
+}
+
+const CONCEPT = 0;
+const PREDICATE = 1;
+const LINK = 2;
+
+function encodeNames(names) {
+    const encoded = names.map(name => Buffer.from(name, 'utf8'));
+    const offsets = new Uint32Array(names.length + 1);
+    encoded.forEach((bytes, i) => { offsets[i + 1] = offsets[i] + bytes.length; });
+    return { bytes: new Uint8Array(Buffer.concat(encoded)), offsets };
+}
+
+async function main() {
+    console.log('🔍 Validating native AtomSpace addon...\n');
+    const space = new native.AtomSpace(3);
+
+    const cat = space.createNode(CONCEPT, 'cat');
+    assert.strictEqual(typeof cat, 'bigint');
+    assert.strictEqual(cat >> 48n, 3n, 'IDs carry the node ID in the high bits');
+
+    const { bytes, offsets } = encodeNames(['dog', 'bird', 'ünïcode']);
+    const animals = space.createNodes(CONCEPT, bytes, offsets);
+    assert.ok(animals instanceof BigUint64Array && animals.length === 3);
+
+    const targets = new BigUint64Array([cat, animals[0], animals[1], animals[2]]);
+    const links = space.createLinks(LINK, targets, new Uint32Array([2, 2]));
+    assert.strictEqual(links.length, 2);
+    const noNodes = space.createNodes(CONCEPT, new Uint8Array(0), new Uint32Array(0));
+    assert.ok(noNodes instanceof BigUint64Array && noNodes.length === 0, 'empty batches return an empty BigUint64Array');
+    const noLinks = space.createLinks(LINK, new BigUint64Array(0), new Uint32Array(0));
+    assert.ok(noLinks instanceof BigUint64Array && noLinks.length === 0);
+    const single = space.createLink(LINK, new BigUint64Array([cat, animals[2]]));
+    assert.strictEqual(space.size(), 7);
+
+    space.setTruthValues(links, new Float64Array([0.25, 0.75]), new Float64Array([0.5, 0.9]));
+    const values = space.getValues(links);
+    assert.deepStrictEqual(Array.from(values.strength), [0.25, 0.75]);
+    assert.deepStrictEqual(Array.from(values.confidence), [0.5, 0.9]);
+    assert.strictEqual(values.ids.buffer, values.strength.buffer, 'columns share one native block');
+
+    const concepts = space.queryByType(CONCEPT);
+    assert.strictEqual(concepts.ids.length, 4);
+    assert.strictEqual(concepts.strength, undefined);
+    const named = space.queryByName('ünïcode', true);
+    assert.deepStrictEqual(Array.from(named.ids), [animals[2]]);
+    assert.strictEqual(named.strength[0], 1.0);
+
+    const pending = space.queryByTypeAsync(LINK, true);
+    space.close();                          // Deferred until the query finishes
+    const asyncLinks = await pending;
+    assert.strictEqual(asyncLinks.ids.length, 3);
+    const strengthById = new Map(Array.from(asyncLinks.ids, (id, i) => [id, asyncLinks.strength[i]]));
+    assert.strictEqual(strengthById.get(links[1]), 0.75);
+    assert.strictEqual(strengthById.get(single), 1.0);
+    assert.throws(() => space.size(), /closed/);
+
+    const other = new native.AtomSpace();
+    assert.throws(() => other.createNode(99, 'x'), RangeError);
+    assert.throws(() => other.createLinks(LINK, new BigUint64Array([1n]), new Uint32Array([1])), RangeError);
+    assert.throws(() => other.setTruthValues([1n], [0.5], [0.5]), TypeError);
+    const p = other.createNode(PREDICATE, 'likes');
+    assert.strictEqual(other.remove(p), true);
+    assert.strictEqual(other.remove(p), false);
+    const byName = await other.queryByNameAsync('likes');
+    assert.strictEqual(byName.ids.length, 0);
+    other.close();
+
+    console.log('✅ Native addon: creation, columnar results and async queries behave as expected');
+}
+
+main().catch(error => {
+    console.error('❌ Native addon validation failed:', error);
+    process.exit(1);
+});
@@ -0,0 +1,166 @@
+/*
+ * OpenCog Benchmark Support
+ * Timing, percentile statistics and machine-readable result output
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "bench_common.h"
+
+uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t bench_rand(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* Results */
+bench_result_t* bench_result_create(bench_report_t* report, const char* name, const char* kind) {
+    bench_result_t* result = calloc(1, sizeof(bench_result_t));
+    snprintf(result->name, sizeof(result->name), "%s", name);
+    snprintf(result->kind, sizeof(result->kind), "%s", kind);
+    result->sample_capacity = 1024;
+    result->samples = malloc(sizeof(double) * result->sample_capacity);
+
+    report->results = realloc(report->results, sizeof(bench_result_t*) * (report->count + 1));
+    report->results[report->count++] = result;
+    return result;
+}
+
+void bench_record(bench_result_t* result, uint64_t elapsed_ns, uint64_t ops) {
+    if (ops == 0) return;
+
+    if (result->sample_count >= result->sample_capacity) {
+        result->sample_capacity *= 2;
+        result->samples = realloc(result->samples, sizeof(double) * result->sample_capacity);
+    }
+    result->samples[result->sample_count++] = (double)elapsed_ns / (double)ops;
+    result->ops += ops;
+    result->total_ns += elapsed_ns;
+}
+
+void bench_metric(bench_result_t* result, const char* name, double value) {
+    if (result->metric_count >= BENCH_MAX_METRICS) return;
+    bench_metric_t* metric = &result->metrics[result->metric_count++];
+    snprintf(metric->name, sizeof(metric->name), "%s", name);
+    metric->value = value;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile; samples must already be sorted (see bench_result_finish) */
+double bench_percentile(const bench_result_t* result, double pct) {
+    if (result->sample_count == 0) return 0.0;
+
+    size_t rank = (size_t)(pct / 100.0 * (double)result->sample_count + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > result->sample_count) rank = result->sample_count;
+    return result->samples[rank - 1];
+}
+
+static void bench_result_finish(bench_result_t* result) {
+    qsort(result->samples, result->sample_count, sizeof(double), compare_double);
+}
+
+/* Report */
+void bench_report_init(bench_report_t* report, const char* revision, const char* filter, double scale) {
+    memset(report, 0, sizeof(*report));
+    report->revision = revision;
+    report->filter = filter;
+    report->scale = scale > 0.0 ? scale : 1.0;
+}
+
+int bench_report_wants(const bench_report_t* report, const char* name) {
+    return !report->filter || !report->filter[0] || strstr(name, report->filter) != NULL;
+}
+
+size_t bench_report_scaled(const bench_report_t* report, size_t base) {
+    size_t n = (size_t)((double)base * report->scale);
+    return n > 0 ? n : 1;
+}
+
+static double result_mean(const bench_result_t* result) {
+    return result->ops ? (double)result->total_ns / (double)result->ops : 0.0;
+}
+
+static double result_ops_per_sec(const bench_result_t* result) {
+    uint64_t elapsed = result->wall_ns ? result->wall_ns : result->total_ns;
+    return elapsed ? (double)result->ops * 1e9 / (double)elapsed : 0.0;
+}
+
+void bench_report_print(const bench_report_t* report, FILE* out) {
+    fprintf(out, "%-36s %-11s %12s %10s %10s %10s %10s %14s\n",
+            "benchmark", "kind", "ops", "mean(ns)", "p50(ns)", "p99(ns)", "p999(ns)", "ops/sec");
+    for (size_t i = 0; i < report->count; i++) {
+        bench_result_t* r = report->results[i];
+        bench_result_finish(r);
+        fprintf(out, "%-36s %-11s %12llu %10.1f %10.1f %10.1f %10.1f %14.0f\n",
+                r->name, r->kind, (unsigned long long)r->ops, result_mean(r),
+                bench_percentile(r, 50.0), bench_percentile(r, 99.0),
+                bench_percentile(r, 99.9), result_ops_per_sec(r));
+        for (size_t m = 0; m < r->metric_count; m++) {
+            fprintf(out, "%-36s   %s = %.1f\n", "", r->metrics[m].name, r->metrics[m].value);
+        }
+    }
+}
+
+int bench_report_write_json(const bench_report_t* report, const char* suite, const char* path) {
+    FILE* out = (path && strcmp(path, "-") != 0) ? fopen(path, "w") : stdout;
+    if (!out) return -1;
+
+    char hostname[256] = "unknown";
+    gethostname(hostname, sizeof(hostname) - 1);
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"suite\": \"%s\",\n", suite);
+    fprintf(out, "  \"revision\": \"%s\",\n", report->revision ? report->revision : "");
+    fprintf(out, "  \"host\": \"%s\",\n", hostname);
+    fprintf(out, "  \"timestamp\": %lld,\n", (long long)time(NULL));
+    fprintf(out, "  \"scale\": %g,\n", report->scale);
+    fprintf(out, "  \"unit\": \"ns/op\",\n");
+    fprintf(out, "  \"results\": [\n");
+
+    for (size_t i = 0; i < report->count; i++) {
+        bench_result_t* r = report->results[i];
+        bench_result_finish(r);
+        fprintf(out, "    {\"name\": \"%s\", \"kind\": \"%s\", \"ops\": %llu, \"samples\": %zu, "
+                "\"total_ns\": %llu, \"ops_per_sec\": %.1f, \"mean\": %.2f, \"min\": %.2f, "
+                "\"p50\": %.2f, \"p90\": %.2f, \"p99\": %.2f, \"p999\": %.2f, \"max\": %.2f",
+                r->name, r->kind, (unsigned long long)r->ops, r->sample_count,
+                (unsigned long long)r->total_ns, result_ops_per_sec(r), result_mean(r),
+                bench_percentile(r, 0.0), bench_percentile(r, 50.0), bench_percentile(r, 90.0),
+                bench_percentile(r, 99.0), bench_percentile(r, 99.9), bench_percentile(r, 100.0));
+        for (size_t m = 0; m < r->metric_count; m++) {
+            fprintf(out, ", \"%s\": %.2f", r->metrics[m].name, r->metrics[m].value);
+        }
+        fprintf(out, "}%s\n", (i + 1 < report->count) ? "," : "");
+    }
+
+    fprintf(out, "  ]\n}\n");
+
+    if (out != stdout) fclose(out);
+    return 0;
+}
+
+void bench_report_destroy(bench_report_t* report) {
+    for (size_t i = 0; i < report->count; i++) {
+        free(report->results[i]->samples);
+        free(report->results[i]);
+    }
+    free(report->results);
+    report->results = NULL;
+    report->count = 0;
+}
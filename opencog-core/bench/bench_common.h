@@ -0,0 +1,69 @@
+#ifndef OPENCOG_BENCH_COMMON_H
+#define OPENCOG_BENCH_COMMON_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Shared timing, statistics and JSON reporting for the benchmark suite */
+
+#define BENCH_MAX_METRICS 8
+
+/* Named figure reported alongside the latency statistics */
+typedef struct {
+    char name[32];
+    double value;
+} bench_metric_t;
+
+/* One benchmark result: a set of per-operation latency samples (ns/op) */
+typedef struct {
+    char name[64];
+    char kind[16];             /* "micro", "macro" or "distributed" */
+    uint64_t ops;              /* Total operations measured */
+    uint64_t total_ns;         /* Total measured time */
+    uint64_t wall_ns;          /* Elapsed time of concurrent runs; 0 means total_ns */
+    double* samples;           /* Per-op latency of each sampled batch */
+    size_t sample_count;
+    size_t sample_capacity;
+    bench_metric_t metrics[BENCH_MAX_METRICS];
+    size_t metric_count;
+} bench_result_t;
+
+/* Collection of results written out as one JSON document */
+typedef struct {
+    bench_result_t** results;
+    size_t count;
+    const char* revision;      /* Source revision the run was built from */
+    const char* filter;        /* Only run benchmarks whose name contains this */
+    double scale;              /* Workload size multiplier */
+} bench_report_t;
+
+/* Monotonic clock in nanoseconds */
+uint64_t bench_now_ns(void);
+
+/* Deterministic PRNG (splitmix64) so workloads are identical across runs */
+uint64_t bench_rand(uint64_t* state);
+
+/* Results */
+bench_result_t* bench_result_create(bench_report_t* report, const char* name, const char* kind);
+void bench_record(bench_result_t* result, uint64_t elapsed_ns, uint64_t ops);
+double bench_percentile(const bench_result_t* result, double pct);
+void bench_metric(bench_result_t* result, const char* name, double value);
+
+/* Report */
+void bench_report_init(bench_report_t* report, const char* revision, const char* filter, double scale);
+int bench_report_wants(const bench_report_t* report, const char* name);
+size_t bench_report_scaled(const bench_report_t* report, size_t base);
+void bench_report_print(const bench_report_t* report, FILE* out);
+int bench_report_write_json(const bench_report_t* report, const char* suite, const char* path);
+void bench_report_destroy(bench_report_t* report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_BENCH_COMMON_H */
@@ -0,0 +1,327 @@
+/*
+ * OpenCog C++ API Benchmarks
+ * The header-only C++ layer (atomspace.hpp) against the C calls it replaces
+ */
+
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "../include/atomspace.hpp"
+#include "../include/where.hpp"
+#include "bench_common.h"
+
+using namespace opencog;
+
+/* Keep results observable so scans are not optimized away */
+static volatile size_t sink;
+
+/* Nodes with links of arity 2 and 3 over them */
+static std::vector<Atom> populate(AtomSpace& space, size_t count) {
+    std::vector<Atom> atoms;
+    atoms.reserve(count);
+    size_t nodes = count / 2;
+    for (size_t i = 0; i < nodes; i++) {
+        atom_type_t type = (i % 4 == 0) ? ATOM_TYPE_PREDICATE : ATOM_TYPE_CONCEPT;
+        atoms.push_back(space.add_node(type, "atom_" + std::to_string(i)));
+    }
+    uint64_t rng = 67;
+    for (size_t i = nodes; i < count; i++) {
+        Atom a = atoms[bench_rand(&rng) % nodes];
+        Atom b = atoms[bench_rand(&rng) % nodes];
+        atoms.push_back(i % 3 ? space.add_link(ATOM_TYPE_LINK, { a, b })
+                              : space.add_link(ATOM_TYPE_LINK, { a, b, a }));
+    }
+    return atoms;
+}
+
+/* The pattern: binary links */
+static bool match_binary_link(atom_handle_t* handle, void* user_data) {
+    (void)user_data;
+    return handle->atom->type == ATOM_TYPE_LINK && handle->atom->outgoing_count == 2;
+}
+
+static void bench_match(bench_report_t* report, AtomSpace& space, size_t queries) {
+    /* Function-pointer matcher; the result array is the only way to consume it */
+    if (bench_report_wants(report, "c_match_fnptr")) {
+        bench_result_t* r = bench_result_create(report, "c_match_fnptr", "micro");
+        for (size_t i = 0; i < queries; i++) {
+            uint64_t t0 = bench_now_ns();
+            atomspace_read_begin(space.get());
+            size_t count = 0;
+            atom_handle_t** results = atomspace_match_pattern_borrowed(space.get(), match_binary_link, NULL, &count);
+            atomspace_read_end(space.get());
+            free(results);
+            sink = count;
+            bench_record(r, bench_now_ns() - t0, 1);
+        }
+    }
+
+    /* The loop a C caller would write by hand over the raw slots */
+    if (bench_report_wants(report, "c_match_scan")) {
+        bench_result_t* r = bench_result_create(report, "c_match_scan", "micro");
+        for (size_t i = 0; i < queries; i++) {
+            uint64_t t0 = bench_now_ns();
+            atomspace_read_begin(space.get());
+            size_t total = 0, count = 0;
+            atom_handle_t* const* slots = atomspace_scan_slots(space.get(), &total);
+            for (size_t j = 0; j < total; j++) {
+                atom_handle_t* handle = slots[j];
+                if (handle && atom_visible_at(handle->atom, MVCC_LATEST) && match_binary_link(handle, NULL)) {
+                    count++;
+                }
+            }
+            atomspace_read_end(space.get());
+            sink = count;
+            bench_record(r, bench_now_ns() - t0, 1);
+        }
+    }
+
+    if (bench_report_wants(report, "cpp_match")) {
+        bench_result_t* r = bench_result_create(report, "cpp_match", "micro");
+        for (size_t i = 0; i < queries; i++) {
+            uint64_t t0 = bench_now_ns();
+            {
+                ReadSection read(space);
+                sink = space.count_if(read, [](Atom a) {
+                    return a.type() == ATOM_TYPE_LINK && a.arity() == 2;
+                });
+            }
+            bench_record(r, bench_now_ns() - t0, 1);
+        }
+    }
+}
+
+static void bench_by_type(bench_report_t* report, AtomSpace& space, size_t queries) {
+    if (bench_report_wants(report, "c_by_type_borrowed")) {
+        bench_result_t* r = bench_result_create(report, "c_by_type_borrowed", "micro");
+        for (size_t i = 0; i < queries; i++) {
+            atom_type_t type = (i % 2) ? ATOM_TYPE_PREDICATE : ATOM_TYPE_CONCEPT;
+            uint64_t t0 = bench_now_ns();
+            atomspace_read_begin(space.get());
+            size_t count = 0;
+            atom_handle_t** results = atomspace_get_atoms_by_type_borrowed(space.get(), type, &count);
+            uint64_t sum = 0;
+            for (size_t j = 0; j < count; j++) sum += results[j]->id;
+            free(results);
+            atomspace_read_end(space.get());
+            sink = sum;
+            bench_record(r, bench_now_ns() - t0, 1);
+        }
+    }
+
+    if (bench_report_wants(report, "cpp_by_type")) {
+        bench_result_t* r = bench_result_create(report, "cpp_by_type", "micro");
+        for (size_t i = 0; i < queries; i++) {
+            atom_type_t type = (i % 2) ? ATOM_TYPE_PREDICATE : ATOM_TYPE_CONCEPT;
+            uint64_t t0 = bench_now_ns();
+            {
+                ReadSection read(space);
+                uint64_t sum = 0;
+                for (Atom a : space.by_type(read, type)) sum += a.id();
+                sink = sum;
+            }
+            bench_record(r, bench_now_ns() - t0, 1);
+        }
+    }
+}
+
+/* Hold a reference to every atom, hand the set over once, then drop it */
+static void bench_references(bench_report_t* report, const std::vector<Atom>& atoms, size_t rounds) {
+    size_t n = atoms.size();
+
+    if (bench_report_wants(report, "c_retain_release")) {
+        bench_result_t* r = bench_result_create(report, "c_retain_release", "micro");
+        for (size_t i = 0; i < rounds; i++) {
+            uint64_t t0 = bench_now_ns();
+            atom_handle_t** held = (atom_handle_t**)malloc(sizeof(atom_handle_t*) * n);
+            for (size_t j = 0; j < n; j++) {
+                atom_retain(atoms[j].handle());
+                held[j] = atoms[j].handle();
+            }
+            atom_handle_t** owner = held;
+            for (size_t j = 0; j < n; j++) atom_release(owner[j]);
+            free(owner);
+            bench_record(r, bench_now_ns() - t0, n);
+        }
+    }
+
+    if (bench_report_wants(report, "cpp_atomref")) {
+        bench_result_t* r = bench_result_create(report, "cpp_atomref", "micro");
+        for (size_t i = 0; i < rounds; i++) {
+            uint64_t t0 = bench_now_ns();
+            std::vector<AtomRef> held;
+            held.reserve(n);
+            for (Atom a : atoms) held.push_back(AtomRef::retain(a));
+            std::vector<AtomRef> owner = std::move(held);
+            owner.clear();
+            bench_record(r, bench_now_ns() - t0, n);
+        }
+    }
+}
+
+/*
+ * Compile-time fused filters (where.hpp) against atomspace_match_pattern's
+ * per-atom callback on a large space: nodes of four types with a spread of
+ * TVs and 1M distinct names, plus binary links over them.
+ */
+static void populate_large(atomspace_t* space, size_t count) {
+    const size_t batch = 65536;
+    std::vector<std::string> names(batch);
+    std::vector<const char*> name_ptrs(batch);
+    std::vector<atom_handle_t*> handles(batch);
+    std::vector<atom_handle_t*> targets(batch * 2);
+    std::vector<size_t> arities(batch, 2);
+    size_t nodes = count - count / 5;
+    atom_handle_t* recent[1024] = { NULL };
+    uint64_t rng = 68;
+
+    for (size_t done = 0; done < nodes; done += batch) {
+        size_t n = std::min(batch, nodes - done);
+        atom_type_t type = (atom_type_t)((done / batch) % 4);
+        for (size_t i = 0; i < n; i++) {
+            names[i] = "n_" + std::to_string((done + i) % 1000000);
+            name_ptrs[i] = names[i].c_str();
+        }
+        atom_create_batch(space, type, name_ptrs.data(), n, handles.data());
+        for (size_t i = 0; i < n; i++) {
+            atom_set_tv(handles[i], (double)((done + i) % 100) / 100.0, 0.5);
+        }
+        for (size_t i = 0; i < 1024 && i < n; i++) recent[i] = handles[bench_rand(&rng) % n];
+    }
+    for (size_t done = nodes; done < count; done += batch) {
+        size_t n = std::min(batch, count - done);
+        for (size_t i = 0; i < n * 2; i++) targets[i] = recent[bench_rand(&rng) % 1024];
+        atom_create_link_batch(space, ATOM_TYPE_LINK, targets.data(), arities.data(), n, handles.data());
+    }
+}
+
+typedef struct {
+    atom_type_t type;
+    double min_strength;
+    const char* name;
+} kernel_pattern_t;
+
+static bool match_type_arity(atom_handle_t* handle, void* user_data) {
+    (void)user_data;
+    return handle->atom->type == ATOM_TYPE_LINK && handle->atom->outgoing_count == 2;
+}
+
+static bool match_type_strength(atom_handle_t* handle, void* user_data) {
+    kernel_pattern_t* pattern = (kernel_pattern_t*)user_data;
+    return handle->atom->type == pattern->type && handle->atom->tv.strength >= pattern->min_strength;
+}
+
+static bool match_type_name(atom_handle_t* handle, void* user_data) {
+    kernel_pattern_t* pattern = (kernel_pattern_t*)user_data;
+    return handle->atom->type == pattern->type && handle->atom->name &&
+           strcmp(handle->atom->name, pattern->name) == 0;
+}
+
+template <typename Filter>
+static void bench_kernel(bench_report_t* report, AtomSpace& space, size_t queries, const char* c_name,
+                         pattern_matcher_fn matcher, kernel_pattern_t* pattern,
+                         const char* cpp_name, Filter filter) {
+    size_t c_count = 0, cpp_count = 0;
+    if (bench_report_wants(report, c_name)) {
+        bench_result_t* r = bench_result_create(report, c_name, "micro");
+        for (size_t i = 0; i < queries; i++) {
+            uint64_t t0 = bench_now_ns();
+            atomspace_read_begin(space.get());
+            atom_handle_t** results = atomspace_match_pattern_borrowed(space.get(), matcher, pattern, &c_count);
+            atomspace_read_end(space.get());
+            free(results);
+            bench_record(r, bench_now_ns() - t0, 1);
+        }
+        bench_metric(r, "matches", (double)c_count);
+    }
+    if (bench_report_wants(report, cpp_name)) {
+        bench_result_t* r = bench_result_create(report, cpp_name, "micro");
+        for (size_t i = 0; i < queries; i++) {
+            uint64_t t0 = bench_now_ns();
+            {
+                ReadSection read(space);
+                cpp_count = space.match(read, filter).collect().size();
+            }
+            bench_record(r, bench_now_ns() - t0, 1);
+        }
+        bench_metric(r, "matches", (double)cpp_count);
+    }
+}
+
+static void bench_kernels(bench_report_t* report, size_t queries) {
+    static const char* const names[] = {
+        "kernel_type_arity_callback", "kernel_type_arity_fused", "kernel_type_tv_callback",
+        "kernel_type_tv_fused", "kernel_type_name_callback", "kernel_type_name_fused"
+    };
+    bool wanted = false;
+    for (const char* name : names) wanted = wanted || bench_report_wants(report, name);
+    if (!wanted) return;
+
+    AtomSpace space;
+    populate_large(space.get(), bench_report_scaled(report, 10000000));
+    kernel_pattern_t pattern = { ATOM_TYPE_PREDICATE, 0.9, "n_4242" };
+
+    bench_kernel(report, space, queries, "kernel_type_arity_callback", match_type_arity, &pattern,
+                 "kernel_type_arity_fused", where::type<ATOM_TYPE_LINK>() && where::arity(2));
+    bench_kernel(report, space, queries, "kernel_type_tv_callback", match_type_strength, &pattern,
+                 "kernel_type_tv_fused", where::type<ATOM_TYPE_PREDICATE>() && where::tv_at_least(0.9));
+    bench_kernel(report, space, queries, "kernel_type_name_callback", match_type_name, &pattern,
+                 "kernel_type_name_fused", where::name("n_4242") && where::type<ATOM_TYPE_PREDICATE>());
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [-o results.json] [-r revision] [-f filter] [-s scale]\n"
+            "  -o FILE   write JSON results to FILE ('-' for stdout)\n"
+            "  -r REV    source revision recorded in the results\n"
+            "  -f NAME   run only benchmarks whose name contains NAME\n"
+            "  -s SCALE  multiply workload sizes by SCALE (default 1.0)\n",
+            prog);
+}
+
+int main(int argc, char** argv) {
+    const char* output = NULL;
+    const char* revision = "";
+    const char* filter = NULL;
+    double scale = 1.0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:r:f:s:h")) != -1) {
+        switch (opt) {
+            case 'o': output = optarg; break;
+            case 'r': revision = optarg; break;
+            case 'f': filter = optarg; break;
+            case 's': scale = atof(optarg); break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    bench_report_t report;
+    bench_report_init(&report, revision, filter, scale);
+
+    {
+        AtomSpace space;
+        std::vector<Atom> atoms = populate(space, bench_report_scaled(&report, 200000));
+        bench_match(&report, space, 200);
+        bench_by_type(&report, space, 200);
+        bench_references(&report, atoms, 50);
+    }
+    bench_kernels(&report, 10);
+
+    bench_report_print(&report, stdout);
+
+    int status = 0;
+    if (output && bench_report_write_json(&report, "opencog-core-cpp", output) != 0) {
+        fprintf(stderr, "Failed to write results to %s\n", output);
+        status = 1;
+    }
+
+    bench_report_destroy(&report);
+    return status;
+}
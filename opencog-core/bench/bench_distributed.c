@@ -0,0 +1,640 @@
+/*
+ * OpenCog Distributed Benchmark Harness
+ * Forks N node processes on localhost and drives message, sync and query
+ * workloads through distributed_ctx_t, without any network access
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sched.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "../include/atom.h"
+#include "../include/distributed.h"
+#include "../include/workload.h"
+#include "bench_common.h"
+
+#define MAX_NODES 16
+
+/* Each run scopes its queues by the harness pid and records itself here */
+#define RUN_DIR "/tmp"
+#define RUN_PREFIX "opencog_bench_"
+
+/* Workloads */
+typedef enum {
+    DIST_MESSAGE,        /* One-way ATOM_UPDATE stream around a ring of nodes */
+    DIST_SYNC,           /* SYNC_REQUEST answered with a batch of atom records */
+    DIST_QUERY,          /* ATOM_QUERY by name answered with matching atom IDs */
+    DIST_WORKLOAD_COUNT
+} dist_workload_t;
+
+static const char* workload_names[DIST_WORKLOAD_COUNT] = { "message", "sync", "query" };
+
+typedef struct {
+    int nodes;
+    size_t requests;         /* Messages or requests issued by each node */
+    size_t payload;          /* Payload bytes of the message workload */
+    size_t window;           /* Outstanding requests per node */
+    size_t atoms;            /* AtomSpace size for sync and query */
+    size_t sync_batch;       /* Atom records per sync response */
+    int timeout_s;
+    uint32_t base_id;        /* Node IDs are base_id + index */
+} harness_config_t;
+
+/* Record carried in sync responses */
+typedef struct {
+    uint64_t id;
+    double strength;
+    double confidence;
+} sync_record_t;
+
+/* Per-node results, written by each node process into the shared segment */
+typedef struct {
+    uint64_t sent;               /* Messages sent, including replies */
+    uint64_t received;
+    uint64_t completed;          /* Messages delivered or requests answered */
+    uint64_t wire_bytes;         /* Serialized bytes handed to the queues */
+    uint64_t queue_full;         /* Sends retried because a queue was full */
+    uint64_t cpu_ns;             /* User + system CPU of the node process */
+    uint64_t end_ns;
+    uint64_t sample_count;
+    int status;
+} node_result_t;
+
+/* Shared segment layout; latency samples of node i start at samples[i * requests] */
+typedef struct {
+    uint32_t ready;
+    uint32_t failed;
+    uint32_t go;
+    uint32_t done;
+    uint64_t start_ns;
+    node_result_t nodes[MAX_NODES];
+    uint64_t samples[];
+} harness_shared_t;
+
+/* Reply that could not be sent yet because the requester's queue was full */
+typedef struct pending_reply {
+    message_type_t type;
+    uint32_t dest;
+    uint64_t timestamp;
+    size_t size;
+    struct pending_reply* next;
+    char payload[];
+} pending_reply_t;
+
+typedef struct {
+    const harness_config_t* cfg;
+    dist_workload_t workload;
+    int index;
+    uint32_t id;
+    distributed_ctx_t* ctx;
+    atomspace_t* space;
+    harness_shared_t* shared;
+    uint64_t* samples;
+    node_result_t result;
+    size_t issued;
+    size_t outstanding;
+    uint64_t rng;
+    char* payload;
+    pending_reply_t* backlog;
+    pending_reply_t* backlog_tail;
+} node_t;
+
+/* Messaging */
+static uint32_t peer_id(const node_t* node, size_t k) {
+    int peers = node->cfg->nodes - 1;
+    if (peers == 0) return node->id;
+    return node->cfg->base_id + (uint32_t)((node->index + 1 + (int)(k % (size_t)peers)) % node->cfg->nodes);
+}
+
+static int send_to(node_t* node, message_type_t type, uint32_t dest, uint64_t timestamp,
+                   void* payload, size_t size) {
+    message_t msg = {
+        .type = type,
+        .source_node = node->id,
+        .dest_node = dest,
+        .timestamp = timestamp,
+        .payload_size = size,
+        .payload = payload
+    };
+    if (distributed_send_message(node->ctx, &msg) != 0) {
+        node->result.queue_full++;
+        return -1;
+    }
+    node->result.sent++;
+    node->result.wire_bytes += sizeof(message_t) + size;
+    return 0;
+}
+
+/* Send queued replies in order; returns true if any were sent */
+static bool flush_backlog(node_t* node) {
+    bool sent = false;
+    while (node->backlog &&
+           send_to(node, node->backlog->type, node->backlog->dest, node->backlog->timestamp,
+                   node->backlog->payload, node->backlog->size) == 0) {
+        pending_reply_t* next = node->backlog->next;
+        free(node->backlog);
+        node->backlog = next;
+        sent = true;
+    }
+    if (!node->backlog) node->backlog_tail = NULL;
+    return sent;
+}
+
+/*
+ * Replies are never dropped. A reply to a full queue is parked and retried
+ * from the main loop, which keeps draining this node's own queue meanwhile;
+ * blocking here instead could deadlock two nodes replying to each other.
+ */
+static void reply(node_t* node, message_type_t type, const message_t* request,
+                  void* payload, size_t size) {
+    if (!node->backlog &&
+        send_to(node, type, request->source_node, request->timestamp, payload, size) == 0) {
+        return;
+    }
+    pending_reply_t* pending = malloc(sizeof(pending_reply_t) + size);
+    pending->type = type;
+    pending->dest = request->source_node;
+    pending->timestamp = request->timestamp;
+    pending->size = size;
+    pending->next = NULL;
+    if (size) memcpy(pending->payload, payload, size);
+    if (node->backlog_tail) node->backlog_tail->next = pending;
+    else node->backlog = pending;
+    node->backlog_tail = pending;
+}
+
+static void record_latency(node_t* node, uint64_t sent_ns) {
+    if (node->result.sample_count < node->cfg->requests) {
+        node->samples[node->result.sample_count++] = bench_now_ns() - sent_ns;
+    }
+    node->result.completed++;
+}
+
+static int issue(node_t* node) {
+    const harness_config_t* cfg = node->cfg;
+    uint64_t now = bench_now_ns();
+
+    switch (node->workload) {
+        case DIST_MESSAGE:
+            /* Ring: every node streams to its successor */
+            return send_to(node, MSG_TYPE_ATOM_UPDATE, peer_id(node, 0), now,
+                           node->payload, cfg->payload);
+        case DIST_SYNC: {
+            uint64_t offset = bench_rand(&node->rng) % (node->space->atom_count + 1);
+            return send_to(node, MSG_TYPE_SYNC_REQUEST, peer_id(node, node->issued), now,
+                           &offset, sizeof(offset));
+        }
+        case DIST_QUERY: {
+            char name[64];
+            uint64_t rank = bench_rand(&node->rng) % (cfg->atoms / 4 + 1);
+            snprintf(name, sizeof(name), "entity_%llu", (unsigned long long)rank);
+            return send_to(node, MSG_TYPE_ATOM_QUERY, peer_id(node, node->issued), now,
+                           name, strlen(name) + 1);
+        }
+        default:
+            return -1;
+    }
+}
+
+static void serve_sync(node_t* node, const message_t* request) {
+    atomspace_t* space = node->space;
+    sync_record_t records[256];
+    size_t count = 0;
+    uint64_t offset = 0;
+    if (request->payload_size >= sizeof(offset)) memcpy(&offset, request->payload, sizeof(offset));
+
+    for (size_t i = offset; i < space->atom_count && count < node->cfg->sync_batch; i++) {
+        atom_handle_t* handle = space->atoms[i];
+        truth_value_t tv = atom_get_tv(handle);
+        records[count].id = handle->id;
+        records[count].strength = tv.strength;
+        records[count].confidence = tv.confidence;
+        count++;
+    }
+    reply(node, MSG_TYPE_SYNC_RESPONSE, request, records, count * sizeof(sync_record_t));
+}
+
+static void serve_query(node_t* node, const message_t* request) {
+    uint64_t ids[256];
+    size_t count = 0;
+    atom_handle_t** matches = NULL;
+    if (request->payload_size > 0 && ((char*)request->payload)[request->payload_size - 1] == '\0') {
+        matches = atomspace_get_atoms_by_name(node->space, (const char*)request->payload, &count);
+    }
+    size_t returned = count < 256 ? count : 256;
+    for (size_t i = 0; i < count; i++) {
+        if (i < returned) ids[i] = matches[i]->id;
+        atom_release(matches[i]);
+    }
+    free(matches);
+    reply(node, MSG_TYPE_ATOM_RESPONSE, request, ids, returned * sizeof(uint64_t));
+}
+
+static void handle(node_t* node, message_t* msg) {
+    node->result.received++;
+    switch (msg->type) {
+        case MSG_TYPE_ATOM_UPDATE:
+            record_latency(node, msg->timestamp);
+            break;
+        case MSG_TYPE_SYNC_REQUEST:
+            serve_sync(node, msg);
+            break;
+        case MSG_TYPE_ATOM_QUERY:
+            serve_query(node, msg);
+            break;
+        case MSG_TYPE_SYNC_RESPONSE:
+        case MSG_TYPE_ATOM_RESPONSE:
+            record_latency(node, msg->timestamp);
+            node->outstanding--;
+            break;
+        default:
+            /* NODE_LEAVE wakes nodes blocked waiting for the end of the run */
+            break;
+    }
+}
+
+/* Node process */
+static int node_setup(node_t* node) {
+    const harness_config_t* cfg = node->cfg;
+    node->id = cfg->base_id + (uint32_t)node->index;
+    node->rng = 0x5eed0000ULL + (uint64_t)node->index;
+    node->samples = &node->shared->samples[(size_t)node->index * cfg->requests];
+
+    node->ctx = distributed_create(node->id, "localhost", (uint16_t)(7000 + node->index));
+    if (!node->ctx || !node->ctx->mq) return -1;
+    for (int i = 0; i < cfg->nodes; i++) {
+        if (i == node->index) continue;
+        distributed_add_node(node->ctx, cfg->base_id + (uint32_t)i, "localhost", (uint16_t)(7000 + i));
+    }
+
+    if (node->workload == DIST_MESSAGE) {
+        node->payload = calloc(1, cfg->payload ? cfg->payload : 1);
+    } else {
+        workload_config_t wl;
+        workload_config_default(&wl);
+        wl.seed = (uint64_t)node->index + 1;
+        wl.atom_count = cfg->atoms;
+        wl.name_vocabulary = cfg->atoms / 4 + 1;
+        node->space = atomspace_create((uint32_t)node->index + 1);
+        if (workload_generate(node->space, &wl, NULL) != 0) return -1;
+    }
+    return 0;
+}
+
+static void node_loop(node_t* node) {
+    const harness_config_t* cfg = node->cfg;
+    harness_shared_t* shared = node->shared;
+    bool one_way = node->workload == DIST_MESSAGE;
+    bool finished = false;
+
+    for (;;) {
+        bool progress = flush_backlog(node);
+        bool can_issue = node->issued < cfg->requests && (one_way || node->outstanding < cfg->window);
+
+        if (can_issue && issue(node) == 0) {
+            node->issued++;
+            if (!one_way) node->outstanding++;
+            progress = true;
+        }
+
+        message_t* msg;
+        while ((msg = distributed_receive_message(node->ctx, 0)) != NULL) {
+            handle(node, msg);
+            distributed_free_message(msg);
+            progress = true;
+        }
+
+        if (!finished && node->issued == cfg->requests && node->outstanding == 0 &&
+            (!one_way || node->result.completed >= cfg->requests)) {
+            finished = true;
+            /* The last node to finish wakes the others */
+            if (__atomic_add_fetch(&shared->done, 1, __ATOMIC_ACQ_REL) == (uint32_t)cfg->nodes) {
+                for (int i = 0; i < cfg->nodes - 1; i++) {
+                    send_to(node, MSG_TYPE_NODE_LEAVE, peer_id(node, (size_t)i), 0, NULL, 0);
+                }
+            }
+        }
+        if (finished && __atomic_load_n(&shared->done, __ATOMIC_ACQUIRE) == (uint32_t)cfg->nodes) {
+            break;
+        }
+
+        if (!progress) {
+            can_issue = node->issued < cfg->requests && (one_way || node->outstanding < cfg->window);
+            if (can_issue || node->backlog) {
+                /* Destination queue full */
+                sched_yield();
+            } else if ((msg = distributed_receive_message(node->ctx, 1)) != NULL) {
+                /* A response, a ring message or the final wake-up is guaranteed to arrive */
+                handle(node, msg);
+                distributed_free_message(msg);
+            }
+        }
+    }
+}
+
+static uint64_t process_cpu_ns(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (uint64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000ULL +
+           (uint64_t)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000ULL;
+}
+
+static int node_main(const harness_config_t* cfg, dist_workload_t workload, int index,
+                     shared_memory_t* shm, harness_shared_t* shared) {
+    node_t node;
+    memset(&node, 0, sizeof(node));
+    node.cfg = cfg;
+    node.workload = workload;
+    node.index = index;
+    node.shared = shared;
+
+    if (node_setup(&node) != 0) {
+        __atomic_add_fetch(&shared->failed, 1, __ATOMIC_ACQ_REL);
+    }
+    __atomic_add_fetch(&shared->ready, 1, __ATOMIC_ACQ_REL);
+
+    /* go is set to 1 to start and 2 to abort */
+    uint32_t go;
+    while ((go = __atomic_load_n(&shared->go, __ATOMIC_ACQUIRE)) == 0) {
+        usleep(100);
+    }
+
+    int status = -1;
+    if (go == 1) {
+        uint64_t cpu_start = process_cpu_ns();
+        node_loop(&node);
+        node.result.cpu_ns = process_cpu_ns() - cpu_start;
+        node.result.end_ns = bench_now_ns();
+        status = 0;
+    }
+    node.result.status = status;
+
+    shared_memory_lock(shm);
+    shared->nodes[index] = node.result;
+    shared_memory_unlock(shm);
+
+    distributed_destroy(node.ctx);
+    atomspace_destroy(node.space);
+    free(node.payload);
+    return status;
+}
+
+/* Harness */
+static void remove_queues(const harness_config_t* cfg) {
+    /* Queues of crashed or killed nodes would otherwise outlive the run */
+    for (int i = 0; i < cfg->nodes; i++) {
+        distributed_remove_node_queue(cfg->base_id + (uint32_t)i);
+    }
+}
+
+static void run_scope(pid_t pid, char* scope, size_t size) {
+    snprintf(scope, size, "bench%d", (int)pid);
+}
+
+static void run_file(pid_t pid, char* path, size_t size) {
+    snprintf(path, size, RUN_DIR "/" RUN_PREFIX "%d.run", (int)pid);
+}
+
+/* Remove the queues of earlier runs whose harness died before cleaning up */
+static void remove_stale_runs(uint32_t base_id) {
+    DIR* dir = opendir(RUN_DIR);
+    if (!dir) return;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        int pid;
+        char tail[8];
+        if (sscanf(entry->d_name, RUN_PREFIX "%d%7s", &pid, tail) != 2 || strcmp(tail, ".run") != 0 ||
+            pid <= 0 || pid == (int)getpid() || kill(pid, 0) == 0 || errno != ESRCH) {
+            continue;
+        }
+        char scope[32], path[64];
+        run_scope(pid, scope, sizeof(scope));
+        distributed_set_queue_scope(scope);
+        for (uint32_t i = 0; i < MAX_NODES; i++) {
+            distributed_remove_node_queue(base_id + i);
+        }
+        run_file(pid, path, sizeof(path));
+        unlink(path);
+    }
+    closedir(dir);
+    distributed_set_queue_scope(NULL);
+}
+
+static int wait_children(pid_t* pids, int count, int timeout_s) {
+    uint64_t deadline = bench_now_ns() + (uint64_t)timeout_s * 1000000000ULL;
+    int remaining = count;
+    int failures = 0;
+
+    while (remaining > 0) {
+        for (int i = 0; i < count; i++) {
+            int status;
+            if (pids[i] > 0 && waitpid(pids[i], &status, WNOHANG) == pids[i]) {
+                if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) failures++;
+                pids[i] = 0;
+                remaining--;
+            }
+        }
+        if (remaining > 0 && bench_now_ns() > deadline) {
+            fprintf(stderr, "timed out after %d s; killing %d node(s)\n", timeout_s, remaining);
+            for (int i = 0; i < count; i++) {
+                if (pids[i] > 0) {
+                    kill(pids[i], SIGKILL);
+                    waitpid(pids[i], NULL, 0);
+                }
+            }
+            return -1;
+        }
+        if (remaining > 0) usleep(1000);
+    }
+    return failures ? -1 : 0;
+}
+
+static int run_workload(bench_report_t* report, const harness_config_t* cfg, dist_workload_t workload) {
+    size_t shared_size = sizeof(harness_shared_t) + (size_t)cfg->nodes * cfg->requests * sizeof(uint64_t);
+    shared_memory_t* shm = shared_memory_create(shared_size + 4096);
+    if (!shm) {
+        fprintf(stderr, "%s: shared memory unavailable\n", workload_names[workload]);
+        return -1;
+    }
+    harness_shared_t* shared = shared_memory_lock(shm);
+    memset(shared, 0, shared_size);
+    shared_memory_unlock(shm);
+
+    pid_t pids[MAX_NODES] = {0};
+    fflush(NULL);
+    for (int i = 0; i < cfg->nodes; i++) {
+        pids[i] = fork();
+        if (pids[i] == 0) {
+            _exit(node_main(cfg, workload, i, shm, shared) == 0 ? 0 : 1);
+        }
+        if (pids[i] < 0) {
+            fprintf(stderr, "fork failed\n");
+            __atomic_store_n(&shared->go, 2, __ATOMIC_RELEASE);
+            wait_children(pids, i, cfg->timeout_s);
+            remove_queues(cfg);
+            shared_memory_destroy(shm);
+            return -1;
+        }
+    }
+
+    /* Start all nodes together once every queue and AtomSpace is ready */
+    uint64_t deadline = bench_now_ns() + (uint64_t)cfg->timeout_s * 1000000000ULL;
+    while (__atomic_load_n(&shared->ready, __ATOMIC_ACQUIRE) < (uint32_t)cfg->nodes &&
+           bench_now_ns() < deadline) {
+        usleep(1000);
+    }
+    bool ready = __atomic_load_n(&shared->ready, __ATOMIC_ACQUIRE) == (uint32_t)cfg->nodes &&
+                 __atomic_load_n(&shared->failed, __ATOMIC_ACQUIRE) == 0;
+    shared->start_ns = bench_now_ns();
+    __atomic_store_n(&shared->go, ready ? 1 : 2, __ATOMIC_RELEASE);
+
+    int status = wait_children(pids, cfg->nodes, cfg->timeout_s);
+    remove_queues(cfg);
+    if (!ready || status != 0) {
+        fprintf(stderr, "%s: node setup or run failed (message queues unavailable?)\n",
+                workload_names[workload]);
+        shared_memory_destroy(shm);
+        return -1;
+    }
+
+    /* Merge per-node results */
+    char name[64];
+    snprintf(name, sizeof(name), "dist_%s_n%d", workload_names[workload], cfg->nodes);
+    bench_result_t* r = bench_result_create(report, name, "distributed");
+    uint64_t sent = 0, wire_bytes = 0, cpu_ns = 0, queue_full = 0, end_ns = shared->start_ns;
+
+    for (int i = 0; i < cfg->nodes; i++) {
+        node_result_t* n = &shared->nodes[i];
+        uint64_t* samples = &shared->samples[(size_t)i * cfg->requests];
+        for (uint64_t s = 0; s < n->sample_count; s++) {
+            bench_record(r, samples[s], 1);
+        }
+        sent += n->sent;
+        wire_bytes += n->wire_bytes;
+        cpu_ns += n->cpu_ns;
+        queue_full += n->queue_full;
+        if (n->end_ns > end_ns) end_ns = n->end_ns;
+    }
+
+    r->wall_ns = end_ns - shared->start_ns;
+    double seconds = (double)r->wall_ns / 1e9;
+    bench_metric(r, "messages", (double)sent);
+    bench_metric(r, "messages_per_sec", seconds > 0.0 ? (double)sent / seconds : 0.0);
+    bench_metric(r, "wire_bytes", (double)wire_bytes);
+    bench_metric(r, "wire_bytes_per_msg", sent ? (double)wire_bytes / (double)sent : 0.0);
+    bench_metric(r, "cpu_ns_per_msg", sent ? (double)cpu_ns / (double)sent : 0.0);
+    bench_metric(r, "queue_full_retries", (double)queue_full);
+
+    shared_memory_destroy(shm);
+    return 0;
+}
+
+static int parse_workloads(const char* spec, bool* enabled) {
+    if (strcmp(spec, "all") == 0) {
+        for (int w = 0; w < DIST_WORKLOAD_COUNT; w++) enabled[w] = true;
+        return 0;
+    }
+    for (const char* p = spec; *p; ) {
+        size_t len = strcspn(p, ",");
+        int found = -1;
+        for (int w = 0; w < DIST_WORKLOAD_COUNT; w++) {
+            if (strlen(workload_names[w]) == len && strncmp(workload_names[w], p, len) == 0) found = w;
+        }
+        if (found < 0) return -1;
+        enabled[found] = true;
+        p += len;
+        if (*p == ',') p++;
+    }
+    return 0;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [-n nodes] [-w workloads] [-c requests] [-p bytes] [-W window]\n"
+            "          [-a atoms] [-b batch] [-T seconds] [-o results.json] [-r revision] [-s scale]\n"
+            "  -n N      node processes to fork (default 4, max %d)\n"
+            "  -w LIST   message,sync,query or all (default all)\n"
+            "  -c N      messages or requests per node (default 20000 x scale)\n"
+            "  -p BYTES  message workload payload size (default 64)\n"
+            "  -W N      outstanding requests per node (default 8)\n"
+            "  -a N      atoms per node for sync and query (default 10000 x scale)\n"
+            "  -b N      atom records per sync response (default 32, max 256)\n"
+            "  -T SECS   kill the run after SECS seconds (default 120)\n"
+            "  -o FILE   write JSON results to FILE ('-' for stdout)\n"
+            "  -r REV    source revision recorded in the results\n"
+            "  -s SCALE  multiply default workload sizes by SCALE (default 1.0)\n",
+            prog, MAX_NODES);
+}
+
+int main(int argc, char** argv) {
+    harness_config_t cfg = {
+        .nodes = 4, .requests = 0, .payload = 64, .window = 8,
+        .atoms = 0, .sync_batch = 32, .timeout_s = 120
+    };
+    bool enabled[DIST_WORKLOAD_COUNT] = { false };
+    const char* workloads = "all";
+    const char* output = NULL;
+    const char* revision = "";
+    double scale = 1.0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:w:c:p:W:a:b:T:o:r:s:h")) != -1) {
+        switch (opt) {
+            case 'n': cfg.nodes = atoi(optarg); break;
+            case 'w': workloads = optarg; break;
+            case 'c': cfg.requests = strtoull(optarg, NULL, 10); break;
+            case 'p': cfg.payload = strtoull(optarg, NULL, 10); break;
+            case 'W': cfg.window = strtoull(optarg, NULL, 10); break;
+            case 'a': cfg.atoms = strtoull(optarg, NULL, 10); break;
+            case 'b': cfg.sync_batch = strtoull(optarg, NULL, 10); break;
+            case 'T': cfg.timeout_s = atoi(optarg); break;
+            case 'o': output = optarg; break;
+            case 'r': revision = optarg; break;
+            case 's': scale = atof(optarg); break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (cfg.nodes < 1 || cfg.nodes > MAX_NODES || cfg.window < 1 || cfg.sync_batch < 1 ||
+        cfg.sync_batch > 256 || cfg.payload > 4096 || parse_workloads(workloads, enabled) != 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    bench_report_t report;
+    bench_report_init(&report, revision, NULL, scale);
+    if (cfg.requests == 0) cfg.requests = bench_report_scaled(&report, 20000);
+    if (cfg.atoms == 0) cfg.atoms = bench_report_scaled(&report, 10000);
+    cfg.base_id = 1;
+
+    /* Concurrent runs never share a queue; a crashed run's are removed by the next one */
+    char scope[32], path[64];
+    remove_stale_runs(cfg.base_id);
+    run_scope(getpid(), scope, sizeof(scope));
+    run_file(getpid(), path, sizeof(path));
+    FILE* marker = fopen(path, "w");
+    if (marker) fclose(marker);
+    distributed_set_queue_scope(scope);
+
+    int failures = 0;
+    for (int w = 0; w < DIST_WORKLOAD_COUNT; w++) {
+        if (enabled[w] && run_workload(&report, &cfg, (dist_workload_t)w) != 0) failures++;
+    }
+    unlink(path);
+
+    bench_report_print(&report, stdout);
+    if (output && bench_report_write_json(&report, "opencog-core-distributed", output) != 0) {
+        fprintf(stderr, "Failed to write results to %s\n", output);
+        failures++;
+    }
+    bench_report_destroy(&report);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,1233 @@
+/*
+ * OpenCog Core Benchmark Suite
+ * Micro benchmarks for AtomSpace and messaging primitives plus macro workloads
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "../include/atom.h"
+#include "../include/distributed.h"
+#include "../include/stats.h"
+#include "../include/lockprof.h"
+#include "../include/trace.h"
+#include "../include/memstats.h"
+#include "../include/vector.h"
+#include "../include/nameindex.h"
+#include "../include/csr.h"
+#include "../include/graph.h"
+#include "../include/timeindex.h"
+#include "../include/querycache.h"
+#include "bench_common.h"
+
+/* Operations timed per sample for cheap operations */
+#define BATCH 64
+
+/* Print the macro_ingest memory breakdown (-m) */
+static bool report_memory = false;
+
+static size_t min_size(size_t a, size_t b) {
+    return a < b ? a : b;
+}
+
+static char** make_names(const char* prefix, size_t count, size_t distinct) {
+    char** names = malloc(sizeof(char*) * count);
+    char buf[64];
+    for (size_t i = 0; i < count; i++) {
+        snprintf(buf, sizeof(buf), "%s_%zu", prefix, i % distinct);
+        names[i] = strdup(buf);
+    }
+    return names;
+}
+
+static void free_names(char** names, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        free(names[i]);
+    }
+    free(names);
+}
+
+static void release_results(atom_handle_t** results, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        atom_release(results[i]);
+    }
+    free(results);
+}
+
+/* Populate a space with nodes of mixed types; handles are returned in order */
+static atom_handle_t** populate(atomspace_t* space, size_t count, size_t distinct_names) {
+    atom_handle_t** handles = malloc(sizeof(atom_handle_t*) * count);
+    char** names = make_names("atom", count, distinct_names);
+    for (size_t i = 0; i < count; i++) {
+        atom_type_t type = (i % 4 == 0) ? ATOM_TYPE_PREDICATE : ATOM_TYPE_CONCEPT;
+        handles[i] = atom_create(space, type, names[i]);
+        atom_set_tv(handles[i], (double)(i % 100) / 100.0, 0.5);
+    }
+    free_names(names, count);
+    return handles;
+}
+
+/* Micro benchmarks */
+
+static void bench_atom_create(bench_report_t* report) {
+    if (!bench_report_wants(report, "atom_create")) return;
+
+    size_t n = bench_report_scaled(report, 200000);
+    char** names = make_names("concept", n, n);
+    atomspace_t* space = atomspace_create(1);
+    bench_result_t* r = bench_result_create(report, "atom_create", "micro");
+
+    for (size_t i = 0; i < n; i += BATCH) {
+        size_t end = min_size(i + BATCH, n);
+        uint64_t t0 = bench_now_ns();
+        for (size_t j = i; j < end; j++) {
+            atom_create(space, ATOM_TYPE_CONCEPT, names[j]);
+        }
+        bench_record(r, bench_now_ns() - t0, end - i);
+    }
+
+    atomspace_destroy(space);
+    free_names(names, n);
+}
+
+static void bench_atom_create_link(bench_report_t* report) {
+    if (!bench_report_wants(report, "atom_create_link")) return;
+
+    size_t nodes = bench_report_scaled(report, 10000);
+    size_t n = bench_report_scaled(report, 200000);
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t** handles = populate(space, nodes, nodes);
+    bench_result_t* r = bench_result_create(report, "atom_create_link", "micro");
+    uint64_t rng = 51;
+
+    for (size_t i = 0; i < n; i += BATCH) {
+        size_t end = min_size(i + BATCH, n);
+        atom_handle_t* outgoing[BATCH][2];
+        for (size_t j = i; j < end; j++) {
+            outgoing[j - i][0] = handles[bench_rand(&rng) % nodes];
+            outgoing[j - i][1] = handles[bench_rand(&rng) % nodes];
+        }
+        uint64_t t0 = bench_now_ns();
+        for (size_t j = i; j < end; j++) {
+            atom_create_link(space, ATOM_TYPE_LINK, outgoing[j - i], 2);
+        }
+        bench_record(r, bench_now_ns() - t0, end - i);
+    }
+
+    free(handles);
+    atomspace_destroy(space);
+}
+
+/* The same workloads through the batch API, BATCH atoms per call */
+static void bench_atom_create_batch(bench_report_t* report) {
+    bool nodes_wanted = bench_report_wants(report, "atom_create_batch");
+    bool links_wanted = bench_report_wants(report, "atom_create_link_batch");
+    if (!nodes_wanted && !links_wanted) return;
+
+    size_t n = bench_report_scaled(report, 200000);
+    atom_handle_t* out[BATCH];
+
+    if (nodes_wanted) {
+        char** names = make_names("concept", n, n);
+        atomspace_t* space = atomspace_create(1);
+        bench_result_t* r = bench_result_create(report, "atom_create_batch", "micro");
+        for (size_t i = 0; i < n; i += BATCH) {
+            size_t end = min_size(i + BATCH, n);
+            uint64_t t0 = bench_now_ns();
+            atom_create_batch(space, ATOM_TYPE_CONCEPT, (const char* const*)names + i, end - i, out);
+            bench_record(r, bench_now_ns() - t0, end - i);
+        }
+        atomspace_destroy(space);
+        free_names(names, n);
+    }
+
+    if (links_wanted) {
+        size_t nodes = bench_report_scaled(report, 10000);
+        atomspace_t* space = atomspace_create(1);
+        atom_handle_t** handles = populate(space, nodes, nodes);
+        bench_result_t* r = bench_result_create(report, "atom_create_link_batch", "micro");
+        uint64_t rng = 51;
+        atom_handle_t* outgoing[BATCH * 2];
+        size_t arities[BATCH];
+        for (size_t j = 0; j < BATCH; j++) arities[j] = 2;
+
+        for (size_t i = 0; i < n; i += BATCH) {
+            size_t end = min_size(i + BATCH, n);
+            for (size_t j = 0; j < (end - i) * 2; j++) {
+                outgoing[j] = handles[bench_rand(&rng) % nodes];
+            }
+            uint64_t t0 = bench_now_ns();
+            atom_create_link_batch(space, ATOM_TYPE_LINK, outgoing, arities, end - i, out);
+            bench_record(r, bench_now_ns() - t0, end - i);
+        }
+        free(handles);
+        atomspace_destroy(space);
+    }
+}
+
+static void bench_atomspace_get_atom(bench_report_t* report) {
+    if (!bench_report_wants(report, "atomspace_get_atom")) return;
+
+    size_t atoms = bench_report_scaled(report, 100000);
+    size_t n = bench_report_scaled(report, 1000000);
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t** handles = populate(space, atoms, atoms);
+    bench_result_t* r = bench_result_create(report, "atomspace_get_atom", "micro");
+    uint64_t rng = 52;
+    uint64_t ids[BATCH];
+    size_t found = 0;
+
+    for (size_t i = 0; i < n; i += BATCH) {
+        size_t end = min_size(i + BATCH, n);
+        for (size_t j = i; j < end; j++) {
+            ids[j - i] = handles[bench_rand(&rng) % atoms]->id;
+        }
+        uint64_t t0 = bench_now_ns();
+        for (size_t j = i; j < end; j++) {
+            found += atomspace_get_atom(space, ids[j - i]) != NULL;
+        }
+        bench_record(r, bench_now_ns() - t0, end - i);
+    }
+
+    if (found != n) fprintf(stderr, "atomspace_get_atom: %zu of %zu lookups missed\n", n - found, n);
+    free(handles);
+    atomspace_destroy(space);
+}
+
+typedef struct {
+    double min_strength;
+} strength_pattern_t;
+
+static bool match_strength(atom_handle_t* atom, void* user_data) {
+    strength_pattern_t* pattern = (strength_pattern_t*)user_data;
+    return atom->atom->tv.strength >= pattern->min_strength;
+}
+
+static void bench_queries(bench_report_t* report) {
+    bool by_type = bench_report_wants(report, "atomspace_get_atoms_by_type");
+    bool by_name = bench_report_wants(report, "atomspace_get_atoms_by_name");
+    bool by_pattern = bench_report_wants(report, "atomspace_match_pattern");
+    bool borrowed = bench_report_wants(report, "atomspace_get_atoms_by_type_borrowed");
+    if (!by_type && !by_name && !by_pattern && !borrowed) return;
+
+    size_t atoms = bench_report_scaled(report, 20000);
+    size_t queries = 500;
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t** handles = populate(space, atoms, atoms / 10 + 1);
+    uint64_t rng = 53;
+    size_t count = 0;
+
+    if (by_type) {
+        bench_result_t* r = bench_result_create(report, "atomspace_get_atoms_by_type", "micro");
+        for (size_t i = 0; i < queries; i++) {
+            atom_type_t type = (i % 2) ? ATOM_TYPE_PREDICATE : ATOM_TYPE_CONCEPT;
+            uint64_t t0 = bench_now_ns();
+            atom_handle_t** results = atomspace_get_atoms_by_type(space, type, &count);
+            bench_record(r, bench_now_ns() - t0, 1);
+            release_results(results, count);
+        }
+    }
+
+    /* Same scan without per-result reference counting, release included */
+    if (borrowed) {
+        bench_result_t* r = bench_result_create(report, "atomspace_get_atoms_by_type_borrowed", "micro");
+        for (size_t i = 0; i < queries; i++) {
+            atom_type_t type = (i % 2) ? ATOM_TYPE_PREDICATE : ATOM_TYPE_CONCEPT;
+            uint64_t t0 = bench_now_ns();
+            atomspace_read_begin(space);
+            atom_handle_t** results = atomspace_get_atoms_by_type_borrowed(space, type, &count);
+            atomspace_read_end(space);
+            free(results);
+            bench_record(r, bench_now_ns() - t0, 1);
+        }
+    }
+
+    if (by_name) {
+        bench_result_t* r = bench_result_create(report, "atomspace_get_atoms_by_name", "micro");
+        for (size_t i = 0; i < queries; i++) {
+            const char* name = handles[bench_rand(&rng) % atoms]->atom->name;
+            uint64_t t0 = bench_now_ns();
+            atom_handle_t** results = atomspace_get_atoms_by_name(space, name, &count);
+            bench_record(r, bench_now_ns() - t0, 1);
+            release_results(results, count);
+        }
+    }
+
+    if (by_pattern) {
+        bench_result_t* r = bench_result_create(report, "atomspace_match_pattern", "micro");
+        strength_pattern_t pattern = { 0.9 };
+        for (size_t i = 0; i < queries; i++) {
+            uint64_t t0 = bench_now_ns();
+            atom_handle_t** results = atomspace_match_pattern(space, match_strength, &pattern, &count);
+            bench_record(r, bench_now_ns() - t0, 1);
+            release_results(results, count);
+        }
+    }
+
+    free(handles);
+    atomspace_destroy(space);
+}
+
+static void bench_tv_av(bench_report_t* report) {
+    static const char* names[] = { "atom_set_tv", "atom_get_tv", "atom_set_av", "atom_get_av" };
+    bool wanted = false;
+    for (size_t k = 0; k < 4; k++) {
+        wanted |= bench_report_wants(report, names[k]) != 0;
+    }
+    if (!wanted) return;
+
+    size_t atoms = bench_report_scaled(report, 10000);
+    size_t n = bench_report_scaled(report, 1000000);
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t** handles = populate(space, atoms, atoms);
+    double checksum = 0.0;
+
+    for (size_t k = 0; k < 4; k++) {
+        if (!bench_report_wants(report, names[k])) continue;
+
+        bench_result_t* r = bench_result_create(report, names[k], "micro");
+        uint64_t rng = 54 + k;
+        for (size_t i = 0; i < n; i += BATCH) {
+            size_t end = min_size(i + BATCH, n);
+            atom_handle_t* batch[BATCH];
+            for (size_t j = i; j < end; j++) {
+                batch[j - i] = handles[bench_rand(&rng) % atoms];
+            }
+            uint64_t t0 = bench_now_ns();
+            for (size_t j = 0; j < end - i; j++) {
+                switch (k) {
+                    case 0: atom_set_tv(batch[j], 0.75, 0.5); break;
+                    case 1: checksum += atom_get_tv(batch[j]).strength; break;
+                    case 2: atom_set_av(batch[j], 10, 5, 1); break;
+                    default: checksum += atom_get_av(batch[j]).sti; break;
+                }
+            }
+            bench_record(r, bench_now_ns() - t0, end - i);
+        }
+    }
+
+    if (checksum < 0.0) fprintf(stderr, "unexpected checksum\n");
+    free(handles);
+    atomspace_destroy(space);
+}
+
+/* Clustered unit-cube vectors, closer to real embeddings than uniform noise */
+static float* make_vectors(size_t count, size_t dim, uint64_t seed) {
+    size_t clusters = 64;
+    float* centers = malloc(clusters * dim * sizeof(float));
+    float* out = malloc(count * dim * sizeof(float));
+    for (size_t i = 0; i < clusters * dim; i++) {
+        centers[i] = (float)(bench_rand(&seed) % 2000) / 1000.0f - 1.0f;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const float* center = centers + (bench_rand(&seed) % clusters) * dim;
+        for (size_t d = 0; d < dim; d++) {
+            out[i * dim + d] = center[d] + (float)(bench_rand(&seed) % 1000) / 2500.0f - 0.2f;
+        }
+    }
+    free(centers);
+    return out;
+}
+
+static void bench_vectors(bench_report_t* report) {
+    bool insert = bench_report_wants(report, "atom_set_vector");
+    bool search = bench_report_wants(report, "atomspace_vector_search");
+    bool batch = bench_report_wants(report, "atomspace_vector_search_batch");
+    bool exact = bench_report_wants(report, "atomspace_vector_search_exact");
+    if (!insert && !search && !batch && !exact) return;
+
+    const size_t dim = 64, k = 10, queries = 200;
+    size_t atoms = bench_report_scaled(report, 20000);
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t** handles = populate(space, atoms, atoms);
+    /* Probes come from the same clusters but are never inserted */
+    float* vectors = make_vectors(atoms + queries, dim, 61);
+    float* probes = vectors + atoms * dim;
+    vector_match_t* found = malloc(queries * k * sizeof(vector_match_t));
+    vector_match_t* truth = malloc(queries * k * sizeof(vector_match_t));
+    size_t* counts = malloc(queries * sizeof(size_t));
+
+    /* Incremental inserts; the graph is searchable after each one */
+    bench_result_t* r = insert ? bench_result_create(report, "atom_set_vector", "micro") : NULL;
+    for (size_t i = 0; i < atoms; i += BATCH) {
+        size_t end = min_size(i + BATCH, atoms);
+        uint64_t t0 = bench_now_ns();
+        for (size_t j = i; j < end; j++) atom_set_vector(space, handles[j], vectors + j * dim, dim);
+        if (r) bench_record(r, bench_now_ns() - t0, end - i);
+    }
+
+    for (size_t q = 0; q < queries; q++) {
+        atomspace_vector_search_exact(space, probes + q * dim, dim, k, truth + q * k);
+    }
+
+    if (exact) {
+        r = bench_result_create(report, "atomspace_vector_search_exact", "micro");
+        for (size_t q = 0; q < queries; q++) {
+            uint64_t t0 = bench_now_ns();
+            atomspace_vector_search_exact(space, probes + q * dim, dim, k, found);
+            bench_record(r, bench_now_ns() - t0, 1);
+        }
+    }
+
+    if (search) {
+        r = bench_result_create(report, "atomspace_vector_search", "micro");
+        for (size_t q = 0; q < queries; q++) {
+            uint64_t t0 = bench_now_ns();
+            counts[q] = atomspace_vector_search(space, probes + q * dim, dim, k, 0, found + q * k);
+            bench_record(r, bench_now_ns() - t0, 1);
+        }
+        /* Share of the exact top k that the graph search returned */
+        size_t hits = 0;
+        for (size_t q = 0; q < queries; q++) {
+            for (size_t i = 0; i < k; i++) {
+                for (size_t j = 0; j < counts[q]; j++) hits += found[q * k + j].atom == truth[q * k + i].atom;
+            }
+        }
+        bench_metric(r, "recall_at_10", (double)hits / (double)(queries * k));
+    }
+
+    if (batch) {
+        r = bench_result_create(report, "atomspace_vector_search_batch", "micro");
+        for (size_t q = 0; q < queries; q += 16) {
+            size_t n = min_size(16, queries - q);
+            uint64_t t0 = bench_now_ns();
+            atomspace_vector_search_batch(space, probes + q * dim, n, dim, k, 0, found, counts);
+            bench_record(r, bench_now_ns() - t0, n);
+        }
+    }
+
+    free(counts);
+    free(truth);
+    free(found);
+    free(vectors);
+    free(handles);
+    atomspace_destroy(space);
+}
+
+/* Name trie searches; each query targets a random atom's name */
+static void bench_names(bench_report_t* report) {
+    bool prefix = bench_report_wants(report, "atomspace_name_prefix");
+    bool glob = bench_report_wants(report, "atomspace_name_glob");
+    bool fuzzy = bench_report_wants(report, "atomspace_name_fuzzy");
+    if (!prefix && !glob && !fuzzy) return;
+
+    enum { MAX_RESULTS = 64 };
+    size_t atoms = bench_report_scaled(report, 100000);
+    size_t queries = 1000;
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t** handles = populate(space, atoms, atoms);
+    atom_handle_t* out[MAX_RESULTS];
+    name_match_t matches[MAX_RESULTS];
+    char query[64];
+    uint64_t rng = 67;
+
+    /* Drop the last digit, so about ten names match */
+    if (prefix) {
+        bench_result_t* r = bench_result_create(report, "atomspace_name_prefix", "micro");
+        for (size_t i = 0; i < queries; i++) {
+            snprintf(query, sizeof(query), "%s", handles[bench_rand(&rng) % atoms]->atom->name);
+            query[strlen(query) - 1] = '\0';
+            uint64_t t0 = bench_now_ns();
+            atomspace_read_begin(space);
+            atomspace_name_prefix(space, query, out, MAX_RESULTS);
+            atomspace_read_end(space);
+            bench_record(r, bench_now_ns() - t0, 1);
+        }
+    }
+
+    /* The last digit becomes `?`, one digit before it a class */
+    if (glob) {
+        bench_result_t* r = bench_result_create(report, "atomspace_name_glob", "micro");
+        for (size_t i = 0; i < queries; i++) {
+            const char* name = handles[bench_rand(&rng) % atoms]->atom->name;
+            size_t length = strlen(name);
+            snprintf(query, sizeof(query), "%.*s[0-4]?", (int)(length > 7 ? length - 2 : length - 1), name);
+            uint64_t t0 = bench_now_ns();
+            atomspace_read_begin(space);
+            atomspace_name_glob(space, query, out, MAX_RESULTS);
+            atomspace_read_end(space);
+            bench_record(r, bench_now_ns() - t0, 1);
+        }
+    }
+
+    /* One substituted byte, searched within one edit */
+    if (fuzzy) {
+        bench_result_t* r = bench_result_create(report, "atomspace_name_fuzzy", "micro");
+        for (size_t i = 0; i < queries; i++) {
+            snprintf(query, sizeof(query), "%s", handles[bench_rand(&rng) % atoms]->atom->name);
+            query[bench_rand(&rng) % strlen(query)] = 'x';
+            uint64_t t0 = bench_now_ns();
+            atomspace_read_begin(space);
+            atomspace_name_fuzzy(space, query, 1, matches, MAX_RESULTS);
+            atomspace_read_end(space);
+            bench_record(r, bench_now_ns() - t0, 1);
+        }
+    }
+
+    free(handles);
+    atomspace_destroy(space);
+}
+
+/* CSR export, and one pass over every edge through it and through the atoms */
+static void bench_csr(bench_report_t* report) {
+    bool build = bench_report_wants(report, "atomspace_csr_build");
+    bool scan = bench_report_wants(report, "csr_edge_scan");
+    if (!build && !scan) return;
+
+    size_t nodes = bench_report_scaled(report, 100000);
+    size_t links = nodes * 2;
+    size_t rounds = 10;
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t** handles = populate(space, nodes, nodes);
+    uint64_t rng = 71;
+    for (size_t i = 0; i < links; i++) {
+        atom_handle_t* outgoing[2] = {
+            handles[bench_rand(&rng) % nodes],
+            handles[bench_rand(&rng) % nodes]
+        };
+        atom_create_link(space, ATOM_TYPE_LINK, outgoing, 2);
+    }
+
+    atomspace_csr_t* csr = NULL;
+    bench_result_t* r = build ? bench_result_create(report, "atomspace_csr_build", "micro") : NULL;
+    for (size_t i = 0; i < (build ? rounds : 1); i++) {
+        atomspace_csr_free(csr);
+        uint64_t t0 = bench_now_ns();
+        csr = atomspace_csr_build(space, CSR_WITH_TV, 0);
+        if (r) bench_record(r, bench_now_ns() - t0, 1);
+    }
+    if (r) {
+        uint64_t t0 = bench_now_ns();
+        atomspace_csr_t* serial = atomspace_csr_build(space, CSR_WITH_TV, 1);
+        bench_metric(r, "single_thread_ns", (double)(bench_now_ns() - t0));
+        atomspace_csr_free(serial);
+    }
+
+    /* Sum of member strengths over the in and out edges of every atom */
+    if (scan) {
+        r = bench_result_create(report, "csr_edge_scan", "micro");
+        double sum = 0.0;
+        uint64_t pointer_ns = 0;
+        for (size_t i = 0; i < rounds; i++) {
+            uint64_t t0 = bench_now_ns();
+            for (uint32_t v = 0; v < csr->vertex_count; v++) {
+                for (uint64_t e = csr->out_offsets[v]; e < csr->out_offsets[v + 1]; e++) {
+                    sum += csr->strengths[csr->out_edges[e]];
+                }
+                for (uint64_t e = csr->in_offsets[v]; e < csr->in_offsets[v + 1]; e++) {
+                    sum += csr->strengths[csr->in_edges[e]];
+                }
+            }
+            bench_record(r, bench_now_ns() - t0, 1);
+
+            t0 = bench_now_ns();
+            atomspace_read_begin(space);
+            size_t count = 0;
+            atom_handle_t* const* slots = atomspace_scan_slots(space, &count);
+            for (size_t s = 0; s < count; s++) {
+                if (!slots[s]) continue;
+                atom_t* atom = slots[s]->atom;
+                for (size_t k = 0; k < atom->outgoing_count; k++) sum += atom->outgoing[k]->atom->tv.strength;
+                for (size_t k = 0; k < atom->incoming_count; k++) sum += atom->incoming[k]->atom->tv.strength;
+            }
+            atomspace_read_end(space);
+            pointer_ns += bench_now_ns() - t0;
+        }
+        bench_metric(r, "pointer_scan_ns", (double)pointer_ns / (double)rounds);
+        if (sum < 0.0) fprintf(stderr, "csr_edge_scan: negative strength sum\n");
+    }
+
+    atomspace_csr_free(csr);
+    free(handles);
+    atomspace_destroy(space);
+}
+
+static void bench_graph(bench_report_t* report) {
+    bool khop = bench_report_wants(report, "graph_khop");
+    bool components = bench_report_wants(report, "graph_components");
+    bool pagerank = bench_report_wants(report, "graph_pagerank");
+    if (!khop && !components && !pagerank) return;
+
+    /* Same shape as macro_traversal, so graph_khop compares with it */
+    size_t nodes = bench_report_scaled(report, 20000);
+    size_t links = nodes * 2;
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t** handles = populate(space, nodes, nodes);
+    uint64_t rng = 63;
+    for (size_t i = 0; i < links; i++) {
+        atom_handle_t* outgoing[2] = {
+            handles[bench_rand(&rng) % nodes],
+            handles[bench_rand(&rng) % nodes]
+        };
+        atom_create_link(space, ATOM_TYPE_LINK, outgoing, 2);
+    }
+    atomspace_csr_t* csr = atomspace_csr_build(space, 0, 0);
+    uint32_t* labels = malloc(csr->vertex_count * sizeof(uint32_t));
+    float* rank = malloc(csr->vertex_count * sizeof(float));
+
+    if (khop) {
+        bench_result_t* r = bench_result_create(report, "graph_khop", "micro");
+        uint64_t reached = 0;
+        for (size_t t = 0; t < 2000; t++) {
+            uint32_t source = atomspace_csr_vertex(csr, handles[bench_rand(&rng) % nodes]);
+            uint64_t t0 = bench_now_ns();
+            reached += graph_bfs(csr, &source, 1, 3, GRAPH_BOTH, 1, labels, NULL);
+            bench_record(r, bench_now_ns() - t0, 1);
+        }
+        bench_metric(r, "mean_reached", (double)reached / 2000.0);
+    }
+
+    if (components) {
+        bench_result_t* r = bench_result_create(report, "graph_components", "micro");
+        size_t count = 0;
+        for (size_t i = 0; i < 10; i++) {
+            uint64_t t0 = bench_now_ns();
+            count = graph_components(csr, 0, labels);
+            bench_record(r, bench_now_ns() - t0, 1);
+        }
+        bench_metric(r, "components", (double)count);
+    }
+
+    if (pagerank) {
+        bench_result_t* r = bench_result_create(report, "graph_pagerank", "micro");
+        uint32_t iterations = 0;
+        for (size_t i = 0; i < 5; i++) {
+            uint64_t t0 = bench_now_ns();
+            iterations = graph_pagerank(csr, GRAPH_BOTH, NULL, 0, rank);
+            bench_record(r, bench_now_ns() - t0, 1);
+        }
+        bench_metric(r, "iterations", (double)iterations);
+        uint64_t t0 = bench_now_ns();
+        graph_write_back(space, csr, rank, (float)csr->vertex_count * 100.0f, GRAPH_FIELD_STI);
+        bench_metric(r, "write_back_ns", (double)(bench_now_ns() - t0));
+    }
+
+    free(labels);
+    free(rank);
+    atomspace_csr_free(csr);
+    free(handles);
+    atomspace_destroy(space);
+}
+
+static void bench_times(bench_report_t* report) {
+    if (!bench_report_wants(report, "time_changes_since")) return;
+
+    size_t nodes = bench_report_scaled(report, 100000);
+    size_t updates = 1000;
+    size_t rounds = 200;
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t** handles = populate(space, nodes, nodes);
+    uint64_t mark = handles[nodes - 1]->atom->value_version;
+    uint64_t start = atomspace_time_position(space);
+    uint64_t rng = 74;
+    for (size_t i = 0; i < updates; i++) {
+        atom_set_tv(handles[bench_rand(&rng) % nodes], 0.5, 0.5);
+    }
+
+    /* What changed since the mark: the log tail against a scan of every atom */
+    atom_handle_t** out = malloc(updates * sizeof(atom_handle_t*));
+    bench_result_t* r = bench_result_create(report, "time_changes_since", "micro");
+    size_t found = 0;
+    uint64_t scan_ns = 0;
+    for (size_t i = 0; i < rounds; i++) {
+        uint64_t cursor = start;
+        uint64_t t0 = bench_now_ns();
+        atomspace_read_begin(space);
+        found = atomspace_changes_since(space, &cursor, out, updates);
+        atomspace_read_end(space);
+        bench_record(r, bench_now_ns() - t0, 1);
+
+        t0 = bench_now_ns();
+        atomspace_read_begin(space);
+        size_t count = 0, scanned = 0;
+        atom_handle_t* const* slots = atomspace_scan_slots(space, &count);
+        for (size_t s = 0; s < count; s++) {
+            if (slots[s] && slots[s]->atom->value_version > mark) scanned++;
+        }
+        atomspace_read_end(space);
+        scan_ns += bench_now_ns() - t0;
+        if (scanned != found) fprintf(stderr, "time_changes_since: %zu logged, %zu scanned\n", found, scanned);
+    }
+    bench_metric(r, "changed_atoms", (double)found);
+    bench_metric(r, "full_scan_ns", (double)scan_ns / (double)rounds);
+
+    free(out);
+    free(handles);
+    atomspace_destroy(space);
+}
+
+static void bench_query_cache(bench_report_t* report) {
+    if (!bench_report_wants(report, "query_cache_hit")) return;
+
+    size_t nodes = bench_report_scaled(report, 100000);
+    size_t distinct = 1000;
+    size_t queries = 20000;
+    size_t write_every = 100;
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t** handles = populate(space, nodes, distinct);
+    char** names = make_names("atom", distinct, distinct);
+
+    /*
+     * Repeated name and type queries with an occasional new predicate, which
+     * invalidates the predicate query and one name, against the same queries
+     * uncached
+     */
+    bench_result_t* r = bench_result_create(report, "query_cache_hit", "micro");
+    uint64_t rng = 75, uncached_ns = 0;
+    size_t cached_total = 0, uncached_total = 0;
+    for (size_t i = 0; i < queries; i++) {
+        if (i % write_every == 0) {
+            atom_create(space, ATOM_TYPE_PREDICATE, names[bench_rand(&rng) % distinct]);
+        }
+        const char* name = names[bench_rand(&rng) % distinct];
+        bool by_type = i % 8 == 0;
+
+        uint64_t t0 = bench_now_ns();
+        atomspace_read_begin(space);
+        const query_result_t* result = by_type ? atomspace_cached_by_type(space, ATOM_TYPE_PREDICATE) :
+                                                 atomspace_cached_by_name(space, name);
+        cached_total += result->count;
+        atomspace_read_end(space);
+        bench_record(r, bench_now_ns() - t0, 1);
+
+        t0 = bench_now_ns();
+        atomspace_read_begin(space);
+        size_t count = 0;
+        atom_handle_t** atoms = by_type ?
+            atomspace_get_atoms_by_types_borrowed(space, ATOM_TYPE_BIT(ATOM_TYPE_PREDICATE), &count) :
+            atomspace_get_atoms_by_name_borrowed(space, name, &count);
+        uncached_total += atoms ? count : 0;
+        free(atoms);
+        atomspace_read_end(space);
+        uncached_ns += bench_now_ns() - t0;
+    }
+    if (cached_total != uncached_total) {
+        fprintf(stderr, "query_cache_hit: %zu cached, %zu uncached\n", cached_total, uncached_total);
+    }
+    query_cache_stats_t stats;
+    atomspace_query_cache_stats(space, &stats);
+    bench_metric(r, "uncached_ns", (double)uncached_ns / (double)queries);
+    bench_metric(r, "hit_ratio", stats.hit_ratio);
+    bench_metric(r, "cache_bytes", (double)stats.bytes);
+
+    free_names(names, distinct);
+    free(handles);
+    atomspace_destroy(space);
+}
+
+static void bench_messaging(bench_report_t* report) {
+    bool send = bench_report_wants(report, "message_send");
+    bool recv = bench_report_wants(report, "message_receive");
+    if (!send && !recv) return;
+
+    distributed_ctx_t* ctx = distributed_create(1, "localhost", 5000);
+    if (!ctx || !ctx->mq) {
+        fprintf(stderr, "messaging benchmarks skipped: message queue unavailable\n");
+        distributed_destroy(ctx);
+        return;
+    }
+
+    /* Drain anything left in the queue by earlier runs */
+    message_t* stale;
+    while ((stale = distributed_receive_message(ctx, 0)) != NULL) {
+        distributed_free_message(stale);
+    }
+
+    size_t n = bench_report_scaled(report, 20000);
+    const size_t window = 32;
+    char payload[64];
+    memset(payload, 'x', sizeof(payload));
+    message_t msg = {
+        .type = MSG_TYPE_ATOM_UPDATE,
+        .source_node = 1,
+        .dest_node = 1,
+        .timestamp = 0,
+        .payload_size = sizeof(payload),
+        .payload = payload
+    };
+
+    bench_result_t* rs = send ? bench_result_create(report, "message_send", "micro") : NULL;
+    bench_result_t* rr = recv ? bench_result_create(report, "message_receive", "micro") : NULL;
+    size_t failures = 0;
+
+    for (size_t i = 0; i < n; i += window) {
+        size_t batch = min_size(window, n - i);
+        size_t sent = 0;
+
+        uint64_t t0 = bench_now_ns();
+        for (size_t j = 0; j < batch; j++) {
+            sent += distributed_send_message(ctx, &msg) == 0;
+        }
+        if (rs) bench_record(rs, bench_now_ns() - t0, batch);
+
+        size_t received = 0;
+        t0 = bench_now_ns();
+        for (size_t j = 0; j < sent; j++) {
+            message_t* in = distributed_receive_message(ctx, 0);
+            if (in) {
+                received++;
+                distributed_free_message(in);
+            }
+        }
+        if (rr) bench_record(rr, bench_now_ns() - t0, received);
+
+        failures += (batch - sent) + (sent - received);
+    }
+
+    if (failures) fprintf(stderr, "messaging: %zu messages failed\n", failures);
+    distributed_destroy(ctx);
+}
+
+/* Macro workloads */
+
+static void bench_macro_ingest(bench_report_t* report) {
+    if (!bench_report_wants(report, "macro_ingest")) return;
+
+    size_t nodes = bench_report_scaled(report, 100000);
+    size_t links = nodes;
+    char** names = make_names("ingest", nodes, nodes / 4 + 1);
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t** handles = malloc(sizeof(atom_handle_t*) * nodes);
+    bench_result_t* r = bench_result_create(report, "macro_ingest", "macro");
+    uint64_t rng = 61;
+    const size_t batch = 256;
+    size_t created = 0;
+    size_t linked = 0;
+
+    /* Interleave node and link creation the way a loader streams facts */
+    while (created < nodes || linked < links) {
+        uint64_t t0 = bench_now_ns();
+        size_t ops = 0;
+        for (; ops < batch && created < nodes; ops++, created++) {
+            handles[created] = atom_create(space, ATOM_TYPE_CONCEPT, names[created]);
+            atom_set_tv(handles[created], 0.8, 0.6);
+        }
+        for (size_t j = 0; j < batch / 2 && linked < links && created > 1; j++, ops++, linked++) {
+            atom_handle_t* outgoing[3];
+            size_t arity = 2 + (bench_rand(&rng) % 2);
+            for (size_t k = 0; k < arity; k++) {
+                outgoing[k] = handles[bench_rand(&rng) % created];
+            }
+            atom_create_link(space, ATOM_TYPE_EVALUATION, outgoing, arity);
+        }
+        bench_record(r, bench_now_ns() - t0, ops);
+    }
+
+    if (report_memory) {
+        atomspace_memory_t mem;
+        if (atomspace_memory_usage(space, &mem, MEMORY_INCLUDE_HEAP) == 0) {
+            printf("macro_ingest ");
+            atomspace_memory_print(&mem, stdout);
+        }
+    }
+
+    free(handles);
+    free_names(names, nodes);
+    atomspace_destroy(space);
+}
+
+/* Analytics during ingest: snapshot scans while a writer keeps adding atoms */
+typedef struct {
+    atomspace_t* space;
+    char** names;
+    size_t count;
+    uint64_t elapsed_ns;
+    volatile int done;
+} analytics_ingest_t;
+
+static void* analytics_ingest_worker(void* arg) {
+    analytics_ingest_t* w = (analytics_ingest_t*)arg;
+    uint64_t t0 = bench_now_ns();
+    for (size_t i = 0; i < w->count; i++) {
+        atom_handle_t* atom = atom_create(w->space, ATOM_TYPE_CONCEPT, w->names[i]);
+        atom_set_tv(atom, 0.8, 0.6);
+    }
+    w->elapsed_ns = bench_now_ns() - t0;
+    __atomic_store_n(&w->done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void bench_macro_analytics_ingest(bench_report_t* report) {
+    if (!bench_report_wants(report, "macro_analytics_ingest")) return;
+
+    size_t nodes = bench_report_scaled(report, 100000);
+    char** names = make_names("analytics", nodes, nodes / 4 + 1);
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t** seed = populate(space, nodes, nodes / 10 + 1);
+    analytics_ingest_t writer = { space, names, nodes, 0, 0 };
+    bench_result_t* r = bench_result_create(report, "macro_analytics_ingest", "macro");
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, analytics_ingest_worker, &writer);
+    size_t scans = 0;
+    while (!__atomic_load_n(&writer.done, __ATOMIC_ACQUIRE)) {
+        size_t count = 0;
+        uint64_t t0 = bench_now_ns();
+        atomspace_snapshot_t* snapshot = atomspace_snapshot_begin(space);
+        free(atomspace_snapshot_get_atoms_by_type(snapshot, ATOM_TYPE_CONCEPT, &count));
+        atomspace_snapshot_end(snapshot);
+        bench_record(r, bench_now_ns() - t0, 1);
+        scans++;
+    }
+    pthread_join(thread, NULL);
+
+    /* Scan latency in the table; the concurrent writer's rate as a metric */
+    bench_metric(r, "ingest_ops_per_sec", writer.elapsed_ns ? 1e9 * (double)nodes / (double)writer.elapsed_ns : 0.0);
+    bench_metric(r, "scans", (double)scans);
+
+    free(seed);
+    free_names(names, nodes);
+    atomspace_destroy(space);
+}
+
+/* Teardown: destroying a space of nodes and links, timed per atom */
+static void bench_macro_teardown(bench_report_t* report) {
+    if (!bench_report_wants(report, "macro_teardown")) return;
+
+    size_t nodes = bench_report_scaled(report, 100000);
+    bench_result_t* r = bench_result_create(report, "macro_teardown", "macro");
+    uint64_t rng = 67;
+
+    for (int round = 0; round < 5; round++) {
+        atomspace_t* space = atomspace_create(1);
+        atom_handle_t** handles = populate(space, nodes, nodes / 4 + 1);
+        for (size_t i = 0; i < nodes; i++) {
+            atom_handle_t* outgoing[2] = {
+                handles[bench_rand(&rng) % nodes], handles[bench_rand(&rng) % nodes]
+            };
+            atom_create_link(space, ATOM_TYPE_EVALUATION, outgoing, 2);
+        }
+        free(handles);
+
+        size_t atoms = space->atom_count;
+        uint64_t t0 = bench_now_ns();
+        atomspace_destroy(space);
+        bench_record(r, bench_now_ns() - t0, atoms);
+    }
+}
+
+/* The ingest workload again, each batch committed as one transaction */
+static void bench_macro_txn_ingest(bench_report_t* report) {
+    if (!bench_report_wants(report, "macro_txn_ingest")) return;
+
+    size_t nodes = bench_report_scaled(report, 100000);
+    size_t links = nodes;
+    char** names = make_names("ingest", nodes, nodes / 4 + 1);
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t** handles = malloc(sizeof(atom_handle_t*) * nodes);
+    bench_result_t* r = bench_result_create(report, "macro_txn_ingest", "macro");
+    uint64_t rng = 61;
+    const size_t batch = 256;
+    size_t created = 0;
+    size_t linked = 0;
+
+    while (created < nodes || linked < links) {
+        uint64_t t0 = bench_now_ns();
+        size_t ops = 0;
+        atomspace_txn_t* txn = atomspace_txn_begin(space);
+        for (; ops < batch && created < nodes; ops++, created++) {
+            handles[created] = atomspace_txn_create(txn, ATOM_TYPE_CONCEPT, names[created]);
+            atomspace_txn_set_tv(txn, handles[created], 0.8, 0.6);
+        }
+        for (size_t j = 0; j < batch / 2 && linked < links && created > 1; j++, ops++, linked++) {
+            atom_handle_t* outgoing[3];
+            size_t arity = 2 + (bench_rand(&rng) % 2);
+            for (size_t k = 0; k < arity; k++) {
+                outgoing[k] = handles[bench_rand(&rng) % created];
+            }
+            atomspace_txn_create_link(txn, ATOM_TYPE_EVALUATION, outgoing, arity);
+        }
+        atomspace_txn_commit(txn);
+        bench_record(r, bench_now_ns() - t0, ops);
+    }
+
+    free(handles);
+    free_names(names, nodes);
+    atomspace_destroy(space);
+}
+
+/* Parallel ingest: several threads creating nodes in one AtomSpace */
+#define INGEST_THREADS 4
+
+typedef struct {
+    atomspace_t* space;
+    char** names;
+    size_t count;
+    uint64_t* batch_ns;         /* Elapsed time of each BATCH of creates */
+} ingest_worker_t;
+
+static void* parallel_ingest_worker(void* arg) {
+    ingest_worker_t* w = (ingest_worker_t*)arg;
+    for (size_t i = 0, b = 0; i < w->count; i += BATCH, b++) {
+        size_t end = min_size(i + BATCH, w->count);
+        uint64_t t0 = bench_now_ns();
+        for (size_t j = i; j < end; j++) {
+            atom_create(w->space, ATOM_TYPE_CONCEPT, w->names[j]);
+        }
+        w->batch_ns[b] = bench_now_ns() - t0;
+    }
+    return NULL;
+}
+
+static void bench_macro_parallel_ingest(bench_report_t* report) {
+    if (!bench_report_wants(report, "macro_parallel_ingest")) return;
+
+    size_t per_thread = bench_report_scaled(report, 50000);
+    size_t batches = (per_thread + BATCH - 1) / BATCH;
+    char** names = make_names("parallel", per_thread, per_thread / 4 + 1);
+    atomspace_t* space = atomspace_create(1);
+    ingest_worker_t workers[INGEST_THREADS];
+    pthread_t threads[INGEST_THREADS];
+
+    uint64_t start = bench_now_ns();
+    for (int t = 0; t < INGEST_THREADS; t++) {
+        workers[t].space = space;
+        workers[t].names = names;
+        workers[t].count = per_thread;
+        workers[t].batch_ns = calloc(batches, sizeof(uint64_t));
+        pthread_create(&threads[t], NULL, parallel_ingest_worker, &workers[t]);
+    }
+    for (int t = 0; t < INGEST_THREADS; t++) pthread_join(threads[t], NULL);
+    uint64_t wall = bench_now_ns() - start;
+
+    bench_result_t* r = bench_result_create(report, "macro_parallel_ingest", "macro");
+    for (int t = 0; t < INGEST_THREADS; t++) {
+        for (size_t b = 0; b < batches; b++) {
+            bench_record(r, workers[t].batch_ns[b], min_size(BATCH, per_thread - b * BATCH));
+        }
+        free(workers[t].batch_ns);
+    }
+    r->wall_ns = wall;
+    bench_metric(r, "threads", INGEST_THREADS);
+
+    free_names(names, per_thread);
+    atomspace_destroy(space);
+}
+
+static void bench_macro_mixed(bench_report_t* report) {
+    if (!bench_report_wants(report, "macro_mixed_rw")) return;
+
+    size_t atoms = bench_report_scaled(report, 50000);
+    size_t n = bench_report_scaled(report, 1000000);
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t** handles = populate(space, atoms, atoms);
+    size_t live = atoms;
+    size_t capacity = atoms;
+    bench_result_t* r = bench_result_create(report, "macro_mixed_rw", "macro");
+    uint64_t rng = 62;
+    double checksum = 0.0;
+
+    /* 80% lookup+read, 10% TV write, 5% AV write, 5% create */
+    for (size_t i = 0; i < n; i += BATCH) {
+        size_t end = min_size(i + BATCH, n);
+        uint64_t t0 = bench_now_ns();
+        for (size_t j = i; j < end; j++) {
+            uint64_t dice = bench_rand(&rng);
+            atom_handle_t* target = handles[(dice >> 8) % live];
+            unsigned op = (unsigned)(dice % 100);
+            if (op < 80) {
+                atom_handle_t* found = atomspace_get_atom(space, target->id);
+                if (found) checksum += atom_get_tv(found).strength;
+            } else if (op < 90) {
+                atom_set_tv(target, 0.5, 0.9);
+            } else if (op < 95) {
+                atom_set_av(target, 1, 1, 0);
+            } else {
+                if (live == capacity) {
+                    capacity *= 2;
+                    handles = realloc(handles, sizeof(atom_handle_t*) * capacity);
+                }
+                atom_handle_t* outgoing[2] = { target, handles[(dice >> 32) % live] };
+                handles[live++] = atom_create_link(space, ATOM_TYPE_LINK, outgoing, 2);
+            }
+        }
+        bench_record(r, bench_now_ns() - t0, end - i);
+    }
+
+    if (checksum < 0.0) fprintf(stderr, "unexpected checksum\n");
+    free(handles);
+    atomspace_destroy(space);
+}
+
+/* Visited set for traversals: open addressing keyed by handle, reset by stamp */
+typedef struct {
+    const atom_handle_t** keys;
+    uint32_t* stamps;
+    size_t mask;
+    uint32_t stamp;
+} visited_set_t;
+
+static bool visited_insert(visited_set_t* set, const atom_handle_t* handle) {
+    size_t slot = ((uintptr_t)handle >> 4) * 0x9E3779B97F4A7C15ULL & set->mask;
+    while (set->stamps[slot] == set->stamp) {
+        if (set->keys[slot] == handle) return false;
+        slot = (slot + 1) & set->mask;
+    }
+    set->stamps[slot] = set->stamp;
+    set->keys[slot] = handle;
+    return true;
+}
+
+static void bench_macro_traversal(bench_report_t* report) {
+    if (!bench_report_wants(report, "macro_traversal")) return;
+
+    size_t nodes = bench_report_scaled(report, 20000);
+    size_t links = nodes * 2;
+    size_t traversals = 2000;
+    const size_t hops = 3;
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t** handles = populate(space, nodes, nodes);
+    uint64_t rng = 63;
+
+    for (size_t i = 0; i < links; i++) {
+        atom_handle_t* outgoing[2] = {
+            handles[bench_rand(&rng) % nodes],
+            handles[bench_rand(&rng) % nodes]
+        };
+        atom_create_link(space, ATOM_TYPE_LINK, outgoing, 2);
+    }
+
+    size_t table_size = 1;
+    while (table_size < (nodes + links) * 2) table_size <<= 1;
+    visited_set_t visited = {
+        .keys = malloc(sizeof(atom_handle_t*) * table_size),
+        .stamps = calloc(table_size, sizeof(uint32_t)),
+        .mask = table_size - 1,
+        .stamp = 0
+    };
+    atom_handle_t** frontier = malloc(sizeof(atom_handle_t*) * (nodes + links));
+    atom_handle_t** next = malloc(sizeof(atom_handle_t*) * (nodes + links));
+    bench_result_t* r = bench_result_create(report, "macro_traversal", "macro");
+    uint64_t reached = 0;
+
+    /* k-hop neighbourhood through incoming links and their outgoing sets */
+    for (size_t t = 0; t < traversals; t++) {
+        visited.stamp++;
+        uint64_t t0 = bench_now_ns();
+
+        size_t frontier_count = 1;
+        frontier[0] = handles[bench_rand(&rng) % nodes];
+        visited_insert(&visited, frontier[0]);
+
+        for (size_t hop = 0; hop < hops && frontier_count > 0; hop++) {
+            size_t next_count = 0;
+            for (size_t f = 0; f < frontier_count; f++) {
+                atom_t* atom = frontier[f]->atom;
+                for (size_t k = 0; k < atom->incoming_count; k++) {
+                    if (visited_insert(&visited, atom->incoming[k])) next[next_count++] = atom->incoming[k];
+                }
+                for (size_t k = 0; k < atom->outgoing_count; k++) {
+                    if (visited_insert(&visited, atom->outgoing[k])) next[next_count++] = atom->outgoing[k];
+                }
+            }
+            reached += next_count;
+            atom_handle_t** swap = frontier;
+            frontier = next;
+            next = swap;
+            frontier_count = next_count;
+        }
+
+        bench_record(r, bench_now_ns() - t0, 1);
+    }
+
+    if (reached == 0) fprintf(stderr, "macro_traversal: no atoms reached\n");
+    free(frontier);
+    free(next);
+    free(visited.keys);
+    free(visited.stamps);
+    free(handles);
+    atomspace_destroy(space);
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [-o results.json] [-r revision] [-f filter] [-s scale] [-l] [-m] [-t trace.bin]\n"
+            "  -o FILE   write JSON results to FILE ('-' for stdout)\n"
+            "  -r REV    source revision recorded in the results\n"
+            "  -f NAME   run only benchmarks whose name contains NAME\n"
+            "  -s SCALE  multiply workload sizes by SCALE (default 1.0)\n"
+            "  -l        profile lock contention and print a report\n"
+            "  -m        print the memory breakdown of the macro_ingest space\n"
+            "  -t FILE   record the binary trace ring and dump it to FILE\n",
+            prog);
+}
+
+int main(int argc, char** argv) {
+    const char* output = NULL;
+    const char* revision = "";
+    const char* filter = NULL;
+    double scale = 1.0;
+    bool profile_locks = false;
+    const char* trace_path = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:r:f:s:lmt:h")) != -1) {
+        switch (opt) {
+            case 'o': output = optarg; break;
+            case 'r': revision = optarg; break;
+            case 'f': filter = optarg; break;
+            case 's': scale = atof(optarg); break;
+            case 'l': profile_locks = true; break;
+            case 'm': report_memory = true; break;
+            case 't': trace_path = optarg; break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    bench_report_t report;
+    bench_report_init(&report, revision, filter, scale);
+    lockprof_set_enabled(profile_locks);
+    if (trace_path) trace_start(1 << 20);
+
+    /* Micro benchmarks */
+    bench_atom_create(&report);
+    bench_atom_create_link(&report);
+    bench_atom_create_batch(&report);
+    bench_atomspace_get_atom(&report);
+    bench_queries(&report);
+    bench_tv_av(&report);
+    bench_vectors(&report);
+    bench_names(&report);
+    bench_csr(&report);
+    bench_graph(&report);
+    bench_times(&report);
+    bench_query_cache(&report);
+    bench_messaging(&report);
+
+    /* Macro workloads */
+    bench_macro_ingest(&report);
+    bench_macro_txn_ingest(&report);
+    bench_macro_parallel_ingest(&report);
+    bench_macro_teardown(&report);
+    bench_macro_analytics_ingest(&report);
+    bench_macro_mixed(&report);
+    bench_macro_traversal(&report);
+
+    bench_report_print(&report, stdout);
+
+    /* Library-side view of the same run when built with make stats */
+    atomspace_stats_t stats;
+    if (atomspace_stats(NULL, &stats) == 0 && stats.enabled) {
+        atomspace_stats_print(&stats, stdout);
+    }
+    if (profile_locks) {
+        lockprof_report(stdout);
+    }
+    if (trace_path) {
+        trace_stop();
+        if (trace_dump(trace_path) != 0) fprintf(stderr, "Failed to write trace to %s\n", trace_path);
+    }
+
+    int status = 0;
+    if (output && bench_report_write_json(&report, "opencog-core", output) != 0) {
+        fprintf(stderr, "Failed to write results to %s\n", output);
+        status = 1;
+    }
+
+    bench_report_destroy(&report);
+    return status;
+}
@@ -4,22 +4,28 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include "atomtype.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/* Atom types for cognitive representation */
-typedef enum {
-    ATOM_TYPE_CONCEPT,
-    ATOM_TYPE_PREDICATE,
-    ATOM_TYPE_LINK,
-    ATOM_TYPE_NODE,
-    ATOM_TYPE_VARIABLE,
-    ATOM_TYPE_EVALUATION,
-    ATOM_TYPE_EXECUTION,
-    ATOM_TYPE_CUSTOM
-} atom_type_t;
+/*
+ * Atom IDs: the high ATOM_ID_NODE_BITS hold the creating node's ID and the
+ * rest a process-wide sequence handed out to threads in blocks. IDs are thus
+ * unique across a cluster without coordination, and the node (shard) that
+ * owns an ID is a single shift.
+ */
+#define ATOM_ID_NODE_BITS 16
+#define ATOM_ID_SEQUENCE_BITS (64 - ATOM_ID_NODE_BITS)
+#define ATOM_ID_SEQUENCE_MASK ((UINT64_C(1) << ATOM_ID_SEQUENCE_BITS) - 1)
+#define ATOM_ID_MAX_NODE ((1u << ATOM_ID_NODE_BITS) - 1)
+#define ATOM_ID_BLOCK_SIZE 1024
+
+#define ATOM_ID_MAKE(node, seq) \
+    (((uint64_t)(node) << ATOM_ID_SEQUENCE_BITS) | ((uint64_t)(seq) & ATOM_ID_SEQUENCE_MASK))
+#define ATOM_ID_NODE(id) ((uint32_t)((id) >> ATOM_ID_SEQUENCE_BITS))
+#define ATOM_ID_SEQUENCE(id) ((uint64_t)(id) & ATOM_ID_SEQUENCE_MASK)
 
 /* Truth value representation */
 typedef struct {
@@ -34,6 +40,14 @@ typedef struct {
     int16_t vlti;        /* Very long-term importance */
 } attention_value_t;
 
+/* An overwritten TV/AV pair kept for open snapshots (mvcc.h) */
+typedef struct atom_value_version {
+    truth_value_t tv;
+    attention_value_t av;
+    uint64_t version;                     /* Version at which this pair was written */
+    struct atom_value_version* prev;      /* Older pair */
+} atom_value_version_t;
+
 /* Forward declarations */
 typedef struct atom atom_t;
 typedef struct atom_handle atom_handle_t;
@@ -49,6 +63,7 @@ struct atom_handle {
 struct atom {
     uint64_t id;                  /* Unique identifier */
     atom_type_t type;             /* Atom type */
+    uint32_t space_id;            /* Owning space's space_id once published */
     char* name;                   /* Atom name/value */
     truth_value_t tv;             /* Truth value */
     attention_value_t av;         /* Attention value */
@@ -61,7 +76,21 @@ struct atom {
     atom_handle_t** incoming;
     size_t incoming_count;
     
+    /* Versions (mvcc.h) */
+    uint64_t create_version;
+    uint64_t delete_version;      /* MVCC_LIVE until removed */
+    uint64_t value_version;       /* Version of tv/av */
+    uint32_t value_seq;           /* Odd while tv/av are being written */
+    uint32_t value_claim;         /* Held by the writer stamping the next tv/av change */
+    atom_value_version_t* history; /* Overwritten tv/av pairs, newest first */
+    
     /* Metadata */
+    size_t slot;                  /* Position in the space's atom array */
+    size_t type_slot;             /* Position in its type's bucket */
+    uint32_t vector_class;        /* Vector dimension class + 1, 0 if none (vector.h) */
+    uint32_t vector_row;          /* Row within that class */
+    void* chunk;                  /* Batch allocation holding this atom, or NULL */
+    void* time_index;             /* Owning space's time index while published (timeindex.h) */
     void* user_data;
     uint64_t creation_time;
     uint64_t last_access_time;
@@ -69,33 +98,71 @@ struct atom {
 
 /* AtomSpace - distributed knowledge base */
 typedef struct {
-    atom_handle_t** atoms;        /* Array of atom handles */
+    atom_handle_t** atoms;        /* Array of atom handles, replaced (not realloc'd) on growth */
     size_t atom_count;
     size_t atom_capacity;
     
     /* Hash table for fast lookup */
     void* lookup_table;
     
+    /* Per-type buckets of atom handles, laid out like the atom array */
+    void* type_index;
+    
+    /* Attached vectors and their nearest-neighbour graphs (vector.h) */
+    void* vector_index;
+    
+    /* Radix trie over atom names (nameindex.h) */
+    void* name_index;
+    
+    /* Change log by time (timeindex.h) */
+    void* time_index;
+    
+    /* Cached query results (querycache.h) */
+    void* query_cache;
+    
+    /* Byte accounting (memstats.h) */
+    void* memory_accounting;
+    
     /* Statistics */
     uint64_t total_atoms_created;
     uint64_t total_atoms_deleted;
     
     /* Distributed coordination */
-    uint32_t node_id;             /* This node's ID in distributed system */
+    uint32_t node_id;             /* This node's ID, at most ATOM_ID_MAX_NODE */
+    uint32_t space_id;            /* Unique within the process; tags change events (changefeed.h) */
     void* coordination_ctx;       /* Coordination context */
 } atomspace_t;
 
-/* AtomSpace operations */
+/* AtomSpace operations; destroy must not be called inside a read section or snapshot */
 atomspace_t* atomspace_create(uint32_t node_id);
 void atomspace_destroy(atomspace_t* space);
 
-/* Atom creation and manipulation */
+/* Atom creation and manipulation; invalid types (atom_type_valid) yield NULL */
 atom_handle_t* atom_create(atomspace_t* space, atom_type_t type, const char* name);
 atom_handle_t* atom_create_link(atomspace_t* space, atom_type_t type, 
                                 atom_handle_t** outgoing, size_t count);
+
+/*
+ * Batch creation. Creates `count` atoms of one type, writing their handles
+ * to `out`, and returns `count` (0 on invalid arguments). Links take their
+ * targets concatenated in `outgoing`, with `arities[i]` targets for link i.
+ * A batch shares one allocation, freed once all of its atoms are.
+ */
+size_t atom_create_batch(atomspace_t* space, atom_type_t type, const char* const* names,
+                         size_t count, atom_handle_t** out);
+size_t atom_create_link_batch(atomspace_t* space, atom_type_t type, atom_handle_t* const* outgoing,
+                              const size_t* arities, size_t count, atom_handle_t** out);
 void atom_retain(atom_handle_t* handle);
 void atom_release(atom_handle_t* handle);
 
+/*
+ * Remove an atom from the space. Links must be removed before their targets.
+ * Open snapshots keep seeing the atom; the space's reference is dropped only
+ * after every read section that might still use the handle has ended.
+ * Returns -1 if the atom is not in the space or still has incoming links.
+ */
+int atomspace_remove_atom(atomspace_t* space, atom_handle_t* handle);
+
 /* Truth value operations */
 void atom_set_tv(atom_handle_t* handle, double strength, double confidence);
 truth_value_t atom_get_tv(atom_handle_t* handle);
@@ -109,11 +176,97 @@ atom_handle_t* atomspace_get_atom(atomspace_t* space, uint64_t id);
 atom_handle_t** atomspace_get_atoms_by_type(atomspace_t* space, atom_type_t type, size_t* count);
 atom_handle_t** atomspace_get_atoms_by_name(atomspace_t* space, const char* name, size_t* count);
 
+/*
+ * Atoms whose type is in `types`, e.g. atom_type_subtypes(ATOM_TYPE_LINK) for
+ * links of every kind. Answered from per-type buckets, so the cost follows
+ * the number of results; atoms come grouped by type, each in creation order.
+ */
+atom_handle_t** atomspace_get_atoms_by_types(atomspace_t* space, atom_type_set_t types, size_t* count);
+
 /* Pattern matching */
 typedef bool (*pattern_matcher_fn)(atom_handle_t* atom, void* user_data);
 atom_handle_t** atomspace_match_pattern(atomspace_t* space, pattern_matcher_fn matcher, 
                                        void* user_data, size_t* count);
 
+/*
+ * Borrowed queries. Results carry no references: they stay valid until the
+ * enclosing atomspace_read_end() and must not be released, only the array
+ * freed. Read sections are per thread, nest, and touch no shared counters.
+ */
+void atomspace_read_begin(atomspace_t* space);
+void atomspace_read_end(atomspace_t* space);
+atom_handle_t** atomspace_get_atoms_by_type_borrowed(atomspace_t* space, atom_type_t type, size_t* count);
+atom_handle_t** atomspace_get_atoms_by_name_borrowed(atomspace_t* space, const char* name, size_t* count);
+atom_handle_t** atomspace_get_atoms_by_types_borrowed(atomspace_t* space, atom_type_set_t types, size_t* count);
+atom_handle_t** atomspace_match_pattern_borrowed(atomspace_t* space, pattern_matcher_fn matcher,
+                                                void* user_data, size_t* count);
+
+/*
+ * Raw scan access for callers that filter inline (atomspace.hpp). Inside a
+ * read section or snapshot, returns the slot array of the space or of one
+ * type's bucket and sets *count. Slots of
+ * removed atoms may be NULL; other atoms count only if atom_visible_at() the
+ * version being read (MVCC_LATEST outside snapshots).
+ */
+atom_handle_t* const* atomspace_scan_slots(atomspace_t* space, size_t* count);
+atom_handle_t* const* atomspace_scan_type_slots(atomspace_t* space, atom_type_t type, size_t* count);
+
+static inline bool atom_visible_at(const atom_t* atom, uint64_t version) {
+    return atom->create_version <= version &&
+           __atomic_load_n(&atom->delete_version, __ATOMIC_ACQUIRE) > version;
+}
+
+/*
+ * Consistent TV/AV pair current at `version` (MVCC_LATEST for the latest),
+ * for scans that read values inline; returns the version it was written at.
+ */
+uint64_t atom_read_values_at(const atom_t* atom, uint64_t version, truth_value_t* tv, attention_value_t* av);
+
+/*
+ * Snapshots. A snapshot sees the atoms and TV/AV values of one committed
+ * version while writers carry on; it is a read section, so results are
+ * borrowed, and it must end on the thread that began it. Incoming sets and
+ * the fields matchers read directly are not versioned: matchers should use
+ * atomspace_snapshot_get_tv/av.
+ */
+typedef struct {
+    atomspace_t* space;
+    uint64_t version;
+} atomspace_snapshot_t;
+
+atomspace_snapshot_t* atomspace_snapshot_begin(atomspace_t* space);
+void atomspace_snapshot_end(atomspace_snapshot_t* snapshot);
+truth_value_t atomspace_snapshot_get_tv(const atomspace_snapshot_t* snapshot, atom_handle_t* handle);
+attention_value_t atomspace_snapshot_get_av(const atomspace_snapshot_t* snapshot, atom_handle_t* handle);
+atom_handle_t** atomspace_snapshot_get_atoms_by_type(const atomspace_snapshot_t* snapshot,
+                                                    atom_type_t type, size_t* count);
+atom_handle_t** atomspace_snapshot_get_atoms_by_name(const atomspace_snapshot_t* snapshot,
+                                                    const char* name, size_t* count);
+atom_handle_t** atomspace_snapshot_get_atoms_by_types(const atomspace_snapshot_t* snapshot,
+                                                     atom_type_set_t types, size_t* count);
+atom_handle_t** atomspace_snapshot_match_pattern(const atomspace_snapshot_t* snapshot,
+                                                pattern_matcher_fn matcher, void* user_data,
+                                                size_t* count);
+
+/*
+ * Transactions. Creates and TV/AV updates are staged privately and applied
+ * by atomspace_txn_commit() under one lock acquisition and one version: a
+ * snapshot sees all of a transaction or none of it, and its new atoms appear
+ * to scans together. Staged handles may be used as link targets and TV/AV
+ * subjects within the transaction; they belong to the space after commit
+ * and are freed by abort. Commit and abort free the transaction.
+ */
+typedef struct atomspace_txn atomspace_txn_t;
+
+atomspace_txn_t* atomspace_txn_begin(atomspace_t* space);
+atom_handle_t* atomspace_txn_create(atomspace_txn_t* txn, atom_type_t type, const char* name);
+atom_handle_t* atomspace_txn_create_link(atomspace_txn_t* txn, atom_type_t type,
+                                         atom_handle_t** outgoing, size_t count);
+int atomspace_txn_set_tv(atomspace_txn_t* txn, atom_handle_t* handle, double strength, double confidence);
+int atomspace_txn_set_av(atomspace_txn_t* txn, atom_handle_t* handle, int16_t sti, int16_t lti, int16_t vlti);
+int atomspace_txn_commit(atomspace_txn_t* txn);
+void atomspace_txn_abort(atomspace_txn_t* txn);
+
 /* Distributed operations */
 int atomspace_sync(atomspace_t* space);
 int atomspace_replicate_atom(atomspace_t* space, atom_handle_t* handle, uint32_t target_node);
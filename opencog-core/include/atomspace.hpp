@@ -0,0 +1,476 @@
+#ifndef OPENCOG_ATOMSPACE_HPP
+#define OPENCOG_ATOMSPACE_HPP
+
+/*
+ * OpenCog C++ API
+ * Header-only RAII layer over the C AtomSpace API (atom.h)
+ *
+ * Everything here is a thin wrapper: Atom is one pointer, AtomRef is one
+ * pointer that owns a reference, query results are spans over the C arrays
+ * and match()/count_if()/for_each() scan the slot array inline, so their
+ * predicates are inlined instead of being called through pattern_matcher_fn.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include "atom.h"
+#include "mvcc.h"
+
+namespace opencog {
+
+class AtomSpan;
+
+/*
+ * Borrowed atom: holds no reference. Valid while the atom is in the space,
+ * or until the end of the read section or snapshot it was found in.
+ */
+class Atom {
+public:
+    Atom() noexcept = default;
+    explicit Atom(atom_handle_t* handle) noexcept : handle_(handle) {}
+
+    atom_handle_t* handle() const noexcept { return handle_; }
+    explicit operator bool() const noexcept { return handle_ != nullptr; }
+
+    uint64_t id() const noexcept { return handle_->id; }
+    atom_type_t type() const noexcept { return handle_->atom->type; }
+    std::string_view name() const noexcept {
+        const char* name = handle_->atom->name;
+        return name ? std::string_view(name) : std::string_view();
+    }
+    size_t arity() const noexcept { return handle_->atom->outgoing_count; }
+    inline AtomSpan outgoing() const noexcept;
+
+    truth_value_t tv() const noexcept { return atom_get_tv(handle_); }
+    attention_value_t av() const noexcept { return atom_get_av(handle_); }
+    void set_tv(double strength, double confidence) const noexcept {
+        atom_set_tv(handle_, strength, confidence);
+    }
+    void set_av(int16_t sti, int16_t lti, int16_t vlti) const noexcept {
+        atom_set_av(handle_, sti, lti, vlti);
+    }
+
+    friend bool operator==(Atom a, Atom b) noexcept { return a.handle_ == b.handle_; }
+    friend bool operator!=(Atom a, Atom b) noexcept { return a.handle_ != b.handle_; }
+
+private:
+    atom_handle_t* handle_ = nullptr;
+};
+
+/* Contiguous run of handles viewed as Atoms (outgoing sets, query results) */
+class AtomSpan {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Atom;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Atom;
+
+        iterator() noexcept = default;
+        explicit iterator(atom_handle_t* const* pos) noexcept : pos_(pos) {}
+
+        Atom operator*() const noexcept { return Atom(*pos_); }
+        Atom operator[](difference_type n) const noexcept { return Atom(pos_[n]); }
+        iterator& operator++() noexcept { ++pos_; return *this; }
+        iterator operator++(int) noexcept { iterator old = *this; ++pos_; return old; }
+        iterator& operator--() noexcept { --pos_; return *this; }
+        iterator operator--(int) noexcept { iterator old = *this; --pos_; return old; }
+        iterator& operator+=(difference_type n) noexcept { pos_ += n; return *this; }
+        iterator& operator-=(difference_type n) noexcept { pos_ -= n; return *this; }
+        friend iterator operator+(iterator it, difference_type n) noexcept { return it += n; }
+        friend iterator operator+(difference_type n, iterator it) noexcept { return it += n; }
+        friend iterator operator-(iterator it, difference_type n) noexcept { return it -= n; }
+        friend difference_type operator-(iterator a, iterator b) noexcept { return a.pos_ - b.pos_; }
+        friend bool operator==(iterator a, iterator b) noexcept { return a.pos_ == b.pos_; }
+        friend bool operator!=(iterator a, iterator b) noexcept { return a.pos_ != b.pos_; }
+        friend bool operator<(iterator a, iterator b) noexcept { return a.pos_ < b.pos_; }
+        friend bool operator>(iterator a, iterator b) noexcept { return a.pos_ > b.pos_; }
+        friend bool operator<=(iterator a, iterator b) noexcept { return a.pos_ <= b.pos_; }
+        friend bool operator>=(iterator a, iterator b) noexcept { return a.pos_ >= b.pos_; }
+
+    private:
+        atom_handle_t* const* pos_ = nullptr;
+    };
+
+    AtomSpan() noexcept = default;
+    AtomSpan(atom_handle_t* const* data, size_t size) noexcept : data_(data), size_(size) {}
+
+    iterator begin() const noexcept { return iterator(data_); }
+    iterator end() const noexcept { return iterator(data_ + size_); }
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    Atom operator[](size_t i) const noexcept { return Atom(data_[i]); }
+    atom_handle_t* const* data() const noexcept { return data_; }
+
+protected:
+    atom_handle_t* const* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+inline AtomSpan Atom::outgoing() const noexcept {
+    return AtomSpan(handle_->atom->outgoing, handle_->atom->outgoing_count);
+}
+
+/*
+ * Owning atom reference: move-only, releases its reference on destruction.
+ * Moves transfer the reference without touching the count; copies must be
+ * asked for with clone(), so every retain in the caller's code is explicit.
+ */
+class AtomRef {
+public:
+    AtomRef() noexcept = default;
+
+    /* Take over a reference the caller already holds (retaining C queries) */
+    static AtomRef adopt(atom_handle_t* handle) noexcept { return AtomRef(handle); }
+
+    /* Add a reference to a borrowed atom, keeping it alive past its removal */
+    static AtomRef retain(Atom atom) noexcept {
+        if (atom) atom_retain(atom.handle());
+        return AtomRef(atom.handle());
+    }
+
+    AtomRef(AtomRef&& other) noexcept : atom_(other.detach()) {}
+    AtomRef& operator=(AtomRef&& other) noexcept {
+        if (this != &other) {
+            reset();
+            atom_ = Atom(other.detach());
+        }
+        return *this;
+    }
+    AtomRef(const AtomRef&) = delete;
+    AtomRef& operator=(const AtomRef&) = delete;
+    ~AtomRef() { reset(); }
+
+    AtomRef clone() const noexcept { return retain(atom_); }
+
+    Atom get() const noexcept { return atom_; }
+    Atom operator*() const noexcept { return atom_; }
+    const Atom* operator->() const noexcept { return &atom_; }
+    explicit operator bool() const noexcept { return static_cast<bool>(atom_); }
+
+    /* Give up ownership; the caller must atom_release() the handle */
+    atom_handle_t* detach() noexcept { return std::exchange(atom_, Atom()).handle(); }
+
+    void reset() noexcept {
+        if (atom_) atom_release(detach());
+    }
+
+private:
+    explicit AtomRef(atom_handle_t* handle) noexcept : atom_(handle) {}
+
+    Atom atom_;
+};
+
+/*
+ * Borrowed query result: owns the C result array, not the atoms. Valid
+ * until the end of the read section or snapshot that produced it.
+ */
+class QueryResult : public AtomSpan {
+public:
+    QueryResult() noexcept = default;
+    QueryResult(atom_handle_t** data, size_t size) noexcept : AtomSpan(data, size) {}
+    QueryResult(QueryResult&& other) noexcept
+        : AtomSpan(std::exchange(other.data_, nullptr), std::exchange(other.size_, 0)) {}
+    QueryResult& operator=(QueryResult&& other) noexcept {
+        if (this != &other) {
+            std::free(const_cast<atom_handle_t**>(data_));
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+    QueryResult(const QueryResult&) = delete;
+    QueryResult& operator=(const QueryResult&) = delete;
+    ~QueryResult() { std::free(const_cast<atom_handle_t**>(data_)); }
+};
+
+struct AcceptAll {
+    bool operator()(Atom) const noexcept { return true; }
+};
+
+namespace detail {
+
+/* Scan predicates take an Atom, or (handle, version) like the where.hpp filters */
+template <typename Pred>
+inline bool call_predicate(Pred& pred, atom_handle_t* handle, uint64_t version) {
+    if constexpr (std::is_invocable_r_v<bool, Pred&, atom_handle_t*, uint64_t>) {
+        return pred(handle, version);
+    } else {
+        return pred(Atom(handle));
+    }
+}
+
+/* Slots ahead of the scan position to prefetch; atoms sit next to their handles */
+constexpr size_t SCAN_PREFETCH = 16;
+
+} // namespace detail
+
+/*
+ * Lazy filtered scan over the space's slot array at one version. The range
+ * captures the array when created and must not outlive the read section or
+ * snapshot it came from. The predicate is a template argument, so each
+ * predicate type gets its own loop with the test inlined.
+ */
+template <typename Pred>
+class MatchRange {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Atom;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Atom;
+
+        iterator() noexcept = default;
+        iterator(const MatchRange* range, size_t index) : range_(range), index_(index) { settle(); }
+
+        Atom operator*() const noexcept { return Atom(range_->slots_[index_]); }
+        iterator& operator++() { ++index_; settle(); return *this; }
+        iterator operator++(int) { iterator old = *this; ++*this; return old; }
+        friend bool operator==(const iterator& a, const iterator& b) noexcept { return a.index_ == b.index_; }
+        friend bool operator!=(const iterator& a, const iterator& b) noexcept { return a.index_ != b.index_; }
+
+    private:
+        void settle() {
+            while (index_ < range_->count_ && !range_->accept(index_)) index_++;
+        }
+
+        const MatchRange* range_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    MatchRange(atomspace_t* space, uint64_t version, Pred pred)
+        : version_(version), pred_(std::move(pred)) {
+        slots_ = atomspace_scan_slots(space, &count_);
+    }
+
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, count_); }
+
+    template <typename Visitor>
+    void for_each(Visitor&& visit) const {
+        for (size_t i = 0; i < count_; i++) {
+            prefetch(i);
+            if (accept(i)) visit(Atom(slots_[i]));
+        }
+    }
+
+    size_t count() const {
+        size_t matches = 0;
+        for (size_t i = 0; i < count_; i++) {
+            prefetch(i);
+            matches += accept(i);
+        }
+        return matches;
+    }
+
+    /* Matches in slot order, as a borrowed result like the C queries return */
+    QueryResult collect() const {
+        size_t capacity = 64, size = 0;
+        atom_handle_t** atoms = static_cast<atom_handle_t**>(std::malloc(sizeof(atom_handle_t*) * capacity));
+        for (size_t i = 0; atoms && i < count_; i++) {
+            prefetch(i);
+            if (!accept(i)) continue;
+            if (size == capacity) {
+                capacity *= 2;
+                atom_handle_t** grown = static_cast<atom_handle_t**>(
+                    std::realloc(atoms, sizeof(atom_handle_t*) * capacity));
+                if (!grown) {
+                    std::free(atoms);
+                    throw std::bad_alloc();
+                }
+                atoms = grown;
+            }
+            atoms[size++] = slots_[i];
+        }
+        if (!atoms) throw std::bad_alloc();
+        return QueryResult(atoms, size);
+    }
+
+private:
+    bool accept(size_t i) const {
+        atom_handle_t* handle = slots_[i];
+        return handle && atom_visible_at(handle->atom, version_) &&
+               detail::call_predicate(pred_, handle, version_);
+    }
+
+    void prefetch(size_t i) const {
+        if (i + detail::SCAN_PREFETCH < count_) __builtin_prefetch(slots_[i + detail::SCAN_PREFETCH]);
+    }
+
+    atom_handle_t* const* slots_ = nullptr;
+    size_t count_ = 0;
+    uint64_t version_;
+    mutable Pred pred_;
+};
+
+class ReadSection;
+class Snapshot;
+
+/* Owns an atomspace_t */
+class AtomSpace {
+public:
+    explicit AtomSpace(uint32_t node_id = 1) : space_(atomspace_create(node_id)) {
+        if (!space_) throw std::bad_alloc();
+    }
+    AtomSpace(AtomSpace&& other) noexcept : space_(std::exchange(other.space_, nullptr)) {}
+    AtomSpace& operator=(AtomSpace&& other) noexcept {
+        if (this != &other) {
+            if (space_) atomspace_destroy(space_);
+            space_ = std::exchange(other.space_, nullptr);
+        }
+        return *this;
+    }
+    AtomSpace(const AtomSpace&) = delete;
+    AtomSpace& operator=(const AtomSpace&) = delete;
+    ~AtomSpace() {
+        if (space_) atomspace_destroy(space_);
+    }
+
+    atomspace_t* get() const noexcept { return space_; }
+
+    /* Size counts atoms created minus atoms removed */
+    size_t size() const noexcept {
+        return space_->total_atoms_created - space_->total_atoms_deleted;
+    }
+
+    /* Created atoms belong to the space; a null Atom means invalid arguments */
+    Atom add_node(atom_type_t type, const char* name) noexcept {
+        return Atom(atom_create(space_, type, name));
+    }
+    Atom add_node(atom_type_t type, const std::string& name) noexcept {
+        return add_node(type, name.c_str());
+    }
+    template <typename Targets>
+    Atom add_link(atom_type_t type, const Targets& targets);
+    Atom add_link(atom_type_t type, std::initializer_list<Atom> targets) {
+        return add_link<std::initializer_list<Atom>>(type, targets);
+    }
+
+    bool remove(Atom atom) noexcept { return atomspace_remove_atom(space_, atom.handle()) == 0; }
+    Atom find(uint64_t id) const noexcept { return Atom(atomspace_get_atom(space_, id)); }
+
+    /* Borrowed queries; the ReadSection argument bounds the result's lifetime */
+    QueryResult by_type(const ReadSection&, atom_type_t type) const noexcept {
+        size_t count = 0;
+        atom_handle_t** atoms = atomspace_get_atoms_by_type_borrowed(space_, type, &count);
+        return QueryResult(atoms, count);
+    }
+    /* Union of per-type buckets, e.g. atom_type_subtypes(ATOM_TYPE_LINK) */
+    QueryResult by_types(const ReadSection&, atom_type_set_t types) const noexcept {
+        size_t count = 0;
+        atom_handle_t** atoms = atomspace_get_atoms_by_types_borrowed(space_, types, &count);
+        return QueryResult(atoms, count);
+    }
+    QueryResult by_name(const ReadSection&, const char* name) const noexcept {
+        size_t count = 0;
+        atom_handle_t** atoms = atomspace_get_atoms_by_name_borrowed(space_, name, &count);
+        return QueryResult(atoms, count);
+    }
+
+    /* Inline scans of the latest state */
+    template <typename Pred>
+    MatchRange<Pred> match(const ReadSection&, Pred pred) const {
+        return MatchRange<Pred>(space_, MVCC_LATEST, std::move(pred));
+    }
+    MatchRange<AcceptAll> atoms(const ReadSection& read) const { return match(read, AcceptAll()); }
+    template <typename Pred>
+    size_t count_if(const ReadSection& read, Pred pred) const {
+        return match(read, std::move(pred)).count();
+    }
+    template <typename Visitor>
+    void for_each(const ReadSection& read, Visitor&& visit) const {
+        match(read, AcceptAll()).for_each(std::forward<Visitor>(visit));
+    }
+
+private:
+    atomspace_t* space_;
+};
+
+template <typename Targets>
+Atom AtomSpace::add_link(atom_type_t type, const Targets& targets) {
+    atom_handle_t* inline_buf[16];
+    size_t count = static_cast<size_t>(std::distance(std::begin(targets), std::end(targets)));
+    atom_handle_t** outgoing = count <= 16 ? inline_buf
+                                           : static_cast<atom_handle_t**>(std::malloc(sizeof(atom_handle_t*) * count));
+    if (!outgoing) return Atom();
+    size_t i = 0;
+    for (Atom target : targets) outgoing[i++] = target.handle();
+    Atom link(atom_create_link(space_, type, outgoing, count));
+    if (outgoing != inline_buf) std::free(outgoing);
+    return link;
+}
+
+/* Scoped atomspace_read_begin/end; per thread, may nest */
+class ReadSection {
+public:
+    explicit ReadSection(const AtomSpace& space) noexcept : space_(space.get()) {
+        atomspace_read_begin(space_);
+    }
+    ~ReadSection() { atomspace_read_end(space_); }
+    ReadSection(const ReadSection&) = delete;
+    ReadSection& operator=(const ReadSection&) = delete;
+
+private:
+    atomspace_t* space_;
+};
+
+/* Scoped snapshot; must end on the thread that began it */
+class Snapshot {
+public:
+    explicit Snapshot(const AtomSpace& space) : snapshot_(atomspace_snapshot_begin(space.get())) {
+        if (!snapshot_) throw std::bad_alloc();
+    }
+    ~Snapshot() { atomspace_snapshot_end(snapshot_); }
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    uint64_t version() const noexcept { return snapshot_->version; }
+    truth_value_t tv(Atom atom) const noexcept { return atomspace_snapshot_get_tv(snapshot_, atom.handle()); }
+    attention_value_t av(Atom atom) const noexcept { return atomspace_snapshot_get_av(snapshot_, atom.handle()); }
+
+    QueryResult by_type(atom_type_t type) const noexcept {
+        size_t count = 0;
+        atom_handle_t** atoms = atomspace_snapshot_get_atoms_by_type(snapshot_, type, &count);
+        return QueryResult(atoms, count);
+    }
+    QueryResult by_types(atom_type_set_t types) const noexcept {
+        size_t count = 0;
+        atom_handle_t** atoms = atomspace_snapshot_get_atoms_by_types(snapshot_, types, &count);
+        return QueryResult(atoms, count);
+    }
+    QueryResult by_name(const char* name) const noexcept {
+        size_t count = 0;
+        atom_handle_t** atoms = atomspace_snapshot_get_atoms_by_name(snapshot_, name, &count);
+        return QueryResult(atoms, count);
+    }
+
+    /* Predicates should read values through tv()/av(), which are versioned */
+    template <typename Pred>
+    MatchRange<Pred> match(Pred pred) const {
+        return MatchRange<Pred>(snapshot_->space, snapshot_->version, std::move(pred));
+    }
+    MatchRange<AcceptAll> atoms() const { return match(AcceptAll()); }
+    template <typename Pred>
+    size_t count_if(Pred pred) const { return match(std::move(pred)).count(); }
+    template <typename Visitor>
+    void for_each(Visitor&& visit) const { match(AcceptAll()).for_each(std::forward<Visitor>(visit)); }
+
+private:
+    atomspace_snapshot_t* snapshot_;
+};
+
+} // namespace opencog
+
+#endif /* OPENCOG_ATOMSPACE_HPP */
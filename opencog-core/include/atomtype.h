@@ -0,0 +1,88 @@
+#ifndef OPENCOG_ATOMTYPE_H
+#define OPENCOG_ATOMTYPE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Atom types for cognitive representation */
+typedef enum {
+    ATOM_TYPE_CONCEPT,
+    ATOM_TYPE_PREDICATE,
+    ATOM_TYPE_LINK,
+    ATOM_TYPE_NODE,
+    ATOM_TYPE_VARIABLE,
+    ATOM_TYPE_EVALUATION,
+    ATOM_TYPE_EXECUTION,
+    ATOM_TYPE_CUSTOM,
+
+    /* Logical connectives */
+    ATOM_TYPE_AND,
+    ATOM_TYPE_OR,
+    ATOM_TYPE_NOT,
+    ATOM_TYPE_IMPLICATION,
+    ATOM_TYPE_EQUIVALENCE
+} atom_type_t;
+
+/* Built-in types; atom_type_register() adds more up to ATOM_TYPE_MAX */
+#define ATOM_TYPE_COUNT (ATOM_TYPE_EQUIVALENCE + 1)
+#define ATOM_TYPE_MAX 64
+
+/* Set of types, one bit per type */
+typedef uint64_t atom_type_set_t;
+#define ATOM_TYPE_BIT(type) ((atom_type_set_t)1 << (type))
+
+/*
+ * Type hierarchy. Each type has at most one parent. The built-in tree is
+ *
+ *   NODE    CONCEPT, PREDICATE, VARIABLE
+ *   LINK    EVALUATION, EXECUTION, AND, OR, NOT, IMPLICATION, EQUIVALENCE
+ *   CUSTOM
+ *
+ * Registering a type precomputes its ancestor set (itself included) and adds
+ * it to the descendant set of each ancestor, so is-a tests and "T or any
+ * subtype" filters are one bit test. The tables are read without locks:
+ * a type's entries are complete before its ID is returned.
+ */
+extern atom_type_set_t atom_type_ancestors[ATOM_TYPE_MAX];
+extern atom_type_set_t atom_type_descendants[ATOM_TYPE_MAX];
+
+/* Returns the new type, or -1 if the name is taken, the parent unknown or the table full */
+int atom_type_register(const char* name, atom_type_t parent);
+
+/* -1 if no type has this name */
+int atom_type_lookup(const char* name);
+
+/* NULL for unknown types */
+const char* atom_type_name(atom_type_t type);
+
+/* -1 for root and unknown types */
+int atom_type_parent(atom_type_t type);
+
+/* Built-in plus registered types; valid types are 0 .. count - 1 */
+size_t atom_type_count(void);
+
+static inline bool atom_type_valid(atom_type_t type) {
+    return (unsigned)type < ATOM_TYPE_MAX &&
+           __atomic_load_n(&atom_type_ancestors[type], __ATOMIC_ACQUIRE) != 0;
+}
+
+/* True if `type` is `base` or one of its subtypes; both must be valid */
+static inline bool atom_type_is_a(atom_type_t type, atom_type_t base) {
+    return (atom_type_ancestors[type] & ATOM_TYPE_BIT(base)) != 0;
+}
+
+/* `base` and all of its subtypes */
+static inline atom_type_set_t atom_type_subtypes(atom_type_t base) {
+    return __atomic_load_n(&atom_type_descendants[base], __ATOMIC_ACQUIRE);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_ATOMTYPE_H */
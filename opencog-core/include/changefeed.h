@@ -0,0 +1,94 @@
+#ifndef OPENCOG_CHANGEFEED_H
+#define OPENCOG_CHANGEFEED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "atom.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Change-data capture.
+ *
+ * While the feed is on, every atom create, TV/AV update and delete is
+ * appended to one process-wide log. Events carry their space's space_id,
+ * so subscribers that share the process with other spaces filter on it.
+ * Writers claim positions with a single atomic add (once per write, batch
+ * or transaction commit) and never wait for readers. Each subscriber keeps
+ * its own cursor and filter and polls events in batches. A subscriber that
+ * falls more than the log's capacity behind loses the overwritten events
+ * and is told how many. When the feed is off the hooks cost one
+ * predictable branch.
+ */
+
+typedef enum {
+    CHANGE_CREATE,
+    CHANGE_UPDATE,            /* TV and/or AV written; the event carries both */
+    CHANGE_DELETE
+} change_kind_t;
+
+#define CHANGE_NAME_MAX 48
+
+typedef struct {
+    uint64_t sequence;        /* Position in the feed, consecutive per subscriber unless dropped */
+    uint64_t version;         /* MVCC version of the change (mvcc.h) */
+    uint64_t atom_id;
+    uint64_t name_hash;       /* FNV-1a of the full name, 0 if unnamed */
+    truth_value_t tv;
+    attention_value_t av;
+    uint8_t kind;             /* change_kind_t */
+    uint8_t type;             /* atom_type_t */
+    uint32_t arity;           /* Outgoing set size */
+    uint32_t space_id;        /* atomspace_t.space_id of the atom's space */
+    char name[CHANGE_NAME_MAX]; /* Name, truncated and NUL-terminated */
+} change_event_t;
+
+/* Subscriber filters; zero masks, a NULL name and space_id 0 accept everything */
+typedef struct {
+    uint32_t kinds;           /* Bit (1 << change_kind_t) */
+    atom_type_set_t types;    /* ATOM_TYPE_BIT(atom_type_t) */
+    const char* name;         /* Exact atom name */
+    uint32_t space_id;        /* Only this space's events */
+} change_filter_t;
+
+typedef struct changefeed_subscription changefeed_subscription_t;
+
+/* Feed control; the log is allocated by the first start and kept */
+extern bool changefeed_active;
+
+/* Pairs with the release in changefeed_start(): writers that see the feed on see its log */
+static inline bool changefeed_is_active(void) {
+    return __atomic_load_n(&changefeed_active, __ATOMIC_ACQUIRE);
+}
+
+int changefeed_start(size_t capacity);
+void changefeed_stop(void);
+uint64_t changefeed_head(void);
+
+/* Subscribers start at the current head */
+changefeed_subscription_t* changefeed_subscribe(const change_filter_t* filter);
+void changefeed_unsubscribe(changefeed_subscription_t* sub);
+
+/* Copy up to `max` matching events; returns the number copied */
+size_t changefeed_poll(changefeed_subscription_t* sub, change_event_t* out, size_t max);
+
+/* Events overwritten before this subscriber read them */
+uint64_t changefeed_dropped(const changefeed_subscription_t* sub);
+
+/*
+ * Writer side, called only while changefeed_is_active(): claim `count`
+ * consecutive positions, then publish one event into each. The event
+ * carries `tv` and `av` as written rather than reading them off the atom.
+ */
+uint64_t changefeed_claim(size_t count);
+void changefeed_publish(uint64_t sequence, change_kind_t kind, const atom_t* atom,
+                        const truth_value_t* tv, const attention_value_t* av, uint64_t version);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_CHANGEFEED_H */
@@ -0,0 +1,65 @@
+#ifndef OPENCOG_CLIENT_H
+#define OPENCOG_CLIENT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "atom.h"
+#include "protocol.h"
+#include "changefeed.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * AtomSpace client for the server protocol (protocol.h).
+ *
+ * client_send() only buffers a request and returns its tag, so callers can
+ * pipeline any number of requests, flush them with one write and collect
+ * the responses with client_recv(). The call helpers below send one request
+ * and wait for its answer; they expect no other traffic on the connection,
+ * so subscriptions belong on a connection of their own.
+ */
+
+typedef struct client client_t;
+
+client_t* client_connect(const char* path);
+void client_close(client_t* client);
+
+/* Pipelined interface; send returns the request tag */
+uint32_t client_send(client_t* client, uint32_t stream, uint8_t op, const void* payload, uint32_t length);
+int client_flush(client_t* client);
+
+/*
+ * Wait for the next frame. The payload stays valid until the next receive;
+ * returns -1 when the connection fails or closes.
+ */
+int client_recv(client_t* client, proto_header_t* header, const void** payload);
+
+/* Calls; IDs are 0 and counts 0 on failure */
+int client_ping(client_t* client);
+uint64_t client_create_node(client_t* client, atom_type_t type, const char* name);
+uint64_t client_create_link(client_t* client, atom_type_t type, const uint64_t* outgoing, uint32_t arity);
+int client_set_tv(client_t* client, uint64_t id, double strength, double confidence);
+int client_get_tv(client_t* client, uint64_t id, truth_value_t* tv);
+int client_remove(client_t* client, uint64_t id);
+
+/* Result arrays are malloc'd and owned by the caller; replies split over frames are joined */
+uint64_t* client_query_type(client_t* client, atom_type_t type, size_t* count);
+uint64_t* client_query_name(client_t* client, const char* name, size_t* count);
+uint64_t* client_match(client_t* client, atom_type_t type, const uint64_t* pattern,
+                       uint32_t arity, size_t* count);
+
+/*
+ * Subscribe `stream` to changes; events then arrive as PROTO_OP_EVENT
+ * frames. Waits for the acknowledgement, skipping frames that arrive first.
+ * The server sends only its own space's events, so filter->space_id is
+ * not sent.
+ */
+int client_subscribe(client_t* client, uint32_t stream, const change_filter_t* filter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_CLIENT_H */
@@ -0,0 +1,71 @@
+#ifndef OPENCOG_CSR_H
+#define OPENCOG_CSR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "atom.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Frozen CSR (compressed sparse row) view of the AtomSpace graph.
+ *
+ * Every atom visible at one snapshot version becomes a vertex, numbered
+ * densely in creation order. Each link has an out edge to every member of
+ * its outgoing set, in order and with repeats; in edges are the same edges
+ * reversed, with sources ascending. Both directions are plain offset and
+ * target arrays, so kernels stream them instead of chasing an allocation
+ * per atom. Type and TV columns are filled on request.
+ *
+ * The view is a copy: it stays valid and unchanged after the space moves
+ * on or is destroyed, and holds no references. Building runs in parallel
+ * on up to CSR_MAX_THREADS threads.
+ */
+
+#define CSR_WITH_TYPES 0x1        /* Fill `types` */
+#define CSR_WITH_TV 0x2           /* Fill `strengths` and `confidences` */
+
+#define CSR_MAX_THREADS 64
+#define CSR_NO_VERTEX UINT32_MAX
+
+typedef struct {
+    uint64_t version;             /* Snapshot version the graph was read at */
+    uint32_t vertex_count;
+    uint64_t edge_count;
+    uint64_t* ids;                /* Atom ID of each vertex */
+    uint64_t* out_offsets;        /* vertex_count + 1 entries into out_edges */
+    uint32_t* out_edges;          /* Link -> member */
+    uint64_t* in_offsets;         /* vertex_count + 1 entries into in_edges */
+    uint32_t* in_edges;           /* Member -> link */
+    uint8_t* types;               /* atom_type_t per vertex, NULL without CSR_WITH_TYPES */
+    float* strengths;             /* TV at the snapshot, NULL without CSR_WITH_TV */
+    float* confidences;
+} atomspace_csr_t;
+
+/*
+ * Build a view of the current state with CSR_WITH_* `flags`. `threads` 0
+ * uses one per online CPU; small spaces use fewer. NULL on invalid
+ * arguments, allocation failure or more than CSR_NO_VERTEX - 1 atoms.
+ */
+atomspace_csr_t* atomspace_csr_build(atomspace_t* space, uint32_t flags, unsigned threads);
+void atomspace_csr_free(atomspace_csr_t* csr);
+
+/* Vertex of an atom, CSR_NO_VERTEX if it was not in the space at the version */
+uint32_t atomspace_csr_vertex(const atomspace_csr_t* csr, const atom_handle_t* handle);
+
+static inline uint64_t atomspace_csr_out_degree(const atomspace_csr_t* csr, uint32_t vertex) {
+    return csr->out_offsets[vertex + 1] - csr->out_offsets[vertex];
+}
+
+static inline uint64_t atomspace_csr_in_degree(const atomspace_csr_t* csr, uint32_t vertex) {
+    return csr->in_offsets[vertex + 1] - csr->in_offsets[vertex];
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_CSR_H */
@@ -11,6 +11,13 @@ extern "C" {
 
 /* Distributed OS primitives for OpenCog */
 
+/* Message queue for async communication */
+typedef struct {
+    int mq_id;
+    size_t max_messages;
+    size_t max_message_size;
+} message_queue_t;
+
 /* Node information in distributed system */
 typedef struct {
     uint32_t node_id;
@@ -18,6 +25,7 @@ typedef struct {
     uint16_t port;
     bool is_active;
     uint64_t last_heartbeat;
+    message_queue_t* mq;          /* Peer's inbound queue, attached once it exists */
 } node_info_t;
 
 /* Message types for inter-node communication */
@@ -50,14 +58,9 @@ typedef struct {
     void* shm_addr;
     size_t shm_size;
     pthread_mutex_t* lock;
+    uint64_t lock_acquired_ns;    /* Lock profiler timestamp while held */
 } shared_memory_t;
 
-/* Message queue for async communication */
-typedef struct {
-    int mq_id;
-    size_t max_messages;
-    size_t max_message_size;
-} message_queue_t;
 
 /* Distributed coordination context */
 typedef struct {
@@ -93,7 +96,11 @@ int distributed_leave_cluster(distributed_ctx_t* ctx);
 int distributed_add_node(distributed_ctx_t* ctx, uint32_t node_id, const char* hostname, uint16_t port);
 int distributed_remove_node(distributed_ctx_t* ctx, uint32_t node_id);
 
-/* Message operations */
+/*
+ * Message operations. Every node owns an inbound queue named after its ID.
+ * Messages addressed to a known peer go to that peer's queue; messages to
+ * this node or to 0 (broadcast) stay on the local queue.
+ */
 int distributed_send_message(distributed_ctx_t* ctx, message_t* msg);
 message_t* distributed_receive_message(distributed_ctx_t* ctx, int timeout_ms);
 void distributed_free_message(message_t* msg);
@@ -104,9 +111,22 @@ void shared_memory_destroy(shared_memory_t* shm);
 void* shared_memory_lock(shared_memory_t* shm);
 void shared_memory_unlock(shared_memory_t* shm);
 
+/*
+ * Node queues are System V queues shared by the whole machine. Programs that
+ * run independent clusters side by side, such as the benchmark harness, give
+ * each run a scope: queue names then include it, and the queues are private
+ * to their user. The scope is process-wide and inherited across fork(); set
+ * it before creating contexts. NULL or "" restores the shared default.
+ */
+void distributed_set_queue_scope(const char* scope);
+
+/* Remove node_id's queue in the current scope; -1 if there is none */
+int distributed_remove_node_queue(uint32_t node_id);
+
 /* Message queue operations */
 message_queue_t* message_queue_create(const char* name, size_t max_messages, size_t max_message_size);
 void message_queue_destroy(message_queue_t* mq);
+void message_queue_close(message_queue_t* mq);
 int message_queue_send(message_queue_t* mq, const void* data, size_t size, int priority);
 int message_queue_receive(message_queue_t* mq, void* buffer, size_t size, int* priority, int timeout_ms);
 
@@ -0,0 +1,50 @@
+#ifndef OPENCOG_EPOCH_H
+#define OPENCOG_EPOCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Epoch-based reclamation.
+ *
+ * Readers bracket access to shared objects with epoch_enter()/epoch_exit();
+ * both touch only the calling thread's own record. Writers that unlink an
+ * object hand it to epoch_retire() instead of freeing it, and it is freed
+ * once every reader that could still see it has left its critical section
+ * (two epoch advances later). Critical sections nest.
+ */
+
+typedef void (*epoch_free_fn)(void* ptr);
+
+/* Read side */
+void epoch_enter(void);
+void epoch_exit(void);
+bool epoch_in_critical(void);
+
+/* Write side */
+void epoch_retire(void* ptr, epoch_free_fn free_fn);
+
+/* Free whatever is already safe; returns the number of objects freed */
+size_t epoch_reclaim(void);
+
+/*
+ * Wait for all current readers and free every retired object, including
+ * those retired by the free functions it runs. Must not be called from
+ * inside a critical section.
+ */
+void epoch_synchronize(void);
+
+/* Current global epoch and objects awaiting reclamation, for diagnostics */
+uint64_t epoch_current(void);
+size_t epoch_pending(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_EPOCH_H */
@@ -0,0 +1,98 @@
+#ifndef OPENCOG_GRAPH_H
+#define OPENCOG_GRAPH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "atom.h"
+#include "csr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Parallel graph algorithms over a CSR view (csr.h).
+ *
+ * Results are arrays indexed by vertex, allocated by the caller with
+ * csr->vertex_count entries; graph_write_back() copies one into the
+ * atoms' TV or AV. `threads` 0 uses one per online CPU, and small graphs
+ * use fewer. Every call runs its own team of threads and returns when
+ * done; the view is only read, so calls on one view may run concurrently.
+ */
+
+/* Which edges a traversal follows; links point at their members */
+typedef enum {
+    GRAPH_OUT,                    /* Link -> member */
+    GRAPH_IN,                     /* Member -> link */
+    GRAPH_BOTH                    /* Either way, as an undirected graph */
+} graph_direction_t;
+
+#define GRAPH_MAX_THREADS 64
+#define GRAPH_UNREACHED UINT32_MAX
+
+/*
+ * Breadth-first search from `sources` to at most `max_depth` hops
+ * (UINT32_MAX for no limit); a k-hop neighbourhood is the vertices with
+ * depth <= k. Fills `depth` (GRAPH_UNREACHED if not reached) and, if not
+ * NULL, `parent` (a vertex one hop nearer a source, itself for sources).
+ * Direction-optimizing: levels with a large frontier are expanded bottom
+ * up, each unvisited vertex looking for a parent in a frontier bitmap.
+ * Returns the number of vertices reached, sources included.
+ */
+size_t graph_bfs(const atomspace_csr_t* csr, const uint32_t* sources, size_t source_count,
+                 uint32_t max_depth, graph_direction_t direction, unsigned threads,
+                 uint32_t* depth, uint32_t* parent);
+
+/*
+ * A fewest-hop path from `source` to `target`, both included, written to
+ * `path` up to `max` vertices. Returns the path's length in vertices, 0 if
+ * there is none.
+ */
+size_t graph_shortest_path(const atomspace_csr_t* csr, uint32_t source, uint32_t target,
+                           graph_direction_t direction, unsigned threads, uint32_t* path, size_t max);
+
+/*
+ * Weakly connected components. Each vertex gets the smallest vertex of its
+ * component as label. Returns the number of components.
+ */
+size_t graph_components(const atomspace_csr_t* csr, unsigned threads, uint32_t* component);
+
+/*
+ * PageRank along `direction`: a vertex passes its rank to its neighbours
+ * in equal shares, and vertices without neighbours spread theirs over all.
+ * Iterates until the L1 change falls below `tolerance` or after
+ * `max_iterations`; ranks sum to 1. Returns the iterations run.
+ */
+typedef struct {
+    float damping;                /* 0.85 */
+    float tolerance;              /* 1e-6 */
+    uint32_t max_iterations;      /* 100 */
+} graph_pagerank_config_t;
+
+void graph_pagerank_config_default(graph_pagerank_config_t* config);
+uint32_t graph_pagerank(const atomspace_csr_t* csr, graph_direction_t direction,
+                        const graph_pagerank_config_t* config, unsigned threads, float* rank);
+
+/*
+ * Store `values[v] * scale` into one field of each vertex's atom that is
+ * still in the space. TV fields are clamped to [0, 1] and AV fields
+ * rounded and clamped to int16_t; the other fields keep their values.
+ * Returns the number of atoms written.
+ */
+typedef enum {
+    GRAPH_FIELD_STI,
+    GRAPH_FIELD_LTI,
+    GRAPH_FIELD_VLTI,
+    GRAPH_FIELD_STRENGTH,
+    GRAPH_FIELD_CONFIDENCE
+} graph_field_t;
+
+size_t graph_write_back(atomspace_t* space, const atomspace_csr_t* csr, const float* values,
+                        float scale, graph_field_t field);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_GRAPH_H */
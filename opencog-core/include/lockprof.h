@@ -0,0 +1,108 @@
+#ifndef OPENCOG_LOCKPROF_H
+#define OPENCOG_LOCKPROF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Lock contention profiler.
+ *
+ * Each lock call site owns a static lockprof_site_t. The wrappers below take
+ * the lock exactly as before when profiling is off (one predictable branch);
+ * when it is on they record acquisitions, contended acquisitions, wait time
+ * and hold time for the site. Profiling can be switched at any time.
+ */
+
+/* Per-site counters; declare with LOCKPROF_SITE(var, "subsystem.lock") */
+typedef struct lockprof_site {
+    const char* name;
+    uint64_t acquisitions;
+    uint64_t contended;
+    uint64_t wait_ns;
+    uint64_t max_wait_ns;
+    uint64_t hold_ns;
+    uint64_t max_hold_ns;
+    struct lockprof_site* next;
+    int registered;
+} lockprof_site_t;
+
+#define LOCKPROF_SITE(var, site_name) \
+    static lockprof_site_t var = { (site_name), 0, 0, 0, 0, 0, 0, NULL, 0 }
+
+/* Snapshot of one site for reporting */
+typedef struct {
+    const char* name;
+    uint64_t acquisitions;
+    uint64_t contended;
+    uint64_t wait_ns;
+    uint64_t max_wait_ns;
+    uint64_t hold_ns;
+    uint64_t max_hold_ns;
+} lockprof_stats_t;
+
+/* Runtime switch */
+extern volatile bool lockprof_active;
+void lockprof_set_enabled(bool enabled);
+bool lockprof_enabled(void);
+
+/* Reporting: sites are ranked by total wait time, highest first */
+size_t lockprof_snapshot(lockprof_stats_t* out, size_t max);
+void lockprof_report(FILE* out);
+void lockprof_reset(void);
+
+/* Slow paths taken only while profiling */
+uint64_t lockprof_mutex_lock_slow(pthread_mutex_t* mutex, lockprof_site_t* site);
+uint64_t lockprof_rdlock_slow(pthread_rwlock_t* lock, lockprof_site_t* site);
+uint64_t lockprof_wrlock_slow(pthread_rwlock_t* lock, lockprof_site_t* site);
+void lockprof_release(lockprof_site_t* site, uint64_t acquired_ns);
+
+/*
+ * Lock wrappers. The lock functions return the acquisition timestamp, or 0
+ * when profiling is off; pass it back to the matching unlock.
+ */
+static inline uint64_t lockprof_mutex_lock(pthread_mutex_t* mutex, lockprof_site_t* site) {
+    if (__builtin_expect(!lockprof_active, 1)) {
+        pthread_mutex_lock(mutex);
+        return 0;
+    }
+    return lockprof_mutex_lock_slow(mutex, site);
+}
+
+static inline void lockprof_mutex_unlock(pthread_mutex_t* mutex, lockprof_site_t* site, uint64_t acquired_ns) {
+    if (acquired_ns) lockprof_release(site, acquired_ns);
+    pthread_mutex_unlock(mutex);
+}
+
+static inline uint64_t lockprof_rdlock(pthread_rwlock_t* lock, lockprof_site_t* site) {
+    if (__builtin_expect(!lockprof_active, 1)) {
+        pthread_rwlock_rdlock(lock);
+        return 0;
+    }
+    return lockprof_rdlock_slow(lock, site);
+}
+
+static inline uint64_t lockprof_wrlock(pthread_rwlock_t* lock, lockprof_site_t* site) {
+    if (__builtin_expect(!lockprof_active, 1)) {
+        pthread_rwlock_wrlock(lock);
+        return 0;
+    }
+    return lockprof_wrlock_slow(lock, site);
+}
+
+static inline void lockprof_rwlock_unlock(pthread_rwlock_t* lock, lockprof_site_t* site, uint64_t acquired_ns) {
+    if (acquired_ns) lockprof_release(site, acquired_ns);
+    pthread_rwlock_unlock(lock);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_LOCKPROF_H */
@@ -0,0 +1,116 @@
+#ifndef OPENCOG_MEMSTATS_H
+#define OPENCOG_MEMSTATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "atom.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Memory accounting.
+ *
+ * Every AtomSpace keeps running byte counters for the allocations it makes,
+ * so atomspace_memory_usage() costs a few dozen loads and a read lock per
+ * index, and may run while writers do. Each subsystem reports the bytes the
+ * code asked for ("requested") and the bytes malloc handed out ("allocated",
+ * from malloc_usable_size); the difference is allocator slack plus unused
+ * array capacity. Per-atom allocations are also broken down by
+ * atom_type_t. Message buffers, shared memory segments and snapshot history
+ * are process-wide.
+ * Heap fragmentation comes from mallinfo2(), which walks the allocator's free
+ * lists, so it is only gathered when MEMORY_INCLUDE_HEAP is passed.
+ */
+
+/* Subsystems */
+typedef enum {
+    MEMORY_ATOMS,             /* atom_t structures */
+    MEMORY_HANDLES,           /* atom_handle_t structures */
+    MEMORY_NAMES,             /* Node name strings */
+    MEMORY_OUTGOING,          /* Link outgoing arrays */
+    MEMORY_INCOMING,          /* Incoming (back-reference) arrays */
+    MEMORY_ATOM_INDEX,        /* The space's handle array */
+    MEMORY_HASH_TABLE,        /* ID lookup buckets and entries */
+    MEMORY_MESSAGES,          /* Received messages not yet freed (process-wide) */
+    MEMORY_SHARED,            /* Shared memory segments (process-wide) */
+    MEMORY_VERSIONS,          /* TV/AV history kept for snapshots (process-wide) */
+    MEMORY_VECTORS,           /* Vector values and their search graphs */
+    MEMORY_NAME_INDEX,        /* Name trie nodes */
+    MEMORY_TIME_INDEX,        /* Change log segments */
+    MEMORY_QUERY_CACHE,       /* Cached query results */
+    MEMORY_CATEGORY_COUNT
+} memory_category_t;
+
+/* Bytes held by one subsystem or atom type */
+typedef struct {
+    uint64_t count;           /* Live allocations (atoms for by_type) */
+    uint64_t requested;       /* Bytes in use */
+    uint64_t allocated;       /* Bytes reserved from the allocator */
+} memory_usage_t;
+
+typedef struct {
+    memory_usage_t categories[MEMORY_CATEGORY_COUNT];
+    memory_usage_t by_type[ATOM_TYPE_MAX];     /* Atom, handle, name, arrays and hash entry */
+    memory_usage_t total;
+    uint64_t slack;                           /* total.allocated - total.requested */
+
+    /* Process heap, filled only with MEMORY_INCLUDE_HEAP */
+    bool has_heap;
+    uint64_t heap_arena;                      /* Bytes obtained via brk/arena mmaps */
+    uint64_t heap_mmapped;                    /* Bytes in large mmapped chunks */
+    uint64_t heap_in_use;                     /* Bytes in allocated chunks */
+    uint64_t heap_free;                       /* Free bytes held inside the arenas */
+    uint64_t heap_releasable;                 /* Free bytes trimmable from the top */
+    double fragmentation;                     /* Trapped free bytes / arena bytes */
+} atomspace_memory_t;
+
+#define MEMORY_INCLUDE_HEAP 0x1
+
+int atomspace_memory_usage(atomspace_t* space, atomspace_memory_t* out, int flags);
+void atomspace_memory_print(const atomspace_memory_t* mem, FILE* out);
+const char* memory_category_name(memory_category_t category);
+
+/* Process-wide distributed layer usage (distributed.c) */
+void distributed_memory_usage(memory_usage_t* messages, memory_usage_t* shared);
+
+/*
+ * Accounting hooks for the AtomSpace. `ptr` is the live allocation (NULL
+ * counts as zero bytes); per-atom categories are charged to `type`.
+ */
+typedef struct memory_accounting memory_accounting_t;
+
+memory_accounting_t* memory_accounting_create(void);
+void memory_accounting_destroy(memory_accounting_t* acc);
+void memory_account_atom(memory_accounting_t* acc, atom_type_t type, int delta);
+void memory_account_alloc(memory_accounting_t* acc, memory_category_t category,
+                          atom_type_t type, const void* ptr, size_t requested);
+void memory_account_free(memory_accounting_t* acc, memory_category_t category,
+                         atom_type_t type, const void* ptr, size_t requested);
+/* For allocations carved out of a larger block, where malloc_usable_size does not apply */
+void memory_account_alloc_sized(memory_accounting_t* acc, memory_category_t category,
+                                atom_type_t type, uint64_t count, size_t requested, size_t allocated);
+void memory_account_free_sized(memory_accounting_t* acc, memory_category_t category,
+                               atom_type_t type, uint64_t count, size_t requested, size_t allocated);
+void memory_account_resize(memory_accounting_t* acc, memory_category_t category,
+                           atom_type_t type, size_t old_requested, size_t old_allocated,
+                           const void* ptr, size_t requested);
+
+/* Fill the per-atom categories, hash entries and by_type breakdown */
+void memory_accounting_read(memory_accounting_t* acc, atomspace_memory_t* out,
+                            size_t hash_entry_size);
+
+/* AtomSpace side of a snapshot: index, hash table and per-atom categories (atomspace.c) */
+void atomspace_memory_layout(atomspace_t* space, atomspace_memory_t* out);
+
+/* Bytes malloc reserves for a request of `size` (glibc size classes) */
+size_t memory_chunk_size(size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_MEMSTATS_H */
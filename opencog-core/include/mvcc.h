@@ -0,0 +1,69 @@
+#ifndef OPENCOG_MVCC_H
+#define OPENCOG_MVCC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "atom.h"
+#include "memstats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Multi-version concurrency control.
+ *
+ * Every change to an AtomSpace (creating or removing an atom, setting a TV
+ * or AV) is stamped with a version from one process-wide commit clock.
+ * A snapshot reads the newest version whose writes have all completed and
+ * sees exactly the changes stamped at or below it. Neither side waits for
+ * the other: changes to several atoms mark their version as pending while
+ * they are applied, and snapshots start below every pending mark. Writers
+ * keep the TV/AV pair they overwrite in a per-atom history while a
+ * snapshot is open or a marked change is in flight, since a snapshot may
+ * then read below them; epoch reclamation (epoch.h) frees history and
+ * removed atoms once the horizon has passed them and no snapshot can reach
+ * them.
+ */
+
+/* delete_version of an atom that has not been removed */
+#define MVCC_LIVE UINT64_MAX
+
+/* Version used by queries that want the latest state */
+#define MVCC_LATEST (MVCC_LIVE - 1)
+
+/* Writer side: stamp one change, marked pending until _end. Calls must not nest. */
+uint64_t mvcc_write_begin(void);
+void mvcc_write_end(void);
+
+/*
+ * Stamp a change that readers cannot see half done, such as a TV/AV pair
+ * written under the atom's sequence lock; it takes no pending mark.
+ */
+uint64_t mvcc_stamp(void);
+
+/* True while a snapshot may read below a new stamp, so overwritten values must be kept */
+bool mvcc_history_needed(void);
+
+/*
+ * Newest version whose changes have all completed. It never decreases, so
+ * snapshots begun after it was read see everything at or below it.
+ */
+uint64_t mvcc_horizon(void);
+
+/* Snapshot side: returns the version the snapshot reads at */
+uint64_t mvcc_snapshot_begin(void);
+void mvcc_snapshot_end(void);
+
+/* History records for overwritten TV/AV values */
+atom_value_version_t* mvcc_version_alloc(void);
+void mvcc_version_free(atom_value_version_t* version);
+
+/* Process-wide bytes held in history records */
+void mvcc_memory_usage(memory_usage_t* versions);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_MVCC_H */
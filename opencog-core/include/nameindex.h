@@ -0,0 +1,75 @@
+#ifndef OPENCOG_NAMEINDEX_H
+#define OPENCOG_NAMEINDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "atom.h"
+#include "memstats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Name index.
+ *
+ * Every named atom is kept in a radix trie over its name's bytes; a node
+ * holds the atoms whose name ends there, in creation order. Atoms are added
+ * when published and dropped when reclaimed, so the trie is always current
+ * and exact, prefix, glob and fuzzy lookups touch only the part of the trie
+ * that can match rather than every atom. Exact lookups
+ * (atomspace_get_atoms_by_name and friends) go through it as well.
+ *
+ * The searches below return borrowed handles: call them between
+ * atomspace_read_begin() and _end() and retain the atoms kept. They see the
+ * latest state, write at most `max` results and return how many they wrote.
+ * Names compare as unsigned bytes.
+ */
+
+/* Atoms whose name starts with `prefix`, ordered by name */
+size_t atomspace_name_prefix(atomspace_t* space, const char* prefix, atom_handle_t** out, size_t max);
+
+/*
+ * Atoms whose whole name matches a shell-style pattern, ordered by name:
+ * `*` matches any run of bytes, `?` one byte, `[abc]`, `[a-z]` and `[!a-z]`
+ * one byte of a class, and `\` quotes the next byte. Patterns of more than
+ * NAME_GLOB_MAX_TOKENS elements match nothing.
+ */
+#define NAME_GLOB_MAX_TOKENS 63
+
+size_t atomspace_name_glob(atomspace_t* space, const char* pattern, atom_handle_t** out, size_t max);
+
+/*
+ * Atoms whose name is within `max_edits` byte insertions, deletions and
+ * substitutions of `name`, nearest first and by name among equals.
+ */
+typedef struct {
+    atom_handle_t* atom;
+    uint32_t distance;
+} name_match_t;
+
+size_t atomspace_name_fuzzy(atomspace_t* space, const char* name, uint32_t max_edits,
+                            name_match_t* out, size_t max);
+
+/*
+ * AtomSpace hooks. Insert takes a published batch, remove runs when a
+ * removed atom is reclaimed; unnamed atoms are ignored. Lookup returns the
+ * atoms named `name` visible at `version` as a malloc'd array, retained if
+ * `retain` is set.
+ */
+typedef struct name_index name_index_t;
+
+name_index_t* name_index_create(void);
+void name_index_destroy(name_index_t* index);
+void name_index_insert(name_index_t* index, atom_handle_t* const* handles, size_t count);
+void name_index_remove(name_index_t* index, atom_handle_t* handle);
+atom_handle_t** name_index_lookup(name_index_t* index, const char* name, bool retain,
+                                  uint64_t version, size_t* count);
+void name_index_memory(name_index_t* index, memory_usage_t* usage);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_NAMEINDEX_H */
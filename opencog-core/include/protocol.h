@@ -0,0 +1,110 @@
+#ifndef OPENCOG_PROTOCOL_H
+#define OPENCOG_PROTOCOL_H
+
+#include <stdint.h>
+#include "atom.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * AtomSpace wire protocol (server.h, client.h).
+ *
+ * Every message is a 16-byte header followed by `length` payload bytes.
+ * Both ends run on one machine over a Unix domain socket, so integers and
+ * doubles are in host byte order and payload structs are copied as-is.
+ * Clients may send any number of requests without waiting (pipelining);
+ * the server answers each connection's requests in order, echoing `stream`
+ * and `tag`. Streams multiplex independent conversations, including
+ * subscriptions, over one connection.
+ *
+ * No frame carries more than PROTO_MAX_PAYLOAD bytes. ID lists that do not
+ * fit are split into several frames on the request's stream and tag; every
+ * frame but the last has PROTO_FLAG_MORE set, and the receiver joins the
+ * payloads in order.
+ */
+
+#define PROTO_DEFAULT_PATH "/tmp/opencog.sock"
+#define PROTO_MAX_PAYLOAD (16u << 20)
+
+/* proto_header_t flags */
+#define PROTO_FLAG_MORE 0x1   /* Reply continues in the next frame with the same tag */
+
+typedef struct {
+    uint32_t length;          /* Payload bytes after the header */
+    uint32_t stream;          /* Chosen by the client; events use the subscribing stream */
+    uint32_t tag;             /* Chosen by the client, echoed in the response */
+    uint8_t op;               /* proto_op_t */
+    uint8_t status;           /* proto_status_t; 0 in requests */
+    uint16_t flags;           /* PROTO_FLAG_*; 0 in requests */
+} proto_header_t;
+
+/* Requests and their response payloads */
+typedef enum {
+    PROTO_OP_PING,            /* -> empty */
+    PROTO_OP_CREATE_NODE,     /* proto_create_node_t + name -> uint64_t id */
+    PROTO_OP_CREATE_LINK,     /* proto_create_link_t + uint64_t ids[arity] -> uint64_t id */
+    PROTO_OP_GET,             /* uint64_t id -> proto_atom_t + uint64_t outgoing[arity] + name */
+    PROTO_OP_SET_TV,          /* proto_set_tv_t -> empty */
+    PROTO_OP_REMOVE,          /* uint64_t id -> empty */
+    PROTO_OP_QUERY_TYPE,      /* uint8_t type -> uint64_t ids[], possibly in several frames */
+    PROTO_OP_QUERY_NAME,      /* name -> uint64_t ids[], possibly in several frames */
+    PROTO_OP_MATCH,           /* proto_create_link_t + uint64_t ids[arity] (0 = any) -> uint64_t ids[], ditto */
+    PROTO_OP_SUBSCRIBE,       /* proto_subscribe_t + name -> empty, then PROTO_OP_EVENT frames */
+    PROTO_OP_UNSUBSCRIBE,     /* -> empty; ends the subscription on this stream */
+    PROTO_OP_EVENT,           /* Server push: change_event_t events[] (changefeed.h) */
+    PROTO_OP_COUNT
+} proto_op_t;
+
+typedef enum {
+    PROTO_OK,
+    PROTO_ERR_MALFORMED,      /* Payload does not fit the op */
+    PROTO_ERR_UNKNOWN_OP,
+    PROTO_ERR_NOT_FOUND,      /* No live atom with that ID */
+    PROTO_ERR_REFUSED,        /* Valid request the space declined, e.g. removing a link target */
+    PROTO_ERR_TOO_LARGE       /* Header announced more than PROTO_MAX_PAYLOAD; connection closes */
+} proto_status_t;
+
+typedef struct {
+    uint8_t type;             /* atom_type_t */
+    uint8_t reserved;
+    uint16_t name_length;     /* Name bytes that follow, no terminator */
+} proto_create_node_t;
+
+typedef struct {
+    uint8_t type;             /* atom_type_t */
+    uint8_t reserved[3];
+    uint32_t arity;           /* Atom IDs that follow */
+} proto_create_link_t;
+
+typedef struct {
+    uint64_t id;
+    double strength;
+    double confidence;
+} proto_set_tv_t;
+
+typedef struct {
+    uint64_t id;
+    truth_value_t tv;
+    attention_value_t av;
+    uint8_t type;             /* atom_type_t */
+    uint8_t reserved;
+    uint32_t arity;
+    uint32_t name_length;
+} proto_atom_t;
+
+/* Same meaning as change_filter_t; a zero name_length matches any name */
+typedef struct {
+    uint32_t kinds;
+    uint32_t name_length;
+    uint64_t types;
+} proto_subscribe_t;
+
+const char* proto_op_name(uint8_t op);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_PROTOCOL_H */
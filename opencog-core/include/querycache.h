@@ -0,0 +1,83 @@
+#ifndef OPENCOG_QUERYCACHE_H
+#define OPENCOG_QUERYCACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "atom.h"
+#include "memstats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Query result cache.
+ *
+ * Repeated type, name and pattern queries at the latest state are answered
+ * from a bounded per-space cache keyed by the query. Each entry records the
+ * generation it was computed at:
+ *
+ * - type queries: the sum of the per-type counters of the queried types,
+ *   bumped when an atom of that type is added or removed;
+ * - name queries: a per-name counter (names hashed over
+ *   QUERY_NAME_GENERATIONS counters), bumped likewise;
+ * - pattern queries: a space-wide counter bumped by every add and removal,
+ *   plus the time log position (timeindex.h), which every TV/AV write moves.
+ *
+ * A hit is an entry whose generation is still current. Results are shared
+ * and immutable and hold no references: like the borrowed queries, call
+ * these between atomspace_read_begin() and _end(), use the result only
+ * until then and retain the atoms kept. A pattern is keyed by its matcher
+ * and user_data pointer, so the matcher must depend on nothing but the
+ * atoms and the data it points at, which must not change while cached.
+ */
+#define QUERY_NAME_GENERATIONS 1024
+#define QUERY_CACHE_DEFAULT_ENTRIES 1024
+#define QUERY_CACHE_DEFAULT_BYTES ((size_t)64 << 20)
+
+typedef struct {
+    size_t count;
+    atom_handle_t* const* atoms;  /* Same order as the uncached query */
+} query_result_t;
+
+const query_result_t* atomspace_cached_by_type(atomspace_t* space, atom_type_t type);
+const query_result_t* atomspace_cached_by_types(atomspace_t* space, atom_type_set_t types);
+const query_result_t* atomspace_cached_by_name(atomspace_t* space, const char* name);
+const query_result_t* atomspace_cached_match(atomspace_t* space, pattern_matcher_fn matcher, void* user_data);
+
+/*
+ * Bound the cache to `max_entries` results and `max_bytes` of result
+ * arrays, dropping what it holds; 0 entries disables it, so queries are
+ * computed every time. Returns -1 on invalid arguments.
+ */
+int atomspace_query_cache_configure(atomspace_t* space, size_t max_entries, size_t max_bytes);
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;              /* Including invalidations */
+    uint64_t invalidations;       /* Misses on an entry outdated by a mutation */
+    uint64_t evictions;
+    size_t entries;
+    size_t bytes;                 /* Result arrays held */
+    double hit_ratio;             /* hits / (hits + misses), 0 before any query */
+} query_cache_stats_t;
+
+void atomspace_query_cache_stats(atomspace_t* space, query_cache_stats_t* stats);
+
+/*
+ * AtomSpace hooks. Invalidate bumps the generations of a published batch
+ * or a removed atom once it is visible to queries.
+ */
+typedef struct query_cache query_cache_t;
+
+query_cache_t* query_cache_create(void);
+void query_cache_destroy(query_cache_t* cache);
+void query_cache_invalidate(query_cache_t* cache, atom_handle_t* const* handles, size_t count);
+void query_cache_memory(query_cache_t* cache, memory_usage_t* usage);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_QUERYCACHE_H */
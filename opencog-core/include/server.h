@@ -0,0 +1,60 @@
+#ifndef OPENCOG_SERVER_H
+#define OPENCOG_SERVER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "atom.h"
+#include "protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * AtomSpace server: hosts one space on a Unix domain socket (protocol.h).
+ *
+ * Each event loop thread owns an epoll set and the connections it
+ * accepted; all loops share the listening socket, and the kernel wakes
+ * one of them per incoming connection. A loop reads every request that
+ * has arrived on a connection, answers them in one pass inside a single
+ * read section, and writes the replies with one send. Subscriptions are
+ * served from the change feed (changefeed.h), which the first subscriber
+ * turns on and the last one turns off.
+ */
+
+typedef struct {
+    const char* path;         /* Socket path; NULL for PROTO_DEFAULT_PATH */
+    int threads;              /* Event loops; 0 for one */
+    size_t feed_capacity;     /* Change feed size if the server starts it; 0 for default */
+    uint32_t reply_limit;     /* Largest ID list frame in bytes; 0 for PROTO_MAX_PAYLOAD */
+} server_config_t;
+
+typedef struct {
+    uint64_t connections;     /* Accepted so far */
+    uint64_t requests;
+    uint64_t events;          /* Change events pushed to subscribers */
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+} server_stats_t;
+
+typedef struct server server_t;
+
+/* Binds the socket, replacing a stale one; NULL on failure */
+server_t* server_create(atomspace_t* space, const server_config_t* config);
+
+/* Serve until server_stop(); the calling thread runs the first loop */
+int server_run(server_t* server);
+
+/* Safe from signal handlers and other threads */
+void server_stop(server_t* server);
+
+void server_stats(server_t* server, server_stats_t* stats);
+
+/* Closes all connections and removes the socket; call after server_run returns */
+void server_destroy(server_t* server);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_SERVER_H */
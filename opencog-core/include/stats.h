@@ -0,0 +1,86 @@
+#ifndef OPENCOG_STATS_H
+#define OPENCOG_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "atom.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Hot-path instrumentation: per-operation counters and latency histograms.
+ *
+ * Recording is compiled in only when OPENCOG_STATS is defined (make stats).
+ * Each thread records into its own counters and log-linear histogram, so the
+ * hot path never touches shared cache lines; atomspace_stats() merges all
+ * threads on demand. Operation statistics are process-wide.
+ */
+
+/* Instrumented operations */
+typedef enum {
+    STATS_OP_CREATE,        /* atom_create, atom_create_link */
+    STATS_OP_CREATE_BATCH,  /* atom_create_batch, atom_create_link_batch; one sample per batch */
+    STATS_OP_LOOKUP,        /* atomspace_get_atom */
+    STATS_OP_QUERY,         /* atomspace_get_atoms_by_type/_by_name */
+    STATS_OP_MATCH,         /* atomspace_match_pattern */
+    STATS_OP_TV_UPDATE,     /* atom_set_tv */
+    STATS_OP_AV_UPDATE,     /* atom_set_av */
+    STATS_OP_SEND,          /* distributed_send_message */
+    STATS_OP_RECEIVE,       /* distributed_receive_message, successful only */
+    STATS_OP_COMMIT,        /* atomspace_txn_commit */
+    STATS_OP_COUNT
+} stats_op_t;
+
+/* Histogram layout: 8 linear sub-buckets per power of two (~12.5% precision) */
+#define STATS_SUB_BUCKET_BITS 3
+#define STATS_SUB_BUCKETS (1 << STATS_SUB_BUCKET_BITS)
+#define STATS_BUCKETS ((64 - STATS_SUB_BUCKET_BITS + 1) * STATS_SUB_BUCKETS)
+
+/* Aggregated view of one operation */
+typedef struct {
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+} stats_op_summary_t;
+
+/* AtomSpace statistics snapshot */
+typedef struct {
+    bool enabled;                          /* Built with OPENCOG_STATS */
+    uint64_t atom_count;                   /* Live atoms: created minus deleted */
+    uint64_t total_atoms_created;
+    uint64_t total_atoms_deleted;
+    uint32_t threads;                      /* Per-thread records (reused after thread exit) */
+    stats_op_summary_t ops[STATS_OP_COUNT];
+} atomspace_stats_t;
+
+/* Snapshot space counters and merge per-thread operation statistics */
+int atomspace_stats(atomspace_t* space, atomspace_stats_t* stats);
+void atomspace_stats_reset(void);
+void atomspace_stats_print(const atomspace_stats_t* stats, FILE* out);
+const char* stats_op_name(stats_op_t op);
+
+/* Recording primitives used by the instrumentation macros */
+uint64_t stats_now_ns(void);
+void stats_record(stats_op_t op, uint64_t elapsed_ns);
+
+#ifdef OPENCOG_STATS
+#define STATS_BEGIN(start) uint64_t start = stats_now_ns()
+#define STATS_END(op, start) stats_record((op), stats_now_ns() - (start))
+#else
+#define STATS_BEGIN(start) do { } while (0)
+#define STATS_END(op, start) do { } while (0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_STATS_H */
@@ -0,0 +1,77 @@
+#ifndef OPENCOG_TIMEINDEX_H
+#define OPENCOG_TIMEINDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "atom.h"
+#include "memstats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Time index.
+ *
+ * Each space keeps an append-only log of changes. An entry is added when an
+ * atom is published, stamped with its creation_time, and on every TV/AV
+ * write, stamped with the new last_access_time. The log is cut into
+ * segments of TIME_SEGMENT_ENTRIES that record the range of times they
+ * hold, so a range query skips every segment outside the range instead of
+ * visiting every atom. Appending reserves a position with one atomic add;
+ * reads append nothing, so last_access_time updates made by reads are not
+ * indexed.
+ *
+ * Queries return borrowed handles like the name searches: call them between
+ * atomspace_read_begin() and _end() and retain the atoms kept. Times are
+ * seconds as from time(NULL) and ranges are [from, to). Results come in log
+ * order, at most `max` of them; the count written is returned.
+ */
+#define TIME_SEGMENT_ENTRIES 4096
+
+/* Atoms still in the space that were created in [from, to) */
+size_t atomspace_created_between(atomspace_t* space, uint64_t from, uint64_t to,
+                                 atom_handle_t** out, size_t max);
+
+/*
+ * Atoms whose latest creation or value write falls in [from, to), each
+ * once. A sliding window is `now - width` to UINT64_MAX.
+ */
+size_t atomspace_changed_between(atomspace_t* space, uint64_t from, uint64_t to,
+                                 atom_handle_t** out, size_t max);
+
+/*
+ * Atoms whose latest change was logged at or after position `*cursor`, each
+ * once, for replication deltas and incremental consumers. *cursor moves past
+ * the entries read, so repeated calls see each change once; an atom changed
+ * again later shows up again. Start from 0 or atomspace_time_position().
+ */
+size_t atomspace_changes_since(atomspace_t* space, uint64_t* cursor, atom_handle_t** out, size_t max);
+uint64_t atomspace_time_position(atomspace_t* space);
+
+/*
+ * Forgetting: drop the leading segments whose entries are all older than
+ * `before`. Queries then no longer see changes made only in them. Returns
+ * the number of entries dropped.
+ */
+size_t atomspace_time_trim(atomspace_t* space, uint64_t before);
+
+/*
+ * AtomSpace hooks. Insert logs a published batch at `version`; append logs
+ * a value write. Published atoms point at their space's index so value
+ * writes, which are not given the space, can find it.
+ */
+typedef struct time_index time_index_t;
+
+time_index_t* time_index_create(void);
+void time_index_destroy(time_index_t* index);
+void time_index_insert(time_index_t* index, atom_handle_t* const* handles, size_t count, uint64_t version);
+void time_index_append(time_index_t* index, const atom_t* atom, uint64_t time, uint64_t version);
+void time_index_memory(time_index_t* index, memory_usage_t* usage);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_TIMEINDEX_H */
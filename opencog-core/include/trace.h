@@ -0,0 +1,108 @@
+#ifndef OPENCOG_TRACE_H
+#define OPENCOG_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Low-overhead event tracing.
+ *
+ * Every tracepoint is both a static USDT probe (provider "opencog", usable
+ * from bpftrace/perf/SystemTap when <sys/sdt.h> is available) and an entry in
+ * an optional in-process binary trace ring. Each thread writes to its own ring
+ * without locks; trace_dump() writes all rings to a file that
+ * trace_convert_chrome() (tools/trace2json) turns into Chrome trace / Perfetto
+ * JSON. When the ring is off a tracepoint costs one predictable branch.
+ */
+
+/* Tracepoints */
+typedef enum {
+    TRACE_ATOM_CREATE,        /* arg0 = atom id, arg1 = atom type */
+    TRACE_QUERY,              /* begin: arg0 = query kind; end: arg1 = result count */
+    TRACE_MSG_SEND,           /* arg0 = message type, arg1 = destination node */
+    TRACE_MSG_RECEIVE,        /* arg0 = message type, arg1 = source node */
+    TRACE_HEARTBEAT,          /* arg0 = source node, arg1 = timestamp (ms) */
+    TRACE_CONSENSUS,          /* arg0 = proposal id, arg1 = consensus phase */
+    TRACE_TXN_COMMIT,         /* arg0 = commit version, arg1 = staged changes */
+    TRACE_EVENT_COUNT
+} trace_event_t;
+
+/* Query kinds reported by TRACE_QUERY */
+typedef enum {
+    TRACE_QUERY_BY_TYPE,
+    TRACE_QUERY_BY_NAME,
+    TRACE_QUERY_MATCH
+} trace_query_kind_t;
+
+/* Event phases, matching Chrome trace "ph" values */
+#define TRACE_PHASE_BEGIN   'B'
+#define TRACE_PHASE_END     'E'
+#define TRACE_PHASE_INSTANT 'i'
+
+/* On-disk record; the file is a trace_file_header_t followed by records */
+typedef struct {
+    uint64_t timestamp_ns;
+    uint64_t arg0;
+    uint64_t arg1;
+    uint32_t tid;
+    uint16_t event;
+    uint8_t phase;
+    uint8_t reserved;
+} trace_record_t;
+
+#define TRACE_FILE_MAGIC "OCTRACE1"
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t record_count;
+    uint32_t pid;
+    uint32_t reserved;
+} trace_file_header_t;
+
+/* Ring control */
+extern volatile bool trace_active;
+int trace_start(size_t events_per_thread);
+void trace_stop(void);
+int trace_dump(const char* path);
+uint64_t trace_dropped(void);
+const char* trace_event_name(trace_event_t event);
+
+/* Convert a binary trace file to Chrome trace JSON; returns records written or -1 */
+long trace_convert_chrome(const char* path, FILE* out);
+
+/* Ring write path, called only while trace_active */
+void trace_record(trace_event_t event, char phase, uint64_t arg0, uint64_t arg1);
+
+/* Static USDT probes */
+#if !defined(OPENCOG_NO_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define TRACE_USDT(name, arg0, arg1) DTRACE_PROBE2(opencog, name, arg0, arg1)
+#endif
+#endif
+#ifndef TRACE_USDT
+#define TRACE_USDT(name, arg0, arg1) do { } while (0)
+#endif
+
+/* Tracepoint: `probe` is the USDT probe name, e.g. opencog:query_begin */
+#define TRACE_POINT(probe, event, phase, arg0, arg1) \
+    do { \
+        TRACE_USDT(probe, arg0, arg1); \
+        if (__builtin_expect(trace_active, 0)) { \
+            trace_record((event), (phase), (uint64_t)(arg0), (uint64_t)(arg1)); \
+        } \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_TRACE_H */
@@ -0,0 +1,111 @@
+#ifndef OPENCOG_VECTOR_H
+#define OPENCOG_VECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "atom.h"
+#include "memstats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Vector values and nearest-neighbour search.
+ *
+ * An atom can carry one dense float vector, e.g. an embedding. Vectors of
+ * the same dimension form a class: their values are stored row by row in
+ * one aligned array, padded to a multiple of 8 floats so the distance
+ * kernels (AVX2/FMA when compiled for it, scalar otherwise) never handle a
+ * tail. Each class keeps an HNSW graph over its rows. Attaching a vector
+ * inserts it into the graph right away, so search needs no rebuild step.
+ *
+ * Vectors are not versioned: snapshots see the current vectors. Replacing
+ * a vector with one of the same dimension overwrites its row and relinks
+ * it. Clearing a vector, moving it to another dimension or removing its
+ * atom leaves a tombstone that searches walk through but never return;
+ * tombstones are not reused, so a class grows by one row per such change
+ * until the space is destroyed (MEMORY_VECTORS counts them). Writers to
+ * one atom's vector must not race each other; writers to different atoms
+ * may.
+ */
+
+typedef enum {
+    VECTOR_METRIC_L2,         /* Squared Euclidean distance */
+    VECTOR_METRIC_COSINE      /* 1 - cosine similarity */
+} vector_metric_t;
+
+#define VECTOR_MAX_DIM 4096
+#define VECTOR_MAX_CLASSES 16         /* Distinct dimensions per space */
+#define VECTOR_MAX_M 64
+
+/* Per-class index parameters */
+typedef struct {
+    vector_metric_t metric;
+    uint32_t m;                   /* Graph degree, 2 .. VECTOR_MAX_M; level 0 keeps 2 * m links */
+    uint32_t ef_construction;     /* Candidate list size while inserting */
+    uint32_t ef_search;           /* Default candidate list size while searching */
+    uint64_t seed;                /* Level generator seed */
+} vector_index_config_t;
+
+void vector_index_config_default(vector_index_config_t* config);
+
+/* Set the parameters of a dimension before its first vector; -1 once it has one */
+int atomspace_vector_configure(atomspace_t* space, uint32_t dim, const vector_index_config_t* config);
+
+/* Attach, replace or clear an atom's vector; 0 on success, -1 on invalid arguments */
+int atom_set_vector(atomspace_t* space, atom_handle_t* handle, const float* values, uint32_t dim);
+int atom_clear_vector(atomspace_t* space, atom_handle_t* handle);
+
+/* Copies up to `capacity` values to `out` and returns the dimension, 0 if none */
+uint32_t atom_get_vector(atomspace_t* space, atom_handle_t* handle, float* out, uint32_t capacity);
+
+/* Live vectors of one dimension */
+size_t atomspace_vector_count(atomspace_t* space, uint32_t dim);
+
+/*
+ * Similarity search. Results are ordered nearest first; the handles are
+ * borrowed, so search between atomspace_read_begin() and _end() or retain
+ * the ones kept. `ef` widens the candidate list (0 uses the class's
+ * ef_search); it is raised to `k` if smaller. Each call returns the number
+ * of matches written, at most `k`.
+ */
+typedef struct {
+    atom_handle_t* atom;
+    float distance;
+} vector_match_t;
+
+size_t atomspace_vector_search(atomspace_t* space, const float* query, uint32_t dim,
+                               size_t k, size_t ef, vector_match_t* out);
+
+/* Atoms nearest to `handle`'s vector, excluding `handle` */
+size_t atomspace_vector_similar(atomspace_t* space, atom_handle_t* handle, size_t k, size_t ef,
+                                vector_match_t* out);
+
+/*
+ * `query_count` queries stored back to back, answered under one lock
+ * acquisition. Query i writes its matches to out[i * k] and their number to
+ * counts[i]; the total is returned.
+ */
+size_t atomspace_vector_search_batch(atomspace_t* space, const float* queries, size_t query_count,
+                                     uint32_t dim, size_t k, size_t ef, vector_match_t* out,
+                                     size_t* counts);
+
+/* Exact answer by scanning every row, for small classes and recall checks */
+size_t atomspace_vector_search_exact(atomspace_t* space, const float* query, uint32_t dim,
+                                     size_t k, vector_match_t* out);
+
+/* AtomSpace hooks; detach runs when a removed atom is reclaimed */
+typedef struct vector_index vector_index_t;
+
+vector_index_t* vector_index_create(void);
+void vector_index_destroy(vector_index_t* index);
+void vector_index_detach(vector_index_t* index, atom_handle_t* handle);
+void vector_index_memory(vector_index_t* index, memory_usage_t* usage);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_VECTOR_H */
@@ -0,0 +1,212 @@
+#ifndef OPENCOG_WHERE_HPP
+#define OPENCOG_WHERE_HPP
+
+/*
+ * OpenCog Query Filters
+ * Composable, compile-time fused predicates for AtomSpace scans
+ *
+ * Filters are small value types combined with &&, || and !. Passed to
+ * AtomSpace::match() or Snapshot::match() they become part of the scan
+ * loop's type, so each query instantiates one specialized loop: the
+ * compiler inlines every test, constant-folds types given as template
+ * arguments, and And<> evaluates the cheaper side first. TV/AV filters read
+ * the values current at the scan's version, so they are correct in
+ * snapshots too.
+ *
+ *     using namespace opencog;
+ *     size_t n = space.count_if(read, where::type<ATOM_TYPE_LINK>() &&
+ *                                     where::arity(2) &&
+ *                                     where::tv_at_least(0.9));
+ */
+
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include "atomspace.hpp"
+
+namespace opencog {
+namespace where {
+
+/* Relative cost of a filter; And<> runs lower costs first */
+enum Cost {
+    COST_FIELD = 0,     /* One field of the atom */
+    COST_VALUES = 1,    /* Consistent TV/AV read */
+    COST_NAME = 2,      /* String comparison */
+    COST_CALL = 3       /* Arbitrary user predicate */
+};
+
+struct FilterBase {};
+
+template <typename T>
+inline constexpr bool is_filter_v = std::is_base_of_v<FilterBase, T>;
+
+/* Type known at compile time */
+template <atom_type_t Type>
+struct TypeIs : FilterBase {
+    static constexpr int cost = COST_FIELD;
+    bool operator()(atom_handle_t* handle, uint64_t) const noexcept { return handle->atom->type == Type; }
+};
+
+struct TypeOf : FilterBase {
+    static constexpr int cost = COST_FIELD;
+    explicit TypeOf(atom_type_t type) noexcept : type(type) {}
+    bool operator()(atom_handle_t* handle, uint64_t) const noexcept { return handle->atom->type == type; }
+    atom_type_t type;
+};
+
+/* Any of a set of types, one bit per atom_type_t */
+struct TypeIn : FilterBase {
+    static constexpr int cost = COST_FIELD;
+    explicit TypeIn(atom_type_set_t mask) noexcept : mask(mask) {}
+    bool operator()(atom_handle_t* handle, uint64_t) const noexcept {
+        return (mask >> handle->atom->type) & 1;
+    }
+    atom_type_set_t mask;
+};
+
+struct ArityIs : FilterBase {
+    static constexpr int cost = COST_FIELD;
+    explicit ArityIs(size_t arity) noexcept : arity(arity) {}
+    bool operator()(atom_handle_t* handle, uint64_t) const noexcept {
+        return handle->atom->outgoing_count == arity;
+    }
+    size_t arity;
+};
+
+/* Checks the first byte inline before calling strcmp */
+struct NameIs : FilterBase {
+    static constexpr int cost = COST_NAME;
+    explicit NameIs(const char* name) noexcept : name(name) {}
+    bool operator()(atom_handle_t* handle, uint64_t) const noexcept {
+        const char* atom_name = handle->atom->name;
+        return atom_name && atom_name[0] == name[0] && std::strcmp(atom_name, name) == 0;
+    }
+    const char* name;
+};
+
+struct NamePrefix : FilterBase {
+    static constexpr int cost = COST_NAME;
+    explicit NamePrefix(const char* prefix) noexcept : prefix(prefix), length(std::strlen(prefix)) {}
+    bool operator()(atom_handle_t* handle, uint64_t) const noexcept {
+        const char* atom_name = handle->atom->name;
+        return atom_name && std::strncmp(atom_name, prefix, length) == 0;
+    }
+    const char* prefix;
+    size_t length;
+};
+
+struct TvAtLeast : FilterBase {
+    static constexpr int cost = COST_VALUES;
+    TvAtLeast(double strength, double confidence) noexcept : strength(strength), confidence(confidence) {}
+    bool operator()(atom_handle_t* handle, uint64_t version) const noexcept {
+        truth_value_t tv;
+        attention_value_t av;
+        atom_read_values_at(handle->atom, version, &tv, &av);
+        return tv.strength >= strength && tv.confidence >= confidence;
+    }
+    double strength;
+    double confidence;
+};
+
+struct StiAtLeast : FilterBase {
+    static constexpr int cost = COST_VALUES;
+    explicit StiAtLeast(int16_t sti) noexcept : sti(sti) {}
+    bool operator()(atom_handle_t* handle, uint64_t version) const noexcept {
+        truth_value_t tv;
+        attention_value_t av;
+        atom_read_values_at(handle->atom, version, &tv, &av);
+        return av.sti >= sti;
+    }
+    int16_t sti;
+};
+
+/* Any callable taking an Atom; values it reads are not versioned */
+template <typename F>
+struct AtomIf : FilterBase {
+    static constexpr int cost = COST_CALL;
+    explicit AtomIf(F f) : f(std::move(f)) {}
+    bool operator()(atom_handle_t* handle, uint64_t) const { return f(Atom(handle)); }
+    F f;
+};
+
+/* Combinators */
+
+template <typename A, typename B>
+struct And : FilterBase {
+    static constexpr int cost = A::cost > B::cost ? A::cost : B::cost;
+    And(A a, B b) : a(std::move(a)), b(std::move(b)) {}
+    bool operator()(atom_handle_t* handle, uint64_t version) const {
+        if constexpr (B::cost < A::cost) {
+            return b(handle, version) && a(handle, version);
+        } else {
+            return a(handle, version) && b(handle, version);
+        }
+    }
+    A a;
+    B b;
+};
+
+template <typename A, typename B>
+struct Or : FilterBase {
+    static constexpr int cost = A::cost > B::cost ? A::cost : B::cost;
+    Or(A a, B b) : a(std::move(a)), b(std::move(b)) {}
+    bool operator()(atom_handle_t* handle, uint64_t version) const {
+        if constexpr (B::cost < A::cost) {
+            return b(handle, version) || a(handle, version);
+        } else {
+            return a(handle, version) || b(handle, version);
+        }
+    }
+    A a;
+    B b;
+};
+
+template <typename A>
+struct Not : FilterBase {
+    static constexpr int cost = A::cost;
+    explicit Not(A a) : a(std::move(a)) {}
+    bool operator()(atom_handle_t* handle, uint64_t version) const { return !a(handle, version); }
+    A a;
+};
+
+template <typename A, typename B, typename = std::enable_if_t<is_filter_v<A> && is_filter_v<B>>>
+And<A, B> operator&&(A a, B b) {
+    return And<A, B>(std::move(a), std::move(b));
+}
+
+template <typename A, typename B, typename = std::enable_if_t<is_filter_v<A> && is_filter_v<B>>>
+Or<A, B> operator||(A a, B b) {
+    return Or<A, B>(std::move(a), std::move(b));
+}
+
+template <typename A, typename = std::enable_if_t<is_filter_v<A>>>
+Not<A> operator!(A a) {
+    return Not<A>(std::move(a));
+}
+
+/* Factories */
+
+template <atom_type_t Type>
+constexpr TypeIs<Type> type() noexcept { return TypeIs<Type>(); }
+inline TypeOf type(atom_type_t type) noexcept { return TypeOf(type); }
+inline TypeIn types(std::initializer_list<atom_type_t> types) noexcept {
+    atom_type_set_t mask = 0;
+    for (atom_type_t t : types) mask |= ATOM_TYPE_BIT(t);
+    return TypeIn(mask);
+}
+/* `base` or any of its subtypes, resolved when the filter is built */
+inline TypeIn is_a(atom_type_t base) noexcept { return TypeIn(atom_type_subtypes(base)); }
+inline ArityIs arity(size_t arity) noexcept { return ArityIs(arity); }
+inline NameIs name(const char* name) noexcept { return NameIs(name); }
+inline NamePrefix name_prefix(const char* prefix) noexcept { return NamePrefix(prefix); }
+inline TvAtLeast tv_at_least(double strength, double confidence = 0.0) noexcept {
+    return TvAtLeast(strength, confidence);
+}
+inline StiAtLeast sti_at_least(int16_t sti) noexcept { return StiAtLeast(sti); }
+template <typename F>
+AtomIf<F> atom_if(F f) { return AtomIf<F>(std::move(f)); }
+
+} // namespace where
+} // namespace opencog
+
+#endif /* OPENCOG_WHERE_HPP */
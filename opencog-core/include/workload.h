@@ -0,0 +1,79 @@
+#ifndef OPENCOG_WORKLOAD_H
+#define OPENCOG_WORKLOAD_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "atom.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Synthetic scale-free knowledge-graph generator for benchmarks and load tests */
+
+#define WORKLOAD_MAX_ARITY 8
+#define WORKLOAD_TYPE_COUNT ATOM_TYPE_COUNT
+
+/*
+ * Generator parameters. The same configuration always produces the same
+ * sequence of atoms, whether built in memory or emitted as text.
+ *
+ * Link targets are drawn by popularity rank: the r-th oldest atom is chosen
+ * with probability proportional to r^(-1/(degree_exponent - 1)), which gives
+ * an incoming-degree distribution P(k) ~ k^(-degree_exponent).
+ */
+typedef struct {
+    uint64_t seed;
+    uint64_t atom_count;               /* Total atoms, nodes and links */
+    double link_fraction;              /* Share of atoms that are links [0.0, 1.0) */
+    double degree_exponent;            /* Power-law exponent of incoming degree (> 1.0) */
+    double arity_weights[WORKLOAD_MAX_ARITY + 1];  /* Relative weight per link arity */
+    double nesting_probability;        /* Chance a link target is itself a link */
+    uint64_t name_vocabulary;          /* Distinct node names */
+    double name_exponent;              /* Zipf exponent of name popularity */
+    double type_weights[WORKLOAD_TYPE_COUNT];      /* Relative weight per atom type */
+    const char* name_prefix;
+} workload_config_t;
+
+/* Summary of a generated workload */
+typedef struct {
+    uint64_t nodes;
+    uint64_t links;
+    uint64_t edges;                    /* Sum of link arities */
+    uint64_t nested_edges;             /* Edges whose target is a link */
+    uint64_t type_counts[WORKLOAD_TYPE_COUNT];
+} workload_stats_t;
+
+/* Fill in defaults: 1M atoms, 60% links, exponent 2.1, arity 2-4 */
+void workload_config_default(workload_config_t* config);
+
+/* Parse an arity distribution such as "2:0.6,3:0.3,4:0.1"; returns -1 on error */
+int workload_parse_arity(workload_config_t* config, const char* spec);
+
+/* Parse a type mix such as "concept:0.5,predicate:0.2,link:0.3"; returns -1 on error */
+int workload_parse_types(workload_config_t* config, const char* spec);
+
+/* True for atom types the generator creates as links */
+bool workload_is_link_type(atom_type_t type);
+
+/* Build the workload directly into an AtomSpace */
+int workload_generate(atomspace_t* space, const workload_config_t* config, workload_stats_t* stats);
+
+/*
+ * Emit the workload as text using constant memory, one statement per atom:
+ *
+ *   concept n0 "entity_3" [truth: 0.81, 0.42];
+ *   eval l0 (n0, n5) [truth: 0.50, 0.90];
+ *
+ * Nodes are labelled n<k> and links l<k> in creation order; links only
+ * reference labels defined earlier in the stream. This is the generator's
+ * own format, not the cognitive grammar (parsers/), which has no truth
+ * values or links of arbitrary type and arity.
+ */
+int workload_emit_text(FILE* out, const workload_config_t* config, workload_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPENCOG_WORKLOAD_H */
@@ -3,16 +3,48 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "atom.h"
 
 extern int yylex();
 void yyerror(const char* s);
 extern int yylineno;
 
+/* Global atomspace for parser - set by parser_init() */
+static atomspace_t* parser_atomspace = NULL;
+
+/* Names refer to the first existing atom of that type; only missing ones are created */
+static atom_handle_t* resolve(atom_type_t type, char* name) {
+    atom_handle_t* found = NULL;
+    size_t count = 0;
+    atomspace_read_begin(parser_atomspace);
+    atom_handle_t** atoms = atomspace_get_atoms_by_name_borrowed(parser_atomspace, name, &count);
+    for (size_t i = 0; i < count && !found; i++) {
+        if (atoms[i]->atom->type == type) found = atoms[i];
+    }
+    free(atoms);
+    atomspace_read_end(parser_atomspace);
+    if (!found) found = atom_create(parser_atomspace, type, name);
+    free(name);
+    return found;
+}
+
+static atom_handle_t* connective(atom_type_t type, atom_handle_t* a, atom_handle_t* b) {
+    atom_handle_t* outgoing[2] = { a, b };
+    if (!a || (b == NULL && type != ATOM_TYPE_NOT)) return NULL;
+    return atom_create_link(parser_atomspace, type, outgoing, b ? 2 : 1);
+}
+
 %}
 
+/* Also emitted into cognitive_grammar.tab.h, which the lexer includes */
+%code requires {
+#include "atom.h"
+}
+
 %union {
     char* string;
     double number;
+    atom_handle_t* atom;
 }
 
 %token CONCEPT PREDICATE LINK NODE EVAL EXEC VARIABLE
@@ -26,6 +58,14 @@ extern int yylineno;
 %token <string> IDENTIFIER STRING
 %token <number> NUMBER
 
+%type <atom> expression
+
+/* Operator precedence (lowest to highest) */
+%right IMPLIES EQUIVALENT
+%left OR
+%left AND
+%right NOT
+
 %start program
 
 %%
@@ -36,21 +76,29 @@ program:
     ;
 
 statement:
-    CONCEPT IDENTIFIER          { free($2); }
-    | PREDICATE IDENTIFIER      { free($2); }
-    | NODE IDENTIFIER           { free($2); }
-    | VARIABLE IDENTIFIER       { free($2); }
+    CONCEPT IDENTIFIER          { resolve(ATOM_TYPE_CONCEPT, $2); }
+    | PREDICATE IDENTIFIER      { resolve(ATOM_TYPE_PREDICATE, $2); }
+    | NODE IDENTIFIER           { resolve(ATOM_TYPE_NODE, $2); }
+    | VARIABLE IDENTIFIER       { resolve(ATOM_TYPE_VARIABLE, $2); }
     | CONSTRUCTION IDENTIFIER LBRACE RBRACE { free($2); }
-    | RULE IDENTIFIER COLON expression
+    | RULE IDENTIFIER COLON expression {
+        /* A rule evaluates its body under a predicate named after the rule */
+        atom_handle_t* outgoing[2] = { resolve(ATOM_TYPE_PREDICATE, $2), $4 };
+        if (outgoing[0] && outgoing[1]) {
+            atom_create_link(parser_atomspace, ATOM_TYPE_EVALUATION, outgoing, 2);
+        }
+    }
     ;
 
+/* Each logical connective builds its own link type */
 expression:
-    IDENTIFIER                  { free($1); }
-    | expression AND expression
-    | expression OR expression
-    | NOT expression
-    | expression IMPLIES expression
-    | LPAREN expression RPAREN
+    IDENTIFIER                  { $$ = resolve(ATOM_TYPE_CONCEPT, $1); }
+    | expression AND expression { $$ = connective(ATOM_TYPE_AND, $1, $3); }
+    | expression OR expression  { $$ = connective(ATOM_TYPE_OR, $1, $3); }
+    | NOT expression            { $$ = connective(ATOM_TYPE_NOT, $2, NULL); }
+    | expression IMPLIES expression { $$ = connective(ATOM_TYPE_IMPLICATION, $1, $3); }
+    | expression EQUIVALENT expression { $$ = connective(ATOM_TYPE_EQUIVALENCE, $1, $3); }
+    | LPAREN expression RPAREN  { $$ = $2; }
     ;
 
 %%
@@ -59,14 +107,22 @@ void yyerror(const char* s) {
     fprintf(stderr, "Parse error at line %d: %s\n", yylineno, s);
 }
 
+/* Lexer buffer interface */
+typedef struct yy_buffer_state* YY_BUFFER_STATE;
+extern YY_BUFFER_STATE yy_scan_string(const char* str);
+extern void yy_delete_buffer(YY_BUFFER_STATE buffer);
+
 /* Parser initialization */
 void parser_init(void* space) {
-    (void)space;
+    parser_atomspace = (atomspace_t*)space;
 }
 
-/* Main parse function */
+/* Main parse function; returns 0 on success, non-zero on a syntax error */
 int parse_cognitive_grammar(const char* input, void* space) {
-    (void)input;
-    (void)space;
-    return 0;
+    if (!input || !space) return -1;
+    parser_init(space);
+    YY_BUFFER_STATE buffer = yy_scan_string(input);
+    int result = yyparse();
+    yy_delete_buffer(buffer);
+    return result;
 }
@@ -8,17 +8,43 @@
 #include <string.h>
 #include <time.h>
 #include <pthread.h>
+#include <malloc.h>
+#include <sched.h>
+#include <limits.h>
 #include "../include/atom.h"
+#include "../include/memstats.h"
+#include "../include/epoch.h"
+#include "../include/mvcc.h"
+#include "../include/changefeed.h"
+#include "../include/vector.h"
+#include "../include/nameindex.h"
+#include "../include/timeindex.h"
+#include "../include/querycache.h"
+#include "../include/stats.h"
+#include "../include/lockprof.h"
+#include "../include/trace.h"
 
-/* Thread-safe ID generator */
-static pthread_mutex_t id_mutex = PTHREAD_MUTEX_INITIALIZER;
-static uint64_t next_atom_id = 1;
+/* Lock-free ID generator: threads claim blocks of sequence numbers */
+static uint64_t next_id_block = 1;
+static __thread uint64_t id_block_next = 0;
+static __thread uint64_t id_block_end = 0;
 
-static uint64_t generate_atom_id(void) {
-    pthread_mutex_lock(&id_mutex);
-    uint64_t id = next_atom_id++;
-    pthread_mutex_unlock(&id_mutex);
-    return id;
+static uint64_t generate_atom_id(uint32_t node_id) {
+    if (id_block_next == id_block_end) {
+        id_block_next = __atomic_fetch_add(&next_id_block, ATOM_ID_BLOCK_SIZE, __ATOMIC_RELAXED);
+        id_block_end = id_block_next + ATOM_ID_BLOCK_SIZE;
+    }
+    return ATOM_ID_MAKE(node_id, id_block_next++);
+}
+
+/* `count` consecutive sequence numbers; returns the first */
+static uint64_t reserve_atom_ids(size_t count) {
+    if (id_block_end - id_block_next >= count) {
+        uint64_t first = id_block_next;
+        id_block_next += count;
+        return first;
+    }
+    return __atomic_fetch_add(&next_id_block, count, __ATOMIC_RELAXED);
 }
 
 /* Hash table for atom lookup - simplified implementation */
@@ -30,147 +56,658 @@ typedef struct hash_entry {
     struct hash_entry* next;
 } hash_entry_t;
 
+/* Entries are carved from slabs owned by the table and freed with it */
+#define HASH_SLAB_ENTRIES 4096
+
+typedef struct hash_slab {
+    struct hash_slab* next;
+    size_t used;
+    hash_entry_t entries[HASH_SLAB_ENTRIES];
+} hash_slab_t;
+
 typedef struct {
     hash_entry_t* buckets[HASH_TABLE_SIZE];
     pthread_rwlock_t lock;
+    hash_slab_t* slabs;
+    hash_entry_t* free_entries;   /* Entries of removed atoms, linked through next */
+    size_t live_entries;
 } hash_table_t;
 
+LOCKPROF_SITE(hash_read_site, "atomspace.hash_table.read");
+LOCKPROF_SITE(hash_write_site, "atomspace.hash_table.write");
+
 static hash_table_t* hash_table_create(void) {
     hash_table_t* table = calloc(1, sizeof(hash_table_t));
     pthread_rwlock_init(&table->lock, NULL);
     return table;
 }
 
-static void hash_table_insert(hash_table_t* table, uint64_t key, atom_handle_t* value) {
-    pthread_rwlock_wrlock(&table->lock);
+/* Caller holds the write lock */
+static hash_entry_t* hash_entry_alloc_locked(hash_table_t* table) {
+    hash_entry_t* entry = table->free_entries;
+    if (entry) {
+        table->free_entries = entry->next;
+        return entry;
+    }
+    if (!table->slabs || table->slabs->used == HASH_SLAB_ENTRIES) {
+        hash_slab_t* slab = malloc(sizeof(hash_slab_t));
+        slab->next = table->slabs;
+        slab->used = 0;
+        table->slabs = slab;
+    }
+    return &table->slabs->entries[table->slabs->used++];
+}
+
+/* Caller holds the write lock */
+static void hash_table_insert_locked(hash_table_t* table, uint64_t key, atom_handle_t* value) {
+    hash_entry_t* entry = hash_entry_alloc_locked(table);
     size_t bucket = key % HASH_TABLE_SIZE;
-    hash_entry_t* entry = malloc(sizeof(hash_entry_t));
     entry->key = key;
     entry->value = value;
     entry->next = table->buckets[bucket];
     table->buckets[bucket] = entry;
-    pthread_rwlock_unlock(&table->lock);
+    table->live_entries++;
+}
+
+/* Caller holds the write lock */
+static void hash_table_remove_locked(hash_table_t* table, uint64_t key) {
+    hash_entry_t** link = &table->buckets[key % HASH_TABLE_SIZE];
+    while (*link) {
+        hash_entry_t* entry = *link;
+        if (entry->key == key) {
+            *link = entry->next;
+            entry->next = table->free_entries;
+            table->free_entries = entry;
+            table->live_entries--;
+            return;
+        }
+        link = &entry->next;
+    }
 }
 
 static atom_handle_t* hash_table_lookup(hash_table_t* table, uint64_t key) {
-    pthread_rwlock_rdlock(&table->lock);
+    uint64_t held = lockprof_rdlock(&table->lock, &hash_read_site);
     size_t bucket = key % HASH_TABLE_SIZE;
     hash_entry_t* entry = table->buckets[bucket];
     while (entry) {
         if (entry->key == key) {
             atom_handle_t* result = entry->value;
-            pthread_rwlock_unlock(&table->lock);
+            lockprof_rwlock_unlock(&table->lock, &hash_read_site, held);
             return result;
         }
         entry = entry->next;
     }
-    pthread_rwlock_unlock(&table->lock);
+    lockprof_rwlock_unlock(&table->lock, &hash_read_site, held);
     return NULL;
 }
 
 static void hash_table_destroy(hash_table_t* table) {
-    for (size_t i = 0; i < HASH_TABLE_SIZE; i++) {
-        hash_entry_t* entry = table->buckets[i];
-        while (entry) {
-            hash_entry_t* next = entry->next;
-            free(entry);
-            entry = next;
-        }
+    hash_slab_t* slab = table->slabs;
+    while (slab) {
+        hash_slab_t* next = slab->next;
+        free(slab);
+        slab = next;
     }
     pthread_rwlock_destroy(&table->lock);
     free(table);
 }
 
+/* A handle and its atom share one allocation; the handle comes first */
+typedef struct {
+    atom_handle_t handle;
+    atom_t atom;
+} atom_block_t;
+
+/* One type's atoms; grows like the atom array and is published the same way */
+typedef struct {
+    atom_handle_t** atoms;        /* Replaced, not realloc'd, on growth */
+    size_t count;
+    size_t capacity;
+} type_bucket_t;
+
+#define TYPE_BUCKET_MIN 16
+
+/* Arrays replaced while publishing; retired once the write lock is released */
+typedef struct {
+    void* arrays[ATOM_TYPE_MAX + 1];
+    size_t count;
+} retired_arrays_t;
+
+static void retired_arrays_release(retired_arrays_t* retired) {
+    for (size_t i = 0; i < retired->count; i++) {
+        epoch_retire(retired->arrays[i], free);
+    }
+}
+
+/* First of `count` feed positions claimed at once, FEED_NONE while the feed is off */
+#define FEED_NONE UINT64_MAX
+
+static inline uint64_t feed_claim(size_t count) {
+    if (__builtin_expect(!changefeed_is_active(), 1) || count == 0) return FEED_NONE;
+    return changefeed_claim(count);
+}
+
+/*
+ * Batch-created atoms live in one chunk: header, blocks, outgoing arrays,
+ * then names. The chunk is freed when its last atom is.
+ */
+typedef struct {
+    uint64_t live;
+} atom_chunk_t;
+
+static void atom_free(atom_handle_t* handle) {
+    atom_t* atom = handle->atom;
+    atom_value_version_t* version = atom->history;
+    while (version) {
+        atom_value_version_t* prev = version->prev;
+        mvcc_version_free(version);
+        version = prev;
+    }
+    free(atom->incoming);
+    if (atom->chunk) {
+        atom_chunk_t* chunk = (atom_chunk_t*)atom->chunk;
+        if (__atomic_sub_fetch(&chunk->live, 1, __ATOMIC_ACQ_REL) == 0) free(chunk);
+        return;
+    }
+    free(atom->outgoing);
+    free(atom->name);
+    free(handle);
+}
+
+/* Undo the accounting of an atom's own allocations */
+static void atom_account_release(memory_accounting_t* acc, atom_t* atom) {
+    size_t name_bytes = atom->name ? strlen(atom->name) + 1 : 0;
+    size_t outgoing_bytes = sizeof(atom_handle_t*) * atom->outgoing_count;
+    if (atom->chunk) {
+        if (name_bytes) memory_account_free_sized(acc, MEMORY_NAMES, atom->type, 1, name_bytes, name_bytes);
+        if (outgoing_bytes) {
+            memory_account_free_sized(acc, MEMORY_OUTGOING, atom->type, 1, outgoing_bytes, outgoing_bytes);
+        }
+        return;
+    }
+    memory_account_free(acc, MEMORY_NAMES, atom->type, atom->name, name_bytes);
+    memory_account_free(acc, MEMORY_OUTGOING, atom->type, atom->outgoing, outgoing_bytes);
+}
+
+/*
+ * Pending releases. Outgoing sets are walked with an explicit stack so
+ * deep link chains cannot overflow the call stack.
+ */
+#define RELEASE_STACK_INLINE 64
+
+typedef struct {
+    atom_handle_t** items;
+    size_t count;
+    size_t capacity;
+    atom_handle_t* inline_items[RELEASE_STACK_INLINE];
+} release_stack_t;
+
+static void release_stack_push(release_stack_t* stack, atom_handle_t* handle) {
+    if (stack->count == stack->capacity) {
+        size_t capacity = stack->capacity * 2;
+        if (stack->items == stack->inline_items) {
+            stack->items = malloc(sizeof(atom_handle_t*) * capacity);
+            memcpy(stack->items, stack->inline_items, sizeof(atom_handle_t*) * stack->count);
+        } else {
+            stack->items = realloc(stack->items, sizeof(atom_handle_t*) * capacity);
+        }
+        stack->capacity = capacity;
+    }
+    stack->items[stack->count++] = handle;
+}
+
 /* AtomSpace implementation */
+static uint32_t next_space_id = 0;
+
 atomspace_t* atomspace_create(uint32_t node_id) {
+    if (node_id > ATOM_ID_MAX_NODE) return NULL;
+    
     atomspace_t* space = calloc(1, sizeof(atomspace_t));
     space->node_id = node_id;
+    space->space_id = __atomic_add_fetch(&next_space_id, 1, __ATOMIC_RELAXED);
     space->atom_capacity = 1024;
     space->atoms = calloc(space->atom_capacity, sizeof(atom_handle_t*));
     space->lookup_table = hash_table_create();
+    space->type_index = calloc(ATOM_TYPE_MAX, sizeof(type_bucket_t));
+    space->vector_index = vector_index_create();
+    space->name_index = name_index_create();
+    space->time_index = time_index_create();
+    space->query_cache = query_cache_create();
+    space->memory_accounting = memory_accounting_create();
     return space;
 }
 
 void atomspace_destroy(atomspace_t* space) {
     if (!space) return;
     
-    /* Release all atoms */
+    /* Finish deferred releases of removed atoms before the rest go */
+    epoch_synchronize();
+    
+    /*
+     * When the space and its links hold the only references, every atom can
+     * be freed directly; otherwise release them one by one so handles held
+     * elsewhere stay valid.
+     */
+    bool shared = false;
+    for (size_t i = 0; i < space->atom_count && !shared; i++) {
+        atom_handle_t* handle = space->atoms[i];
+        shared = handle && handle->ref_count != 1 + handle->atom->incoming_count;
+    }
+    
     for (size_t i = 0; i < space->atom_count; i++) {
         if (space->atoms[i]) {
-            atom_release(space->atoms[i]);
+            /* Handles held elsewhere must not log value writes to the freed index */
+            __atomic_store_n(&space->atoms[i]->atom->time_index, NULL, __ATOMIC_RELAXED);
+            if (shared) atom_release(space->atoms[i]);
+            else atom_free(space->atoms[i]);
+            space->total_atoms_deleted++;
         }
     }
     
     free(space->atoms);
+    type_bucket_t* buckets = (type_bucket_t*)space->type_index;
+    for (int t = 0; t < ATOM_TYPE_MAX; t++) {
+        free(buckets[t].atoms);
+    }
+    free(buckets);
+    vector_index_destroy((vector_index_t*)space->vector_index);
+    name_index_destroy((name_index_t*)space->name_index);
+    time_index_destroy((time_index_t*)space->time_index);
+    query_cache_destroy((query_cache_t*)space->query_cache);
     hash_table_destroy((hash_table_t*)space->lookup_table);
+    memory_accounting_destroy((memory_accounting_t*)space->memory_accounting);
     free(space);
 }
 
 /* Atom creation */
-atom_handle_t* atom_create(atomspace_t* space, atom_type_t type, const char* name) {
-    if (!space) return NULL;
+static void incoming_append(atomspace_t* space, atom_t* target, atom_handle_t* handle) {
+    size_t old_allocated = target->incoming ? malloc_usable_size(target->incoming) : 0;
+    target->incoming = realloc(target->incoming,
+                              sizeof(atom_handle_t*) * (target->incoming_count + 1));
+    target->incoming[target->incoming_count++] = handle;
+    memory_account_resize((memory_accounting_t*)space->memory_accounting, MEMORY_INCOMING,
+                          target->type, sizeof(atom_handle_t*) * (target->incoming_count - 1),
+                          old_allocated, target->incoming,
+                          sizeof(atom_handle_t*) * target->incoming_count);
+}
+
+/* Allocate an atom that is not yet in the space; targets are retained */
+static atom_handle_t* atom_build(atomspace_t* space, atom_type_t type, const char* name,
+                                 atom_handle_t** outgoing, size_t count) {
+    memory_accounting_t* acc = (memory_accounting_t*)space->memory_accounting;
     
-    /* Allocate atom */
-    atom_t* atom = calloc(1, sizeof(atom_t));
-    atom->id = generate_atom_id();
+    /* Allocate handle and atom together */
+    atom_block_t* block = calloc(1, sizeof(atom_block_t));
+    atom_t* atom = &block->atom;
+    atom->id = generate_atom_id(space->node_id);
     atom->type = type;
     atom->name = name ? strdup(name) : NULL;
+    if (atom->name) {
+        memory_account_alloc(acc, MEMORY_NAMES, type, atom->name, strlen(atom->name) + 1);
+    }
     atom->tv.strength = 1.0;
     atom->tv.confidence = 0.0;
     atom->av.sti = 0;
     atom->av.lti = 0;
     atom->av.vlti = 0;
+    atom->create_version = MVCC_LIVE;
+    atom->delete_version = MVCC_LIVE;
     atom->creation_time = time(NULL);
     atom->last_access_time = atom->creation_time;
     
-    /* Create handle */
-    atom_handle_t* handle = malloc(sizeof(atom_handle_t));
+    /* Set outgoing set */
+    if (count > 0) {
+        atom->outgoing = malloc(sizeof(atom_handle_t*) * count);
+        atom->outgoing_count = count;
+        memory_account_alloc(acc, MEMORY_OUTGOING, type, atom->outgoing,
+                             sizeof(atom_handle_t*) * count);
+        for (size_t i = 0; i < count; i++) {
+            atom->outgoing[i] = outgoing[i];
+            atom_retain(outgoing[i]);
+        }
+    }
+    
+    /* Initialise handle */
+    atom_handle_t* handle = &block->handle;
     handle->id = atom->id;
     handle->atom = atom;
     handle->ref_count = 1;
+    return handle;
+}
+
+/* Make room for `n` more atoms in a slot array, retiring the old array */
+static atom_handle_t** slots_reserve(atom_handle_t** atoms, size_t count, size_t* capacity,
+                                     size_t n, retired_arrays_t* retired) {
+    if (count + n <= *capacity) return atoms;
+    
+    /* Scans may still be reading the old array; it is retired, not freed */
+    size_t grown_capacity = *capacity ? *capacity : TYPE_BUCKET_MIN;
+    while (grown_capacity < count + n) grown_capacity *= 2;
+    atom_handle_t** grown = malloc(grown_capacity * sizeof(atom_handle_t*));
+    if (count) memcpy(grown, atoms, count * sizeof(atom_handle_t*));
+    if (atoms) retired->arrays[retired->count++] = atoms;
+    *capacity = grown_capacity;
+    return grown;
+}
+
+/*
+ * Add built atoms to the array, type buckets, lookup table and incoming sets
+ * in one pass; the caller holds the write lock. The new count is published
+ * once, after every slot is filled, so scans see all of the atoms or none.
+ * Each bucket publishes its own count, so a bucket scan at MVCC_LATEST can see
+ * part of a multi-type transaction; snapshots see it whole. Replaced arrays
+ * go to `retired` for the caller to retire after unlocking. Create events go
+ * to the feed positions from `feed` on.
+ */
+static void atoms_publish_locked(atomspace_t* space, atom_handle_t** handles, size_t n,
+                                 uint64_t version, uint64_t feed, retired_arrays_t* retired) {
+    hash_table_t* table = (hash_table_t*)space->lookup_table;
+    type_bucket_t* buckets = (type_bucket_t*)space->type_index;
     
-    /* Add to atomspace */
-    if (space->atom_count >= space->atom_capacity) {
-        space->atom_capacity *= 2;
-        space->atoms = realloc(space->atoms, 
-                              space->atom_capacity * sizeof(atom_handle_t*));
+    atom_handle_t** atoms = slots_reserve(space->atoms, space->atom_count, &space->atom_capacity,
+                                          n, retired);
+    if (atoms != space->atoms) __atomic_store_n(&space->atoms, atoms, __ATOMIC_RELEASE);
+    
+    /* Grow each touched bucket once; `added` then becomes its next free slot */
+    size_t added[ATOM_TYPE_MAX] = {0};
+    for (size_t i = 0; i < n; i++) {
+        added[handles[i]->atom->type]++;
+    }
+    for (int t = 0; t < ATOM_TYPE_MAX; t++) {
+        if (!added[t]) continue;
+        type_bucket_t* bucket = &buckets[t];
+        atoms = slots_reserve(bucket->atoms, bucket->count, &bucket->capacity, added[t], retired);
+        if (atoms != bucket->atoms) __atomic_store_n(&bucket->atoms, atoms, __ATOMIC_RELEASE);
+        added[t] = bucket->count;
     }
-    space->atoms[space->atom_count++] = handle;
-    space->total_atoms_created++;
     
-    /* Add to lookup table */
-    hash_table_insert((hash_table_t*)space->lookup_table, atom->id, handle);
+    for (size_t i = 0; i < n; i++) {
+        atom_t* atom = handles[i]->atom;
+        atom->create_version = version;
+        atom->value_version = version;
+        atom->slot = space->atom_count + i;
+        atom->time_index = space->time_index;
+        atom->space_id = space->space_id;
+        space->atoms[atom->slot] = handles[i];
+        atom->type_slot = added[atom->type]++;
+        buckets[atom->type].atoms[atom->type_slot] = handles[i];
+        hash_table_insert_locked(table, atom->id, handles[i]);
+        for (size_t k = 0; k < atom->outgoing_count; k++) {
+            incoming_append(space, atom->outgoing[k]->atom, handles[i]);
+        }
+    }
+    __atomic_store_n(&space->atom_count, space->atom_count + n, __ATOMIC_RELEASE);
+    for (int t = 0; t < ATOM_TYPE_MAX; t++) {
+        if (added[t] > buckets[t].count) __atomic_store_n(&buckets[t].count, added[t], __ATOMIC_RELEASE);
+    }
+    space->total_atoms_created += n;
+    name_index_insert((name_index_t*)space->name_index, handles, n);
+    time_index_insert((time_index_t*)space->time_index, handles, n, version);
+    query_cache_invalidate((query_cache_t*)space->query_cache, handles, n);
     
+    if (feed != FEED_NONE) {
+        for (size_t i = 0; i < n; i++) {
+            atom_t* atom = handles[i]->atom;
+            changefeed_publish(feed + i, CHANGE_CREATE, atom, &atom->tv, &atom->av, version);
+        }
+    }
+}
+
+static atom_handle_t* atom_create_internal(atomspace_t* space, atom_type_t type, const char* name,
+                                           atom_handle_t** outgoing, size_t count) {
+    atom_handle_t* handle = atom_build(space, type, name, outgoing, count);
+    
+    /* Add to atomspace, lookup table and incoming sets under one write lock */
+    hash_table_t* table = (hash_table_t*)space->lookup_table;
+    uint64_t held = lockprof_wrlock(&table->lock, &hash_write_site);
+    uint64_t version = mvcc_write_begin();
+    retired_arrays_t retired = { .count = 0 };
+    atoms_publish_locked(space, &handle, 1, version, feed_claim(1), &retired);
+    mvcc_write_end();
+    lockprof_rwlock_unlock(&table->lock, &hash_write_site, held);
+    
+    /* Retiring may run reclamation, which takes the write lock */
+    retired_arrays_release(&retired);
+    memory_account_atom((memory_accounting_t*)space->memory_accounting, type, 1);
+    
+    TRACE_POINT(atom_create, TRACE_ATOM_CREATE, TRACE_PHASE_INSTANT, handle->id, type);
+    return handle;
+}
+
+atom_handle_t* atom_create(atomspace_t* space, atom_type_t type, const char* name) {
+    if (!space || !atom_type_valid(type)) return NULL;
+    
+    STATS_BEGIN(start);
+    atom_handle_t* handle = atom_create_internal(space, type, name, NULL, 0);
+    STATS_END(STATS_OP_CREATE, start);
     return handle;
 }
 
 atom_handle_t* atom_create_link(atomspace_t* space, atom_type_t type,
                                 atom_handle_t** outgoing, size_t count) {
-    if (!space) return NULL;
-    
-    atom_handle_t* handle = atom_create(space, type, NULL);
-    if (!handle) return NULL;
+    if (!space || !atom_type_valid(type) || (count > 0 && !outgoing)) return NULL;
     
-    atom_t* atom = handle->atom;
+    STATS_BEGIN(start);
+    atom_handle_t* handle = atom_create_internal(space, type, NULL, outgoing, count);
+    STATS_END(STATS_OP_CREATE, start);
+    return handle;
+}
+
+/*
+ * Batch creation: IDs are reserved, atoms, names and outgoing arrays are
+ * allocated as one chunk, and the batch is published under one lock.
+ */
+static atom_chunk_t* atom_chunk_create(size_t count, size_t outgoing_total, size_t name_bytes,
+                                       atom_handle_t*** outgoing_out, char** names_out) {
+    size_t blocks = sizeof(atom_chunk_t) + count * sizeof(atom_block_t);
+    size_t arrays = outgoing_total * sizeof(atom_handle_t*);
+    atom_chunk_t* chunk = calloc(1, blocks + arrays + name_bytes);
+    chunk->live = count;
+    *outgoing_out = (atom_handle_t**)((char*)chunk + blocks);
+    *names_out = (char*)chunk + blocks + arrays;
+    return chunk;
+}
+
+static void atom_chunk_fill(atomspace_t* space, atom_chunk_t* chunk, atom_type_t type,
+                            size_t count, atom_handle_t** out) {
+    atom_block_t* blocks = (atom_block_t*)(chunk + 1);
+    uint64_t first = reserve_atom_ids(count);
+    uint64_t now = time(NULL);
     
-    /* Set outgoing set */
-    if (count > 0) {
-        atom->outgoing = malloc(sizeof(atom_handle_t*) * count);
-        atom->outgoing_count = count;
+    for (size_t i = 0; i < count; i++) {
+        atom_t* atom = &blocks[i].atom;
+        atom->id = ATOM_ID_MAKE(space->node_id, first + i);
+        atom->type = type;
+        atom->tv.strength = 1.0;
+        atom->create_version = MVCC_LIVE;
+        atom->delete_version = MVCC_LIVE;
+        atom->creation_time = now;
+        atom->last_access_time = now;
+        atom->chunk = chunk;
         
-        for (size_t i = 0; i < count; i++) {
-            atom->outgoing[i] = outgoing[i];
-            atom_retain(outgoing[i]);
-            
-            /* Add to incoming set of target atom */
-            atom_t* target = outgoing[i]->atom;
-            target->incoming = realloc(target->incoming,
-                                      sizeof(atom_handle_t*) * (target->incoming_count + 1));
-            target->incoming[target->incoming_count++] = handle;
+        atom_handle_t* handle = &blocks[i].handle;
+        handle->id = atom->id;
+        handle->atom = atom;
+        handle->ref_count = 1;
+        out[i] = handle;
+    }
+}
+
+/* `arrays` names or outgoing arrays totalling `bytes` were carved from the chunk */
+static void atom_batch_publish(atomspace_t* space, atom_type_t type, atom_handle_t** out, size_t count,
+                               memory_category_t category, size_t arrays, size_t bytes) {
+    hash_table_t* table = (hash_table_t*)space->lookup_table;
+    uint64_t held = lockprof_wrlock(&table->lock, &hash_write_site);
+    uint64_t version = mvcc_write_begin();
+    retired_arrays_t retired = { .count = 0 };
+    atoms_publish_locked(space, out, count, version, feed_claim(count), &retired);
+    mvcc_write_end();
+    lockprof_rwlock_unlock(&table->lock, &hash_write_site, held);
+    retired_arrays_release(&retired);
+    
+    memory_accounting_t* acc = (memory_accounting_t*)space->memory_accounting;
+    memory_account_atom(acc, type, (int)count);
+    if (arrays) memory_account_alloc_sized(acc, category, type, arrays, bytes, bytes);
+    TRACE_POINT(atom_create, TRACE_ATOM_CREATE, TRACE_PHASE_INSTANT, out[0]->id, type);
+}
+
+size_t atom_create_batch(atomspace_t* space, atom_type_t type, const char* const* names,
+                         size_t count, atom_handle_t** out) {
+    if (!space || !atom_type_valid(type) || !names || !out || count == 0 || count > INT_MAX) return 0;
+    STATS_BEGIN(start);
+    
+    size_t name_bytes = 0;
+    size_t named = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!names[i]) continue;
+        name_bytes += strlen(names[i]) + 1;
+        named++;
+    }
+    char* name_area;
+    atom_handle_t** outgoing_area;
+    atom_chunk_t* chunk = atom_chunk_create(count, 0, name_bytes, &outgoing_area, &name_area);
+    atom_chunk_fill(space, chunk, type, count, out);
+    for (size_t i = 0; i < count; i++) {
+        if (!names[i]) continue;
+        size_t length = strlen(names[i]) + 1;
+        memcpy(name_area, names[i], length);
+        out[i]->atom->name = name_area;
+        name_area += length;
+    }
+    
+    atom_batch_publish(space, type, out, count, MEMORY_NAMES, named, name_bytes);
+    STATS_END(STATS_OP_CREATE_BATCH, start);
+    return count;
+}
+
+size_t atom_create_link_batch(atomspace_t* space, atom_type_t type, atom_handle_t* const* outgoing,
+                              const size_t* arities, size_t count, atom_handle_t** out) {
+    if (!space || !atom_type_valid(type) || !outgoing || !arities || !out || count == 0 ||
+        count > INT_MAX) {
+        return 0;
+    }
+    STATS_BEGIN(start);
+    
+    size_t outgoing_total = 0;
+    size_t linked = 0;
+    for (size_t i = 0; i < count; i++) {
+        outgoing_total += arities[i];
+        linked += arities[i] > 0;
+    }
+    char* name_area;
+    atom_handle_t** outgoing_area;
+    atom_chunk_t* chunk = atom_chunk_create(count, outgoing_total, 0, &outgoing_area, &name_area);
+    atom_chunk_fill(space, chunk, type, count, out);
+    memcpy(outgoing_area, outgoing, outgoing_total * sizeof(atom_handle_t*));
+    for (size_t i = 0, offset = 0; i < count; offset += arities[i], i++) {
+        atom_t* atom = out[i]->atom;
+        atom->outgoing = arities[i] ? outgoing_area + offset : NULL;
+        atom->outgoing_count = arities[i];
+        for (size_t k = 0; k < arities[i]; k++) {
+            atom_retain(atom->outgoing[k]);
         }
     }
     
-    return handle;
+    atom_batch_publish(space, type, out, count, MEMORY_OUTGOING, linked,
+                       outgoing_total * sizeof(atom_handle_t*));
+    STATS_END(STATS_OP_CREATE_BATCH, start);
+    return count;
+}
+
+/*
+ * Atom removal: the slot stays visible to older snapshots until the grace
+ * period ends and the horizon has passed the removal, so no snapshot begun
+ * since can read below it. The atom is then unpublished, and released only
+ * after a second grace period, since readers that entered before the
+ * unpublish may still have loaded its handle from a slot or an index.
+ */
+typedef struct {
+    atomspace_t* space;
+    atom_handle_t* handle;
+    uint64_t horizon;             /* mvcc_horizon() when last retired */
+} removed_atom_t;
+
+static void release_removed(void* arg) {
+    removed_atom_t* removed = (removed_atom_t*)arg;
+    atom_release(removed->handle);
+    free(removed);
+}
+
+static void unpublish_removed(void* arg) {
+    removed_atom_t* removed = (removed_atom_t*)arg;
+    hash_table_t* table = (hash_table_t*)removed->space->lookup_table;
+    
+    atom_t* atom = removed->handle->atom;
+    /* An older write was still in flight; snapshots may yet start below the removal */
+    if (removed->horizon < atom->delete_version) {
+        removed->horizon = mvcc_horizon();
+        epoch_retire(removed, unpublish_removed);
+        return;
+    }
+    type_bucket_t* bucket = &((type_bucket_t*)removed->space->type_index)[atom->type];
+    
+    uint64_t held = lockprof_wrlock(&table->lock, &hash_write_site);
+    removed->space->atoms[atom->slot] = NULL;
+    bucket->atoms[atom->type_slot] = NULL;
+    lockprof_rwlock_unlock(&table->lock, &hash_write_site, held);
+    
+    vector_index_detach((vector_index_t*)removed->space->vector_index, removed->handle);
+    name_index_remove((name_index_t*)removed->space->name_index, removed->handle);
+    __atomic_store_n(&atom->time_index, NULL, __ATOMIC_RELAXED);
+    epoch_retire(removed, release_removed);
+}
+
+static void incoming_remove(atom_t* target, atom_handle_t* handle) {
+    for (size_t i = 0; i < target->incoming_count; i++) {
+        if (target->incoming[i] == handle) {
+            target->incoming[i] = target->incoming[--target->incoming_count];
+            return;
+        }
+    }
+}
+
+int atomspace_remove_atom(atomspace_t* space, atom_handle_t* handle) {
+    if (!space || !handle) return -1;
+    atom_t* atom = handle->atom;
+    hash_table_t* table = (hash_table_t*)space->lookup_table;
+    memory_accounting_t* acc = (memory_accounting_t*)space->memory_accounting;
+    
+    uint64_t held = lockprof_wrlock(&table->lock, &hash_write_site);
+    /* Atoms still referenced by links stay; remove the links first */
+    if (atom->incoming_count > 0 || atom->delete_version != MVCC_LIVE ||
+        atom->slot >= space->atom_count || space->atoms[atom->slot] != handle) {
+        lockprof_rwlock_unlock(&table->lock, &hash_write_site, held);
+        return -1;
+    }
+    uint64_t version = mvcc_write_begin();
+    __atomic_store_n(&atom->delete_version, version, __ATOMIC_RELEASE);
+    mvcc_write_end();
+    query_cache_invalidate((query_cache_t*)space->query_cache, &handle, 1);
+    uint64_t feed = feed_claim(1);
+    if (feed != FEED_NONE) changefeed_publish(feed, CHANGE_DELETE, atom, &atom->tv, &atom->av, version);
+    hash_table_remove_locked(table, atom->id);
+    for (size_t i = 0; i < atom->outgoing_count; i++) {
+        atom_t* target = atom->outgoing[i]->atom;
+        size_t allocated = target->incoming ? malloc_usable_size(target->incoming) : 0;
+        incoming_remove(target, handle);
+        memory_account_resize(acc, MEMORY_INCOMING, target->type,
+                              sizeof(atom_handle_t*) * (target->incoming_count + 1), allocated,
+                              target->incoming, sizeof(atom_handle_t*) * target->incoming_count);
+    }
+    space->total_atoms_deleted++;
+    lockprof_rwlock_unlock(&table->lock, &hash_write_site, held);
+    
+    memory_account_atom(acc, atom->type, -1);
+    atom_account_release(acc, atom);
+    memory_account_free(acc, MEMORY_INCOMING, atom->type, atom->incoming, 0);
+    
+    /* Readers may still hold borrowed handles; drop the space's reference later */
+    removed_atom_t* removed = malloc(sizeof(removed_atom_t));
+    removed->space = space;
+    removed->handle = handle;
+    removed->horizon = mvcc_horizon();
+    epoch_retire(removed, unpublish_removed);
+    return 0;
 }
 
 void atom_retain(atom_handle_t* handle) {
@@ -180,35 +717,198 @@ void atom_retain(atom_handle_t* handle) {
 
 void atom_release(atom_handle_t* handle) {
     if (!handle) return;
+    if (__sync_sub_and_fetch(&handle->ref_count, 1) != 0) return;
+    
+    release_stack_t stack = { .count = 0, .capacity = RELEASE_STACK_INLINE };
+    stack.items = stack.inline_items;
+    release_stack_push(&stack, handle);
     
-    if (__sync_sub_and_fetch(&handle->ref_count, 1) == 0) {
-        atom_t* atom = handle->atom;
+    while (stack.count > 0) {
+        atom_handle_t* current = stack.items[--stack.count];
+        atom_t* atom = current->atom;
         
-        /* Free outgoing atoms */
+        /* Drop references to outgoing atoms */
         for (size_t i = 0; i < atom->outgoing_count; i++) {
-            atom_release(atom->outgoing[i]);
+            if (__sync_sub_and_fetch(&atom->outgoing[i]->ref_count, 1) == 0) {
+                release_stack_push(&stack, atom->outgoing[i]);
+            }
+        }
+        atom_free(current);
+    }
+    
+    if (stack.items != stack.inline_items) free(stack.items);
+}
+
+/*
+ * TV/AV writes. value_claim orders the writers of one atom, so versions and
+ * feed positions rise with each write. value_seq is the readers' sequence
+ * lock. While a snapshot may read below a write, the overwritten pair is
+ * pushed onto the atom's history; once the horizon has passed the write, it
+ * is trimmed.
+ */
+typedef struct {
+    atom_handle_t* handle;
+    uint64_t version;
+    uint64_t horizon;             /* mvcc_horizon() when last retired */
+} value_trim_t;
+
+static void value_claim(atom_t* atom) {
+    for (;;) {
+        uint32_t held = 0;
+        if (__atomic_compare_exchange_n(&atom->value_claim, &held, 1, true, __ATOMIC_ACQUIRE,
+                                        __ATOMIC_RELAXED)) {
+            return;
+        }
+        sched_yield();
+    }
+}
+
+static void value_unclaim(atom_t* atom) {
+    __atomic_store_n(&atom->value_claim, 0, __ATOMIC_RELEASE);
+}
+
+static void value_write_lock(atom_t* atom) {
+    for (;;) {
+        uint32_t seq = __atomic_load_n(&atom->value_seq, __ATOMIC_RELAXED);
+        if (!(seq & 1) && __atomic_compare_exchange_n(&atom->value_seq, &seq, seq + 1, true,
+                                                      __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return;
+        }
+        sched_yield();
+    }
+}
+
+static void value_write_unlock(atom_t* atom) {
+    __atomic_add_fetch(&atom->value_seq, 1, __ATOMIC_RELEASE);
+}
+
+/* Snapshots begun after the trim was retired read at or above `horizon` */
+static void trim_history(void* arg) {
+    value_trim_t* trim = (value_trim_t*)arg;
+    atom_t* atom = trim->handle->atom;
+    uint64_t before = trim->horizon < trim->version ? trim->horizon : trim->version;
+    
+    value_write_lock(atom);
+    atom_value_version_t* keep = atom->history;
+    while (keep && keep->version > before) {
+        keep = keep->prev;
+    }
+    atom_value_version_t* stale = NULL;
+    if (keep) {
+        stale = keep->prev;
+        __atomic_store_n(&keep->prev, NULL, __ATOMIC_RELEASE);
+    }
+    value_write_unlock(atom);
+    
+    while (stale) {
+        atom_value_version_t* prev = stale->prev;
+        mvcc_version_free(stale);
+        stale = prev;
+    }
+    
+    /* Trim the rest once the horizon has passed the write */
+    if (trim->horizon < trim->version) {
+        trim->horizon = mvcc_horizon();
+        epoch_retire(trim, trim_history);
+        return;
+    }
+    atom_release(trim->handle);
+    free(trim);
+}
+
+/*
+ * Write a pair while the caller holds the atom's claim, publishing it to
+ * feed position `feed` unless that is FEED_NONE. A `version` of 0 stamps
+ * the write inside the sequence lock; a transaction passes its own version
+ * and `keep` set, since snapshots read below it until it ends. Returns the
+ * history trim to retire once the claim is released, or NULL.
+ */
+static value_trim_t* atom_apply_values(atom_handle_t* handle, const truth_value_t* tv,
+                                       const attention_value_t* av, uint64_t version, bool keep,
+                                       uint64_t feed) {
+    atom_t* atom = handle->atom;
+    
+    value_write_lock(atom);
+    if (version == 0) {
+        version = mvcc_stamp();
+        keep = mvcc_history_needed();
+    }
+    /* A transaction writing an atom twice keeps the first log entry */
+    bool logged = atom->value_version != version;
+    if (keep) {
+        atom_value_version_t* old = mvcc_version_alloc();
+        old->tv = atom->tv;
+        old->av = atom->av;
+        old->version = atom->value_version;
+        old->prev = atom->history;
+        __atomic_store_n(&atom->history, old, __ATOMIC_RELEASE);
+    }
+    if (tv) atom->tv = *tv;
+    if (av) atom->av = *av;
+    atom->value_version = version;
+    uint64_t now = time(NULL);
+    atom->last_access_time = now;
+    truth_value_t written_tv = atom->tv;
+    attention_value_t written_av = atom->av;
+    value_write_unlock(atom);
+    /* Outside the write section, so readers do not spin on the event copy */
+    if (feed != FEED_NONE) changefeed_publish(feed, CHANGE_UPDATE, atom, &written_tv, &written_av, version);
+    time_index_t* times = __atomic_load_n(&atom->time_index, __ATOMIC_RELAXED);
+    if (times && logged) time_index_append(times, atom, now, version);
+    
+    if (!keep) return NULL;
+    value_trim_t* trim = malloc(sizeof(value_trim_t));
+    trim->handle = handle;
+    trim->version = version;
+    atom_retain(handle);
+    return trim;
+}
+
+static void trim_retire(value_trim_t* trim) {
+    trim->horizon = mvcc_horizon();
+    epoch_retire(trim, trim_history);
+}
+
+static void atom_write_values(atom_handle_t* handle, const truth_value_t* tv,
+                              const attention_value_t* av) {
+    value_claim(handle->atom);
+    value_trim_t* trim = atom_apply_values(handle, tv, av, 0, false, feed_claim(1));
+    value_unclaim(handle->atom);
+    if (trim) trim_retire(trim);
+}
+
+/* Consistent copy of the current pair; returns its version */
+static uint64_t atom_read_values(const atom_t* atom, truth_value_t* tv, attention_value_t* av,
+                                 atom_value_version_t** history) {
+    for (;;) {
+        uint32_t seq = __atomic_load_n(&atom->value_seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            sched_yield();
+            continue;
         }
-        free(atom->outgoing);
-        free(atom->incoming);
-        free(atom->name);
-        free(atom);
-        free(handle);
+        *tv = atom->tv;
+        *av = atom->av;
+        uint64_t version = atom->value_version;
+        if (history) *history = __atomic_load_n(&atom->history, __ATOMIC_ACQUIRE);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&atom->value_seq, __ATOMIC_RELAXED) == seq) return version;
     }
 }
 
 /* Truth value operations */
 void atom_set_tv(atom_handle_t* handle, double strength, double confidence) {
     if (!handle) return;
-    atom_t* atom = handle->atom;
-    atom->tv.strength = strength;
-    atom->tv.confidence = confidence;
-    atom->last_access_time = time(NULL);
+    STATS_BEGIN(start);
+    truth_value_t tv = { strength, confidence };
+    atom_write_values(handle, &tv, NULL);
+    STATS_END(STATS_OP_TV_UPDATE, start);
 }
 
 truth_value_t atom_get_tv(atom_handle_t* handle) {
     truth_value_t tv = {0.0, 0.0};
     if (handle) {
-        tv = handle->atom->tv;
+        attention_value_t av;
+        atom_read_values(handle->atom, &tv, &av, NULL);
         handle->atom->last_access_time = time(NULL);
     }
     return tv;
@@ -217,17 +917,17 @@ truth_value_t atom_get_tv(atom_handle_t* handle) {
 /* Attention value operations */
 void atom_set_av(atom_handle_t* handle, int16_t sti, int16_t lti, int16_t vlti) {
     if (!handle) return;
-    atom_t* atom = handle->atom;
-    atom->av.sti = sti;
-    atom->av.lti = lti;
-    atom->av.vlti = vlti;
-    atom->last_access_time = time(NULL);
+    STATS_BEGIN(start);
+    attention_value_t av = { sti, lti, vlti };
+    atom_write_values(handle, NULL, &av);
+    STATS_END(STATS_OP_AV_UPDATE, start);
 }
 
 attention_value_t atom_get_av(atom_handle_t* handle) {
     attention_value_t av = {0, 0, 0};
     if (handle) {
-        av = handle->atom->av;
+        truth_value_t tv;
+        atom_read_values(handle->atom, &tv, &av, NULL);
         handle->atom->last_access_time = time(NULL);
     }
     return av;
@@ -236,17 +936,53 @@ attention_value_t atom_get_av(atom_handle_t* handle) {
 /* Query operations */
 atom_handle_t* atomspace_get_atom(atomspace_t* space, uint64_t id) {
     if (!space) return NULL;
-    return hash_table_lookup((hash_table_t*)space->lookup_table, id);
+    STATS_BEGIN(start);
+    atom_handle_t* handle = hash_table_lookup((hash_table_t*)space->lookup_table, id);
+    STATS_END(STATS_OP_LOOKUP, start);
+    return handle;
 }
 
-atom_handle_t** atomspace_get_atoms_by_type(atomspace_t* space, atom_type_t type, size_t* count) {
-    if (!space || !count) return NULL;
-    
+/*
+ * Scan the space for atoms visible at `version` and accepted by `keep`.
+ * Retained results hold a reference each; borrowed results hold none and
+ * stay valid while the caller is inside a read section or snapshot.
+ */
+typedef bool (*atom_filter_fn)(atom_handle_t* handle, const void* arg);
+
+atom_handle_t* const* atomspace_scan_slots(atomspace_t* space, size_t* count) {
+    /* The count is published after its slot; any array loaded later holds it */
+    *count = __atomic_load_n(&space->atom_count, __ATOMIC_ACQUIRE);
+    return __atomic_load_n(&space->atoms, __ATOMIC_ACQUIRE);
+}
+
+atom_handle_t* const* atomspace_scan_type_slots(atomspace_t* space, atom_type_t type, size_t* count) {
+    if (!atom_type_valid(type)) {
+        *count = 0;
+        return NULL;
+    }
+    type_bucket_t* bucket = &((type_bucket_t*)space->type_index)[type];
+    *count = __atomic_load_n(&bucket->count, __ATOMIC_ACQUIRE);
+    return __atomic_load_n(&bucket->atoms, __ATOMIC_ACQUIRE);
+}
+
+/* A slot array loaded once, so both collection passes see the same atoms */
+typedef struct {
+    atom_handle_t* const* atoms;
+    size_t count;
+} slot_range_t;
+
+/* The caller is inside a critical section from loading the ranges to the return */
+static atom_handle_t** collect_ranges(const slot_range_t* ranges, size_t range_count,
+                                      atom_filter_fn keep, const void* arg, bool retain,
+                                      uint64_t version, size_t* count) {
     /* Count matching atoms */
     size_t matches = 0;
-    for (size_t i = 0; i < space->atom_count; i++) {
-        if (space->atoms[i] && space->atoms[i]->atom->type == type) {
-            matches++;
+    for (size_t r = 0; r < range_count; r++) {
+        for (size_t i = 0; i < ranges[r].count; i++) {
+            atom_handle_t* handle = ranges[r].atoms[i];
+            if (handle && atom_visible_at(handle->atom, version) && keep(handle, arg)) {
+                matches++;
+            }
         }
     }
     
@@ -254,67 +990,422 @@ atom_handle_t** atomspace_get_atoms_by_type(atomspace_t* space, atom_type_t type
     atom_handle_t** result = malloc(sizeof(atom_handle_t*) * matches);
     size_t idx = 0;
     
-    for (size_t i = 0; i < space->atom_count; i++) {
-        if (space->atoms[i] && space->atoms[i]->atom->type == type) {
-            result[idx++] = space->atoms[i];
-            atom_retain(space->atoms[i]);
+    for (size_t r = 0; r < range_count; r++) {
+        for (size_t i = 0; i < ranges[r].count && idx < matches; i++) {
+            atom_handle_t* handle = ranges[r].atoms[i];
+            if (handle && atom_visible_at(handle->atom, version) && keep(handle, arg)) {
+                result[idx++] = handle;
+                if (retain) atom_retain(handle);
+            }
         }
     }
     
-    *count = matches;
+    *count = idx;
     return result;
 }
 
-atom_handle_t** atomspace_get_atoms_by_name(atomspace_t* space, const char* name, size_t* count) {
+static atom_handle_t** collect_atoms(atomspace_t* space, atom_filter_fn keep, const void* arg,
+                                     bool retain, uint64_t version, size_t* count) {
+    epoch_enter();
+    slot_range_t range;
+    range.atoms = atomspace_scan_slots(space, &range.count);
+    atom_handle_t** result = collect_ranges(&range, 1, keep, arg, retain, version, count);
+    epoch_exit();
+    return result;
+}
+
+static bool filter_any(atom_handle_t* handle, const void* arg) {
+    (void)handle;
+    (void)arg;
+    return true;
+}
+
+typedef struct {
+    pattern_matcher_fn matcher;
+    void* user_data;
+} pattern_filter_t;
+
+static bool filter_pattern(atom_handle_t* handle, const void* arg) {
+    const pattern_filter_t* pattern = (const pattern_filter_t*)arg;
+    return pattern->matcher(handle, pattern->user_data);
+}
+
+/* Union of the buckets of every type in `types` */
+static atom_handle_t** query_by_types(atomspace_t* space, atom_type_set_t types, bool retain,
+                                      uint64_t version, size_t* count) {
+    if (!space || !count) return NULL;
+    STATS_BEGIN(start);
+    TRACE_POINT(query_begin, TRACE_QUERY, TRACE_PHASE_BEGIN, TRACE_QUERY_BY_TYPE, 0);
+    epoch_enter();
+    slot_range_t ranges[ATOM_TYPE_MAX];
+    size_t range_count = 0;
+    for (int t = 0; t < ATOM_TYPE_MAX && types >> t; t++) {
+        if (!(types & ATOM_TYPE_BIT(t))) continue;
+        ranges[range_count].atoms = atomspace_scan_type_slots(space, (atom_type_t)t, &ranges[range_count].count);
+        if (ranges[range_count].count) range_count++;
+    }
+    atom_handle_t** result = collect_ranges(ranges, range_count, filter_any, NULL, retain, version, count);
+    epoch_exit();
+    STATS_END(STATS_OP_QUERY, start);
+    TRACE_POINT(query_end, TRACE_QUERY, TRACE_PHASE_END, TRACE_QUERY_BY_TYPE, *count);
+    return result;
+}
+
+static atom_handle_t** query_by_name(atomspace_t* space, const char* name, bool retain,
+                                     uint64_t version, size_t* count) {
     if (!space || !name || !count) return NULL;
+    STATS_BEGIN(start);
+    TRACE_POINT(query_begin, TRACE_QUERY, TRACE_PHASE_BEGIN, TRACE_QUERY_BY_NAME, 0);
+    atom_handle_t** result = name_index_lookup((name_index_t*)space->name_index, name, retain, version, count);
+    STATS_END(STATS_OP_QUERY, start);
+    TRACE_POINT(query_end, TRACE_QUERY, TRACE_PHASE_END, TRACE_QUERY_BY_NAME, *count);
+    return result;
+}
+
+static atom_handle_t** query_pattern(atomspace_t* space, pattern_matcher_fn matcher,
+                                     void* user_data, bool retain, uint64_t version,
+                                     size_t* count) {
+    if (!space || !matcher || !count) return NULL;
+    STATS_BEGIN(start);
+    TRACE_POINT(query_begin, TRACE_QUERY, TRACE_PHASE_BEGIN, TRACE_QUERY_MATCH, 0);
+    pattern_filter_t pattern = { matcher, user_data };
+    atom_handle_t** result = collect_atoms(space, filter_pattern, &pattern, retain, version, count);
+    STATS_END(STATS_OP_MATCH, start);
+    TRACE_POINT(query_end, TRACE_QUERY, TRACE_PHASE_END, TRACE_QUERY_MATCH, *count);
+    return result;
+}
+
+atom_handle_t** atomspace_get_atoms_by_type(atomspace_t* space, atom_type_t type, size_t* count) {
+    if (!atom_type_valid(type)) return query_by_types(space, 0, true, MVCC_LATEST, count);
+    return query_by_types(space, ATOM_TYPE_BIT(type), true, MVCC_LATEST, count);
+}
+
+atom_handle_t** atomspace_get_atoms_by_types(atomspace_t* space, atom_type_set_t types, size_t* count) {
+    return query_by_types(space, types, true, MVCC_LATEST, count);
+}
+
+atom_handle_t** atomspace_get_atoms_by_name(atomspace_t* space, const char* name, size_t* count) {
+    return query_by_name(space, name, true, MVCC_LATEST, count);
+}
+
+/* Pattern matching */
+atom_handle_t** atomspace_match_pattern(atomspace_t* space, pattern_matcher_fn matcher,
+                                       void* user_data, size_t* count) {
+    return query_pattern(space, matcher, user_data, true, MVCC_LATEST, count);
+}
+
+/* Borrowed queries: no per-result reference counting */
+void atomspace_read_begin(atomspace_t* space) {
+    (void)space;
+    epoch_enter();
+}
+
+void atomspace_read_end(atomspace_t* space) {
+    (void)space;
+    epoch_exit();
+}
+
+atom_handle_t** atomspace_get_atoms_by_type_borrowed(atomspace_t* space, atom_type_t type, size_t* count) {
+    if (!atom_type_valid(type)) return query_by_types(space, 0, false, MVCC_LATEST, count);
+    return query_by_types(space, ATOM_TYPE_BIT(type), false, MVCC_LATEST, count);
+}
+
+atom_handle_t** atomspace_get_atoms_by_types_borrowed(atomspace_t* space, atom_type_set_t types, size_t* count) {
+    return query_by_types(space, types, false, MVCC_LATEST, count);
+}
+
+atom_handle_t** atomspace_get_atoms_by_name_borrowed(atomspace_t* space, const char* name, size_t* count) {
+    return query_by_name(space, name, false, MVCC_LATEST, count);
+}
+
+atom_handle_t** atomspace_match_pattern_borrowed(atomspace_t* space, pattern_matcher_fn matcher,
+                                                void* user_data, size_t* count) {
+    return query_pattern(space, matcher, user_data, false, MVCC_LATEST, count);
+}
+
+/* Snapshots */
+atomspace_snapshot_t* atomspace_snapshot_begin(atomspace_t* space) {
+    if (!space) return NULL;
+    atomspace_snapshot_t* snapshot = malloc(sizeof(atomspace_snapshot_t));
+    snapshot->space = space;
+    epoch_enter();
+    snapshot->version = mvcc_snapshot_begin();
+    return snapshot;
+}
+
+void atomspace_snapshot_end(atomspace_snapshot_t* snapshot) {
+    if (!snapshot) return;
+    mvcc_snapshot_end();
+    epoch_exit();
+    free(snapshot);
+}
+
+/* Newest pair written at or before the snapshot */
+uint64_t atom_read_values_at(const atom_t* atom, uint64_t version, truth_value_t* tv, attention_value_t* av) {
+    atom_value_version_t* history;
+    uint64_t written = atom_read_values(atom, tv, av, &history);
+    while (written > version && history) {
+        *tv = history->tv;
+        *av = history->av;
+        written = history->version;
+        history = __atomic_load_n(&history->prev, __ATOMIC_ACQUIRE);
+    }
+    return written;
+}
+
+truth_value_t atomspace_snapshot_get_tv(const atomspace_snapshot_t* snapshot, atom_handle_t* handle) {
+    truth_value_t tv = {0.0, 0.0};
+    attention_value_t av;
+    if (snapshot && handle) atom_read_values_at(handle->atom, snapshot->version, &tv, &av);
+    return tv;
+}
+
+attention_value_t atomspace_snapshot_get_av(const atomspace_snapshot_t* snapshot, atom_handle_t* handle) {
+    truth_value_t tv;
+    attention_value_t av = {0, 0, 0};
+    if (snapshot && handle) atom_read_values_at(handle->atom, snapshot->version, &tv, &av);
+    return av;
+}
+
+atom_handle_t** atomspace_snapshot_get_atoms_by_type(const atomspace_snapshot_t* snapshot,
+                                                    atom_type_t type, size_t* count) {
+    if (!snapshot) return NULL;
+    atom_type_set_t types = atom_type_valid(type) ? ATOM_TYPE_BIT(type) : 0;
+    return query_by_types(snapshot->space, types, false, snapshot->version, count);
+}
+
+atom_handle_t** atomspace_snapshot_get_atoms_by_types(const atomspace_snapshot_t* snapshot,
+                                                     atom_type_set_t types, size_t* count) {
+    if (!snapshot) return NULL;
+    return query_by_types(snapshot->space, types, false, snapshot->version, count);
+}
+
+atom_handle_t** atomspace_snapshot_get_atoms_by_name(const atomspace_snapshot_t* snapshot,
+                                                    const char* name, size_t* count) {
+    if (!snapshot) return NULL;
+    return query_by_name(snapshot->space, name, false, snapshot->version, count);
+}
+
+atom_handle_t** atomspace_snapshot_match_pattern(const atomspace_snapshot_t* snapshot,
+                                                pattern_matcher_fn matcher, void* user_data,
+                                                size_t* count) {
+    if (!snapshot) return NULL;
+    return query_pattern(snapshot->space, matcher, user_data, false, snapshot->version, count);
+}
+
+/* Transactions */
+typedef struct {
+    atom_handle_t* handle;
+    bool has_tv;
+    bool has_av;
+    truth_value_t tv;
+    attention_value_t av;
+} txn_update_t;
+
+struct atomspace_txn {
+    atomspace_t* space;
+    atom_handle_t** created;      /* Built but unpublished atoms, in creation order */
+    size_t created_count;
+    size_t created_capacity;
+    txn_update_t* updates;        /* TV/AV writes to atoms already in the space */
+    size_t update_count;
+    size_t update_capacity;
+};
+
+static bool atom_staged(const atom_t* atom) {
+    return atom->create_version == MVCC_LIVE;
+}
+
+atomspace_txn_t* atomspace_txn_begin(atomspace_t* space) {
+    if (!space) return NULL;
+    atomspace_txn_t* txn = calloc(1, sizeof(atomspace_txn_t));
+    txn->space = space;
+    return txn;
+}
+
+static atom_handle_t* txn_stage(atomspace_txn_t* txn, atom_type_t type, const char* name,
+                                atom_handle_t** outgoing, size_t count) {
+    if (txn->created_count == txn->created_capacity) {
+        txn->created_capacity = txn->created_capacity ? txn->created_capacity * 2 : 16;
+        txn->created = realloc(txn->created, txn->created_capacity * sizeof(atom_handle_t*));
+    }
+    atom_handle_t* handle = atom_build(txn->space, type, name, outgoing, count);
+    txn->created[txn->created_count++] = handle;
+    return handle;
+}
+
+atom_handle_t* atomspace_txn_create(atomspace_txn_t* txn, atom_type_t type, const char* name) {
+    if (!txn || !atom_type_valid(type)) return NULL;
+    return txn_stage(txn, type, name, NULL, 0);
+}
+
+atom_handle_t* atomspace_txn_create_link(atomspace_txn_t* txn, atom_type_t type,
+                                         atom_handle_t** outgoing, size_t count) {
+    if (!txn || !atom_type_valid(type) || (count > 0 && !outgoing)) return NULL;
+    return txn_stage(txn, type, NULL, outgoing, count);
+}
+
+/* Staged atoms are private and written in place; others get an update record */
+static int atom_address_compare(const void* a, const void* b) {
+    uintptr_t x = (uintptr_t)*(atom_t* const*)a;
+    uintptr_t y = (uintptr_t)*(atom_t* const*)b;
+    return (x > y) - (x < y);
+}
+
+static txn_update_t* txn_update(atomspace_txn_t* txn, atom_handle_t* handle) {
+    for (size_t i = txn->update_count; i > 0; i--) {
+        if (txn->updates[i - 1].handle == handle) return &txn->updates[i - 1];
+    }
+    if (txn->update_count == txn->update_capacity) {
+        txn->update_capacity = txn->update_capacity ? txn->update_capacity * 2 : 16;
+        txn->updates = realloc(txn->updates, txn->update_capacity * sizeof(txn_update_t));
+    }
+    txn_update_t* update = &txn->updates[txn->update_count++];
+    memset(update, 0, sizeof(*update));
+    update->handle = handle;
+    return update;
+}
+
+int atomspace_txn_set_tv(atomspace_txn_t* txn, atom_handle_t* handle, double strength, double confidence) {
+    if (!txn || !handle) return -1;
+    truth_value_t tv = { strength, confidence };
+    if (atom_staged(handle->atom)) {
+        handle->atom->tv = tv;
+        return 0;
+    }
+    txn_update_t* update = txn_update(txn, handle);
+    update->has_tv = true;
+    update->tv = tv;
+    return 0;
+}
+
+int atomspace_txn_set_av(atomspace_txn_t* txn, atom_handle_t* handle, int16_t sti, int16_t lti, int16_t vlti) {
+    if (!txn || !handle) return -1;
+    attention_value_t av = { sti, lti, vlti };
+    if (atom_staged(handle->atom)) {
+        handle->atom->av = av;
+        return 0;
+    }
+    txn_update_t* update = txn_update(txn, handle);
+    update->has_av = true;
+    update->av = av;
+    return 0;
+}
+
+static void txn_free(atomspace_txn_t* txn) {
+    free(txn->created);
+    free(txn->updates);
+    free(txn);
+}
+
+int atomspace_txn_commit(atomspace_txn_t* txn) {
+    if (!txn) return -1;
+    STATS_BEGIN(start);
+    atomspace_t* space = txn->space;
+    hash_table_t* table = (hash_table_t*)space->lookup_table;
     
-    size_t matches = 0;
-    for (size_t i = 0; i < space->atom_count; i++) {
-        if (space->atoms[i] && space->atoms[i]->atom->name &&
-            strcmp(space->atoms[i]->atom->name, name) == 0) {
-            matches++;
-        }
+    /* Claimed in address order, so concurrent transactions cannot deadlock; updates keep staging order */
+    atom_t** claims = NULL;
+    if (txn->update_count > 0) claims = malloc(txn->update_count * sizeof(atom_t*));
+    for (size_t i = 0; i < txn->update_count; i++) {
+        claims[i] = txn->updates[i].handle->atom;
+    }
+    if (txn->update_count > 1) qsort(claims, txn->update_count, sizeof(atom_t*), atom_address_compare);
+    for (size_t i = 0; i < txn->update_count; i++) {
+        value_claim(claims[i]);
     }
     
-    atom_handle_t** result = malloc(sizeof(atom_handle_t*) * matches);
-    size_t idx = 0;
+    /* Every change carries one version, so a snapshot sees all of them or none */
+    uint64_t version = mvcc_write_begin();
+    uint64_t feed = feed_claim(txn->created_count + txn->update_count);
+    retired_arrays_t retired = { .count = 0 };
+    if (txn->created_count > 0) {
+        uint64_t held = lockprof_wrlock(&table->lock, &hash_write_site);
+        atoms_publish_locked(space, txn->created, txn->created_count, version, feed, &retired);
+        lockprof_rwlock_unlock(&table->lock, &hash_write_site, held);
+    }
     
-    for (size_t i = 0; i < space->atom_count; i++) {
-        if (space->atoms[i] && space->atoms[i]->atom->name &&
-            strcmp(space->atoms[i]->atom->name, name) == 0) {
-            result[idx++] = space->atoms[i];
-            atom_retain(space->atoms[i]);
-        }
+    value_trim_t** trims = NULL;
+    if (txn->update_count > 0) trims = malloc(txn->update_count * sizeof(value_trim_t*));
+    for (size_t i = 0; i < txn->update_count; i++) {
+        txn_update_t* update = &txn->updates[i];
+        trims[i] = atom_apply_values(update->handle, update->has_tv ? &update->tv : NULL,
+                                     update->has_av ? &update->av : NULL, version, true,
+                                     feed == FEED_NONE ? FEED_NONE : feed + txn->created_count + i);
+    }
+    mvcc_write_end();
+    for (size_t i = 0; i < txn->update_count; i++) {
+        value_unclaim(claims[i]);
     }
+    free(claims);
     
-    *count = matches;
-    return result;
+    /* Retiring may run reclamation, which takes the write lock */
+    retired_arrays_release(&retired);
+    for (size_t i = 0; i < txn->update_count; i++) {
+        if (trims[i]) trim_retire(trims[i]);
+    }
+    free(trims);
+    
+    memory_accounting_t* acc = (memory_accounting_t*)space->memory_accounting;
+    for (size_t i = 0; i < txn->created_count; i++) {
+        memory_account_atom(acc, txn->created[i]->atom->type, 1);
+    }
+    
+    TRACE_POINT(txn_commit, TRACE_TXN_COMMIT, TRACE_PHASE_INSTANT, version,
+                txn->created_count + txn->update_count);
+    STATS_END(STATS_OP_COMMIT, start);
+    txn_free(txn);
+    return 0;
 }
 
-/* Pattern matching */
-atom_handle_t** atomspace_match_pattern(atomspace_t* space, pattern_matcher_fn matcher,
-                                       void* user_data, size_t* count) {
-    if (!space || !matcher || !count) return NULL;
+void atomspace_txn_abort(atomspace_txn_t* txn) {
+    if (!txn) return;
+    memory_accounting_t* acc = (memory_accounting_t*)txn->space->memory_accounting;
     
-    size_t matches = 0;
-    for (size_t i = 0; i < space->atom_count; i++) {
-        if (space->atoms[i] && matcher(space->atoms[i], user_data)) {
-            matches++;
-        }
+    /* Newest first, so staged links drop their staged targets before those go */
+    for (size_t i = txn->created_count; i > 0; i--) {
+        atom_account_release(acc, txn->created[i - 1]->atom);
+        atom_release(txn->created[i - 1]);
     }
+    txn_free(txn);
+}
+
+/* Memory accounting */
+void atomspace_memory_layout(atomspace_t* space, atomspace_memory_t* out) {
+    hash_table_t* table = (hash_table_t*)space->lookup_table;
     
-    atom_handle_t** result = malloc(sizeof(atom_handle_t*) * matches);
-    size_t idx = 0;
+    /* Arrays are replaced and slabs added under the write lock */
+    uint64_t held = lockprof_rdlock(&table->lock, &hash_read_site);
+    out->categories[MEMORY_ATOM_INDEX].count = 1;
+    out->categories[MEMORY_ATOM_INDEX].requested = space->atom_count * sizeof(atom_handle_t*);
+    out->categories[MEMORY_ATOM_INDEX].allocated = malloc_usable_size(space->atoms);
     
-    for (size_t i = 0; i < space->atom_count; i++) {
-        if (space->atoms[i] && matcher(space->atoms[i], user_data)) {
-            result[idx++] = space->atoms[i];
-            atom_retain(space->atoms[i]);
-        }
+    /* Type buckets hold a second pointer per atom */
+    type_bucket_t* buckets = (type_bucket_t*)space->type_index;
+    for (int t = 0; t < ATOM_TYPE_MAX; t++) {
+        if (!buckets[t].atoms) continue;
+        out->categories[MEMORY_ATOM_INDEX].count++;
+        out->categories[MEMORY_ATOM_INDEX].requested += buckets[t].count * sizeof(atom_handle_t*);
+        out->categories[MEMORY_ATOM_INDEX].allocated += malloc_usable_size(buckets[t].atoms);
     }
     
-    *count = matches;
-    return result;
+    /* Buckets and unused slab capacity; memory_accounting_read() adds one entry per atom */
+    size_t slab_bytes = 0;
+    for (hash_slab_t* slab = table->slabs; slab; slab = slab->next) {
+        slab_bytes += malloc_usable_size(slab);
+    }
+    out->categories[MEMORY_HASH_TABLE].count = 1;
+    out->categories[MEMORY_HASH_TABLE].requested = sizeof(hash_table_t);
+    out->categories[MEMORY_HASH_TABLE].allocated = malloc_usable_size(table) + slab_bytes -
+                                                   table->live_entries * sizeof(hash_entry_t);
+    lockprof_rwlock_unlock(&table->lock, &hash_read_site, held);
+    
+    vector_index_memory((vector_index_t*)space->vector_index, &out->categories[MEMORY_VECTORS]);
+    name_index_memory((name_index_t*)space->name_index, &out->categories[MEMORY_NAME_INDEX]);
+    time_index_memory((time_index_t*)space->time_index, &out->categories[MEMORY_TIME_INDEX]);
+    query_cache_memory((query_cache_t*)space->query_cache, &out->categories[MEMORY_QUERY_CACHE]);
+    memory_accounting_read((memory_accounting_t*)space->memory_accounting, out,
+                           sizeof(hash_entry_t));
 }
 
 /* Distributed operations - stubs for now */
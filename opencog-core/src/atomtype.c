@@ -0,0 +1,127 @@
+/*
+ * OpenCog Atom Types
+ * Runtime-extensible type hierarchy with precomputed subtype sets
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "../include/atomtype.h"
+
+#define BIT(type) ATOM_TYPE_BIT(ATOM_TYPE_##type)
+#define NODE_SUBTYPES (BIT(CONCEPT) | BIT(PREDICATE) | BIT(VARIABLE))
+#define LINK_SUBTYPES (BIT(EVALUATION) | BIT(EXECUTION) | BIT(AND) | BIT(OR) | BIT(NOT) | \
+                       BIT(IMPLICATION) | BIT(EQUIVALENCE))
+
+/* Built-in types are static so lookups never wait for initialization */
+atom_type_set_t atom_type_ancestors[ATOM_TYPE_MAX] = {
+    [ATOM_TYPE_CONCEPT] = BIT(CONCEPT) | BIT(NODE),
+    [ATOM_TYPE_PREDICATE] = BIT(PREDICATE) | BIT(NODE),
+    [ATOM_TYPE_LINK] = BIT(LINK),
+    [ATOM_TYPE_NODE] = BIT(NODE),
+    [ATOM_TYPE_VARIABLE] = BIT(VARIABLE) | BIT(NODE),
+    [ATOM_TYPE_EVALUATION] = BIT(EVALUATION) | BIT(LINK),
+    [ATOM_TYPE_EXECUTION] = BIT(EXECUTION) | BIT(LINK),
+    [ATOM_TYPE_CUSTOM] = BIT(CUSTOM),
+    [ATOM_TYPE_AND] = BIT(AND) | BIT(LINK),
+    [ATOM_TYPE_OR] = BIT(OR) | BIT(LINK),
+    [ATOM_TYPE_NOT] = BIT(NOT) | BIT(LINK),
+    [ATOM_TYPE_IMPLICATION] = BIT(IMPLICATION) | BIT(LINK),
+    [ATOM_TYPE_EQUIVALENCE] = BIT(EQUIVALENCE) | BIT(LINK),
+};
+
+atom_type_set_t atom_type_descendants[ATOM_TYPE_MAX] = {
+    [ATOM_TYPE_CONCEPT] = BIT(CONCEPT),
+    [ATOM_TYPE_PREDICATE] = BIT(PREDICATE),
+    [ATOM_TYPE_LINK] = BIT(LINK) | LINK_SUBTYPES,
+    [ATOM_TYPE_NODE] = BIT(NODE) | NODE_SUBTYPES,
+    [ATOM_TYPE_VARIABLE] = BIT(VARIABLE),
+    [ATOM_TYPE_EVALUATION] = BIT(EVALUATION),
+    [ATOM_TYPE_EXECUTION] = BIT(EXECUTION),
+    [ATOM_TYPE_CUSTOM] = BIT(CUSTOM),
+    [ATOM_TYPE_AND] = BIT(AND),
+    [ATOM_TYPE_OR] = BIT(OR),
+    [ATOM_TYPE_NOT] = BIT(NOT),
+    [ATOM_TYPE_IMPLICATION] = BIT(IMPLICATION),
+    [ATOM_TYPE_EQUIVALENCE] = BIT(EQUIVALENCE),
+};
+
+static const char* type_names[ATOM_TYPE_MAX] = {
+    "concept", "predicate", "link", "node", "variable", "evaluation", "execution", "custom",
+    "and", "or", "not", "implication", "equivalence"
+};
+
+static int type_parents[ATOM_TYPE_MAX] = {
+    [ATOM_TYPE_CONCEPT] = ATOM_TYPE_NODE,
+    [ATOM_TYPE_PREDICATE] = ATOM_TYPE_NODE,
+    [ATOM_TYPE_LINK] = -1,
+    [ATOM_TYPE_NODE] = -1,
+    [ATOM_TYPE_VARIABLE] = ATOM_TYPE_NODE,
+    [ATOM_TYPE_EVALUATION] = ATOM_TYPE_LINK,
+    [ATOM_TYPE_EXECUTION] = ATOM_TYPE_LINK,
+    [ATOM_TYPE_CUSTOM] = -1,
+    [ATOM_TYPE_AND] = ATOM_TYPE_LINK,
+    [ATOM_TYPE_OR] = ATOM_TYPE_LINK,
+    [ATOM_TYPE_NOT] = ATOM_TYPE_LINK,
+    [ATOM_TYPE_IMPLICATION] = ATOM_TYPE_LINK,
+    [ATOM_TYPE_EQUIVALENCE] = ATOM_TYPE_LINK,
+};
+
+static size_t type_count = ATOM_TYPE_COUNT;
+static pthread_mutex_t register_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int lookup_locked(const char* name, size_t count) {
+    for (size_t t = 0; t < count; t++) {
+        if (strcmp(type_names[t], name) == 0) return (int)t;
+    }
+    return -1;
+}
+
+int atom_type_register(const char* name, atom_type_t parent) {
+    if (!name || !*name || !atom_type_valid(parent)) return -1;
+
+    pthread_mutex_lock(&register_lock);
+    size_t count = type_count;
+    if (count == ATOM_TYPE_MAX || lookup_locked(name, count) >= 0) {
+        pthread_mutex_unlock(&register_lock);
+        return -1;
+    }
+    char* copy = strdup(name);
+    if (!copy) {
+        pthread_mutex_unlock(&register_lock);
+        return -1;
+    }
+
+    atom_type_t type = (atom_type_t)count;
+    atom_type_set_t ancestors = atom_type_ancestors[parent] | ATOM_TYPE_BIT(type);
+    type_names[type] = copy;
+    type_parents[type] = parent;
+    atom_type_descendants[type] = ATOM_TYPE_BIT(type);
+    /* Publishing the ancestor set makes the type valid */
+    __atomic_store_n(&atom_type_ancestors[type], ancestors, __ATOMIC_RELEASE);
+    for (size_t t = 0; t < count; t++) {
+        if (ancestors & ATOM_TYPE_BIT(t)) {
+            __atomic_fetch_or(&atom_type_descendants[t], ATOM_TYPE_BIT(type), __ATOMIC_RELEASE);
+        }
+    }
+    __atomic_store_n(&type_count, count + 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&register_lock);
+    return (int)type;
+}
+
+int atom_type_lookup(const char* name) {
+    if (!name) return -1;
+    return lookup_locked(name, atom_type_count());
+}
+
+const char* atom_type_name(atom_type_t type) {
+    return atom_type_valid(type) ? type_names[type] : NULL;
+}
+
+int atom_type_parent(atom_type_t type) {
+    return atom_type_valid(type) ? type_parents[type] : -1;
+}
+
+size_t atom_type_count(void) {
+    return __atomic_load_n(&type_count, __ATOMIC_ACQUIRE);
+}
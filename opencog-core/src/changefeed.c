@@ -0,0 +1,185 @@
+/*
+ * OpenCog Change Feed
+ * Lock-free multi-producer broadcast log of atom mutations
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "../include/changefeed.h"
+
+#define DEFAULT_FEED_EVENTS 65536
+
+/* Set in a slot's sequence while its event is being written */
+#define SLOT_BUSY (1ULL << 63)
+
+bool changefeed_active = false;
+
+typedef struct {
+    uint64_t sequence;            /* Sequence of the event held, | SLOT_BUSY while writing */
+    change_event_t event;
+} feed_slot_t;
+
+static pthread_mutex_t feed_lock = PTHREAD_MUTEX_INITIALIZER;
+static feed_slot_t* feed_slots = NULL;
+static size_t feed_capacity = 0;      /* Power of two */
+static uint64_t feed_head = 0;        /* Positions ever claimed */
+
+struct changefeed_subscription {
+    uint64_t cursor;
+    uint64_t dropped;
+    uint32_t kinds;
+    atom_type_set_t types;
+    uint32_t space_id;
+    uint64_t name_hash;
+    char* name;
+};
+
+static uint64_t name_hash(const char* name) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (const unsigned char* p = (const unsigned char*)name; *p; p++) {
+        hash = (hash ^ *p) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/* Feed control */
+int changefeed_start(size_t capacity) {
+    pthread_mutex_lock(&feed_lock);
+    if (!feed_slots) {
+        size_t wanted = capacity ? capacity : DEFAULT_FEED_EVENTS;
+        size_t size = 1;
+        while (size < wanted) size <<= 1;
+        feed_slots = calloc(size, sizeof(feed_slot_t));
+        if (!feed_slots) {
+            pthread_mutex_unlock(&feed_lock);
+            return -1;
+        }
+        /* No slot holds sequence 0 yet */
+        for (size_t i = 0; i < size; i++) {
+            feed_slots[i].sequence = SLOT_BUSY - 1;
+        }
+        __atomic_store_n(&feed_capacity, size, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&feed_lock);
+
+    /* A log that already exists keeps its original size */
+    __atomic_store_n(&changefeed_active, true, __ATOMIC_RELEASE);
+    return 0;
+}
+
+void changefeed_stop(void) {
+    __atomic_store_n(&changefeed_active, false, __ATOMIC_RELEASE);
+}
+
+uint64_t changefeed_head(void) {
+    return __atomic_load_n(&feed_head, __ATOMIC_ACQUIRE);
+}
+
+/* Writer side */
+uint64_t changefeed_claim(size_t count) {
+    return __atomic_fetch_add(&feed_head, count, __ATOMIC_ACQ_REL);
+}
+
+void changefeed_publish(uint64_t sequence, change_kind_t kind, const atom_t* atom,
+                        const truth_value_t* tv, const attention_value_t* av, uint64_t version) {
+    if (!feed_slots) return;
+    feed_slot_t* slot = &feed_slots[sequence & (feed_capacity - 1)];
+
+    __atomic_store_n(&slot->sequence, sequence | SLOT_BUSY, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    change_event_t* event = &slot->event;
+    event->sequence = sequence;
+    event->version = version;
+    event->atom_id = atom->id;
+    event->tv = *tv;
+    event->av = *av;
+    event->kind = (uint8_t)kind;
+    event->type = (uint8_t)atom->type;
+    event->arity = (uint32_t)atom->outgoing_count;
+    event->space_id = atom->space_id;
+    if (atom->name) {
+        event->name_hash = name_hash(atom->name);
+        strncpy(event->name, atom->name, CHANGE_NAME_MAX - 1);
+        event->name[CHANGE_NAME_MAX - 1] = '\0';
+    } else {
+        event->name_hash = 0;
+        event->name[0] = '\0';
+    }
+
+    __atomic_store_n(&slot->sequence, sequence, __ATOMIC_RELEASE);
+}
+
+/* Subscribers */
+changefeed_subscription_t* changefeed_subscribe(const change_filter_t* filter) {
+    changefeed_subscription_t* sub = calloc(1, sizeof(changefeed_subscription_t));
+    sub->cursor = changefeed_head();
+    if (filter) {
+        sub->kinds = filter->kinds;
+        sub->types = filter->types;
+        sub->space_id = filter->space_id;
+        if (filter->name) {
+            sub->name = strdup(filter->name);
+            sub->name_hash = name_hash(filter->name);
+        }
+    }
+    return sub;
+}
+
+void changefeed_unsubscribe(changefeed_subscription_t* sub) {
+    if (!sub) return;
+    free(sub->name);
+    free(sub);
+}
+
+static bool event_matches(const changefeed_subscription_t* sub, const change_event_t* event) {
+    if (sub->kinds && !(sub->kinds & (1u << event->kind))) return false;
+    if (sub->types && !(sub->types & ATOM_TYPE_BIT(event->type))) return false;
+    if (sub->space_id && sub->space_id != event->space_id) return false;
+    if (sub->name) {
+        return event->name_hash == sub->name_hash &&
+               strncmp(event->name, sub->name, CHANGE_NAME_MAX - 1) == 0;
+    }
+    return true;
+}
+
+size_t changefeed_poll(changefeed_subscription_t* sub, change_event_t* out, size_t max) {
+    size_t capacity = __atomic_load_n(&feed_capacity, __ATOMIC_ACQUIRE);
+    if (!sub || !out || capacity == 0) return 0;
+
+    uint64_t head = changefeed_head();
+    size_t copied = 0;
+    while (copied < max && sub->cursor < head) {
+        uint64_t cursor = sub->cursor;
+        if (head - cursor > capacity) {
+            sub->dropped += head - capacity - cursor;
+            sub->cursor = head - capacity;
+            continue;
+        }
+
+        feed_slot_t* slot = &feed_slots[cursor & (capacity - 1)];
+        uint64_t seen = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        if ((seen & ~SLOT_BUSY) > cursor && seen != SLOT_BUSY - 1) {
+            /* Lapped by a writer */
+            sub->dropped++;
+            sub->cursor++;
+            continue;
+        }
+        if (seen != cursor) break;      /* Claimed but not yet published */
+
+        change_event_t event = slot->event;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        sub->cursor++;
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) != cursor) {
+            sub->dropped++;
+            continue;
+        }
+        if (event_matches(sub, &event)) out[copied++] = event;
+    }
+    return copied;
+}
+
+uint64_t changefeed_dropped(const changefeed_subscription_t* sub) {
+    return sub ? sub->dropped : 0;
+}
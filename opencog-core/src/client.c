@@ -0,0 +1,281 @@
+/*
+ * OpenCog AtomSpace Client
+ * Pipelined requests to an AtomSpace server over a Unix domain socket
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../include/client.h"
+
+#define CLIENT_BUFFER_INITIAL 65536
+
+struct client {
+    int fd;
+    uint32_t next_tag;
+    char* out;
+    size_t out_length;
+    size_t out_capacity;
+    char* in;
+    size_t in_start;          /* Start of the next unread frame */
+    size_t in_length;
+    size_t in_capacity;
+};
+
+client_t* client_connect(const char* path) {
+    if (!path) path = PROTO_DEFAULT_PATH;
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) return NULL;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return NULL;
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    client_t* client = calloc(1, sizeof(client_t));
+    client->fd = fd;
+    client->next_tag = 1;
+    return client;
+}
+
+void client_close(client_t* client) {
+    if (!client) return;
+    close(client->fd);
+    free(client->out);
+    free(client->in);
+    free(client);
+}
+
+static void* grow(char** data, size_t* capacity, size_t needed) {
+    if (needed > *capacity) {
+        size_t size = *capacity ? *capacity : CLIENT_BUFFER_INITIAL;
+        while (size < needed) size *= 2;
+        *data = realloc(*data, size);
+        *capacity = size;
+    }
+    return *data;
+}
+
+/* Pipelined interface */
+uint32_t client_send(client_t* client, uint32_t stream, uint8_t op, const void* payload, uint32_t length) {
+    proto_header_t header = { length, stream, client->next_tag++, op, 0, 0 };
+    grow(&client->out, &client->out_capacity, client->out_length + sizeof(header) + length);
+    memcpy(client->out + client->out_length, &header, sizeof(header));
+    if (length) memcpy(client->out + client->out_length + sizeof(header), payload, length);
+    client->out_length += sizeof(header) + length;
+    return header.tag;
+}
+
+int client_flush(client_t* client) {
+    size_t sent = 0;
+    while (sent < client->out_length) {
+        ssize_t n = send(client->fd, client->out + sent, client->out_length - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            client->out_length = 0;
+            return -1;
+        }
+        sent += (size_t)n;
+    }
+    client->out_length = 0;
+    return 0;
+}
+
+int client_recv(client_t* client, proto_header_t* header, const void** payload) {
+    /* Drop the frame returned last time */
+    if (client->in_start > 0) {
+        memmove(client->in, client->in + client->in_start, client->in_length - client->in_start);
+        client->in_length -= client->in_start;
+        client->in_start = 0;
+    }
+
+    for (;;) {
+        if (client->in_length >= sizeof(proto_header_t)) {
+            memcpy(header, client->in, sizeof(*header));
+            if (header->length > PROTO_MAX_PAYLOAD) return -1;
+            if (client->in_length >= sizeof(*header) + header->length) {
+                if (payload) *payload = client->in + sizeof(*header);
+                client->in_start = sizeof(*header) + header->length;
+                return 0;
+            }
+        }
+
+        grow(&client->in, &client->in_capacity, client->in_length + CLIENT_BUFFER_INITIAL);
+        ssize_t n = recv(client->fd, client->in + client->in_length, client->in_capacity - client->in_length, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        client->in_length += (size_t)n;
+    }
+}
+
+/* Send one request and wait for its reply */
+static int call(client_t* client, uint8_t op, const void* payload, uint32_t length,
+                proto_header_t* reply, const void** data) {
+    uint32_t tag = client_send(client, 0, op, payload, length);
+    if (client_flush(client) != 0) return -1;
+    do {
+        if (client_recv(client, reply, data) != 0) return -1;
+    } while (reply->tag != tag);
+    return reply->status == PROTO_OK ? 0 : -1;
+}
+
+int client_ping(client_t* client) {
+    proto_header_t reply;
+    return call(client, PROTO_OP_PING, NULL, 0, &reply, NULL);
+}
+
+static uint64_t reply_id(const proto_header_t* reply, const void* data) {
+    uint64_t id = 0;
+    if (reply->length == sizeof(id)) memcpy(&id, data, sizeof(id));
+    return id;
+}
+
+uint64_t client_create_node(client_t* client, atom_type_t type, const char* name) {
+    size_t name_length = name ? strlen(name) : 0;
+    if (name_length > UINT16_MAX) return 0;
+
+    char stack[256];
+    size_t length = sizeof(proto_create_node_t) + name_length;
+    char* payload = length <= sizeof(stack) ? stack : malloc(length);
+    proto_create_node_t node = { (uint8_t)type, 0, (uint16_t)name_length };
+    memcpy(payload, &node, sizeof(node));
+    if (name_length) memcpy(payload + sizeof(node), name, name_length);
+
+    proto_header_t reply;
+    const void* data;
+    int status = call(client, PROTO_OP_CREATE_NODE, payload, (uint32_t)length, &reply, &data);
+    if (payload != stack) free(payload);
+    return status == 0 ? reply_id(&reply, data) : 0;
+}
+
+/* CREATE_LINK and MATCH share a payload layout; NULL if it is too large to send */
+static char* link_payload(atom_type_t type, const uint64_t* ids, uint32_t arity, uint32_t* length) {
+    size_t size = sizeof(proto_create_link_t) + (size_t)arity * sizeof(uint64_t);
+    if (size > PROTO_MAX_PAYLOAD) return NULL;
+    char* payload = malloc(size);
+    proto_create_link_t link = { (uint8_t)type, { 0, 0, 0 }, arity };
+    memcpy(payload, &link, sizeof(link));
+    if (arity) memcpy(payload + sizeof(link), ids, arity * sizeof(uint64_t));
+    *length = (uint32_t)size;
+    return payload;
+}
+
+uint64_t client_create_link(client_t* client, atom_type_t type, const uint64_t* outgoing, uint32_t arity) {
+    uint32_t length;
+    char* payload = link_payload(type, outgoing, arity, &length);
+    if (!payload) return 0;
+    proto_header_t reply;
+    const void* data;
+    int status = call(client, PROTO_OP_CREATE_LINK, payload, length, &reply, &data);
+    free(payload);
+    return status == 0 ? reply_id(&reply, data) : 0;
+}
+
+int client_set_tv(client_t* client, uint64_t id, double strength, double confidence) {
+    proto_set_tv_t set = { id, strength, confidence };
+    proto_header_t reply;
+    return call(client, PROTO_OP_SET_TV, &set, sizeof(set), &reply, NULL);
+}
+
+int client_get_tv(client_t* client, uint64_t id, truth_value_t* tv) {
+    proto_header_t reply;
+    const void* data;
+    if (call(client, PROTO_OP_GET, &id, sizeof(id), &reply, &data) != 0 ||
+        reply.length < sizeof(proto_atom_t)) {
+        return -1;
+    }
+    proto_atom_t atom;
+    memcpy(&atom, data, sizeof(atom));
+    if (tv) *tv = atom.tv;
+    return 0;
+}
+
+int client_remove(client_t* client, uint64_t id) {
+    proto_header_t reply;
+    return call(client, PROTO_OP_REMOVE, &id, sizeof(id), &reply, NULL);
+}
+
+/* Send an ID list request and join its frames (protocol.h) */
+static uint64_t* call_ids(client_t* client, uint8_t op, const void* payload, uint32_t length,
+                          size_t* count) {
+    uint32_t tag = client_send(client, 0, op, payload, length);
+    if (client_flush(client) != 0) return NULL;
+
+    uint64_t* ids = NULL;
+    size_t total = 0;
+    proto_header_t reply;
+    do {
+        const void* data;
+        do {
+            if (client_recv(client, &reply, &data) != 0) {
+                free(ids);
+                return NULL;
+            }
+        } while (reply.tag != tag);
+        if (reply.status != PROTO_OK) {
+            free(ids);
+            return NULL;
+        }
+        size_t n = reply.length / sizeof(uint64_t);
+        ids = realloc(ids, (total + n ? total + n : 1) * sizeof(uint64_t));
+        memcpy(ids + total, data, n * sizeof(uint64_t));
+        total += n;
+    } while (reply.flags & PROTO_FLAG_MORE);
+    *count = total;
+    return ids;
+}
+
+uint64_t* client_query_type(client_t* client, atom_type_t type, size_t* count) {
+    if (!count) return NULL;
+    *count = 0;
+    uint8_t payload = (uint8_t)type;
+    return call_ids(client, PROTO_OP_QUERY_TYPE, &payload, 1, count);
+}
+
+uint64_t* client_query_name(client_t* client, const char* name, size_t* count) {
+    if (!count || !name) return NULL;
+    *count = 0;
+    size_t length = strlen(name);
+    if (length > PROTO_MAX_PAYLOAD) return NULL;
+    return call_ids(client, PROTO_OP_QUERY_NAME, name, (uint32_t)length, count);
+}
+
+uint64_t* client_match(client_t* client, atom_type_t type, const uint64_t* pattern,
+                       uint32_t arity, size_t* count) {
+    if (!count) return NULL;
+    *count = 0;
+    uint32_t length;
+    char* payload = link_payload(type, pattern, arity, &length);
+    if (!payload) return NULL;
+    uint64_t* ids = call_ids(client, PROTO_OP_MATCH, payload, length, count);
+    free(payload);
+    return ids;
+}
+
+int client_subscribe(client_t* client, uint32_t stream, const change_filter_t* filter) {
+    size_t name_length = (filter && filter->name) ? strlen(filter->name) : 0;
+    proto_subscribe_t subscribe = { filter ? filter->kinds : 0, (uint32_t)name_length,
+                                    filter ? filter->types : 0 };
+    char* payload = malloc(sizeof(subscribe) + name_length);
+    memcpy(payload, &subscribe, sizeof(subscribe));
+    if (name_length) memcpy(payload + sizeof(subscribe), filter->name, name_length);
+
+    uint32_t tag = client_send(client, stream, PROTO_OP_SUBSCRIBE, payload,
+                               (uint32_t)(sizeof(subscribe) + name_length));
+    free(payload);
+    if (client_flush(client) != 0) return -1;
+
+    proto_header_t reply;
+    do {
+        if (client_recv(client, &reply, NULL) != 0) return -1;
+    } while (reply.tag != tag || reply.op != PROTO_OP_SUBSCRIBE);
+    return reply.status == PROTO_OK ? 0 : -1;
+}
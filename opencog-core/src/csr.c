@@ -0,0 +1,338 @@
+/*
+ * OpenCog CSR Export
+ * Frozen compressed sparse row views of the atom graph, built in parallel
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "../include/csr.h"
+
+#define CSR_ALIGN 64                  /* Arrays start on a cache line */
+#define CSR_MIN_SLOTS_PER_THREAD 4096
+#define CSR_PREFETCH 8                /* Slots ahead whose atom is prefetched */
+
+/* The public view plus the slot map atomspace_csr_vertex() reads */
+typedef struct {
+    atomspace_csr_t csr;
+    uint32_t* vertex_of_slot;
+    size_t slot_count;
+} csr_graph_t;
+
+typedef enum {
+    PHASE_COUNT,                  /* Vertices and out edges per chunk of slots */
+    PHASE_ASSIGN,                 /* Vertex numbers, columns and out offsets */
+    PHASE_OUT_EDGES,              /* Out edges and in degrees */
+    PHASE_IN_EDGES,               /* Scatter out edges into in lists */
+    PHASE_IN_SORT                 /* Order each in list by source */
+} build_phase_t;
+
+typedef struct {
+    csr_graph_t* graph;
+    const atomspace_snapshot_t* snapshot;
+    atom_handle_t* const* slots;
+    unsigned workers;
+    build_phase_t phase;
+    size_t chunk_vertices[CSR_MAX_THREADS];   /* Counts, then first vertex of each chunk */
+    uint64_t chunk_edges[CSR_MAX_THREADS];    /* Counts, then first edge of each chunk */
+    uint64_t* in_cursor;                      /* Next free in-edge position per vertex */
+} csr_build_t;
+
+typedef struct {
+    csr_build_t* build;
+    unsigned worker;
+} csr_worker_t;
+
+static void* csr_alloc(size_t bytes) {
+    bytes = (bytes + CSR_ALIGN - 1) / CSR_ALIGN * CSR_ALIGN;
+    return aligned_alloc(CSR_ALIGN, bytes ? bytes : CSR_ALIGN);
+}
+
+/*
+ * Atoms are only removed once no link holds them, so every member of a
+ * link visible at the version is visible too and each outgoing entry is
+ * an edge; the member atoms are touched once, when edges are written.
+ */
+static inline bool slot_visible(const csr_build_t* build, size_t slot) {
+    atom_handle_t* handle = build->slots[slot];
+    return handle && atom_visible_at(handle->atom, build->snapshot->version);
+}
+
+static void count_chunk(csr_build_t* build, size_t begin, size_t end, unsigned worker) {
+    size_t vertices = 0;
+    uint64_t edges = 0;
+    for (size_t s = begin; s < end; s++) {
+        if (s + CSR_PREFETCH < end && build->slots[s + CSR_PREFETCH]) {
+            __builtin_prefetch(build->slots[s + CSR_PREFETCH]->atom);
+        }
+        if (!slot_visible(build, s)) continue;
+        vertices++;
+        edges += build->slots[s]->atom->outgoing_count;
+    }
+    build->chunk_vertices[worker] = vertices;
+    build->chunk_edges[worker] = edges;
+}
+
+static void assign_chunk(csr_build_t* build, size_t begin, size_t end, unsigned worker) {
+    atomspace_csr_t* csr = &build->graph->csr;
+    uint32_t vertex = (uint32_t)build->chunk_vertices[worker];
+    uint64_t edge = build->chunk_edges[worker];
+    for (size_t s = begin; s < end; s++) {
+        if (s + CSR_PREFETCH < end && build->slots[s + CSR_PREFETCH]) {
+            __builtin_prefetch(build->slots[s + CSR_PREFETCH]->atom);
+        }
+        if (!slot_visible(build, s)) {
+            build->graph->vertex_of_slot[s] = CSR_NO_VERTEX;
+            continue;
+        }
+        atom_handle_t* handle = build->slots[s];
+        atom_t* atom = handle->atom;
+        build->graph->vertex_of_slot[s] = vertex;
+        csr->ids[vertex] = atom->id;
+        if (csr->types) csr->types[vertex] = (uint8_t)atom->type;
+        if (csr->strengths) {
+            truth_value_t tv = atomspace_snapshot_get_tv(build->snapshot, handle);
+            csr->strengths[vertex] = (float)tv.strength;
+            csr->confidences[vertex] = (float)tv.confidence;
+        }
+        csr->out_offsets[vertex] = edge;
+        edge += atom->outgoing_count;
+        vertex++;
+    }
+}
+
+/*
+ * Reaching a member's slot takes four dependent loads: link atom, outgoing
+ * array, member handle, member atom. Prefetching each one a few slots
+ * ahead of the next lets the misses of several links overlap.
+ */
+static inline void prefetch_members(const csr_build_t* build, size_t s, size_t end) {
+    atom_handle_t* const* slots = build->slots;
+    if (s + 4 * CSR_PREFETCH < end && slots[s + 4 * CSR_PREFETCH]) {
+        __builtin_prefetch(slots[s + 4 * CSR_PREFETCH]->atom);
+    }
+    if (s + 3 * CSR_PREFETCH < end && slots[s + 3 * CSR_PREFETCH]) {
+        __builtin_prefetch(slots[s + 3 * CSR_PREFETCH]->atom->outgoing);
+    }
+    if (s + 2 * CSR_PREFETCH < end && slots[s + 2 * CSR_PREFETCH]) {
+        const atom_t* atom = slots[s + 2 * CSR_PREFETCH]->atom;
+        for (size_t k = 0; k < atom->outgoing_count; k++) __builtin_prefetch(atom->outgoing[k]);
+    }
+    if (s + CSR_PREFETCH < end && slots[s + CSR_PREFETCH]) {
+        const atom_t* atom = slots[s + CSR_PREFETCH]->atom;
+        for (size_t k = 0; k < atom->outgoing_count; k++) __builtin_prefetch(atom->outgoing[k]->atom);
+    }
+}
+
+static void out_edges_chunk(csr_build_t* build, size_t begin, size_t end) {
+    atomspace_csr_t* csr = &build->graph->csr;
+    const uint32_t* vertex_of_slot = build->graph->vertex_of_slot;
+    for (size_t s = begin; s < end; s++) {
+        prefetch_members(build, s, end);
+        uint32_t vertex = vertex_of_slot[s];
+        if (vertex == CSR_NO_VERTEX) continue;
+        atom_t* atom = build->slots[s]->atom;
+        uint64_t edge = csr->out_offsets[vertex];
+        for (size_t k = 0; k < atom->outgoing_count; k++) {
+            uint32_t target = vertex_of_slot[atom->outgoing[k]->atom->slot];
+            csr->out_edges[edge++] = target;
+            __atomic_fetch_add(&csr->in_offsets[target + 1], 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void in_edges_chunk(csr_build_t* build, uint32_t begin, uint32_t end) {
+    atomspace_csr_t* csr = &build->graph->csr;
+    for (uint32_t v = begin; v < end; v++) {
+        for (uint64_t e = csr->out_offsets[v]; e < csr->out_offsets[v + 1]; e++) {
+            uint64_t at = __atomic_fetch_add(&build->in_cursor[csr->out_edges[e]], 1, __ATOMIC_RELAXED);
+            csr->in_edges[at] = v;
+        }
+    }
+}
+
+static int compare_vertex(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return x < y ? -1 : (x > y);
+}
+
+static void in_sort_chunk(csr_build_t* build, uint32_t begin, uint32_t end) {
+    atomspace_csr_t* csr = &build->graph->csr;
+    for (uint32_t v = begin; v < end; v++) {
+        uint32_t* list = csr->in_edges + csr->in_offsets[v];
+        size_t count = csr->in_offsets[v + 1] - csr->in_offsets[v];
+        if (count > 32) {
+            qsort(list, count, sizeof(uint32_t), compare_vertex);
+            continue;
+        }
+        for (size_t i = 1; i < count; i++) {
+            uint32_t source = list[i];
+            size_t j = i;
+            for (; j > 0 && list[j - 1] > source; j--) list[j] = list[j - 1];
+            list[j] = source;
+        }
+    }
+}
+
+/* Worker `worker` of `workers` takes one contiguous share of slots or vertices */
+static void* run_worker(void* arg) {
+    csr_worker_t* w = (csr_worker_t*)arg;
+    csr_build_t* build = w->build;
+    size_t slots = build->graph->slot_count;
+    size_t vertices = build->graph->csr.vertex_count;
+    size_t slot_begin = slots * w->worker / build->workers;
+    size_t slot_end = slots * (w->worker + 1) / build->workers;
+    uint32_t vertex_begin = (uint32_t)(vertices * w->worker / build->workers);
+    uint32_t vertex_end = (uint32_t)(vertices * (w->worker + 1) / build->workers);
+
+    switch (build->phase) {
+    case PHASE_COUNT:
+        count_chunk(build, slot_begin, slot_end, w->worker);
+        break;
+    case PHASE_ASSIGN:
+        assign_chunk(build, slot_begin, slot_end, w->worker);
+        break;
+    case PHASE_OUT_EDGES:
+        out_edges_chunk(build, slot_begin, slot_end);
+        break;
+    case PHASE_IN_EDGES:
+        in_edges_chunk(build, vertex_begin, vertex_end);
+        break;
+    case PHASE_IN_SORT:
+        in_sort_chunk(build, vertex_begin, vertex_end);
+        break;
+    }
+    return NULL;
+}
+
+/*
+ * Run one phase on every worker; the calling thread is worker 0. Helpers
+ * need no read section of their own: the caller's snapshot keeps every
+ * atom they touch from being reclaimed. A helper that cannot be started
+ * has its share run on the calling thread.
+ */
+static void run_phase(csr_build_t* build, build_phase_t phase) {
+    pthread_t threads[CSR_MAX_THREADS];
+    bool started[CSR_MAX_THREADS] = { false };
+    csr_worker_t workers[CSR_MAX_THREADS];
+    build->phase = phase;
+    for (unsigned i = 0; i < build->workers; i++) {
+        workers[i].build = build;
+        workers[i].worker = i;
+        if (i > 0) started[i] = pthread_create(&threads[i], NULL, run_worker, &workers[i]) == 0;
+    }
+    run_worker(&workers[0]);
+    for (unsigned i = 1; i < build->workers; i++) {
+        if (started[i]) pthread_join(threads[i], NULL);
+        else run_worker(&workers[i]);
+    }
+}
+
+void atomspace_csr_free(atomspace_csr_t* csr) {
+    if (!csr) return;
+    csr_graph_t* graph = (csr_graph_t*)csr;
+    free(csr->ids);
+    free(csr->out_offsets);
+    free(csr->out_edges);
+    free(csr->in_offsets);
+    free(csr->in_edges);
+    free(csr->types);
+    free(csr->strengths);
+    free(csr->confidences);
+    free(graph->vertex_of_slot);
+    free(graph);
+}
+
+atomspace_csr_t* atomspace_csr_build(atomspace_t* space, uint32_t flags, unsigned threads) {
+    if (!space || (flags & ~(uint32_t)(CSR_WITH_TYPES | CSR_WITH_TV))) return NULL;
+    csr_graph_t* graph = calloc(1, sizeof(csr_graph_t));
+    if (!graph) return NULL;
+    atomspace_csr_t* csr = &graph->csr;
+
+    atomspace_snapshot_t* snapshot = atomspace_snapshot_begin(space);
+    csr_build_t build;
+    memset(&build, 0, sizeof(build));
+    build.graph = graph;
+    build.snapshot = snapshot;
+    build.slots = atomspace_scan_slots(space, &graph->slot_count);
+    csr->version = snapshot->version;
+
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (unsigned)online : 1;
+    }
+    size_t useful = graph->slot_count / CSR_MIN_SLOTS_PER_THREAD;
+    if (threads > useful) threads = useful ? (unsigned)useful : 1;
+    if (threads > CSR_MAX_THREADS) threads = CSR_MAX_THREADS;
+    build.workers = threads;
+
+    run_phase(&build, PHASE_COUNT);
+    size_t vertices = 0;
+    uint64_t edges = 0;
+    for (unsigned w = 0; w < build.workers; w++) {
+        size_t chunk_vertices = build.chunk_vertices[w];
+        uint64_t chunk_edges = build.chunk_edges[w];
+        build.chunk_vertices[w] = vertices;
+        build.chunk_edges[w] = edges;
+        vertices += chunk_vertices;
+        edges += chunk_edges;
+    }
+    if (vertices >= CSR_NO_VERTEX) goto fail;
+    csr->vertex_count = (uint32_t)vertices;
+    csr->edge_count = edges;
+
+    graph->vertex_of_slot = csr_alloc(graph->slot_count * sizeof(uint32_t));
+    csr->ids = csr_alloc(vertices * sizeof(uint64_t));
+    csr->out_offsets = csr_alloc((vertices + 1) * sizeof(uint64_t));
+    csr->out_edges = csr_alloc(edges * sizeof(uint32_t));
+    csr->in_offsets = csr_alloc((vertices + 1) * sizeof(uint64_t));
+    csr->in_edges = csr_alloc(edges * sizeof(uint32_t));
+    build.in_cursor = csr_alloc(vertices * sizeof(uint64_t));
+    bool allocated = graph->vertex_of_slot && csr->ids && csr->out_offsets && csr->out_edges &&
+                     csr->in_offsets && csr->in_edges && build.in_cursor;
+    if (flags & CSR_WITH_TYPES) {
+        csr->types = csr_alloc(vertices);
+        allocated = allocated && csr->types;
+    }
+    if (flags & CSR_WITH_TV) {
+        csr->strengths = csr_alloc(vertices * sizeof(float));
+        csr->confidences = csr_alloc(vertices * sizeof(float));
+        allocated = allocated && csr->strengths && csr->confidences;
+    }
+    if (!allocated) goto fail;
+
+    run_phase(&build, PHASE_ASSIGN);
+    csr->out_offsets[vertices] = edges;
+
+    /* In degrees accumulate in in_offsets[v + 1]; a prefix sum turns them into offsets */
+    memset(csr->in_offsets, 0, (vertices + 1) * sizeof(uint64_t));
+    run_phase(&build, PHASE_OUT_EDGES);
+    for (size_t v = 0; v < vertices; v++) {
+        csr->in_offsets[v + 1] += csr->in_offsets[v];
+    }
+    memcpy(build.in_cursor, csr->in_offsets, vertices * sizeof(uint64_t));
+    run_phase(&build, PHASE_IN_EDGES);
+    run_phase(&build, PHASE_IN_SORT);
+
+    free(build.in_cursor);
+    atomspace_snapshot_end(snapshot);
+    return csr;
+
+fail:
+    free(build.in_cursor);
+    atomspace_snapshot_end(snapshot);
+    atomspace_csr_free(csr);
+    return NULL;
+}
+
+uint32_t atomspace_csr_vertex(const atomspace_csr_t* csr, const atom_handle_t* handle) {
+    if (!csr || !handle) return CSR_NO_VERTEX;
+    const csr_graph_t* graph = (const csr_graph_t*)csr;
+    const atom_t* atom = handle->atom;
+    if (atom->slot >= graph->slot_count) return CSR_NO_VERTEX;
+    uint32_t vertex = graph->vertex_of_slot[atom->slot];
+    if (vertex == CSR_NO_VERTEX || csr->ids[vertex] != atom->id) return CSR_NO_VERTEX;
+    return vertex;
+}
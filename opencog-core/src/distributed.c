@@ -13,7 +13,39 @@
 #include <sys/time.h>
 #include <pthread.h>
 #include <errno.h>
+#include <malloc.h>
 #include "../include/distributed.h"
+#include "../include/memstats.h"
+#include "../include/stats.h"
+#include "../include/lockprof.h"
+#include "../include/trace.h"
+
+LOCKPROF_SITE(shm_mutex_site, "distributed.shm_mutex");
+
+/* Process-wide byte accounting for received messages and shared memory */
+static memory_usage_t message_memory;
+static memory_usage_t shared_memory;
+
+static void account_usage(memory_usage_t* usage, int64_t count, int64_t requested, int64_t allocated) {
+    __atomic_fetch_add(&usage->count, (uint64_t)count, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&usage->requested, (uint64_t)requested, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&usage->allocated, (uint64_t)allocated, __ATOMIC_RELAXED);
+}
+
+static int64_t message_allocated(message_t* msg) {
+    return (int64_t)(malloc_usable_size(msg) + (msg->payload ? malloc_usable_size(msg->payload) : 0));
+}
+
+void distributed_memory_usage(memory_usage_t* messages, memory_usage_t* shared) {
+    memory_usage_t* sources[2] = { &message_memory, &shared_memory };
+    memory_usage_t* targets[2] = { messages, shared };
+    for (int i = 0; i < 2; i++) {
+        if (!targets[i]) continue;
+        targets[i]->count = __atomic_load_n(&sources[i]->count, __ATOMIC_RELAXED);
+        targets[i]->requested = __atomic_load_n(&sources[i]->requested, __ATOMIC_RELAXED);
+        targets[i]->allocated = __atomic_load_n(&sources[i]->allocated, __ATOMIC_RELAXED);
+    }
+}
 
 /* Heartbeat interval in milliseconds */
 #define HEARTBEAT_INTERVAL_MS 1000
@@ -37,6 +69,7 @@ static void* heartbeat_thread_func(void* arg) {
         msg.payload = NULL;
         
         /* Send heartbeat */
+        TRACE_POINT(heartbeat_send, TRACE_HEARTBEAT, TRACE_PHASE_INSTANT, msg.source_node, msg.timestamp);
         distributed_send_message(ctx, &msg);
         
         /* Sleep */
@@ -58,6 +91,8 @@ static void* message_handler_thread_func(void* arg) {
             /* Handle message based on type */
             switch (msg->type) {
                 case MSG_TYPE_HEARTBEAT:
+                    TRACE_POINT(heartbeat_receive, TRACE_HEARTBEAT, TRACE_PHASE_INSTANT,
+                                msg->source_node, msg->timestamp);
                     /* Update node heartbeat */
                     for (size_t i = 0; i < ctx->node_count; i++) {
                         if (ctx->nodes[i]->node_id == msg->source_node) {
@@ -98,6 +133,66 @@ static void* message_handler_thread_func(void* arg) {
     return NULL;
 }
 
+/* System V key for a queue name */
+static key_t message_queue_key(const char* name) {
+    key_t key = ftok(name, 'O');
+    if (key != -1) return key;
+    
+    /* Names that are not existing paths are hashed into a key */
+    uint32_t hash = 2166136261u;
+    for (const char* p = name; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+    return (key_t)((hash & 0x00ffffffu) | ((uint32_t)'O' << 24));
+}
+
+/* Scope of node queue names; empty for the shared default */
+static char queue_scope[64] = "";
+
+void distributed_set_queue_scope(const char* scope) {
+    snprintf(queue_scope, sizeof(queue_scope), "%s", scope ? scope : "");
+}
+
+/* Inbound queue of a node, named after its ID and the queue scope */
+static void node_queue_name(uint32_t node_id, char* name, size_t size) {
+    if (queue_scope[0]) {
+        snprintf(name, size, "/opencog_%s_node_%u", queue_scope, node_id);
+    } else {
+        snprintf(name, size, "/opencog_node_%u", node_id);
+    }
+}
+
+/* Scoped queues belong to one run, so only their owner may use them */
+static message_queue_t* node_queue_get(uint32_t node_id, int flags) {
+    char mq_name[256];
+    node_queue_name(node_id, mq_name, sizeof(mq_name));
+    if (flags & IPC_CREAT) flags |= queue_scope[0] ? 0600 : 0666;
+    int mq_id = msgget(message_queue_key(mq_name), flags);
+    if (mq_id < 0) return NULL;
+    
+    message_queue_t* mq = malloc(sizeof(message_queue_t));
+    mq->mq_id = mq_id;
+    mq->max_messages = 100;
+    mq->max_message_size = 65536;
+    return mq;
+}
+
+static message_queue_t* node_queue_open(uint32_t node_id) {
+    return node_queue_get(node_id, IPC_CREAT);
+}
+
+/* Attach to a peer's queue without creating it; the peer may not be up yet */
+static message_queue_t* node_queue_attach(uint32_t node_id) {
+    return node_queue_get(node_id, 0);
+}
+
+int distributed_remove_node_queue(uint32_t node_id) {
+    message_queue_t* mq = node_queue_attach(node_id);
+    if (!mq) return -1;
+    message_queue_destroy(mq);
+    return 0;
+}
+
 /* Distributed context operations */
 distributed_ctx_t* distributed_create(uint32_t node_id, const char* hostname, uint16_t port) {
     distributed_ctx_t* ctx = calloc(1, sizeof(distributed_ctx_t));
@@ -105,9 +200,7 @@ distributed_ctx_t* distributed_create(uint32_t node_id, const char* hostname, ui
     ctx->running = false;
     
     /* Create message queue */
-    char mq_name[256];
-    snprintf(mq_name, sizeof(mq_name), "/opencog_node_%u", node_id);
-    ctx->mq = message_queue_create(mq_name, 100, 65536);
+    ctx->mq = node_queue_open(node_id);
     
     /* Create shared memory */
     ctx->shm = shared_memory_create(1024 * 1024); /* 1MB */
@@ -124,6 +217,7 @@ void distributed_destroy(distributed_ctx_t* ctx) {
     
     /* Free nodes */
     for (size_t i = 0; i < ctx->node_count; i++) {
+        message_queue_close(ctx->nodes[i]->mq);
         free(ctx->nodes[i]);
     }
     free(ctx->nodes);
@@ -180,6 +274,7 @@ int distributed_add_node(distributed_ctx_t* ctx, uint32_t node_id, const char* h
     node->port = port;
     node->is_active = false;
     node->last_heartbeat = 0;
+    node->mq = node_queue_attach(node_id);
     
     ctx->nodes = realloc(ctx->nodes, sizeof(node_info_t*) * (ctx->node_count + 1));
     ctx->nodes[ctx->node_count++] = node;
@@ -192,6 +287,7 @@ int distributed_remove_node(distributed_ctx_t* ctx, uint32_t node_id) {
     
     for (size_t i = 0; i < ctx->node_count; i++) {
         if (ctx->nodes[i]->node_id == node_id) {
+            message_queue_close(ctx->nodes[i]->mq);
             free(ctx->nodes[i]);
             
             /* Shift remaining nodes */
@@ -209,6 +305,8 @@ int distributed_remove_node(distributed_ctx_t* ctx, uint32_t node_id) {
 /* Message operations - simplified implementation using System V message queues */
 int distributed_send_message(distributed_ctx_t* ctx, message_t* msg) {
     if (!ctx || !msg) return -1;
+    STATS_BEGIN(start);
+    TRACE_POINT(msg_send, TRACE_MSG_SEND, TRACE_PHASE_INSTANT, msg->type, msg->dest_node);
     
     /* Serialize message */
     size_t total_size = sizeof(message_t) + msg->payload_size;
@@ -218,15 +316,29 @@ int distributed_send_message(distributed_ctx_t* ctx, message_t* msg) {
         memcpy(buffer + sizeof(message_t), msg->payload, msg->payload_size);
     }
     
-    /* Send via message queue */
-    int result = message_queue_send(ctx->mq, buffer, total_size, 0);
+    /* Send via the destination's message queue */
+    message_queue_t* mq = ctx->mq;
+    if (msg->dest_node != 0 && msg->dest_node != ctx->this_node_id) {
+        mq = NULL;
+        for (size_t i = 0; i < ctx->node_count; i++) {
+            node_info_t* node = ctx->nodes[i];
+            if (node->node_id == msg->dest_node) {
+                if (!node->mq) node->mq = node_queue_attach(node->node_id);
+                mq = node->mq;
+                break;
+            }
+        }
+    }
+    int result = message_queue_send(mq, buffer, total_size, 0);
     free(buffer);
     
+    STATS_END(STATS_OP_SEND, start);
     return result;
 }
 
 message_t* distributed_receive_message(distributed_ctx_t* ctx, int timeout_ms) {
     if (!ctx) return NULL;
+    STATS_BEGIN(start);
     
     char buffer[65536];
     int priority;
@@ -245,17 +357,28 @@ message_t* distributed_receive_message(distributed_ctx_t* ctx, int timeout_ms) {
     } else {
         msg->payload = NULL;
     }
+    account_usage(&message_memory, 1, (int64_t)(sizeof(message_t) + msg->payload_size),
+                  message_allocated(msg));
     
+    STATS_END(STATS_OP_RECEIVE, start);
+    TRACE_POINT(msg_receive, TRACE_MSG_RECEIVE, TRACE_PHASE_INSTANT, msg->type, msg->source_node);
     return msg;
 }
 
 void distributed_free_message(message_t* msg) {
     if (!msg) return;
+    account_usage(&message_memory, -1, -(int64_t)(sizeof(message_t) + msg->payload_size),
+                  -message_allocated(msg));
     if (msg->payload) free(msg->payload);
     free(msg);
 }
 
 /* Shared memory operations */
+static size_t shared_segment_size(size_t size) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return (size + page - 1) / page * page;
+}
+
 shared_memory_t* shared_memory_create(size_t size) {
     shared_memory_t* shm = malloc(sizeof(shared_memory_t));
     
@@ -275,6 +398,7 @@ shared_memory_t* shared_memory_create(size_t size) {
     }
     
     shm->shm_size = size;
+    shm->lock_acquired_ns = 0;
     
     /* Initialize mutex in shared memory */
     shm->lock = (pthread_mutex_t*)shm->shm_addr;
@@ -284,12 +408,15 @@ shared_memory_t* shared_memory_create(size_t size) {
     pthread_mutex_init(shm->lock, &attr);
     pthread_mutexattr_destroy(&attr);
     
+    account_usage(&shared_memory, 1, (int64_t)size, (int64_t)shared_segment_size(size));
     return shm;
 }
 
 void shared_memory_destroy(shared_memory_t* shm) {
     if (!shm) return;
     
+    account_usage(&shared_memory, -1, -(int64_t)shm->shm_size,
+                  -(int64_t)shared_segment_size(shm->shm_size));
     pthread_mutex_destroy(shm->lock);
     shmdt(shm->shm_addr);
     shmctl(shm->shm_id, IPC_RMID, NULL);
@@ -298,13 +425,15 @@ void shared_memory_destroy(shared_memory_t* shm) {
 
 void* shared_memory_lock(shared_memory_t* shm) {
     if (!shm) return NULL;
-    pthread_mutex_lock(shm->lock);
+    shm->lock_acquired_ns = lockprof_mutex_lock(shm->lock, &shm_mutex_site);
     return (char*)shm->shm_addr + sizeof(pthread_mutex_t);
 }
 
 void shared_memory_unlock(shared_memory_t* shm) {
     if (!shm) return;
-    pthread_mutex_unlock(shm->lock);
+    uint64_t held = shm->lock_acquired_ns;
+    shm->lock_acquired_ns = 0;
+    lockprof_mutex_unlock(shm->lock, &shm_mutex_site, held);
 }
 
 /* Message queue operations */
@@ -312,8 +441,7 @@ message_queue_t* message_queue_create(const char* name, size_t max_messages, siz
     message_queue_t* mq = malloc(sizeof(message_queue_t));
     
     /* Create message queue */
-    key_t key = ftok(name, 'O');
-    mq->mq_id = msgget(key, IPC_CREAT | 0666);
+    mq->mq_id = msgget(message_queue_key(name), IPC_CREAT | 0666);
     if (mq->mq_id < 0) {
         free(mq);
         return NULL;
@@ -331,6 +459,11 @@ void message_queue_destroy(message_queue_t* mq) {
     free(mq);
 }
 
+/* Drop the handle but leave the queue to its owner */
+void message_queue_close(message_queue_t* mq) {
+    free(mq);
+}
+
 int message_queue_send(message_queue_t* mq, const void* data, size_t size, int priority) {
     if (!mq || !data || size > mq->max_message_size) return -1;
     
@@ -378,6 +511,8 @@ consensus_t* consensus_create(void* proposal_data, size_t size, size_t required_
     consensus->voted_nodes = calloc(required_votes, sizeof(uint32_t));
     consensus->vote_count = 0;
     consensus->required_votes = required_votes;
+    TRACE_POINT(consensus_create, TRACE_CONSENSUS, TRACE_PHASE_INSTANT,
+                consensus->proposal_id, consensus->phase);
     return consensus;
 }
 
@@ -389,11 +524,15 @@ void consensus_destroy(consensus_t* consensus) {
 }
 
 int consensus_propose(distributed_ctx_t* ctx, consensus_t* consensus) {
+    TRACE_POINT(consensus_propose, TRACE_CONSENSUS, TRACE_PHASE_INSTANT,
+                consensus->proposal_id, CONSENSUS_PROPOSE);
     /* TODO: Implement proposal distribution */
     return 0;
 }
 
 int consensus_vote(distributed_ctx_t* ctx, consensus_t* consensus, bool accept) {
+    TRACE_POINT(consensus_vote, TRACE_CONSENSUS, TRACE_PHASE_INSTANT,
+                consensus->proposal_id, accept ? CONSENSUS_ACCEPT : CONSENSUS_REJECT);
     /* TODO: Implement voting mechanism */
     return 0;
 }
@@ -0,0 +1,213 @@
+/*
+ * OpenCog Epoch-Based Reclamation
+ * Deferred freeing of shared objects without reader-side atomics
+ */
+
+#include <stdlib.h>
+#include <sched.h>
+#include <pthread.h>
+#include "../include/epoch.h"
+
+/* Objects are freed once this many epochs have passed since retirement */
+#define EPOCH_GRACE 2
+
+/* Retirements between opportunistic reclaim passes */
+#define EPOCH_RECLAIM_INTERVAL 64
+
+/* Per-thread reader state; records are reused after their thread exits */
+typedef struct epoch_record {
+    uint64_t epoch;               /* Global epoch seen on entry, 0 when quiescent */
+    uint32_t nesting;
+    bool in_use;
+    struct epoch_record* next;
+} epoch_record_t;
+
+typedef struct retired {
+    void* ptr;
+    epoch_free_fn free_fn;
+    uint64_t epoch;
+    struct retired* next;
+} retired_t;
+
+static uint64_t global_epoch = 1;
+
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static epoch_record_t* registry = NULL;
+static pthread_key_t record_key;
+static pthread_once_t record_key_once = PTHREAD_ONCE_INIT;
+static __thread epoch_record_t* local_record = NULL;
+
+/* Retired objects in retirement (and so epoch) order */
+static pthread_mutex_t limbo_lock = PTHREAD_MUTEX_INITIALIZER;
+static retired_t* limbo_head = NULL;
+static retired_t* limbo_tail = NULL;
+static size_t limbo_count = 0;
+static uint64_t retire_count = 0;
+
+/* Set while this thread runs free functions, which may retire further objects */
+static __thread bool reclaiming = false;
+static __thread size_t chained_retires = 0;
+
+static void record_thread_exit(void* arg) {
+    epoch_record_t* record = (epoch_record_t*)arg;
+    pthread_mutex_lock(&registry_lock);
+    __atomic_store_n(&record->epoch, 0, __ATOMIC_RELEASE);
+    record->nesting = 0;
+    record->in_use = false;
+    pthread_mutex_unlock(&registry_lock);
+}
+
+static void make_record_key(void) {
+    pthread_key_create(&record_key, record_thread_exit);
+}
+
+static epoch_record_t* thread_record(void) {
+    if (local_record) return local_record;
+
+    pthread_once(&record_key_once, make_record_key);
+    pthread_mutex_lock(&registry_lock);
+
+    epoch_record_t* record = registry;
+    while (record && record->in_use) {
+        record = record->next;
+    }
+    if (!record) {
+        record = calloc(1, sizeof(epoch_record_t));
+        record->next = registry;
+        registry = record;
+    }
+    record->in_use = true;
+
+    pthread_mutex_unlock(&registry_lock);
+    pthread_setspecific(record_key, record);
+    local_record = record;
+    return record;
+}
+
+/* Read side */
+void epoch_enter(void) {
+    epoch_record_t* record = thread_record();
+    if (record->nesting++ == 0) {
+        __atomic_store_n(&record->epoch, __atomic_load_n(&global_epoch, __ATOMIC_ACQUIRE),
+                         __ATOMIC_RELAXED);
+        /* Publish the pin before reading any shared pointer */
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    }
+}
+
+void epoch_exit(void) {
+    epoch_record_t* record = local_record;
+    if (!record || record->nesting == 0) return;
+    if (--record->nesting == 0) {
+        __atomic_store_n(&record->epoch, 0, __ATOMIC_RELEASE);
+    }
+}
+
+bool epoch_in_critical(void) {
+    return local_record && local_record->nesting > 0;
+}
+
+/* The epoch advances only when every active reader has seen the current one */
+static bool try_advance(void) {
+    uint64_t current = __atomic_load_n(&global_epoch, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    pthread_mutex_lock(&registry_lock);
+    for (epoch_record_t* record = registry; record; record = record->next) {
+        uint64_t seen = __atomic_load_n(&record->epoch, __ATOMIC_ACQUIRE);
+        if (seen != 0 && seen != current) {
+            pthread_mutex_unlock(&registry_lock);
+            return false;
+        }
+    }
+    pthread_mutex_unlock(&registry_lock);
+
+    __atomic_compare_exchange_n(&global_epoch, &current, current + 1, false,
+                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    return true;
+}
+
+/* Write side */
+void epoch_retire(void* ptr, epoch_free_fn free_fn) {
+    if (!ptr || !free_fn) return;
+    if (reclaiming) chained_retires++;
+
+    retired_t* item = malloc(sizeof(retired_t));
+    item->ptr = ptr;
+    item->free_fn = free_fn;
+    item->next = NULL;
+
+    pthread_mutex_lock(&limbo_lock);
+    item->epoch = __atomic_load_n(&global_epoch, __ATOMIC_ACQUIRE);
+    if (limbo_tail) limbo_tail->next = item;
+    else limbo_head = item;
+    limbo_tail = item;
+    limbo_count++;
+    bool reclaim = (++retire_count % EPOCH_RECLAIM_INTERVAL) == 0;
+    pthread_mutex_unlock(&limbo_lock);
+
+    if (reclaim) epoch_reclaim();
+}
+
+size_t epoch_reclaim(void) {
+    try_advance();
+    uint64_t current = __atomic_load_n(&global_epoch, __ATOMIC_ACQUIRE);
+
+    /* Detach the safe prefix, then free outside the lock */
+    pthread_mutex_lock(&limbo_lock);
+    retired_t* ready = NULL;
+    retired_t* last = NULL;
+    while (limbo_head && limbo_head->epoch + EPOCH_GRACE <= current) {
+        retired_t* item = limbo_head;
+        limbo_head = item->next;
+        item->next = NULL;
+        if (last) last->next = item;
+        else ready = item;
+        last = item;
+        limbo_count--;
+    }
+    if (!limbo_head) limbo_tail = NULL;
+    pthread_mutex_unlock(&limbo_lock);
+
+    size_t freed = 0;
+    bool outer = reclaiming;
+    reclaiming = true;
+    while (ready) {
+        retired_t* next = ready->next;
+        ready->free_fn(ready->ptr);
+        free(ready);
+        ready = next;
+        freed++;
+    }
+    reclaiming = outer;
+    return freed;
+}
+
+void epoch_synchronize(void) {
+    /* A reader cannot wait for itself; free only what is already safe */
+    if (epoch_in_critical()) {
+        epoch_reclaim();
+        return;
+    }
+
+    /* Repeat for objects the free functions retired in turn */
+    do {
+        chained_retires = 0;
+        uint64_t target = __atomic_load_n(&global_epoch, __ATOMIC_ACQUIRE) + EPOCH_GRACE;
+        while (__atomic_load_n(&global_epoch, __ATOMIC_ACQUIRE) < target) {
+            if (!try_advance()) sched_yield();
+        }
+        epoch_reclaim();
+    } while (chained_retires > 0);
+}
+
+uint64_t epoch_current(void) {
+    return __atomic_load_n(&global_epoch, __ATOMIC_ACQUIRE);
+}
+
+size_t epoch_pending(void) {
+    pthread_mutex_lock(&limbo_lock);
+    size_t pending = limbo_count;
+    pthread_mutex_unlock(&limbo_lock);
+    return pending;
+}
@@ -0,0 +1,608 @@
+/*
+ * OpenCog Graph Algorithms
+ * Parallel BFS, components and PageRank over CSR views
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "../include/graph.h"
+#include "../include/mvcc.h"
+
+#define GRAPH_MIN_VERTICES_PER_THREAD 4096
+#define GRAPH_PUSH_BUFFER 256         /* Vertices a worker gathers before claiming queue space */
+#define BFS_ALPHA 14                  /* Go bottom up once frontier edges exceed unexplored / ALPHA */
+#define BFS_BETA 24                   /* Return top down once the frontier is under vertices / BETA */
+
+/*
+ * Teams. Every algorithm runs as one function on each worker, meeting at a
+ * barrier between steps, so threads are started once per call rather than
+ * once per level or iteration. The calling thread is worker 0; the team
+ * shrinks to the threads that could be started.
+ */
+typedef struct team team_t;
+typedef void (*team_fn)(team_t* team, unsigned worker);
+
+struct team {
+    unsigned workers;
+    pthread_barrier_t barrier;
+    pthread_mutex_t lock;
+    pthread_cond_t started;
+    bool ready;                   /* Set once `workers` and the barrier are final */
+    team_fn fn;
+    void* ctx;
+};
+
+typedef struct {
+    team_t* team;
+    unsigned worker;
+} team_member_t;
+
+static void* team_member_run(void* arg) {
+    team_member_t* member = (team_member_t*)arg;
+    team_t* team = member->team;
+    pthread_mutex_lock(&team->lock);
+    while (!team->ready) pthread_cond_wait(&team->started, &team->lock);
+    pthread_mutex_unlock(&team->lock);
+    team->fn(team, member->worker);
+    return NULL;
+}
+
+static unsigned team_size(unsigned threads, size_t vertices) {
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (unsigned)online : 1;
+    }
+    size_t useful = vertices / GRAPH_MIN_VERTICES_PER_THREAD;
+    if (threads > useful) threads = useful ? (unsigned)useful : 1;
+    return threads > GRAPH_MAX_THREADS ? GRAPH_MAX_THREADS : threads;
+}
+
+static void team_run(unsigned threads, team_fn fn, void* ctx) {
+    team_t team;
+    pthread_t ids[GRAPH_MAX_THREADS];
+    team_member_t members[GRAPH_MAX_THREADS];
+    team.fn = fn;
+    team.ctx = ctx;
+    team.ready = false;
+    pthread_mutex_init(&team.lock, NULL);
+    pthread_cond_init(&team.started, NULL);
+
+    unsigned workers = 1;
+    for (unsigned i = 1; i < threads; i++) {
+        members[workers].team = &team;
+        members[workers].worker = workers;
+        if (pthread_create(&ids[workers], NULL, team_member_run, &members[workers]) != 0) break;
+        workers++;
+    }
+    team.workers = workers;
+    pthread_barrier_init(&team.barrier, NULL, workers);
+    pthread_mutex_lock(&team.lock);
+    team.ready = true;
+    pthread_cond_broadcast(&team.started);
+    pthread_mutex_unlock(&team.lock);
+
+    fn(&team, 0);
+    for (unsigned i = 1; i < workers; i++) {
+        pthread_join(ids[i], NULL);
+    }
+    pthread_barrier_destroy(&team.barrier);
+    pthread_cond_destroy(&team.started);
+    pthread_mutex_destroy(&team.lock);
+}
+
+static inline void team_sync(team_t* team) {
+    pthread_barrier_wait(&team->barrier);
+}
+
+/* Worker `worker`'s contiguous share of `n` items */
+static inline void team_share(const team_t* team, unsigned worker, size_t n, size_t* begin, size_t* end) {
+    *begin = n * worker / team->workers;
+    *end = n * (worker + 1) / team->workers;
+}
+
+/* Adjacency in one direction: one or two offset/edge list pairs */
+typedef struct {
+    const uint64_t* offsets[2];
+    const uint32_t* edges[2];
+    int count;
+} adjacency_t;
+
+static void adjacency_init(adjacency_t* adj, const atomspace_csr_t* csr, graph_direction_t direction,
+                           bool reverse) {
+    bool out = direction == GRAPH_BOTH || (direction == GRAPH_OUT) != reverse;
+    bool in = direction == GRAPH_BOTH || (direction == GRAPH_IN) != reverse;
+    adj->count = 0;
+    if (out) {
+        adj->offsets[adj->count] = csr->out_offsets;
+        adj->edges[adj->count++] = csr->out_edges;
+    }
+    if (in) {
+        adj->offsets[adj->count] = csr->in_offsets;
+        adj->edges[adj->count++] = csr->in_edges;
+    }
+}
+
+static inline uint64_t adjacency_degree(const adjacency_t* adj, uint32_t v) {
+    uint64_t degree = 0;
+    for (int l = 0; l < adj->count; l++) degree += adj->offsets[l][v + 1] - adj->offsets[l][v];
+    return degree;
+}
+
+/* BFS */
+typedef struct {
+    const atomspace_csr_t* csr;
+    adjacency_t forward;          /* Top down: frontier -> children */
+    adjacency_t reverse;          /* Bottom up: vertex -> possible parents */
+    const uint32_t* sources;
+    size_t source_count;
+    uint32_t max_depth;
+    uint32_t target;              /* Stop once reached; GRAPH_UNREACHED for none */
+    uint32_t* depth;
+    uint32_t* parent;
+
+    uint32_t* queue;              /* Frontier while top down */
+    uint32_t* next_queue;
+    uint64_t* bits;               /* Frontier while bottom up */
+    uint64_t* next_bits;
+    size_t words;
+
+    /* Shared between steps; worker 0 writes them while the others wait */
+    size_t queue_count;
+    bool frontier_is_bitmap;
+    bool bottom_up;               /* Mode of the current level */
+    bool done;
+    uint32_t level;
+    uint64_t frontier_edges;      /* Edges out of the frontier */
+    uint64_t unexplored_edges;    /* Edges out of vertices not yet reached */
+
+    /* Accumulated by all workers during a step */
+    size_t next_count;
+    uint64_t next_edges;
+    size_t reached;
+} bfs_t;
+
+typedef struct {
+    uint32_t items[GRAPH_PUSH_BUFFER];
+    size_t count;
+} push_buffer_t;
+
+static void push_flush(push_buffer_t* buffer, uint32_t* queue, size_t* queue_count) {
+    if (!buffer->count) return;
+    size_t at = __atomic_fetch_add(queue_count, buffer->count, __ATOMIC_RELAXED);
+    memcpy(queue + at, buffer->items, buffer->count * sizeof(uint32_t));
+    buffer->count = 0;
+}
+
+static inline void push(push_buffer_t* buffer, uint32_t v, uint32_t* queue, size_t* queue_count) {
+    buffer->items[buffer->count++] = v;
+    if (buffer->count == GRAPH_PUSH_BUFFER) push_flush(buffer, queue, queue_count);
+}
+
+static void bfs_top_down(bfs_t* bfs, team_t* team, unsigned worker, size_t* found, uint64_t* edges) {
+    size_t begin, end;
+    team_share(team, worker, bfs->queue_count, &begin, &end);
+    push_buffer_t buffer;
+    buffer.count = 0;
+    uint32_t next_depth = bfs->level + 1;
+    for (size_t i = begin; i < end; i++) {
+        uint32_t u = bfs->queue[i];
+        for (int l = 0; l < bfs->forward.count; l++) {
+            const uint32_t* edge = bfs->forward.edges[l];
+            for (uint64_t e = bfs->forward.offsets[l][u]; e < bfs->forward.offsets[l][u + 1]; e++) {
+                uint32_t v = edge[e];
+                uint32_t unreached = GRAPH_UNREACHED;
+                if (__atomic_load_n(&bfs->depth[v], __ATOMIC_RELAXED) != GRAPH_UNREACHED ||
+                    !__atomic_compare_exchange_n(&bfs->depth[v], &unreached, next_depth, false,
+                                                 __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                    continue;
+                }
+                if (bfs->parent) bfs->parent[v] = u;
+                push(&buffer, v, bfs->next_queue, &bfs->next_count);
+                (*found)++;
+                *edges += adjacency_degree(&bfs->forward, v);
+            }
+        }
+    }
+    push_flush(&buffer, bfs->next_queue, &bfs->next_count);
+}
+
+/* Each worker owns whole bitmap words, so next_bits needs no atomics */
+static void bfs_bottom_up(bfs_t* bfs, team_t* team, unsigned worker, size_t* found, uint64_t* edges) {
+    size_t begin, end;
+    team_share(team, worker, bfs->words, &begin, &end);
+    uint32_t vertices = bfs->csr->vertex_count;
+    uint32_t next_depth = bfs->level + 1;
+    for (size_t w = begin; w < end; w++) {
+        uint64_t next = 0;
+        uint32_t last = (w + 1) * 64 < vertices ? (uint32_t)((w + 1) * 64) : vertices;
+        for (uint32_t v = (uint32_t)(w * 64); v < last; v++) {
+            if (bfs->depth[v] != GRAPH_UNREACHED) continue;
+            for (int l = 0; l < bfs->reverse.count; l++) {
+                const uint32_t* edge = bfs->reverse.edges[l];
+                uint64_t e = bfs->reverse.offsets[l][v];
+                uint64_t e_end = bfs->reverse.offsets[l][v + 1];
+                for (; e < e_end; e++) {
+                    uint32_t u = edge[e];
+                    if (bfs->bits[u >> 6] >> (u & 63) & 1) break;
+                }
+                if (e == e_end) continue;
+                bfs->depth[v] = next_depth;
+                if (bfs->parent) bfs->parent[v] = edge[e];
+                next |= 1ull << (v & 63);
+                (*found)++;
+                *edges += adjacency_degree(&bfs->forward, v);
+                break;
+            }
+        }
+        bfs->next_bits[w] = next;
+    }
+}
+
+static void bfs_worker(team_t* team, unsigned worker) {
+    bfs_t* bfs = (bfs_t*)team->ctx;
+    uint32_t vertices = bfs->csr->vertex_count;
+    size_t begin, end;
+    team_share(team, worker, vertices, &begin, &end);
+    for (size_t v = begin; v < end; v++) bfs->depth[v] = GRAPH_UNREACHED;
+    team_sync(team);
+
+    if (worker == 0) {
+        uint64_t total = 0;
+        for (int l = 0; l < bfs->forward.count; l++) total += bfs->forward.offsets[l][vertices];
+        for (size_t i = 0; i < bfs->source_count; i++) {
+            uint32_t s = bfs->sources[i];
+            if (s >= vertices || bfs->depth[s] == 0) continue;
+            bfs->depth[s] = 0;
+            if (bfs->parent) bfs->parent[s] = s;
+            bfs->queue[bfs->queue_count++] = s;
+            bfs->frontier_edges += adjacency_degree(&bfs->forward, s);
+        }
+        bfs->reached = bfs->queue_count;
+        bfs->unexplored_edges = total - bfs->frontier_edges;
+    }
+
+    for (;;) {
+        team_sync(team);
+        if (worker == 0) {
+            bfs->done = bfs->queue_count == 0 || bfs->level >= bfs->max_depth ||
+                        (bfs->target != GRAPH_UNREACHED && bfs->depth[bfs->target] != GRAPH_UNREACHED);
+            if (bfs->frontier_is_bitmap) bfs->bottom_up = bfs->queue_count >= vertices / BFS_BETA;
+            else bfs->bottom_up = bfs->frontier_edges > bfs->unexplored_edges / BFS_ALPHA;
+            bfs->next_count = 0;
+            bfs->next_edges = 0;
+        }
+        team_sync(team);
+        if (bfs->done) break;
+
+        /* Switch the frontier's representation to the level's mode */
+        if (bfs->bottom_up && !bfs->frontier_is_bitmap) {
+            size_t word_begin, word_end;
+            team_share(team, worker, bfs->words, &word_begin, &word_end);
+            memset(bfs->bits + word_begin, 0, (word_end - word_begin) * sizeof(uint64_t));
+            team_sync(team);
+            size_t item_begin, item_end;
+            team_share(team, worker, bfs->queue_count, &item_begin, &item_end);
+            for (size_t i = item_begin; i < item_end; i++) {
+                uint32_t v = bfs->queue[i];
+                __atomic_fetch_or(&bfs->bits[v >> 6], 1ull << (v & 63), __ATOMIC_RELAXED);
+            }
+            team_sync(team);
+        } else if (!bfs->bottom_up && bfs->frontier_is_bitmap) {
+            /* next_count doubles as the queue's fill level here */
+            size_t word_begin, word_end;
+            team_share(team, worker, bfs->words, &word_begin, &word_end);
+            push_buffer_t buffer;
+            buffer.count = 0;
+            for (size_t w = word_begin; w < word_end; w++) {
+                for (uint64_t bits = bfs->bits[w]; bits; bits &= bits - 1) {
+                    push(&buffer, (uint32_t)(w * 64 + (size_t)__builtin_ctzll(bits)), bfs->queue, &bfs->next_count);
+                }
+            }
+            push_flush(&buffer, bfs->queue, &bfs->next_count);
+            team_sync(team);
+            if (worker == 0) {
+                bfs->queue_count = bfs->next_count;
+                bfs->next_count = 0;
+            }
+            team_sync(team);
+        }
+
+        size_t found = 0;
+        uint64_t edges = 0;
+        if (bfs->bottom_up) bfs_bottom_up(bfs, team, worker, &found, &edges);
+        else bfs_top_down(bfs, team, worker, &found, &edges);
+        if (bfs->bottom_up) __atomic_fetch_add(&bfs->next_count, found, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&bfs->next_edges, edges, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&bfs->reached, found, __ATOMIC_RELAXED);
+        team_sync(team);
+
+        if (worker == 0) {
+            if (bfs->bottom_up) {
+                uint64_t* swap = bfs->bits;
+                bfs->bits = bfs->next_bits;
+                bfs->next_bits = swap;
+            } else {
+                uint32_t* swap = bfs->queue;
+                bfs->queue = bfs->next_queue;
+                bfs->next_queue = swap;
+            }
+            bfs->frontier_is_bitmap = bfs->bottom_up;
+            bfs->queue_count = bfs->next_count;
+            bfs->frontier_edges = bfs->next_edges;
+            bfs->unexplored_edges -= bfs->next_edges;
+            bfs->level++;
+        }
+    }
+}
+
+/* queue_count is the frontier's size in either representation */
+static size_t bfs_run(const atomspace_csr_t* csr, const uint32_t* sources, size_t source_count,
+                      uint32_t max_depth, uint32_t target, graph_direction_t direction, unsigned threads,
+                      uint32_t* depth, uint32_t* parent) {
+    bfs_t bfs;
+    memset(&bfs, 0, sizeof(bfs));
+    bfs.csr = csr;
+    adjacency_init(&bfs.forward, csr, direction, false);
+    adjacency_init(&bfs.reverse, csr, direction, true);
+    bfs.sources = sources;
+    bfs.source_count = source_count;
+    bfs.max_depth = max_depth;
+    bfs.target = target;
+    bfs.depth = depth;
+    bfs.parent = parent;
+    bfs.words = ((size_t)csr->vertex_count + 63) / 64;
+    bfs.queue = malloc(((size_t)csr->vertex_count + 1) * sizeof(uint32_t));
+    bfs.next_queue = malloc(((size_t)csr->vertex_count + 1) * sizeof(uint32_t));
+    bfs.bits = calloc(bfs.words + 1, sizeof(uint64_t));
+    bfs.next_bits = calloc(bfs.words + 1, sizeof(uint64_t));
+    if (bfs.queue && bfs.next_queue && bfs.bits && bfs.next_bits) {
+        team_run(team_size(threads, csr->vertex_count), bfs_worker, &bfs);
+    }
+    free(bfs.queue);
+    free(bfs.next_queue);
+    free(bfs.bits);
+    free(bfs.next_bits);
+    return bfs.reached;
+}
+
+size_t graph_bfs(const atomspace_csr_t* csr, const uint32_t* sources, size_t source_count,
+                 uint32_t max_depth, graph_direction_t direction, unsigned threads,
+                 uint32_t* depth, uint32_t* parent) {
+    if (!csr || (!sources && source_count) || !depth || direction > GRAPH_BOTH) return 0;
+    return bfs_run(csr, sources, source_count, max_depth, GRAPH_UNREACHED, direction, threads, depth, parent);
+}
+
+size_t graph_shortest_path(const atomspace_csr_t* csr, uint32_t source, uint32_t target,
+                           graph_direction_t direction, unsigned threads, uint32_t* path, size_t max) {
+    if (!csr || source >= csr->vertex_count || target >= csr->vertex_count || direction > GRAPH_BOTH) return 0;
+    uint32_t* depth = malloc(((size_t)csr->vertex_count) * sizeof(uint32_t));
+    uint32_t* parent = malloc(((size_t)csr->vertex_count) * sizeof(uint32_t));
+    size_t length = 0;
+    if (depth && parent) {
+        bfs_run(csr, &source, 1, UINT32_MAX, target, direction, threads, depth, parent);
+        if (depth[target] != GRAPH_UNREACHED) {
+            length = (size_t)depth[target] + 1;
+            for (uint32_t v = target;; v = parent[v]) {
+                if (path && depth[v] < max) path[depth[v]] = v;
+                if (v == source) break;
+            }
+        }
+    }
+    free(depth);
+    free(parent);
+    return length;
+}
+
+/*
+ * Connected components by lock-free union-find: a root is only ever
+ * hooked under a smaller root, so each tree's root is its smallest vertex.
+ * Finds halve the path as they go.
+ */
+typedef struct {
+    const atomspace_csr_t* csr;
+    uint32_t* component;
+    size_t count;
+} components_t;
+
+static uint32_t uf_find(uint32_t* parent, uint32_t x) {
+    for (;;) {
+        uint32_t p = __atomic_load_n(&parent[x], __ATOMIC_RELAXED);
+        if (p == x) return x;
+        uint32_t grand = __atomic_load_n(&parent[p], __ATOMIC_RELAXED);
+        if (grand != p) {
+            __atomic_compare_exchange_n(&parent[x], &p, grand, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        }
+        x = grand;
+    }
+}
+
+static void uf_union(uint32_t* parent, uint32_t a, uint32_t b) {
+    for (;;) {
+        a = uf_find(parent, a);
+        b = uf_find(parent, b);
+        if (a == b) return;
+        if (a < b) {
+            uint32_t swap = a;
+            a = b;
+            b = swap;
+        }
+        uint32_t expected = a;
+        if (__atomic_compare_exchange_n(&parent[a], &expected, b, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            return;
+        }
+    }
+}
+
+static void components_worker(team_t* team, unsigned worker) {
+    components_t* cc = (components_t*)team->ctx;
+    const atomspace_csr_t* csr = cc->csr;
+    size_t begin, end;
+    team_share(team, worker, csr->vertex_count, &begin, &end);
+    for (size_t v = begin; v < end; v++) cc->component[v] = (uint32_t)v;
+    team_sync(team);
+
+    for (size_t v = begin; v < end; v++) {
+        for (uint64_t e = csr->out_offsets[v]; e < csr->out_offsets[v + 1]; e++) {
+            uf_union(cc->component, (uint32_t)v, csr->out_edges[e]);
+        }
+    }
+    team_sync(team);
+
+    size_t roots = 0;
+    for (size_t v = begin; v < end; v++) {
+        uint32_t root = uf_find(cc->component, (uint32_t)v);
+        roots += root == v;
+        cc->component[v] = root;
+    }
+    __atomic_fetch_add(&cc->count, roots, __ATOMIC_RELAXED);
+}
+
+size_t graph_components(const atomspace_csr_t* csr, unsigned threads, uint32_t* component) {
+    if (!csr || !component) return 0;
+    components_t cc = { csr, component, 0 };
+    team_run(team_size(threads, csr->vertex_count), components_worker, &cc);
+    return cc.count;
+}
+
+/*
+ * PageRank, pulling: each vertex sums the shares of its reverse
+ * neighbours, so every write goes to the worker's own range. Partial sums
+ * are reduced by every worker alike, so all reach the same decision to
+ * stop without another barrier.
+ */
+typedef struct {
+    const atomspace_csr_t* csr;
+    adjacency_t forward;
+    adjacency_t reverse;
+    graph_pagerank_config_t config;
+    float* rank;
+    float* next;
+    float* share;                 /* rank / degree, 0 for vertices without neighbours */
+    double dangling[GRAPH_MAX_THREADS];
+    double delta[GRAPH_MAX_THREADS];
+    uint32_t iterations;
+} pagerank_t;
+
+static void pagerank_worker(team_t* team, unsigned worker) {
+    pagerank_t* pr = (pagerank_t*)team->ctx;
+    uint32_t vertices = pr->csr->vertex_count;
+    size_t begin, end;
+    team_share(team, worker, vertices, &begin, &end);
+    float* rank = pr->rank;
+    float* next = pr->next;
+    for (size_t v = begin; v < end; v++) rank[v] = 1.0f / (float)vertices;
+
+    uint32_t iteration = 0;
+    while (iteration < pr->config.max_iterations) {
+        double dangling = 0.0;
+        for (size_t v = begin; v < end; v++) {
+            uint64_t degree = adjacency_degree(&pr->forward, (uint32_t)v);
+            pr->share[v] = degree ? rank[v] / (float)degree : 0.0f;
+            if (!degree) dangling += rank[v];
+        }
+        pr->dangling[worker] = dangling;
+        team_sync(team);
+
+        dangling = 0.0;
+        for (unsigned w = 0; w < team->workers; w++) dangling += pr->dangling[w];
+        float damping = pr->config.damping;
+        float base = (float)((1.0 - damping) / vertices + damping * dangling / vertices);
+        double delta = 0.0;
+        for (size_t v = begin; v < end; v++) {
+            float sum = 0.0f;
+            for (int l = 0; l < pr->reverse.count; l++) {
+                const uint32_t* edge = pr->reverse.edges[l];
+                for (uint64_t e = pr->reverse.offsets[l][v]; e < pr->reverse.offsets[l][v + 1]; e++) {
+                    sum += pr->share[edge[e]];
+                }
+            }
+            next[v] = base + damping * sum;
+            delta += fabs((double)next[v] - (double)rank[v]);
+        }
+        pr->delta[worker] = delta;
+        team_sync(team);
+
+        delta = 0.0;
+        for (unsigned w = 0; w < team->workers; w++) delta += pr->delta[w];
+        float* swap = rank;
+        rank = next;
+        next = swap;
+        iteration++;
+        if (delta < pr->config.tolerance) break;
+    }
+
+    if (rank != pr->rank) memcpy(pr->rank + begin, rank + begin, (end - begin) * sizeof(float));
+    if (worker == 0) pr->iterations = iteration;
+}
+
+void graph_pagerank_config_default(graph_pagerank_config_t* config) {
+    if (!config) return;
+    config->damping = 0.85f;
+    config->tolerance = 1e-6f;
+    config->max_iterations = 100;
+}
+
+uint32_t graph_pagerank(const atomspace_csr_t* csr, graph_direction_t direction,
+                        const graph_pagerank_config_t* config, unsigned threads, float* rank) {
+    if (!csr || !rank || direction > GRAPH_BOTH || csr->vertex_count == 0) return 0;
+    pagerank_t pr;
+    memset(&pr, 0, sizeof(pr));
+    pr.csr = csr;
+    adjacency_init(&pr.forward, csr, direction, false);
+    adjacency_init(&pr.reverse, csr, direction, true);
+    if (config) pr.config = *config;
+    else graph_pagerank_config_default(&pr.config);
+    pr.rank = rank;
+    pr.next = malloc((size_t)csr->vertex_count * sizeof(float));
+    pr.share = malloc((size_t)csr->vertex_count * sizeof(float));
+    if (pr.next && pr.share) team_run(team_size(threads, csr->vertex_count), pagerank_worker, &pr);
+    free(pr.next);
+    free(pr.share);
+    return pr.iterations;
+}
+
+/* Write-back */
+static int16_t clamp_av(float value) {
+    if (!(value > INT16_MIN)) return INT16_MIN;
+    if (value >= INT16_MAX) return INT16_MAX;
+    return (int16_t)lrintf(value);
+}
+
+static double clamp_unit(float value) {
+    if (!(value > 0.0f)) return 0.0;
+    return value < 1.0f ? value : 1.0;
+}
+
+size_t graph_write_back(atomspace_t* space, const atomspace_csr_t* csr, const float* values,
+                        float scale, graph_field_t field) {
+    if (!space || !csr || !values || field > GRAPH_FIELD_CONFIDENCE) return 0;
+    size_t written = 0;
+    atomspace_read_begin(space);
+    size_t count = 0;
+    atom_handle_t* const* slots = atomspace_scan_slots(space, &count);
+    for (size_t s = 0; s < count; s++) {
+        atom_handle_t* handle = slots[s];
+        if (!handle || !atom_visible_at(handle->atom, MVCC_LATEST)) continue;
+        uint32_t v = atomspace_csr_vertex(csr, handle);
+        if (v == CSR_NO_VERTEX) continue;
+        float value = values[v] * scale;
+        if (field <= GRAPH_FIELD_VLTI) {
+            attention_value_t av = atom_get_av(handle);
+            if (field == GRAPH_FIELD_STI) av.sti = clamp_av(value);
+            else if (field == GRAPH_FIELD_LTI) av.lti = clamp_av(value);
+            else av.vlti = clamp_av(value);
+            atom_set_av(handle, av.sti, av.lti, av.vlti);
+        } else {
+            truth_value_t tv = atom_get_tv(handle);
+            if (field == GRAPH_FIELD_STRENGTH) tv.strength = clamp_unit(value);
+            else tv.confidence = clamp_unit(value);
+            atom_set_tv(handle, tv.strength, tv.confidence);
+        }
+        written++;
+    }
+    atomspace_read_end(space);
+    return written;
+}
@@ -0,0 +1,156 @@
+/*
+ * OpenCog Lock Contention Profiler
+ * Per-site acquisition, contention, wait and hold time accounting
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/lockprof.h"
+
+volatile bool lockprof_active = false;
+
+/* Sites register themselves on first profiled use (lock-free push) */
+static lockprof_site_t* site_list = NULL;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void register_site(lockprof_site_t* site) {
+    if (__atomic_load_n(&site->registered, __ATOMIC_ACQUIRE)) return;
+
+    int expected = 0;
+    if (!__atomic_compare_exchange_n(&site->registered, &expected, 1, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    lockprof_site_t* head = __atomic_load_n(&site_list, __ATOMIC_ACQUIRE);
+    do {
+        site->next = head;
+    } while (!__atomic_compare_exchange_n(&site_list, &head, site, true,
+                                          __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+}
+
+static void update_max(uint64_t* target, uint64_t value) {
+    uint64_t current = __atomic_load_n(target, __ATOMIC_RELAXED);
+    while (value > current &&
+           !__atomic_compare_exchange_n(target, &current, value, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+/* Record an acquisition and return its timestamp (never 0) */
+static uint64_t record_acquire(lockprof_site_t* site, bool contended, uint64_t wait_start) {
+    uint64_t acquired = now_ns();
+    register_site(site);
+
+    __atomic_fetch_add(&site->acquisitions, 1, __ATOMIC_RELAXED);
+    if (contended) {
+        uint64_t wait = acquired - wait_start;
+        __atomic_fetch_add(&site->contended, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&site->wait_ns, wait, __ATOMIC_RELAXED);
+        update_max(&site->max_wait_ns, wait);
+    }
+    return acquired ? acquired : 1;
+}
+
+uint64_t lockprof_mutex_lock_slow(pthread_mutex_t* mutex, lockprof_site_t* site) {
+    if (pthread_mutex_trylock(mutex) == 0) {
+        return record_acquire(site, false, 0);
+    }
+    uint64_t start = now_ns();
+    pthread_mutex_lock(mutex);
+    return record_acquire(site, true, start);
+}
+
+uint64_t lockprof_rdlock_slow(pthread_rwlock_t* lock, lockprof_site_t* site) {
+    if (pthread_rwlock_tryrdlock(lock) == 0) {
+        return record_acquire(site, false, 0);
+    }
+    uint64_t start = now_ns();
+    pthread_rwlock_rdlock(lock);
+    return record_acquire(site, true, start);
+}
+
+uint64_t lockprof_wrlock_slow(pthread_rwlock_t* lock, lockprof_site_t* site) {
+    if (pthread_rwlock_trywrlock(lock) == 0) {
+        return record_acquire(site, false, 0);
+    }
+    uint64_t start = now_ns();
+    pthread_rwlock_wrlock(lock);
+    return record_acquire(site, true, start);
+}
+
+void lockprof_release(lockprof_site_t* site, uint64_t acquired_ns) {
+    uint64_t held = now_ns() - acquired_ns;
+    __atomic_fetch_add(&site->hold_ns, held, __ATOMIC_RELAXED);
+    update_max(&site->max_hold_ns, held);
+}
+
+/* Runtime switch */
+void lockprof_set_enabled(bool enabled) {
+    lockprof_active = enabled;
+}
+
+bool lockprof_enabled(void) {
+    return lockprof_active;
+}
+
+/* Reporting */
+static int compare_wait(const void* a, const void* b) {
+    const lockprof_stats_t* x = (const lockprof_stats_t*)a;
+    const lockprof_stats_t* y = (const lockprof_stats_t*)b;
+    return (y->wait_ns > x->wait_ns) - (y->wait_ns < x->wait_ns);
+}
+
+size_t lockprof_snapshot(lockprof_stats_t* out, size_t max) {
+    size_t count = 0;
+    for (lockprof_site_t* site = __atomic_load_n(&site_list, __ATOMIC_ACQUIRE);
+         site && count < max; site = site->next) {
+        lockprof_stats_t* s = &out[count++];
+        s->name = site->name;
+        s->acquisitions = __atomic_load_n(&site->acquisitions, __ATOMIC_RELAXED);
+        s->contended = __atomic_load_n(&site->contended, __ATOMIC_RELAXED);
+        s->wait_ns = __atomic_load_n(&site->wait_ns, __ATOMIC_RELAXED);
+        s->max_wait_ns = __atomic_load_n(&site->max_wait_ns, __ATOMIC_RELAXED);
+        s->hold_ns = __atomic_load_n(&site->hold_ns, __ATOMIC_RELAXED);
+        s->max_hold_ns = __atomic_load_n(&site->max_hold_ns, __ATOMIC_RELAXED);
+    }
+    qsort(out, count, sizeof(lockprof_stats_t), compare_wait);
+    return count;
+}
+
+void lockprof_report(FILE* out) {
+    lockprof_stats_t sites[128];
+    size_t count = lockprof_snapshot(sites, sizeof(sites) / sizeof(sites[0]));
+
+    fprintf(out, "Lock contention profile (ranked by total wait)\n");
+    fprintf(out, "  %-32s %12s %10s %8s %12s %12s %12s %12s\n",
+            "lock site", "acquired", "contended", "rate", "wait(us)", "max wait(us)",
+            "hold(us)", "max hold(us)");
+    for (size_t i = 0; i < count; i++) {
+        lockprof_stats_t* s = &sites[i];
+        fprintf(out, "  %-32s %12llu %10llu %7.2f%% %12.1f %12.1f %12.1f %12.1f\n",
+                s->name, (unsigned long long)s->acquisitions, (unsigned long long)s->contended,
+                s->acquisitions ? 100.0 * (double)s->contended / (double)s->acquisitions : 0.0,
+                (double)s->wait_ns / 1e3, (double)s->max_wait_ns / 1e3,
+                (double)s->hold_ns / 1e3, (double)s->max_hold_ns / 1e3);
+    }
+}
+
+void lockprof_reset(void) {
+    for (lockprof_site_t* site = __atomic_load_n(&site_list, __ATOMIC_ACQUIRE);
+         site; site = site->next) {
+        __atomic_store_n(&site->acquisitions, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&site->contended, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&site->wait_ns, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&site->max_wait_ns, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&site->hold_ns, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&site->max_hold_ns, 0, __ATOMIC_RELAXED);
+    }
+}
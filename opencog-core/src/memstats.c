@@ -0,0 +1,229 @@
+/*
+ * OpenCog Memory Accounting
+ * Running byte counters per subsystem and atom type, plus heap fragmentation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include "../include/memstats.h"
+#include "../include/mvcc.h"
+
+/* Per-space counters, updated with relaxed atomics by the creating thread */
+struct memory_accounting {
+    uint64_t atoms[ATOM_TYPE_MAX];
+    memory_usage_t categories[MEMORY_CATEGORY_COUNT];   /* Variable-size allocations only */
+    memory_usage_t types[ATOM_TYPE_MAX];              /* Variable-size part per type */
+};
+
+static const char* category_names[MEMORY_CATEGORY_COUNT] = {
+    "atoms", "handles", "names", "outgoing", "incoming",
+    "atom_index", "hash_table", "messages", "shared_memory", "versions", "vectors",
+    "name_index", "time_index", "query_cache"
+};
+
+static void add(uint64_t* counter, uint64_t delta) {
+    __atomic_fetch_add(counter, delta, __ATOMIC_RELAXED);
+}
+
+static void sub(uint64_t* counter, uint64_t delta) {
+    __atomic_fetch_sub(counter, delta, __ATOMIC_RELAXED);
+}
+
+static uint64_t load(const uint64_t* counter) {
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+size_t memory_chunk_size(size_t size) {
+    void* probe = malloc(size);
+    size_t usable = probe ? malloc_usable_size(probe) : size;
+    free(probe);
+    return usable;
+}
+
+/* Lifecycle */
+memory_accounting_t* memory_accounting_create(void) {
+    return calloc(1, sizeof(memory_accounting_t));
+}
+
+void memory_accounting_destroy(memory_accounting_t* acc) {
+    free(acc);
+}
+
+/* Hooks */
+void memory_account_atom(memory_accounting_t* acc, atom_type_t type, int delta) {
+    if (!acc || (unsigned)type >= ATOM_TYPE_MAX) return;
+    if (delta > 0) add(&acc->atoms[type], (uint64_t)delta);
+    else sub(&acc->atoms[type], (uint64_t)-delta);
+}
+
+void memory_account_alloc_sized(memory_accounting_t* acc, memory_category_t category,
+                                atom_type_t type, uint64_t count, size_t requested, size_t allocated) {
+    if (!acc) return;
+    memory_usage_t* usage = &acc->categories[category];
+    add(&usage->count, count);
+    add(&usage->requested, requested);
+    add(&usage->allocated, allocated);
+
+    if ((unsigned)type < ATOM_TYPE_MAX) {
+        add(&acc->types[type].requested, requested);
+        add(&acc->types[type].allocated, allocated);
+    }
+}
+
+void memory_account_free_sized(memory_accounting_t* acc, memory_category_t category,
+                               atom_type_t type, uint64_t count, size_t requested, size_t allocated) {
+    if (!acc) return;
+    memory_usage_t* usage = &acc->categories[category];
+    sub(&usage->count, count);
+    sub(&usage->requested, requested);
+    sub(&usage->allocated, allocated);
+
+    if ((unsigned)type < ATOM_TYPE_MAX) {
+        sub(&acc->types[type].requested, requested);
+        sub(&acc->types[type].allocated, allocated);
+    }
+}
+
+void memory_account_alloc(memory_accounting_t* acc, memory_category_t category,
+                          atom_type_t type, const void* ptr, size_t requested) {
+    if (!ptr) return;
+    memory_account_alloc_sized(acc, category, type, 1, requested, malloc_usable_size((void*)ptr));
+}
+
+void memory_account_free(memory_accounting_t* acc, memory_category_t category,
+                         atom_type_t type, const void* ptr, size_t requested) {
+    if (!ptr) return;
+    memory_account_free_sized(acc, category, type, 1, requested, malloc_usable_size((void*)ptr));
+}
+
+/* `old_allocated` must be read before the realloc; zero means a new allocation */
+void memory_account_resize(memory_accounting_t* acc, memory_category_t category,
+                           atom_type_t type, size_t old_requested, size_t old_allocated,
+                           const void* ptr, size_t requested) {
+    if (!acc || !ptr) return;
+    uint64_t allocated = malloc_usable_size((void*)ptr);
+
+    memory_usage_t* usage = &acc->categories[category];
+    if (old_allocated == 0) add(&usage->count, 1);
+    add(&usage->requested, requested - old_requested);
+    add(&usage->allocated, allocated - old_allocated);
+
+    if ((unsigned)type < ATOM_TYPE_MAX) {
+        add(&acc->types[type].requested, requested - old_requested);
+        add(&acc->types[type].allocated, allocated - old_allocated);
+    }
+}
+
+/*
+ * Snapshot: fixed-size per-atom structures are derived from the atom counts.
+ * A handle shares its atom's allocation, so the chunk's slack is charged to
+ * the atom (batch-created atoms are charged the same); hash entries come
+ * from slabs and carry no per-entry overhead.
+ */
+void memory_accounting_read(memory_accounting_t* acc, atomspace_memory_t* out,
+                            size_t hash_entry_size) {
+    size_t handle_chunk = sizeof(atom_handle_t);
+    size_t atom_chunk = memory_chunk_size(sizeof(atom_handle_t) + sizeof(atom_t)) - handle_chunk;
+    size_t entry_chunk = hash_entry_size;
+    uint64_t total_atoms = 0;
+
+    for (int t = 0; t < ATOM_TYPE_MAX; t++) {
+        uint64_t atoms = load(&acc->atoms[t]);
+        memory_usage_t* usage = &out->by_type[t];
+        usage->count = atoms;
+        usage->requested = load(&acc->types[t].requested) +
+                           atoms * (sizeof(atom_t) + sizeof(atom_handle_t) + hash_entry_size);
+        usage->allocated = load(&acc->types[t].allocated) +
+                           atoms * (atom_chunk + handle_chunk + entry_chunk);
+        total_atoms += atoms;
+    }
+
+    for (int c = MEMORY_NAMES; c <= MEMORY_INCOMING; c++) {
+        out->categories[c].count = load(&acc->categories[c].count);
+        out->categories[c].requested = load(&acc->categories[c].requested);
+        out->categories[c].allocated = load(&acc->categories[c].allocated);
+    }
+
+    out->categories[MEMORY_ATOMS].count = total_atoms;
+    out->categories[MEMORY_ATOMS].requested = total_atoms * sizeof(atom_t);
+    out->categories[MEMORY_ATOMS].allocated = total_atoms * atom_chunk;
+    out->categories[MEMORY_HANDLES].count = total_atoms;
+    out->categories[MEMORY_HANDLES].requested = total_atoms * sizeof(atom_handle_t);
+    out->categories[MEMORY_HANDLES].allocated = total_atoms * handle_chunk;
+    out->categories[MEMORY_HASH_TABLE].count += total_atoms;
+    out->categories[MEMORY_HASH_TABLE].requested += total_atoms * hash_entry_size;
+    out->categories[MEMORY_HASH_TABLE].allocated += total_atoms * entry_chunk;
+}
+
+/* Query */
+static void read_heap(atomspace_memory_t* out) {
+    struct mallinfo2 info = mallinfo2();
+    out->has_heap = true;
+    out->heap_arena = info.arena;
+    out->heap_mmapped = info.hblkhd;
+    out->heap_in_use = info.uordblks + info.hblkhd;
+    out->heap_free = info.fordblks;
+    out->heap_releasable = info.keepcost;
+
+    /* Free space below the top chunk cannot be returned to the OS */
+    uint64_t trapped = info.fordblks > info.keepcost ? info.fordblks - info.keepcost : 0;
+    out->fragmentation = info.arena ? (double)trapped / (double)info.arena : 0.0;
+}
+
+int atomspace_memory_usage(atomspace_t* space, atomspace_memory_t* out, int flags) {
+    if (!space || !out || !space->memory_accounting) return -1;
+    memset(out, 0, sizeof(*out));
+
+    atomspace_memory_layout(space, out);
+    distributed_memory_usage(&out->categories[MEMORY_MESSAGES], &out->categories[MEMORY_SHARED]);
+    mvcc_memory_usage(&out->categories[MEMORY_VERSIONS]);
+
+    for (int c = 0; c < MEMORY_CATEGORY_COUNT; c++) {
+        out->total.count += out->categories[c].count;
+        out->total.requested += out->categories[c].requested;
+        out->total.allocated += out->categories[c].allocated;
+    }
+    out->slack = out->total.allocated - out->total.requested;
+
+    if (flags & MEMORY_INCLUDE_HEAP) read_heap(out);
+    return 0;
+}
+
+const char* memory_category_name(memory_category_t category) {
+    return ((unsigned)category < MEMORY_CATEGORY_COUNT) ? category_names[category] : "unknown";
+}
+
+void atomspace_memory_print(const atomspace_memory_t* mem, FILE* out) {
+    fprintf(out, "AtomSpace memory (requested / allocated bytes)\n");
+    fprintf(out, "  %-16s %12s %14s %14s %8s\n", "subsystem", "count", "requested", "allocated", "slack");
+    for (int c = 0; c < MEMORY_CATEGORY_COUNT; c++) {
+        const memory_usage_t* u = &mem->categories[c];
+        fprintf(out, "  %-16s %12llu %14llu %14llu %7.1f%%\n", category_names[c],
+                (unsigned long long)u->count, (unsigned long long)u->requested,
+                (unsigned long long)u->allocated,
+                u->allocated ? 100.0 * (double)(u->allocated - u->requested) / (double)u->allocated : 0.0);
+    }
+    fprintf(out, "  %-16s %12llu %14llu %14llu %7.1f%%\n", "total",
+            (unsigned long long)mem->total.count, (unsigned long long)mem->total.requested,
+            (unsigned long long)mem->total.allocated,
+            mem->total.allocated ? 100.0 * (double)mem->slack / (double)mem->total.allocated : 0.0);
+
+    fprintf(out, "  %-16s %12s %14s %14s %8s\n", "atom type", "atoms", "requested", "allocated", "B/atom");
+    for (int t = 0; t < ATOM_TYPE_MAX; t++) {
+        const memory_usage_t* u = &mem->by_type[t];
+        if (!u->count) continue;
+        fprintf(out, "  %-16s %12llu %14llu %14llu %8.1f\n", atom_type_name((atom_type_t)t),
+                (unsigned long long)u->count, (unsigned long long)u->requested,
+                (unsigned long long)u->allocated, (double)u->allocated / (double)u->count);
+    }
+
+    if (mem->has_heap) {
+        fprintf(out, "  heap: arena %llu, mmapped %llu, in use %llu, free %llu (%llu releasable), "
+                "fragmentation %.1f%%\n",
+                (unsigned long long)mem->heap_arena, (unsigned long long)mem->heap_mmapped,
+                (unsigned long long)mem->heap_in_use, (unsigned long long)mem->heap_free,
+                (unsigned long long)mem->heap_releasable, 100.0 * mem->fragmentation);
+    }
+}
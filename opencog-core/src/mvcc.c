@@ -0,0 +1,154 @@
+/*
+ * OpenCog Multi-Version Concurrency Control
+ * Commit clock, in-flight writer tracking and snapshot versions
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <malloc.h>
+#include "../include/mvcc.h"
+
+static uint64_t commit_clock = 1;
+static uint64_t open_snapshots = 0;
+static uint64_t open_writes = 0;      /* Writers between mvcc_write_begin and _end */
+static uint64_t horizon = 0;          /* Highest horizon handed out so far */
+
+/*
+ * Per-thread writer state. `pending` is a lower bound on the version the
+ * thread is writing, 0 when idle; snapshots stay below every pending write.
+ */
+typedef struct writer_record {
+    uint64_t pending;
+    bool in_use;
+    struct writer_record* next;
+} writer_record_t;
+
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static writer_record_t* registry = NULL;
+static pthread_key_t record_key;
+static pthread_once_t record_key_once = PTHREAD_ONCE_INIT;
+static __thread writer_record_t* local_record = NULL;
+
+static memory_usage_t version_memory;
+
+static void record_thread_exit(void* arg) {
+    writer_record_t* record = (writer_record_t*)arg;
+    pthread_mutex_lock(&registry_lock);
+    __atomic_store_n(&record->pending, 0, __ATOMIC_RELEASE);
+    record->in_use = false;
+    pthread_mutex_unlock(&registry_lock);
+}
+
+static void make_record_key(void) {
+    pthread_key_create(&record_key, record_thread_exit);
+}
+
+static writer_record_t* thread_record(void) {
+    if (local_record) return local_record;
+
+    pthread_once(&record_key_once, make_record_key);
+    pthread_mutex_lock(&registry_lock);
+
+    writer_record_t* record = registry;
+    while (record && record->in_use) {
+        record = record->next;
+    }
+    if (!record) {
+        record = calloc(1, sizeof(writer_record_t));
+        __atomic_store_n(&record->next, registry, __ATOMIC_RELAXED);
+        __atomic_store_n(&registry, record, __ATOMIC_RELEASE);
+    }
+    record->in_use = true;
+
+    pthread_mutex_unlock(&registry_lock);
+    pthread_setspecific(record_key, record);
+    local_record = record;
+    return record;
+}
+
+/* Writer side */
+uint64_t mvcc_write_begin(void) {
+    writer_record_t* record = thread_record();
+    __atomic_add_fetch(&open_writes, 1, __ATOMIC_SEQ_CST);
+    /*
+     * The mark is read from the clock after the count went up, so a stamped
+     * write that missed the count is already below it; the increment below
+     * publishes the mark to anyone who sees the new version.
+     */
+    __atomic_store_n(&record->pending, __atomic_load_n(&commit_clock, __ATOMIC_SEQ_CST) + 1,
+                     __ATOMIC_SEQ_CST);
+    return __atomic_add_fetch(&commit_clock, 1, __ATOMIC_SEQ_CST);
+}
+
+void mvcc_write_end(void) {
+    __atomic_store_n(&local_record->pending, 0, __ATOMIC_SEQ_CST);
+    __atomic_sub_fetch(&open_writes, 1, __ATOMIC_SEQ_CST);
+}
+
+uint64_t mvcc_stamp(void) {
+    return __atomic_add_fetch(&commit_clock, 1, __ATOMIC_SEQ_CST);
+}
+
+bool mvcc_history_needed(void) {
+    return __atomic_load_n(&open_snapshots, __ATOMIC_SEQ_CST) > 0 ||
+           __atomic_load_n(&open_writes, __ATOMIC_SEQ_CST) > 0;
+}
+
+uint64_t mvcc_horizon(void) {
+    /* Newest version below every write still in flight */
+    uint64_t version = __atomic_load_n(&commit_clock, __ATOMIC_SEQ_CST);
+    writer_record_t* head = __atomic_load_n(&registry, __ATOMIC_ACQUIRE);
+    for (writer_record_t* record = head; record; record = record->next) {
+        uint64_t pending = __atomic_load_n(&record->pending, __ATOMIC_SEQ_CST);
+        if (pending != 0 && pending - 1 < version) version = pending - 1;
+    }
+
+    /*
+     * A mark read from a stale clock can land below a horizon handed out
+     * earlier. Everything at or below that one is still complete, so never
+     * go back behind it.
+     */
+    uint64_t handed = __atomic_load_n(&horizon, __ATOMIC_ACQUIRE);
+    while (handed < version &&
+           !__atomic_compare_exchange_n(&horizon, &handed, version, true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+    }
+    return handed > version ? handed : version;
+}
+
+/* Snapshot side */
+uint64_t mvcc_snapshot_begin(void) {
+    /*
+     * Writers that check for history after this keep it; the rest kept it
+     * for an older marked write or are at or below the horizon
+     */
+    __atomic_add_fetch(&open_snapshots, 1, __ATOMIC_SEQ_CST);
+    return mvcc_horizon();
+}
+
+void mvcc_snapshot_end(void) {
+    __atomic_sub_fetch(&open_snapshots, 1, __ATOMIC_SEQ_CST);
+}
+
+/* History records */
+atom_value_version_t* mvcc_version_alloc(void) {
+    atom_value_version_t* version = malloc(sizeof(atom_value_version_t));
+    __atomic_fetch_add(&version_memory.count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&version_memory.requested, sizeof(atom_value_version_t), __ATOMIC_RELAXED);
+    __atomic_fetch_add(&version_memory.allocated, malloc_usable_size(version), __ATOMIC_RELAXED);
+    return version;
+}
+
+void mvcc_version_free(atom_value_version_t* version) {
+    if (!version) return;
+    __atomic_fetch_sub(&version_memory.count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_sub(&version_memory.requested, sizeof(atom_value_version_t), __ATOMIC_RELAXED);
+    __atomic_fetch_sub(&version_memory.allocated, malloc_usable_size(version), __ATOMIC_RELAXED);
+    free(version);
+}
+
+void mvcc_memory_usage(memory_usage_t* versions) {
+    if (!versions) return;
+    versions->count = __atomic_load_n(&version_memory.count, __ATOMIC_RELAXED);
+    versions->requested = __atomic_load_n(&version_memory.requested, __ATOMIC_RELAXED);
+    versions->allocated = __atomic_load_n(&version_memory.allocated, __ATOMIC_RELAXED);
+}
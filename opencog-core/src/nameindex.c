@@ -0,0 +1,565 @@
+/*
+ * OpenCog Name Index
+ * Radix trie over atom names with prefix, glob and fuzzy search
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <pthread.h>
+#include "../include/nameindex.h"
+#include "../include/mvcc.h"
+#include "../include/lockprof.h"
+
+LOCKPROF_SITE(name_read_site, "name_index.read");
+LOCKPROF_SITE(name_write_site, "name_index.write");
+
+/*
+ * A trie node. Its name is the concatenated labels from the root; children
+ * are sorted by the first byte of their label, which no two share, and
+ * every node other than the root holds atoms or branches.
+ */
+typedef struct name_node {
+    char* label;
+    uint32_t label_length;
+    uint32_t child_count;
+    uint32_t child_capacity;
+    uint32_t atom_count;
+    uint32_t atom_capacity;
+    struct name_node** children;
+    atom_handle_t** atoms;        /* Atoms with exactly this name, in creation order */
+} name_node_t;
+
+struct name_index {
+    pthread_rwlock_t lock;        /* Searches read, inserts and removals write */
+    name_node_t root;             /* Empty label */
+};
+
+/* Trie maintenance */
+static name_node_t* node_create(const char* label, size_t length) {
+    name_node_t* node = calloc(1, sizeof(name_node_t));
+    node->label = malloc(length + 1);
+    memcpy(node->label, label, length);
+    node->label[length] = '\0';
+    node->label_length = (uint32_t)length;
+    return node;
+}
+
+static void node_free(name_node_t* node) {
+    for (uint32_t i = 0; i < node->child_count; i++) {
+        node_free(node->children[i]);
+    }
+    free(node->children);
+    free(node->atoms);
+    free(node->label);
+    free(node);
+}
+
+/* Index of the child starting with `byte`, or where it would be inserted */
+static uint32_t child_search(const name_node_t* node, unsigned char byte, bool* found) {
+    uint32_t lo = 0, hi = node->child_count;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        unsigned char first = (unsigned char)node->children[mid]->label[0];
+        if (first == byte) {
+            *found = true;
+            return mid;
+        }
+        if (first < byte) lo = mid + 1;
+        else hi = mid;
+    }
+    *found = false;
+    return lo;
+}
+
+static void child_insert(name_node_t* node, uint32_t at, name_node_t* child) {
+    if (node->child_count == node->child_capacity) {
+        node->child_capacity = node->child_capacity ? node->child_capacity * 2 : 2;
+        node->children = realloc(node->children, node->child_capacity * sizeof(name_node_t*));
+    }
+    memmove(&node->children[at + 1], &node->children[at],
+            (node->child_count - at) * sizeof(name_node_t*));
+    node->children[at] = child;
+    node->child_count++;
+}
+
+static void atom_append(name_node_t* node, atom_handle_t* handle) {
+    if (node->atom_count == node->atom_capacity) {
+        node->atom_capacity = node->atom_capacity ? node->atom_capacity * 2 : 1;
+        node->atoms = realloc(node->atoms, node->atom_capacity * sizeof(atom_handle_t*));
+    }
+    node->atoms[node->atom_count++] = handle;
+}
+
+static void trie_insert(name_node_t* node, const char* name, size_t length, atom_handle_t* handle) {
+    size_t pos = 0;
+    while (pos < length) {
+        bool found;
+        uint32_t at = child_search(node, (unsigned char)name[pos], &found);
+        if (!found) {
+            name_node_t* leaf = node_create(name + pos, length - pos);
+            atom_append(leaf, handle);
+            child_insert(node, at, leaf);
+            return;
+        }
+
+        name_node_t* child = node->children[at];
+        size_t common = 1;
+        while (common < child->label_length && pos + common < length &&
+               child->label[common] == name[pos + common]) {
+            common++;
+        }
+        if (common < child->label_length) {
+            /* Split the child's label; the head becomes the new branch point */
+            name_node_t* head = node_create(child->label, common);
+            child->label_length -= (uint32_t)common;
+            memmove(child->label, child->label + common, child->label_length + 1);
+            child_insert(head, 0, child);
+            node->children[at] = head;
+            child = head;
+        }
+        node = child;
+        pos += common;
+    }
+    atom_append(node, handle);
+}
+
+/* Fold a node holding no atoms and one child into that child */
+static void node_merge_child(name_node_t* node) {
+    name_node_t* child = node->children[0];
+    char* label = malloc(node->label_length + child->label_length + 1);
+    memcpy(label, node->label, node->label_length);
+    memcpy(label + node->label_length, child->label, child->label_length + 1);
+    free(node->label);
+    node->label = label;
+    node->label_length += child->label_length;
+
+    free(node->children);
+    free(node->atoms);
+    node->children = child->children;
+    node->child_count = child->child_count;
+    node->child_capacity = child->child_capacity;
+    node->atoms = child->atoms;
+    node->atom_count = child->atom_count;
+    node->atom_capacity = child->atom_capacity;
+    free(child->label);
+    free(child);
+}
+
+/* Remove `handle` below `node`, pruning and merging the nodes it leaves bare */
+static bool trie_remove(name_node_t* node, const char* name, size_t length, atom_handle_t* handle) {
+    if (length == 0) {
+        for (uint32_t i = 0; i < node->atom_count; i++) {
+            if (node->atoms[i] != handle) continue;
+            memmove(&node->atoms[i], &node->atoms[i + 1], (node->atom_count - i - 1) * sizeof(atom_handle_t*));
+            node->atom_count--;
+            return true;
+        }
+        return false;
+    }
+
+    bool found;
+    uint32_t at = child_search(node, (unsigned char)name[0], &found);
+    if (!found) return false;
+    name_node_t* child = node->children[at];
+    if (child->label_length > length || memcmp(child->label, name, child->label_length) != 0) return false;
+    if (!trie_remove(child, name + child->label_length, length - child->label_length, handle)) return false;
+
+    if (child->atom_count == 0 && child->child_count == 0) {
+        node_free(child);
+        memmove(&node->children[at], &node->children[at + 1], (node->child_count - at - 1) * sizeof(name_node_t*));
+        node->child_count--;
+    } else if (child->atom_count == 0 && child->child_count == 1) {
+        node_merge_child(child);
+    }
+    return true;
+}
+
+/* The node whose name is `name`, NULL if there is none */
+static const name_node_t* trie_find(const name_node_t* node, const char* name, size_t length) {
+    while (length > 0) {
+        bool found;
+        uint32_t at = child_search(node, (unsigned char)name[0], &found);
+        if (!found) return NULL;
+        node = node->children[at];
+        if (node->label_length > length || memcmp(node->label, name, node->label_length) != 0) return NULL;
+        name += node->label_length;
+        length -= node->label_length;
+    }
+    return node;
+}
+
+/* Hooks */
+name_index_t* name_index_create(void) {
+    name_index_t* index = calloc(1, sizeof(name_index_t));
+    if (!index) return NULL;
+    pthread_rwlock_init(&index->lock, NULL);
+    index->root.label = calloc(1, 1);
+    return index;
+}
+
+void name_index_destroy(name_index_t* index) {
+    if (!index) return;
+    for (uint32_t i = 0; i < index->root.child_count; i++) {
+        node_free(index->root.children[i]);
+    }
+    free(index->root.children);
+    free(index->root.atoms);
+    free(index->root.label);
+    pthread_rwlock_destroy(&index->lock);
+    free(index);
+}
+
+void name_index_insert(name_index_t* index, atom_handle_t* const* handles, size_t count) {
+    if (!index) return;
+    uint64_t held = lockprof_wrlock(&index->lock, &name_write_site);
+    for (size_t i = 0; i < count; i++) {
+        const char* name = handles[i]->atom->name;
+        if (name) trie_insert(&index->root, name, strlen(name), handles[i]);
+    }
+    lockprof_rwlock_unlock(&index->lock, &name_write_site, held);
+}
+
+void name_index_remove(name_index_t* index, atom_handle_t* handle) {
+    if (!index || !handle->atom->name) return;
+    const char* name = handle->atom->name;
+    uint64_t held = lockprof_wrlock(&index->lock, &name_write_site);
+    trie_remove(&index->root, name, strlen(name), handle);
+    lockprof_rwlock_unlock(&index->lock, &name_write_site, held);
+}
+
+atom_handle_t** name_index_lookup(name_index_t* index, const char* name, bool retain,
+                                  uint64_t version, size_t* count) {
+    uint64_t held = lockprof_rdlock(&index->lock, &name_read_site);
+    const name_node_t* node = trie_find(&index->root, name, strlen(name));
+    size_t matches = 0;
+    for (uint32_t i = 0; node && i < node->atom_count; i++) {
+        if (atom_visible_at(node->atoms[i]->atom, version)) matches++;
+    }
+
+    atom_handle_t** result = malloc(sizeof(atom_handle_t*) * matches);
+    size_t idx = 0;
+    for (uint32_t i = 0; node && i < node->atom_count && idx < matches; i++) {
+        atom_handle_t* handle = node->atoms[i];
+        if (!atom_visible_at(handle->atom, version)) continue;
+        result[idx++] = handle;
+        if (retain) atom_retain(handle);
+    }
+    lockprof_rwlock_unlock(&index->lock, &name_read_site, held);
+
+    *count = idx;
+    return result;
+}
+
+static void node_memory(const name_node_t* node, memory_usage_t* usage) {
+    usage->count++;
+    usage->requested += sizeof(name_node_t) + node->label_length + 1 +
+                        node->child_count * sizeof(name_node_t*) +
+                        node->atom_count * sizeof(atom_handle_t*);
+    usage->allocated += malloc_usable_size(node->label) + malloc_usable_size(node->children) +
+                        malloc_usable_size(node->atoms);
+    for (uint32_t i = 0; i < node->child_count; i++) {
+        usage->allocated += malloc_usable_size(node->children[i]);
+        node_memory(node->children[i], usage);
+    }
+}
+
+void name_index_memory(name_index_t* index, memory_usage_t* usage) {
+    if (!index) return;
+    uint64_t held = lockprof_rdlock(&index->lock, &name_read_site);
+    usage->allocated += malloc_usable_size(index);
+    node_memory(&index->root, usage);
+    lockprof_rwlock_unlock(&index->lock, &name_read_site, held);
+}
+
+/* Searches; each walks the trie in byte order, so results come out sorted by name */
+typedef struct {
+    atom_handle_t** out;
+    size_t max;
+    size_t count;
+} emit_t;
+
+/* Append the node's live atoms; false once `out` is full */
+static bool emit_atoms(const name_node_t* node, emit_t* emit) {
+    for (uint32_t i = 0; i < node->atom_count; i++) {
+        if (emit->count == emit->max) return false;
+        atom_handle_t* handle = node->atoms[i];
+        if (atom_visible_at(handle->atom, MVCC_LATEST)) emit->out[emit->count++] = handle;
+    }
+    return emit->count < emit->max;
+}
+
+static bool emit_subtree(const name_node_t* node, emit_t* emit) {
+    if (!emit_atoms(node, emit)) return false;
+    for (uint32_t i = 0; i < node->child_count; i++) {
+        if (!emit_subtree(node->children[i], emit)) return false;
+    }
+    return true;
+}
+
+size_t atomspace_name_prefix(atomspace_t* space, const char* prefix, atom_handle_t** out, size_t max) {
+    if (!space || !prefix || !out || max == 0) return 0;
+    name_index_t* index = (name_index_t*)space->name_index;
+    emit_t emit = { out, max, 0 };
+
+    uint64_t held = lockprof_rdlock(&index->lock, &name_read_site);
+    const name_node_t* node = &index->root;
+    size_t length = strlen(prefix);
+    while (node && length > 0) {
+        bool found;
+        uint32_t at = child_search(node, (unsigned char)prefix[0], &found);
+        node = found ? node->children[at] : NULL;
+        if (!node) break;
+
+        /* The prefix may end inside a label */
+        size_t compare = node->label_length < length ? node->label_length : length;
+        if (memcmp(node->label, prefix, compare) != 0) node = NULL;
+        prefix += compare;
+        length -= compare;
+    }
+    if (node) emit_subtree(node, &emit);
+    lockprof_rwlock_unlock(&index->lock, &name_read_site, held);
+    return emit.count;
+}
+
+/* Glob patterns run as an NFA whose state set rides along the walk */
+enum { GLOB_BYTE, GLOB_ANY, GLOB_STAR, GLOB_CLASS };
+
+typedef struct {
+    uint8_t kind;
+    uint8_t byte;
+    uint8_t bits[32];             /* GLOB_CLASS members */
+} glob_token_t;
+
+typedef struct {
+    glob_token_t tokens[NAME_GLOB_MAX_TOKENS];
+    size_t count;                 /* State `count` accepts */
+} glob_t;
+
+static bool glob_compile(const char* pattern, glob_t* glob) {
+    glob->count = 0;
+    const unsigned char* p = (const unsigned char*)pattern;
+    while (*p) {
+        if (*p == '*' && glob->count && glob->tokens[glob->count - 1].kind == GLOB_STAR) {
+            p++;
+            continue;
+        }
+        if (glob->count == NAME_GLOB_MAX_TOKENS) return false;
+        glob_token_t* token = &glob->tokens[glob->count++];
+        memset(token, 0, sizeof(*token));
+
+        if (*p == '*') {
+            token->kind = GLOB_STAR;
+            p++;
+        } else if (*p == '?') {
+            token->kind = GLOB_ANY;
+            p++;
+        } else if (*p == '[') {
+            /* A `]` right after the opening bracket is a member */
+            const unsigned char* q = p + 1;
+            bool negate = *q == '!' || *q == '^';
+            if (negate) q++;
+            for (bool first = true; *q && (first || *q != ']'); first = false) {
+                unsigned char lo = *q, hi = *q;
+                if (q[1] == '-' && q[2] && q[2] != ']') {
+                    hi = q[2];
+                    q += 2;
+                }
+                for (unsigned c = lo; c <= hi; c++) token->bits[c >> 3] |= (uint8_t)(1u << (c & 7));
+                q++;
+            }
+            if (!*q) {
+                /* Unterminated: a literal bracket */
+                memset(token, 0, sizeof(*token));
+                token->kind = GLOB_BYTE;
+                token->byte = '[';
+                p++;
+                continue;
+            }
+            if (negate) {
+                for (int i = 0; i < 32; i++) token->bits[i] = (uint8_t)~token->bits[i];
+            }
+            token->kind = GLOB_CLASS;
+            p = q + 1;
+        } else {
+            if (*p == '\\' && p[1]) p++;
+            token->kind = GLOB_BYTE;
+            token->byte = *p++;
+        }
+    }
+    return true;
+}
+
+/* A `*` may match nothing, so reaching it reaches the state after it */
+static uint64_t glob_closure(const glob_t* glob, uint64_t states) {
+    for (size_t i = 0; i < glob->count; i++) {
+        if ((states >> i & 1) && glob->tokens[i].kind == GLOB_STAR) states |= 1ull << (i + 1);
+    }
+    return states;
+}
+
+static uint64_t glob_step(const glob_t* glob, uint64_t states, unsigned char byte) {
+    uint64_t next = 0;
+    for (size_t i = 0; i < glob->count && states >> i; i++) {
+        if (!(states >> i & 1)) continue;
+        const glob_token_t* token = &glob->tokens[i];
+        switch (token->kind) {
+        case GLOB_STAR:
+            next |= 1ull << i;
+            break;
+        case GLOB_ANY:
+            next |= 1ull << (i + 1);
+            break;
+        case GLOB_BYTE:
+            if (token->byte == byte) next |= 1ull << (i + 1);
+            break;
+        case GLOB_CLASS:
+            if (token->bits[byte >> 3] >> (byte & 7) & 1) next |= 1ull << (i + 1);
+            break;
+        }
+    }
+    return glob_closure(glob, next);
+}
+
+static bool glob_walk(const name_node_t* node, const glob_t* glob, uint64_t states, emit_t* emit) {
+    if ((states >> glob->count & 1) && !emit_atoms(node, emit)) return false;
+    for (uint32_t i = 0; i < node->child_count; i++) {
+        const name_node_t* child = node->children[i];
+        uint64_t next = states;
+        for (uint32_t b = 0; b < child->label_length && next; b++) {
+            next = glob_step(glob, next, (unsigned char)child->label[b]);
+        }
+        if (next && !glob_walk(child, glob, next, emit)) return false;
+    }
+    return true;
+}
+
+size_t atomspace_name_glob(atomspace_t* space, const char* pattern, atom_handle_t** out, size_t max) {
+    if (!space || !pattern || !out || max == 0) return 0;
+    glob_t glob;
+    if (!glob_compile(pattern, &glob)) return 0;
+    name_index_t* index = (name_index_t*)space->name_index;
+    emit_t emit = { out, max, 0 };
+
+    uint64_t held = lockprof_rdlock(&index->lock, &name_read_site);
+    glob_walk(&index->root, &glob, glob_closure(&glob, 1), &emit);
+    lockprof_rwlock_unlock(&index->lock, &name_read_site, held);
+    return emit.count;
+}
+
+/*
+ * Fuzzy search keeps one Levenshtein row per byte of the current path, so
+ * a branch is computed once for every name below it and dropped as soon as
+ * no cell of its row is within the bound. Only the band of cells within
+ * max_edits of the diagonal can be, so each byte costs O(max_edits) rather
+ * than O(query length), like a step of a Levenshtein automaton.
+ */
+typedef struct {
+    name_match_t match;
+    size_t order;                 /* Position in name order */
+} fuzzy_hit_t;
+
+typedef struct {
+    const unsigned char* query;
+    size_t length;
+    uint32_t max_edits;
+    uint32_t* rows;               /* (length + 1) cells per depth; the band and one cell either side */
+    size_t row_capacity;          /* Depths allocated */
+    fuzzy_hit_t* matches;
+    size_t match_count;
+    size_t match_capacity;
+} fuzzy_t;
+
+static uint32_t* fuzzy_row(fuzzy_t* fuzzy, size_t depth) {
+    if (depth >= fuzzy->row_capacity) {
+        fuzzy->row_capacity = (depth + 1) * 2;
+        fuzzy->rows = realloc(fuzzy->rows, fuzzy->row_capacity * (fuzzy->length + 1) * sizeof(uint32_t));
+    }
+    return fuzzy->rows + depth * (fuzzy->length + 1);
+}
+
+/* Row `depth` from row `depth - 1`; false once every cell exceeds the bound */
+static bool fuzzy_step(fuzzy_t* fuzzy, size_t depth, unsigned char byte) {
+    uint32_t* next = fuzzy_row(fuzzy, depth);
+    const uint32_t* prev = next - (fuzzy->length + 1);
+    uint32_t bound = fuzzy->max_edits;
+    size_t lo = depth > bound ? depth - bound : 0;
+    size_t hi = bound >= fuzzy->length || depth + bound >= fuzzy->length ? fuzzy->length : depth + bound;
+    if (lo > hi) return false;
+
+    if (lo > 0) next[lo - 1] = bound + 1;
+    if (hi < fuzzy->length) next[hi + 1] = bound + 1;
+    uint32_t best = bound + 1;
+    for (size_t j = lo; j <= hi; j++) {
+        uint32_t cost = prev[j] + 1;
+        if (j > 0) {
+            uint32_t replace = prev[j - 1] + (fuzzy->query[j - 1] != byte);
+            uint32_t insert = next[j - 1] + 1;
+            if (replace < cost) cost = replace;
+            if (insert < cost) cost = insert;
+        }
+        if (cost > bound) cost = bound + 1;
+        next[j] = cost;
+        if (cost < best) best = cost;
+    }
+    return best <= bound;
+}
+
+static void fuzzy_walk(const name_node_t* node, fuzzy_t* fuzzy, size_t depth) {
+    if (depth + fuzzy->max_edits >= fuzzy->length && fuzzy_row(fuzzy, depth)[fuzzy->length] <= fuzzy->max_edits) {
+        uint32_t distance = fuzzy_row(fuzzy, depth)[fuzzy->length];
+        for (uint32_t i = 0; i < node->atom_count; i++) {
+            atom_handle_t* handle = node->atoms[i];
+            if (!atom_visible_at(handle->atom, MVCC_LATEST)) continue;
+            if (fuzzy->match_count == fuzzy->match_capacity) {
+                fuzzy->match_capacity = fuzzy->match_capacity ? fuzzy->match_capacity * 2 : 16;
+                fuzzy->matches = realloc(fuzzy->matches, fuzzy->match_capacity * sizeof(fuzzy_hit_t));
+            }
+            fuzzy->matches[fuzzy->match_count] = (fuzzy_hit_t){ { handle, distance }, fuzzy->match_count };
+            fuzzy->match_count++;
+        }
+    }
+
+    for (uint32_t c = 0; c < node->child_count; c++) {
+        const name_node_t* child = node->children[c];
+        bool alive = true;
+        for (uint32_t b = 0; b < child->label_length && alive; b++) {
+            alive = fuzzy_step(fuzzy, depth + b + 1, (unsigned char)child->label[b]);
+        }
+        if (alive) fuzzy_walk(child, fuzzy, depth + child->label_length);
+    }
+}
+
+/* Nearest first; matches were found in name order, which breaks ties */
+static int hit_by_distance(const void* a, const void* b) {
+    const fuzzy_hit_t* x = (const fuzzy_hit_t*)a;
+    const fuzzy_hit_t* y = (const fuzzy_hit_t*)b;
+    if (x->match.distance != y->match.distance) return x->match.distance < y->match.distance ? -1 : 1;
+    return x->order < y->order ? -1 : (x->order > y->order);
+}
+
+size_t atomspace_name_fuzzy(atomspace_t* space, const char* name, uint32_t max_edits,
+                            name_match_t* out, size_t max) {
+    if (!space || !name || !out || max == 0) return 0;
+    name_index_t* index = (name_index_t*)space->name_index;
+    /* Distances never exceed the longer name; the cap keeps bound + 1 from wrapping */
+    if (max_edits > UINT32_MAX / 2) max_edits = UINT32_MAX / 2;
+    fuzzy_t fuzzy = { (const unsigned char*)name, strlen(name), max_edits, NULL, 0, NULL, 0, 0 };
+    uint32_t* root = fuzzy_row(&fuzzy, 0);
+    for (size_t j = 0; j <= fuzzy.length; j++) root[j] = j <= max_edits ? (uint32_t)j : max_edits + 1;
+
+    uint64_t held = lockprof_rdlock(&index->lock, &name_read_site);
+    fuzzy_walk(&index->root, &fuzzy, 0);
+    lockprof_rwlock_unlock(&index->lock, &name_read_site, held);
+
+    size_t count = fuzzy.match_count < max ? fuzzy.match_count : max;
+    if (fuzzy.match_count > 1) {
+        qsort(fuzzy.matches, fuzzy.match_count, sizeof(fuzzy_hit_t), hit_by_distance);
+    }
+    for (size_t i = 0; i < count; i++) {
+        out[i] = fuzzy.matches[i].match;
+    }
+    free(fuzzy.matches);
+    free(fuzzy.rows);
+    return count;
+}
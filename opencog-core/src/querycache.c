@@ -0,0 +1,408 @@
+/*
+ * OpenCog Query Cache
+ * Bounded cache of query results with generation-based invalidation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <pthread.h>
+#include "../include/querycache.h"
+#include "../include/timeindex.h"
+#include "../include/epoch.h"
+#include "../include/lockprof.h"
+
+LOCKPROF_SITE(cache_read_site, "query_cache.read");
+LOCKPROF_SITE(cache_write_site, "query_cache.write");
+
+#define QUERY_CACHE_WAYS 4            /* Entries a key may occupy; the least recently used goes */
+
+typedef enum {
+    QUERY_TYPES,
+    QUERY_NAME,
+    QUERY_PATTERN
+} query_kind_t;
+
+typedef struct {
+    query_kind_t kind;
+    atom_type_set_t types;
+    const char* name;             /* Owned by entries */
+    pattern_matcher_fn matcher;
+    void* user_data;
+    uint64_t name_hash;
+    uint64_t hash;
+} query_key_t;
+
+typedef struct cached_result {
+    query_result_t result;
+    atom_handle_t** atoms;        /* From the borrowed query, NULL if empty */
+    struct cached_result* next;   /* Cleared results awaiting retirement */
+} cached_result_t;
+
+typedef struct {
+    query_key_t key;
+    uint64_t generation;
+    uint64_t last_used;
+    cached_result_t* result;      /* NULL while the entry is free */
+    size_t bytes;
+} cache_entry_t;
+
+struct query_cache {
+    uint64_t type_generations[ATOM_TYPE_MAX];
+    uint64_t name_generations[QUERY_NAME_GENERATIONS];
+    uint64_t structure_generation;
+
+    pthread_rwlock_t lock;        /* Lookups read, inserts and configuration write */
+    cache_entry_t* entries;       /* set_count * QUERY_CACHE_WAYS, allocated on first insert */
+    size_t set_count;
+    size_t max_entries;
+    size_t max_bytes;
+    size_t used;
+    size_t bytes;
+    size_t hand;                  /* Next entry to evict when over the byte budget */
+    uint64_t tick;
+
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t invalidations;
+    uint64_t evictions;
+};
+
+static uint64_t hash_bytes(uint64_t hash, const void* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static void key_init(query_key_t* key, query_kind_t kind) {
+    memset(key, 0, sizeof(*key));
+    key->kind = kind;
+}
+
+static void key_finish(query_key_t* key) {
+    uint64_t hash = hash_bytes(0xcbf29ce484222325ull, &key->kind, sizeof(key->kind));
+    if (key->kind == QUERY_TYPES) {
+        hash = hash_bytes(hash, &key->types, sizeof(key->types));
+    } else if (key->kind == QUERY_NAME) {
+        key->name_hash = hash_bytes(0xcbf29ce484222325ull, key->name, strlen(key->name));
+        hash ^= key->name_hash;
+        hash *= 0x100000001b3ull;
+    } else {
+        hash = hash_bytes(hash, &key->matcher, sizeof(key->matcher));
+        hash = hash_bytes(hash, &key->user_data, sizeof(key->user_data));
+    }
+    key->hash = hash;
+}
+
+static bool key_equal(const query_key_t* a, const query_key_t* b) {
+    if (a->hash != b->hash || a->kind != b->kind) return false;
+    if (a->kind == QUERY_TYPES) return a->types == b->types;
+    if (a->kind == QUERY_NAME) return strcmp(a->name, b->name) == 0;
+    return a->matcher == b->matcher && a->user_data == b->user_data;
+}
+
+/* Current generation of what a key's result depends on */
+static uint64_t key_generation(atomspace_t* space, const query_cache_t* cache, const query_key_t* key) {
+    if (key->kind == QUERY_TYPES) {
+        uint64_t generation = 0;
+        for (int t = 0; t < ATOM_TYPE_MAX && key->types >> t; t++) {
+            if (key->types & ATOM_TYPE_BIT(t)) {
+                generation += __atomic_load_n(&cache->type_generations[t], __ATOMIC_ACQUIRE);
+            }
+        }
+        return generation;
+    }
+    if (key->kind == QUERY_NAME) {
+        return __atomic_load_n(&cache->name_generations[key->name_hash % QUERY_NAME_GENERATIONS],
+                               __ATOMIC_ACQUIRE);
+    }
+    return __atomic_load_n(&cache->structure_generation, __ATOMIC_ACQUIRE) + atomspace_time_position(space);
+}
+
+/* Results */
+static cached_result_t* result_compute(atomspace_t* space, const query_key_t* key) {
+    size_t count = 0;
+    atom_handle_t** atoms;
+    if (key->kind == QUERY_TYPES) {
+        atoms = atomspace_get_atoms_by_types_borrowed(space, key->types, &count);
+    } else if (key->kind == QUERY_NAME) {
+        atoms = atomspace_get_atoms_by_name_borrowed(space, key->name, &count);
+    } else {
+        atoms = atomspace_match_pattern_borrowed(space, key->matcher, key->user_data, &count);
+    }
+    cached_result_t* result = malloc(sizeof(cached_result_t));
+    if (!result) {
+        free(atoms);
+        return NULL;
+    }
+    result->atoms = atoms;
+    result->next = NULL;
+    result->result.atoms = atoms;
+    result->result.count = atoms ? count : 0;
+    return result;
+}
+
+static void result_free(void* ptr) {
+    cached_result_t* result = (cached_result_t*)ptr;
+    free(result->atoms);
+    free(result);
+}
+
+static size_t result_bytes(const cached_result_t* result) {
+    return malloc_usable_size((void*)result) + (result->atoms ? malloc_usable_size(result->atoms) : 0);
+}
+
+/*
+ * Retire results cleared under the write lock, once it is released:
+ * retiring may run reclamation, which takes the hash table's write lock,
+ * while publishing holds that lock and then takes this cache's lock.
+ */
+static void results_retire(cached_result_t* retired) {
+    while (retired) {
+        cached_result_t* next = retired->next;
+        epoch_retire(retired, result_free);
+        retired = next;
+    }
+}
+
+/* Free an entry; lookups may still be using its result, so it joins `retired` */
+static void entry_clear(query_cache_t* cache, cache_entry_t* entry, cached_result_t** retired) {
+    if (!entry->result) return;
+    entry->result->next = *retired;
+    *retired = entry->result;
+    free((char*)entry->key.name);
+    cache->bytes -= entry->bytes;
+    cache->used--;
+    memset(entry, 0, sizeof(*entry));
+}
+
+static cache_entry_t* entry_find(query_cache_t* cache, const query_key_t* key) {
+    if (!cache->entries) return NULL;
+    cache_entry_t* set = &cache->entries[(key->hash % cache->set_count) * QUERY_CACHE_WAYS];
+    for (int w = 0; w < QUERY_CACHE_WAYS; w++) {
+        if (set[w].result && key_equal(&set[w].key, key)) return &set[w];
+    }
+    return NULL;
+}
+
+/*
+ * Store a result computed at `generation`, unless a newer one got there
+ * first. Returns false if it was not kept, leaving it to the caller.
+ */
+static bool entry_store(query_cache_t* cache, const query_key_t* key, uint64_t generation,
+                        cached_result_t* result, cached_result_t** retired) {
+    if (cache->max_entries == 0) return false;
+    size_t bytes = result_bytes(result);
+    if (bytes > cache->max_bytes) return false;
+    if (!cache->entries) {
+        cache->entries = calloc(cache->set_count * QUERY_CACHE_WAYS, sizeof(cache_entry_t));
+        if (!cache->entries) return false;
+    }
+
+    cache_entry_t* entry = entry_find(cache, key);
+    if (entry) {
+        if (entry->generation > generation) return false;
+        entry_clear(cache, entry, retired);
+    } else {
+        cache_entry_t* set = &cache->entries[(key->hash % cache->set_count) * QUERY_CACHE_WAYS];
+        entry = &set[0];
+        for (int w = 0; w < QUERY_CACHE_WAYS && entry->result; w++) {
+            if (!set[w].result || __atomic_load_n(&set[w].last_used, __ATOMIC_RELAXED) <
+                                  __atomic_load_n(&entry->last_used, __ATOMIC_RELAXED)) {
+                entry = &set[w];
+            }
+        }
+        if (entry->result) {
+            entry_clear(cache, entry, retired);
+            __atomic_fetch_add(&cache->evictions, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    /* Over the byte budget: sweep other entries out in order */
+    size_t total = cache->set_count * QUERY_CACHE_WAYS;
+    for (size_t swept = 0; cache->bytes + bytes > cache->max_bytes && swept < total; swept++) {
+        cache_entry_t* victim = &cache->entries[cache->hand];
+        cache->hand = (cache->hand + 1) % total;
+        if (victim != entry && victim->result) {
+            entry_clear(cache, victim, retired);
+            __atomic_fetch_add(&cache->evictions, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    char* name = NULL;
+    if (key->kind == QUERY_NAME && !(name = strdup(key->name))) return false;
+    entry->key = *key;
+    entry->key.name = name;
+    entry->generation = generation;
+    entry->last_used = __atomic_add_fetch(&cache->tick, 1, __ATOMIC_RELAXED);
+    entry->result = result;
+    entry->bytes = bytes;
+    cache->bytes += bytes;
+    cache->used++;
+    return true;
+}
+
+static const query_result_t* cached_query(atomspace_t* space, query_key_t* key) {
+    static const query_result_t empty = { 0, NULL };
+    if (!space) return &empty;
+    query_cache_t* cache = (query_cache_t*)space->query_cache;
+    key_finish(key);
+    uint64_t generation = key_generation(space, cache, key);
+
+    uint64_t held = lockprof_rdlock(&cache->lock, &cache_read_site);
+    cache_entry_t* entry = entry_find(cache, key);
+    if (entry && entry->generation == generation) {
+        __atomic_store_n(&entry->last_used, __atomic_add_fetch(&cache->tick, 1, __ATOMIC_RELAXED),
+                         __ATOMIC_RELAXED);
+        const query_result_t* hit = &entry->result->result;
+        lockprof_rwlock_unlock(&cache->lock, &cache_read_site, held);
+        __atomic_fetch_add(&cache->hits, 1, __ATOMIC_RELAXED);
+        return hit;
+    }
+    lockprof_rwlock_unlock(&cache->lock, &cache_read_site, held);
+    __atomic_fetch_add(&cache->misses, 1, __ATOMIC_RELAXED);
+    if (entry) __atomic_fetch_add(&cache->invalidations, 1, __ATOMIC_RELAXED);
+
+    /* Computed after the generation was read, so a mutation racing with it outdates the entry */
+    cached_result_t* result = result_compute(space, key);
+    if (!result) return &empty;
+    cached_result_t* retired = NULL;
+    held = lockprof_wrlock(&cache->lock, &cache_write_site);
+    bool kept = entry_store(cache, key, generation, result, &retired);
+    lockprof_rwlock_unlock(&cache->lock, &cache_write_site, held);
+    results_retire(retired);
+    /* An uncached result lives until the caller's read section ends */
+    if (!kept) epoch_retire(result, result_free);
+    return &result->result;
+}
+
+const query_result_t* atomspace_cached_by_type(atomspace_t* space, atom_type_t type) {
+    return atomspace_cached_by_types(space, atom_type_valid(type) ? ATOM_TYPE_BIT(type) : 0);
+}
+
+const query_result_t* atomspace_cached_by_types(atomspace_t* space, atom_type_set_t types) {
+    query_key_t key;
+    key_init(&key, QUERY_TYPES);
+    key.types = types;
+    return cached_query(space, &key);
+}
+
+const query_result_t* atomspace_cached_by_name(atomspace_t* space, const char* name) {
+    static const query_result_t empty = { 0, NULL };
+    if (!name) return &empty;
+    query_key_t key;
+    key_init(&key, QUERY_NAME);
+    key.name = name;
+    return cached_query(space, &key);
+}
+
+const query_result_t* atomspace_cached_match(atomspace_t* space, pattern_matcher_fn matcher, void* user_data) {
+    static const query_result_t empty = { 0, NULL };
+    if (!matcher) return &empty;
+    query_key_t key;
+    key_init(&key, QUERY_PATTERN);
+    key.matcher = matcher;
+    key.user_data = user_data;
+    return cached_query(space, &key);
+}
+
+/* Configuration and statistics */
+static size_t set_count_for(size_t max_entries) {
+    size_t sets = 1;
+    while (sets * QUERY_CACHE_WAYS < max_entries) sets <<= 1;
+    return sets;
+}
+
+int atomspace_query_cache_configure(atomspace_t* space, size_t max_entries, size_t max_bytes) {
+    if (!space || (max_entries && !max_bytes)) return -1;
+    query_cache_t* cache = (query_cache_t*)space->query_cache;
+    cached_result_t* retired = NULL;
+    uint64_t held = lockprof_wrlock(&cache->lock, &cache_write_site);
+    if (cache->entries) {
+        for (size_t i = 0; i < cache->set_count * QUERY_CACHE_WAYS; i++) {
+            entry_clear(cache, &cache->entries[i], &retired);
+        }
+        free(cache->entries);
+        cache->entries = NULL;
+    }
+    cache->max_entries = max_entries;
+    cache->max_bytes = max_bytes;
+    cache->set_count = set_count_for(max_entries);
+    cache->hand = 0;
+    lockprof_rwlock_unlock(&cache->lock, &cache_write_site, held);
+    results_retire(retired);
+    return 0;
+}
+
+void atomspace_query_cache_stats(atomspace_t* space, query_cache_stats_t* stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!space) return;
+    query_cache_t* cache = (query_cache_t*)space->query_cache;
+    uint64_t held = lockprof_rdlock(&cache->lock, &cache_read_site);
+    stats->entries = cache->used;
+    stats->bytes = cache->bytes;
+    lockprof_rwlock_unlock(&cache->lock, &cache_read_site, held);
+    stats->hits = __atomic_load_n(&cache->hits, __ATOMIC_RELAXED);
+    stats->misses = __atomic_load_n(&cache->misses, __ATOMIC_RELAXED);
+    stats->invalidations = __atomic_load_n(&cache->invalidations, __ATOMIC_RELAXED);
+    stats->evictions = __atomic_load_n(&cache->evictions, __ATOMIC_RELAXED);
+    uint64_t total = stats->hits + stats->misses;
+    stats->hit_ratio = total ? (double)stats->hits / (double)total : 0.0;
+}
+
+/* AtomSpace hooks */
+query_cache_t* query_cache_create(void) {
+    query_cache_t* cache = calloc(1, sizeof(query_cache_t));
+    pthread_rwlock_init(&cache->lock, NULL);
+    cache->max_entries = QUERY_CACHE_DEFAULT_ENTRIES;
+    cache->max_bytes = QUERY_CACHE_DEFAULT_BYTES;
+    cache->set_count = set_count_for(QUERY_CACHE_DEFAULT_ENTRIES);
+    return cache;
+}
+
+void query_cache_destroy(query_cache_t* cache) {
+    if (!cache) return;
+    if (cache->entries) {
+        for (size_t i = 0; i < cache->set_count * QUERY_CACHE_WAYS; i++) {
+            if (!cache->entries[i].result) continue;
+            result_free(cache->entries[i].result);
+            free((char*)cache->entries[i].key.name);
+        }
+        free(cache->entries);
+    }
+    pthread_rwlock_destroy(&cache->lock);
+    free(cache);
+}
+
+void query_cache_invalidate(query_cache_t* cache, atom_handle_t* const* handles, size_t count) {
+    if (!cache || count == 0) return;
+    atom_type_set_t types = 0;
+    for (size_t i = 0; i < count; i++) {
+        const atom_t* atom = handles[i]->atom;
+        types |= ATOM_TYPE_BIT(atom->type);
+        if (!atom->name) continue;
+        uint64_t name_hash = hash_bytes(0xcbf29ce484222325ull, atom->name, strlen(atom->name));
+        __atomic_fetch_add(&cache->name_generations[name_hash % QUERY_NAME_GENERATIONS], 1, __ATOMIC_RELEASE);
+    }
+    for (int t = 0; t < ATOM_TYPE_MAX && types >> t; t++) {
+        if (types & ATOM_TYPE_BIT(t)) __atomic_fetch_add(&cache->type_generations[t], 1, __ATOMIC_RELEASE);
+    }
+    __atomic_fetch_add(&cache->structure_generation, 1, __ATOMIC_RELEASE);
+}
+
+void query_cache_memory(query_cache_t* cache, memory_usage_t* usage) {
+    if (!cache) return;
+    uint64_t held = lockprof_rdlock(&cache->lock, &cache_read_site);
+    usage->count += cache->used;
+    usage->requested += sizeof(query_cache_t) + cache->bytes;
+    usage->allocated += malloc_usable_size(cache) + cache->bytes;
+    if (cache->entries) {
+        usage->requested += cache->set_count * QUERY_CACHE_WAYS * sizeof(cache_entry_t);
+        usage->allocated += malloc_usable_size(cache->entries);
+    }
+    lockprof_rwlock_unlock(&cache->lock, &cache_read_site, held);
+}
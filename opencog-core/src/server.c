@@ -0,0 +1,744 @@
+/*
+ * OpenCog AtomSpace Server
+ * epoll event loops serving the binary protocol over a Unix domain socket
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "../include/server.h"
+#include "../include/changefeed.h"
+
+#define SERVER_BUFFER_INITIAL 65536
+#define SERVER_READ_CHUNK 65536
+
+/* Stop reading from a connection while this many reply bytes are unsent */
+#define SERVER_OUTPUT_LIMIT (4u << 20)
+
+/* Events per PROTO_OP_EVENT frame */
+#define SERVER_EVENT_BATCH 256
+
+/* How often loops with subscribers poll the change feed */
+#define SERVER_FEED_POLL_MS 1
+
+#define SERVER_MAX_EVENTS 64
+
+typedef struct {
+    char* data;
+    size_t start;             /* Consumed bytes at the front */
+    size_t length;            /* End of valid data */
+    size_t capacity;
+} buffer_t;
+
+typedef struct stream_subscription {
+    uint32_t stream;
+    uint32_t tag;             /* Tag of the subscribe request, echoed in events */
+    changefeed_subscription_t* feed;
+    struct stream_subscription* next;
+} stream_subscription_t;
+
+typedef struct connection {
+    int fd;
+    uint32_t interest;        /* Registered epoll events */
+    bool closing;             /* Close once the output drains */
+    buffer_t in;
+    buffer_t out;
+    stream_subscription_t* subscriptions;
+    struct connection* prev;
+    struct connection* next;
+} connection_t;
+
+typedef struct {
+    server_t* server;
+    int epoll_fd;
+    pthread_t thread;
+    connection_t* connections;
+    size_t subscriptions;
+    server_stats_t stats;     /* Written by the loop only */
+} event_loop_t;
+
+struct server {
+    atomspace_t* space;
+    server_config_t config;
+    char path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+    int listen_fd;
+    int stop_fd;
+    event_loop_t* loops;
+    int loop_count;
+};
+
+/* The change feed is process-wide; servers share it */
+static pthread_mutex_t feed_users_lock = PTHREAD_MUTEX_INITIALIZER;
+static size_t feed_users = 0;
+
+static int feed_acquire(size_t capacity) {
+    pthread_mutex_lock(&feed_users_lock);
+    if (feed_users == 0 && changefeed_start(capacity) != 0) {
+        pthread_mutex_unlock(&feed_users_lock);
+        return -1;
+    }
+    feed_users++;
+    pthread_mutex_unlock(&feed_users_lock);
+    return 0;
+}
+
+static void feed_release(void) {
+    pthread_mutex_lock(&feed_users_lock);
+    if (--feed_users == 0) changefeed_stop();
+    pthread_mutex_unlock(&feed_users_lock);
+}
+
+static const char* op_names[PROTO_OP_COUNT] = {
+    "ping", "create_node", "create_link", "get", "set_tv", "remove",
+    "query_type", "query_name", "match", "subscribe", "unsubscribe", "event"
+};
+
+const char* proto_op_name(uint8_t op) {
+    return op < PROTO_OP_COUNT ? op_names[op] : "unknown";
+}
+
+static void stat_add(uint64_t* counter, uint64_t amount) {
+    __atomic_store_n(counter, *counter + amount, __ATOMIC_RELAXED);
+}
+
+/* Buffers */
+static void* buffer_reserve(buffer_t* buffer, size_t bytes) {
+    if (buffer->length + bytes > buffer->capacity) {
+        /* Reclaim consumed space before growing */
+        if (buffer->start > 0) {
+            memmove(buffer->data, buffer->data + buffer->start, buffer->length - buffer->start);
+            buffer->length -= buffer->start;
+            buffer->start = 0;
+        }
+        size_t capacity = buffer->capacity ? buffer->capacity : SERVER_BUFFER_INITIAL;
+        while (capacity < buffer->length + bytes) capacity *= 2;
+        if (capacity != buffer->capacity) {
+            buffer->data = realloc(buffer->data, capacity);
+            buffer->capacity = capacity;
+        }
+    }
+    void* space = buffer->data + buffer->length;
+    buffer->length += bytes;
+    return space;
+}
+
+static void buffer_consume(buffer_t* buffer, size_t bytes) {
+    buffer->start += bytes;
+    if (buffer->start == buffer->length) {
+        buffer->start = 0;
+        buffer->length = 0;
+    }
+}
+
+/*
+ * Replies are built in place: header first, length patched at the end.
+ * Offsets are relative to the unsent data, which growing may move.
+ */
+static size_t reply_begin(connection_t* conn, const proto_header_t* request, uint8_t op, uint8_t status) {
+    size_t offset = conn->out.length - conn->out.start;
+    proto_header_t* header = buffer_reserve(&conn->out, sizeof(proto_header_t));
+    header->length = 0;
+    header->stream = request->stream;
+    header->tag = request->tag;
+    header->op = op;
+    header->status = status;
+    header->flags = 0;
+    return offset;
+}
+
+static void reply_end(connection_t* conn, size_t offset) {
+    uint32_t length = (uint32_t)(conn->out.length - conn->out.start - offset - sizeof(proto_header_t));
+    memcpy(conn->out.data + conn->out.start + offset, &length, sizeof(length));
+}
+
+static void reply_status(connection_t* conn, const proto_header_t* request, uint8_t status) {
+    reply_begin(conn, request, request->op, status);
+}
+
+static void reply_id(connection_t* conn, const proto_header_t* request, uint64_t id) {
+    size_t offset = reply_begin(conn, request, request->op, PROTO_OK);
+    memcpy(buffer_reserve(&conn->out, sizeof(id)), &id, sizeof(id));
+    reply_end(conn, offset);
+}
+
+/* ID lists are split into frames of at most `limit` bytes (protocol.h) */
+static void reply_ids(connection_t* conn, const proto_header_t* request, uint32_t limit,
+                      atom_handle_t** handles, size_t count) {
+    size_t per_frame = limit / sizeof(uint64_t);
+    size_t sent = 0;
+    do {
+        size_t chunk = count - sent < per_frame ? count - sent : per_frame;
+        size_t offset = reply_begin(conn, request, request->op, PROTO_OK);
+        if (sent + chunk < count) {
+            proto_header_t* header = (proto_header_t*)(conn->out.data + conn->out.start + offset);
+            header->flags = PROTO_FLAG_MORE;
+        }
+        uint64_t* ids = buffer_reserve(&conn->out, chunk * sizeof(uint64_t));
+        for (size_t i = 0; i < chunk; i++) {
+            memcpy(&ids[i], &handles[sent + i]->id, sizeof(uint64_t));
+        }
+        sent += chunk;
+        reply_end(conn, offset);
+    } while (sent < count);
+    free(handles);
+}
+
+/* Requests; payloads may be unaligned, so fields are copied out */
+static atom_handle_t* lookup_id(atomspace_t* space, const void* data) {
+    uint64_t id;
+    memcpy(&id, data, sizeof(id));
+    return atomspace_get_atom(space, id);
+}
+
+/* Resolve `arity` IDs following a proto_create_link_t; 0 IDs resolve to NULL if allowed */
+static int resolve_outgoing(atomspace_t* space, const proto_header_t* request, const char* payload,
+                            bool wildcards, proto_create_link_t* link, atom_handle_t*** handles) {
+    if (request->length < sizeof(proto_create_link_t)) return PROTO_ERR_MALFORMED;
+    memcpy(link, payload, sizeof(*link));
+    if (!atom_type_valid((atom_type_t)link->type) ||
+        request->length != sizeof(*link) + (uint64_t)link->arity * sizeof(uint64_t)) {
+        return PROTO_ERR_MALFORMED;
+    }
+
+    *handles = malloc((link->arity ? link->arity : 1) * sizeof(atom_handle_t*));
+    const char* ids = payload + sizeof(*link);
+    for (uint32_t i = 0; i < link->arity; i++) {
+        uint64_t id;
+        memcpy(&id, ids + i * sizeof(uint64_t), sizeof(id));
+        if (id == 0 && wildcards) {
+            (*handles)[i] = NULL;
+        } else if (!((*handles)[i] = atomspace_get_atom(space, id))) {
+            free(*handles);
+            return PROTO_ERR_NOT_FOUND;
+        }
+    }
+    return PROTO_OK;
+}
+
+typedef struct {
+    atom_type_t type;
+    uint32_t arity;
+    atom_handle_t** targets;  /* NULL entries match anything */
+} link_pattern_t;
+
+static bool match_link(atom_handle_t* handle, void* arg) {
+    const link_pattern_t* pattern = (const link_pattern_t*)arg;
+    const atom_t* atom = handle->atom;
+    if (atom->type != pattern->type || atom->outgoing_count != pattern->arity) return false;
+    for (uint32_t i = 0; i < pattern->arity; i++) {
+        if (pattern->targets[i] && atom->outgoing[i] != pattern->targets[i]) return false;
+    }
+    return true;
+}
+
+static char* copy_name(const char* data, size_t length) {
+    char* name = malloc(length + 1);
+    memcpy(name, data, length);
+    name[length] = '\0';
+    return name;
+}
+
+static void handle_subscribe(event_loop_t* loop, connection_t* conn, const proto_header_t* request,
+                             const char* payload) {
+    proto_subscribe_t subscribe;
+    if (request->length < sizeof(subscribe)) {
+        reply_status(conn, request, PROTO_ERR_MALFORMED);
+        return;
+    }
+    memcpy(&subscribe, payload, sizeof(subscribe));
+    if (request->length != sizeof(subscribe) + (uint64_t)subscribe.name_length) {
+        reply_status(conn, request, PROTO_ERR_MALFORMED);
+        return;
+    }
+    for (stream_subscription_t* sub = conn->subscriptions; sub; sub = sub->next) {
+        if (sub->stream == request->stream) {
+            reply_status(conn, request, PROTO_ERR_REFUSED);
+            return;
+        }
+    }
+    if (feed_acquire(loop->server->config.feed_capacity) != 0) {
+        reply_status(conn, request, PROTO_ERR_REFUSED);
+        return;
+    }
+
+    char* name = subscribe.name_length ? copy_name(payload + sizeof(subscribe), subscribe.name_length) : NULL;
+    /* Only the served space's events, whatever else shares the process */
+    change_filter_t filter = { subscribe.kinds, subscribe.types, name, loop->server->space->space_id };
+    stream_subscription_t* sub = malloc(sizeof(stream_subscription_t));
+    sub->stream = request->stream;
+    sub->tag = request->tag;
+    sub->feed = changefeed_subscribe(&filter);
+    sub->next = conn->subscriptions;
+    conn->subscriptions = sub;
+    loop->subscriptions++;
+    free(name);
+    reply_status(conn, request, PROTO_OK);
+}
+
+static void subscription_free(event_loop_t* loop, stream_subscription_t* sub) {
+    changefeed_unsubscribe(sub->feed);
+    free(sub);
+    loop->subscriptions--;
+    feed_release();
+}
+
+static void handle_unsubscribe(event_loop_t* loop, connection_t* conn, const proto_header_t* request) {
+    for (stream_subscription_t** link = &conn->subscriptions; *link; link = &(*link)->next) {
+        if ((*link)->stream == request->stream) {
+            stream_subscription_t* sub = *link;
+            *link = sub->next;
+            subscription_free(loop, sub);
+            reply_status(conn, request, PROTO_OK);
+            return;
+        }
+    }
+    reply_status(conn, request, PROTO_ERR_NOT_FOUND);
+}
+
+static void handle_get(connection_t* conn, const proto_header_t* request, atom_handle_t* handle) {
+    atom_t* atom = handle->atom;
+    proto_atom_t reply;
+    memset(&reply, 0, sizeof(reply));
+    reply.id = handle->id;
+    reply.tv = atom_get_tv(handle);
+    reply.av = atom_get_av(handle);
+    reply.type = (uint8_t)atom->type;
+    reply.arity = (uint32_t)atom->outgoing_count;
+    reply.name_length = atom->name ? (uint32_t)strlen(atom->name) : 0;
+
+    size_t offset = reply_begin(conn, request, request->op, PROTO_OK);
+    memcpy(buffer_reserve(&conn->out, sizeof(reply)), &reply, sizeof(reply));
+    uint64_t* outgoing = buffer_reserve(&conn->out, reply.arity * sizeof(uint64_t));
+    for (uint32_t i = 0; i < reply.arity; i++) {
+        memcpy(&outgoing[i], &atom->outgoing[i]->id, sizeof(uint64_t));
+    }
+    if (reply.name_length) {
+        memcpy(buffer_reserve(&conn->out, reply.name_length), atom->name, reply.name_length);
+    }
+    reply_end(conn, offset);
+}
+
+static void handle_request(event_loop_t* loop, connection_t* conn, const proto_header_t* request,
+                           const char* payload) {
+    atomspace_t* space = loop->server->space;
+    atom_handle_t* handle;
+    atom_handle_t** handles;
+    proto_create_link_t link;
+    size_t count;
+    int status;
+
+    switch (request->op) {
+        case PROTO_OP_PING:
+            reply_status(conn, request, PROTO_OK);
+            break;
+
+        case PROTO_OP_CREATE_NODE: {
+            proto_create_node_t node;
+            if (request->length < sizeof(node)) {
+                reply_status(conn, request, PROTO_ERR_MALFORMED);
+                break;
+            }
+            memcpy(&node, payload, sizeof(node));
+            if (!atom_type_valid((atom_type_t)node.type) || request->length != sizeof(node) + node.name_length) {
+                reply_status(conn, request, PROTO_ERR_MALFORMED);
+                break;
+            }
+            char* name = copy_name(payload + sizeof(node), node.name_length);
+            handle = atom_create(space, (atom_type_t)node.type, name);
+            free(name);
+            reply_id(conn, request, handle->id);
+            break;
+        }
+
+        case PROTO_OP_CREATE_LINK:
+            status = resolve_outgoing(space, request, payload, false, &link, &handles);
+            if (status != PROTO_OK) {
+                reply_status(conn, request, (uint8_t)status);
+                break;
+            }
+            handle = atom_create_link(space, (atom_type_t)link.type, handles, link.arity);
+            free(handles);
+            reply_id(conn, request, handle->id);
+            break;
+
+        case PROTO_OP_GET:
+            if (request->length != sizeof(uint64_t)) {
+                reply_status(conn, request, PROTO_ERR_MALFORMED);
+            } else if (!(handle = lookup_id(space, payload))) {
+                reply_status(conn, request, PROTO_ERR_NOT_FOUND);
+            } else {
+                handle_get(conn, request, handle);
+            }
+            break;
+
+        case PROTO_OP_SET_TV: {
+            proto_set_tv_t set;
+            if (request->length != sizeof(set)) {
+                reply_status(conn, request, PROTO_ERR_MALFORMED);
+                break;
+            }
+            memcpy(&set, payload, sizeof(set));
+            if (!(handle = atomspace_get_atom(space, set.id))) {
+                reply_status(conn, request, PROTO_ERR_NOT_FOUND);
+                break;
+            }
+            atom_set_tv(handle, set.strength, set.confidence);
+            reply_status(conn, request, PROTO_OK);
+            break;
+        }
+
+        case PROTO_OP_REMOVE:
+            if (request->length != sizeof(uint64_t)) {
+                reply_status(conn, request, PROTO_ERR_MALFORMED);
+            } else if (!(handle = lookup_id(space, payload))) {
+                reply_status(conn, request, PROTO_ERR_NOT_FOUND);
+            } else {
+                status = atomspace_remove_atom(space, handle) == 0 ? PROTO_OK : PROTO_ERR_REFUSED;
+                reply_status(conn, request, (uint8_t)status);
+            }
+            break;
+
+        case PROTO_OP_QUERY_TYPE:
+            if (request->length != 1 || !atom_type_valid((atom_type_t)(uint8_t)payload[0])) {
+                reply_status(conn, request, PROTO_ERR_MALFORMED);
+                break;
+            }
+            handles = atomspace_get_atoms_by_type_borrowed(space, (atom_type_t)payload[0], &count);
+            reply_ids(conn, request, loop->server->config.reply_limit, handles, count);
+            break;
+
+        case PROTO_OP_QUERY_NAME: {
+            char* name = copy_name(payload, request->length);
+            handles = atomspace_get_atoms_by_name_borrowed(space, name, &count);
+            free(name);
+            reply_ids(conn, request, loop->server->config.reply_limit, handles, count);
+            break;
+        }
+
+        case PROTO_OP_MATCH: {
+            status = resolve_outgoing(space, request, payload, true, &link, &handles);
+            if (status == PROTO_ERR_NOT_FOUND) {
+                /* Nothing links to an atom that does not exist */
+                reply_ids(conn, request, loop->server->config.reply_limit, NULL, 0);
+                break;
+            }
+            if (status != PROTO_OK) {
+                reply_status(conn, request, (uint8_t)status);
+                break;
+            }
+            link_pattern_t pattern = { (atom_type_t)link.type, link.arity, handles };
+            atom_handle_t** matches = atomspace_match_pattern_borrowed(space, match_link, &pattern, &count);
+            free(handles);
+            reply_ids(conn, request, loop->server->config.reply_limit, matches, count);
+            break;
+        }
+
+        case PROTO_OP_SUBSCRIBE:
+            handle_subscribe(loop, conn, request, payload);
+            break;
+
+        case PROTO_OP_UNSUBSCRIBE:
+            handle_unsubscribe(loop, conn, request);
+            break;
+
+        default:
+            reply_status(conn, request, PROTO_ERR_UNKNOWN_OP);
+            break;
+    }
+}
+
+/* Answer every complete request in the input buffer */
+static void process_input(event_loop_t* loop, connection_t* conn) {
+    atomspace_t* space = loop->server->space;
+    uint64_t requests = 0;
+
+    atomspace_read_begin(space);
+    while (conn->in.length - conn->in.start >= sizeof(proto_header_t)) {
+        proto_header_t header;
+        memcpy(&header, conn->in.data + conn->in.start, sizeof(header));
+        if (header.length > PROTO_MAX_PAYLOAD) {
+            reply_status(conn, &header, PROTO_ERR_TOO_LARGE);
+            conn->closing = true;
+            break;
+        }
+        if (conn->in.length - conn->in.start < sizeof(header) + header.length) break;
+
+        handle_request(loop, conn, &header, conn->in.data + conn->in.start + sizeof(header));
+        buffer_consume(&conn->in, sizeof(header) + header.length);
+        requests++;
+    }
+    atomspace_read_end(space);
+    stat_add(&loop->stats.requests, requests);
+}
+
+/* Connections */
+static void connection_watch(event_loop_t* loop, connection_t* conn) {
+    uint32_t interest = 0;
+    if (!conn->closing && conn->out.length - conn->out.start < SERVER_OUTPUT_LIMIT) interest |= EPOLLIN;
+    if (conn->out.length > conn->out.start) interest |= EPOLLOUT;
+    if (interest == conn->interest) return;
+
+    struct epoll_event event = { .events = interest, .data.ptr = conn };
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event);
+    conn->interest = interest;
+}
+
+static void connection_close(event_loop_t* loop, connection_t* conn) {
+    while (conn->subscriptions) {
+        stream_subscription_t* sub = conn->subscriptions;
+        conn->subscriptions = sub->next;
+        subscription_free(loop, sub);
+    }
+    if (conn->prev) conn->prev->next = conn->next;
+    else loop->connections = conn->next;
+    if (conn->next) conn->next->prev = conn->prev;
+
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    free(conn->in.data);
+    free(conn->out.data);
+    free(conn);
+}
+
+/* Returns -1 if the connection failed */
+static int connection_flush(event_loop_t* loop, connection_t* conn) {
+    while (conn->out.length > conn->out.start) {
+        ssize_t sent = send(conn->fd, conn->out.data + conn->out.start,
+                            conn->out.length - conn->out.start, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return -1;
+        }
+        buffer_consume(&conn->out, (size_t)sent);
+        stat_add(&loop->stats.bytes_out, (uint64_t)sent);
+    }
+    if (conn->closing && conn->out.length == conn->out.start) return -1;
+    connection_watch(loop, conn);
+    return 0;
+}
+
+static int connection_read(event_loop_t* loop, connection_t* conn) {
+    char* space = buffer_reserve(&conn->in, SERVER_READ_CHUNK);
+    conn->in.length -= SERVER_READ_CHUNK;
+
+    ssize_t received = recv(conn->fd, space, SERVER_READ_CHUNK, 0);
+    if (received == 0) return -1;
+    if (received < 0) return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+
+    conn->in.length += (size_t)received;
+    stat_add(&loop->stats.bytes_in, (uint64_t)received);
+    process_input(loop, conn);
+    return 0;
+}
+
+static void accept_connections(event_loop_t* loop) {
+    for (;;) {
+        int fd = accept4(loop->server->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+
+        connection_t* conn = calloc(1, sizeof(connection_t));
+        conn->fd = fd;
+        conn->interest = EPOLLIN;
+        struct epoll_event event = { .events = EPOLLIN, .data.ptr = conn };
+        if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            free(conn);
+            continue;
+        }
+        conn->next = loop->connections;
+        if (conn->next) conn->next->prev = conn;
+        loop->connections = conn;
+        stat_add(&loop->stats.connections, 1);
+    }
+}
+
+/* Move new change events into each subscribed stream's output */
+static void pump_subscriptions(event_loop_t* loop) {
+    connection_t* next;
+    for (connection_t* conn = loop->connections; conn; conn = next) {
+        next = conn->next;
+        if (!conn->subscriptions) continue;
+
+        size_t before = conn->out.length - conn->out.start;
+        for (stream_subscription_t* sub = conn->subscriptions; sub; sub = sub->next) {
+            proto_header_t request = { 0, sub->stream, sub->tag, PROTO_OP_EVENT, PROTO_OK, 0 };
+            size_t count = SERVER_EVENT_BATCH;
+            while (count == SERVER_EVENT_BATCH &&
+                   conn->out.length - conn->out.start < SERVER_OUTPUT_LIMIT) {
+                /* Events are polled straight into the reply */
+                size_t offset = reply_begin(conn, &request, PROTO_OP_EVENT, PROTO_OK);
+                change_event_t* events = buffer_reserve(&conn->out, SERVER_EVENT_BATCH * sizeof(change_event_t));
+                count = changefeed_poll(sub->feed, events, SERVER_EVENT_BATCH);
+                if (count == 0) {
+                    conn->out.length = conn->out.start + offset;
+                    break;
+                }
+                conn->out.length -= (SERVER_EVENT_BATCH - count) * sizeof(change_event_t);
+                reply_end(conn, offset);
+                stat_add(&loop->stats.events, count);
+            }
+        }
+        if (conn->out.length - conn->out.start != before && connection_flush(loop, conn) != 0) {
+            connection_close(loop, conn);
+        }
+    }
+}
+
+static void* event_loop_run(void* arg) {
+    event_loop_t* loop = (event_loop_t*)arg;
+    server_t* server = loop->server;
+    struct epoll_event events[SERVER_MAX_EVENTS];
+
+    for (;;) {
+        int timeout = loop->subscriptions ? SERVER_FEED_POLL_MS : -1;
+        int ready = epoll_wait(loop->epoll_fd, events, SERVER_MAX_EVENTS, timeout);
+        if (ready < 0 && errno != EINTR) break;
+
+        bool stopping = false;
+        for (int i = 0; i < ready; i++) {
+            void* source = events[i].data.ptr;
+            if (source == &server->stop_fd) {
+                stopping = true;
+                continue;
+            }
+            if (source == &server->listen_fd) {
+                accept_connections(loop);
+                continue;
+            }
+
+            connection_t* conn = (connection_t*)source;
+            int failed = 0;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) failed = -1;
+            if (!failed && (events[i].events & EPOLLIN)) failed = connection_read(loop, conn);
+            if (!failed) failed = connection_flush(loop, conn);
+            if (failed) connection_close(loop, conn);
+        }
+        if (stopping) break;
+        if (loop->subscriptions) pump_subscriptions(loop);
+    }
+
+    while (loop->connections) {
+        connection_close(loop, loop->connections);
+    }
+    return NULL;
+}
+
+/* Server lifecycle */
+server_t* server_create(atomspace_t* space, const server_config_t* config) {
+    if (!space) return NULL;
+
+    server_t* server = calloc(1, sizeof(server_t));
+    server->space = space;
+    if (config) server->config = *config;
+    const char* path = server->config.path ? server->config.path : PROTO_DEFAULT_PATH;
+    if (strlen(path) >= sizeof(server->path)) {
+        free(server);
+        return NULL;
+    }
+    strcpy(server->path, path);
+    server->config.path = server->path;
+    server->loop_count = server->config.threads > 0 ? server->config.threads : 1;
+    if (server->config.reply_limit < sizeof(uint64_t) || server->config.reply_limit > PROTO_MAX_PAYLOAD) {
+        server->config.reply_limit = PROTO_MAX_PAYLOAD;
+    }
+    server->listen_fd = -1;
+    server->stop_fd = -1;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, server->path);
+
+    server->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    server->stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    unlink(server->path);
+    if (server->listen_fd < 0 || server->stop_fd < 0 ||
+        bind(server->listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(server->listen_fd, SOMAXCONN) != 0) {
+        server_destroy(server);
+        return NULL;
+    }
+
+    server->loops = calloc(server->loop_count, sizeof(event_loop_t));
+    for (int i = 0; i < server->loop_count; i++) {
+        server->loops[i].epoll_fd = -1;
+    }
+    for (int i = 0; i < server->loop_count; i++) {
+        event_loop_t* loop = &server->loops[i];
+        loop->server = server;
+        loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+        /* Each connection wakes one loop; stopping wakes them all */
+        struct epoll_event listen_event = { .events = EPOLLIN | EPOLLEXCLUSIVE,
+                                            .data.ptr = &server->listen_fd };
+        struct epoll_event stop_event = { .events = EPOLLIN, .data.ptr = &server->stop_fd };
+        if (loop->epoll_fd < 0 ||
+            epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, server->listen_fd, &listen_event) != 0 ||
+            epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, server->stop_fd, &stop_event) != 0) {
+            server_destroy(server);
+            return NULL;
+        }
+    }
+    return server;
+}
+
+int server_run(server_t* server) {
+    if (!server) return -1;
+
+    int started = 1;
+    for (; started < server->loop_count; started++) {
+        event_loop_t* loop = &server->loops[started];
+        if (pthread_create(&loop->thread, NULL, event_loop_run, loop) != 0) break;
+    }
+    event_loop_run(&server->loops[0]);
+    for (int i = 1; i < started; i++) {
+        pthread_join(server->loops[i].thread, NULL);
+    }
+    return started == server->loop_count ? 0 : -1;
+}
+
+void server_stop(server_t* server) {
+    if (!server) return;
+    uint64_t one = 1;
+    ssize_t written = write(server->stop_fd, &one, sizeof(one));
+    (void)written;
+}
+
+void server_stats(server_t* server, server_stats_t* stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!server || !server->loops) return;
+
+    for (int i = 0; i < server->loop_count; i++) {
+        const server_stats_t* loop = &server->loops[i].stats;
+        stats->connections += __atomic_load_n(&loop->connections, __ATOMIC_RELAXED);
+        stats->requests += __atomic_load_n(&loop->requests, __ATOMIC_RELAXED);
+        stats->events += __atomic_load_n(&loop->events, __ATOMIC_RELAXED);
+        stats->bytes_in += __atomic_load_n(&loop->bytes_in, __ATOMIC_RELAXED);
+        stats->bytes_out += __atomic_load_n(&loop->bytes_out, __ATOMIC_RELAXED);
+    }
+}
+
+void server_destroy(server_t* server) {
+    if (!server) return;
+    if (server->loops) {
+        for (int i = 0; i < server->loop_count; i++) {
+            if (server->loops[i].epoll_fd >= 0) close(server->loops[i].epoll_fd);
+        }
+        free(server->loops);
+    }
+    if (server->listen_fd >= 0) {
+        close(server->listen_fd);
+        unlink(server->path);
+    }
+    if (server->stop_fd >= 0) close(server->stop_fd);
+    free(server);
+}
@@ -0,0 +1,228 @@
+/*
+ * OpenCog Hot-Path Instrumentation
+ * Per-thread operation counters and HDR-style latency histograms
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "../include/stats.h"
+
+/* Per-thread recording state; only the owning thread writes to it */
+typedef struct stats_thread {
+    uint64_t count[STATS_OP_COUNT];
+    uint64_t total_ns[STATS_OP_COUNT];
+    uint64_t min_ns[STATS_OP_COUNT];
+    uint64_t max_ns[STATS_OP_COUNT];
+    uint64_t buckets[STATS_OP_COUNT][STATS_BUCKETS];
+    struct stats_thread* next;
+    bool in_use;
+} stats_thread_t;
+
+/* Registry of all thread records; records of exited threads are reused */
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static stats_thread_t* registry = NULL;
+static uint32_t registry_size = 0;
+static pthread_key_t thread_key;
+static pthread_once_t thread_key_once = PTHREAD_ONCE_INIT;
+static __thread stats_thread_t* local_stats = NULL;
+
+static const char* op_names[STATS_OP_COUNT] = {
+    "create", "create_batch", "lookup", "query", "match", "tv_update", "av_update", "send", "receive",
+    "commit"
+};
+
+static void thread_exit(void* arg) {
+    stats_thread_t* record = (stats_thread_t*)arg;
+    pthread_mutex_lock(&registry_lock);
+    record->in_use = false;
+    pthread_mutex_unlock(&registry_lock);
+}
+
+static void make_thread_key(void) {
+    pthread_key_create(&thread_key, thread_exit);
+}
+
+static stats_thread_t* thread_record(void) {
+    if (local_stats) return local_stats;
+
+    pthread_once(&thread_key_once, make_thread_key);
+    pthread_mutex_lock(&registry_lock);
+
+    stats_thread_t* record = registry;
+    while (record && record->in_use) {
+        record = record->next;
+    }
+    if (!record) {
+        record = calloc(1, sizeof(stats_thread_t));
+        for (int op = 0; op < STATS_OP_COUNT; op++) {
+            record->min_ns[op] = UINT64_MAX;
+        }
+        record->next = registry;
+        registry = record;
+        registry_size++;
+    }
+    record->in_use = true;
+
+    pthread_mutex_unlock(&registry_lock);
+    pthread_setspecific(thread_key, record);
+    local_stats = record;
+    return record;
+}
+
+/* Histogram bucket math: values below 8 are exact, then 8 buckets per octave */
+static size_t bucket_index(uint64_t value) {
+    if (value < STATS_SUB_BUCKETS) return (size_t)value;
+
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - STATS_SUB_BUCKET_BITS;
+    return (size_t)(shift + 1) * STATS_SUB_BUCKETS + ((value >> shift) & (STATS_SUB_BUCKETS - 1));
+}
+
+static uint64_t bucket_midpoint(size_t bucket) {
+    if (bucket < STATS_SUB_BUCKETS) return bucket;
+
+    int shift = (int)(bucket / STATS_SUB_BUCKETS) - 1;
+    uint64_t low = (uint64_t)(STATS_SUB_BUCKETS + bucket % STATS_SUB_BUCKETS) << shift;
+    return low + ((1ULL << shift) >> 1);
+}
+
+/* Owner-only updates; relaxed atomics keep concurrent aggregation well-defined */
+static inline uint64_t load_relaxed(const uint64_t* p) {
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+
+static inline void store_relaxed(uint64_t* p, uint64_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELAXED);
+}
+
+uint64_t stats_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void stats_record(stats_op_t op, uint64_t elapsed_ns) {
+    if ((unsigned)op >= STATS_OP_COUNT) return;
+    stats_thread_t* record = thread_record();
+
+    store_relaxed(&record->count[op], load_relaxed(&record->count[op]) + 1);
+    store_relaxed(&record->total_ns[op], load_relaxed(&record->total_ns[op]) + elapsed_ns);
+    if (elapsed_ns < load_relaxed(&record->min_ns[op])) store_relaxed(&record->min_ns[op], elapsed_ns);
+    if (elapsed_ns > load_relaxed(&record->max_ns[op])) store_relaxed(&record->max_ns[op], elapsed_ns);
+
+    uint64_t* bucket = &record->buckets[op][bucket_index(elapsed_ns)];
+    store_relaxed(bucket, load_relaxed(bucket) + 1);
+}
+
+static uint64_t histogram_percentile(const uint64_t* buckets, uint64_t total, double pct) {
+    if (total == 0) return 0;
+
+    uint64_t target = (uint64_t)(pct / 100.0 * (double)total + 0.5);
+    if (target < 1) target = 1;
+
+    uint64_t seen = 0;
+    for (size_t b = 0; b < STATS_BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen >= target) return bucket_midpoint(b);
+    }
+    return bucket_midpoint(STATS_BUCKETS - 1);
+}
+
+/* Public API */
+int atomspace_stats(atomspace_t* space, atomspace_stats_t* stats) {
+    if (!stats) return -1;
+    memset(stats, 0, sizeof(*stats));
+
+#ifdef OPENCOG_STATS
+    stats->enabled = true;
+#endif
+
+    if (space) {
+        stats->total_atoms_created = __atomic_load_n(&space->total_atoms_created, __ATOMIC_RELAXED);
+        stats->total_atoms_deleted = __atomic_load_n(&space->total_atoms_deleted, __ATOMIC_RELAXED);
+        /* atom_count is the slot high-water mark; removed slots are not reused */
+        stats->atom_count = stats->total_atoms_created - stats->total_atoms_deleted;
+    }
+
+    uint64_t* merged = calloc(STATS_BUCKETS, sizeof(uint64_t));
+    if (!merged) return -1;
+
+    pthread_mutex_lock(&registry_lock);
+    stats->threads = registry_size;
+
+    for (int op = 0; op < STATS_OP_COUNT; op++) {
+        stats_op_summary_t* summary = &stats->ops[op];
+        memset(merged, 0, STATS_BUCKETS * sizeof(uint64_t));
+        summary->min_ns = UINT64_MAX;
+
+        for (stats_thread_t* record = registry; record; record = record->next) {
+            uint64_t count = load_relaxed(&record->count[op]);
+            if (count == 0) continue;
+
+            summary->count += count;
+            summary->total_ns += load_relaxed(&record->total_ns[op]);
+            uint64_t min_ns = load_relaxed(&record->min_ns[op]);
+            uint64_t max_ns = load_relaxed(&record->max_ns[op]);
+            if (min_ns < summary->min_ns) summary->min_ns = min_ns;
+            if (max_ns > summary->max_ns) summary->max_ns = max_ns;
+            for (size_t b = 0; b < STATS_BUCKETS; b++) {
+                merged[b] += load_relaxed(&record->buckets[op][b]);
+            }
+        }
+
+        if (summary->count == 0) summary->min_ns = 0;
+        summary->p50_ns = histogram_percentile(merged, summary->count, 50.0);
+        summary->p90_ns = histogram_percentile(merged, summary->count, 90.0);
+        summary->p99_ns = histogram_percentile(merged, summary->count, 99.0);
+        summary->p999_ns = histogram_percentile(merged, summary->count, 99.9);
+    }
+
+    pthread_mutex_unlock(&registry_lock);
+    free(merged);
+    return 0;
+}
+
+void atomspace_stats_reset(void) {
+    pthread_mutex_lock(&registry_lock);
+    for (stats_thread_t* record = registry; record; record = record->next) {
+        for (int op = 0; op < STATS_OP_COUNT; op++) {
+            store_relaxed(&record->count[op], 0);
+            store_relaxed(&record->total_ns[op], 0);
+            store_relaxed(&record->min_ns[op], UINT64_MAX);
+            store_relaxed(&record->max_ns[op], 0);
+            for (size_t b = 0; b < STATS_BUCKETS; b++) {
+                store_relaxed(&record->buckets[op][b], 0);
+            }
+        }
+    }
+    pthread_mutex_unlock(&registry_lock);
+}
+
+void atomspace_stats_print(const atomspace_stats_t* stats, FILE* out) {
+    if (!stats || !out) return;
+
+    fprintf(out, "AtomSpace statistics (%s)\n", stats->enabled ? "instrumented" : "instrumentation disabled");
+    fprintf(out, "  atoms: %llu live, %llu created, %llu deleted\n",
+            (unsigned long long)stats->atom_count,
+            (unsigned long long)stats->total_atoms_created,
+            (unsigned long long)stats->total_atoms_deleted);
+    fprintf(out, "  %-10s %12s %10s %10s %10s %10s %10s\n",
+            "operation", "count", "mean(ns)", "p50(ns)", "p99(ns)", "p999(ns)", "max(ns)");
+
+    for (int op = 0; op < STATS_OP_COUNT; op++) {
+        const stats_op_summary_t* s = &stats->ops[op];
+        if (s->count == 0) continue;
+        fprintf(out, "  %-10s %12llu %10.1f %10llu %10llu %10llu %10llu\n",
+                op_names[op], (unsigned long long)s->count,
+                (double)s->total_ns / (double)s->count,
+                (unsigned long long)s->p50_ns, (unsigned long long)s->p99_ns,
+                (unsigned long long)s->p999_ns, (unsigned long long)s->max_ns);
+    }
+}
+
+const char* stats_op_name(stats_op_t op) {
+    return ((unsigned)op < STATS_OP_COUNT) ? op_names[op] : "unknown";
+}
@@ -0,0 +1,278 @@
+/*
+ * OpenCog Time Index
+ * Append-only change log in time-bounded segments
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <pthread.h>
+#include "../include/timeindex.h"
+#include "../include/epoch.h"
+#include "../include/mvcc.h"
+
+#define TIME_DIRECTORY_MIN 16
+#define TIME_NO_SLOT UINT32_MAX       /* Atom beyond the slots an entry can address */
+
+typedef struct {
+    uint64_t version;             /* Version written; 0 while the entry is being filled */
+    uint32_t slot;                /* Atom's position in the space's atom array */
+    uint32_t time;
+} time_entry_t;
+
+typedef struct {
+    uint64_t min_time;            /* Range of the times written so far */
+    uint64_t max_time;
+    time_entry_t entries[TIME_SEGMENT_ENTRIES];
+} time_segment_t;
+
+/*
+ * Segments by number (position / TIME_SEGMENT_ENTRIES); NULL before
+ * allocation and after trimming. Appenders read the directory outside any
+ * epoch, so replaced ones are kept on `previous` until the index goes.
+ */
+typedef struct time_directory {
+    size_t capacity;
+    struct time_directory* previous;
+    time_segment_t* segments[];
+} time_directory_t;
+
+struct time_index {
+    uint64_t next;                /* Next position to reserve */
+    uint64_t first;               /* First position not trimmed */
+    time_directory_t* directory;  /* Replaced on growth */
+    pthread_mutex_t lock;         /* Segment allocation, growth and trimming */
+};
+
+time_index_t* time_index_create(void) {
+    time_index_t* index = calloc(1, sizeof(time_index_t));
+    index->directory = calloc(1, sizeof(time_directory_t) + TIME_DIRECTORY_MIN * sizeof(time_segment_t*));
+    index->directory->capacity = TIME_DIRECTORY_MIN;
+    pthread_mutex_init(&index->lock, NULL);
+    return index;
+}
+
+void time_index_destroy(time_index_t* index) {
+    if (!index) return;
+    for (size_t i = 0; i < index->directory->capacity; i++) {
+        free(index->directory->segments[i]);
+    }
+    for (time_directory_t* directory = index->directory; directory;) {
+        time_directory_t* previous = directory->previous;
+        free(directory);
+        directory = previous;
+    }
+    pthread_mutex_destroy(&index->lock);
+    free(index);
+}
+
+/* Appending */
+static time_segment_t* segment_allocate(time_index_t* index, uint64_t number) {
+    pthread_mutex_lock(&index->lock);
+    time_directory_t* directory = index->directory;
+    if (number >= directory->capacity) {
+        size_t capacity = directory->capacity * 2;
+        while (capacity <= number) capacity *= 2;
+        time_directory_t* grown = calloc(1, sizeof(time_directory_t) + capacity * sizeof(time_segment_t*));
+        grown->capacity = capacity;
+        grown->previous = directory;
+        memcpy(grown->segments, directory->segments, directory->capacity * sizeof(time_segment_t*));
+        __atomic_store_n(&index->directory, grown, __ATOMIC_RELEASE);
+        directory = grown;
+    }
+    time_segment_t* segment = directory->segments[number];
+    if (!segment) {
+        segment = calloc(1, sizeof(time_segment_t));
+        segment->min_time = UINT64_MAX;
+        __atomic_store_n(&directory->segments[number], segment, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&index->lock);
+    return segment;
+}
+
+static inline time_segment_t* segment_get(time_index_t* index, uint64_t number) {
+    time_directory_t* directory = __atomic_load_n(&index->directory, __ATOMIC_ACQUIRE);
+    if (number < directory->capacity) {
+        time_segment_t* segment = __atomic_load_n(&directory->segments[number], __ATOMIC_ACQUIRE);
+        if (segment) return segment;
+    }
+    return segment_allocate(index, number);
+}
+
+static void entry_write(time_segment_t* segment, uint64_t position, uint64_t slot, uint64_t time,
+                        uint64_t version) {
+    time_entry_t* entry = &segment->entries[position % TIME_SEGMENT_ENTRIES];
+    entry->slot = slot < TIME_NO_SLOT ? (uint32_t)slot : TIME_NO_SLOT;
+    entry->time = (uint32_t)time;
+    /* Bounds move at most once a second, so these rarely loop */
+    uint64_t seen = __atomic_load_n(&segment->min_time, __ATOMIC_RELAXED);
+    while (time < seen && !__atomic_compare_exchange_n(&segment->min_time, &seen, time, true,
+                                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    seen = __atomic_load_n(&segment->max_time, __ATOMIC_RELAXED);
+    while (time > seen && !__atomic_compare_exchange_n(&segment->max_time, &seen, time, true,
+                                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    __atomic_store_n(&entry->version, version, __ATOMIC_RELEASE);
+}
+
+void time_index_insert(time_index_t* index, atom_handle_t* const* handles, size_t count, uint64_t version) {
+    if (!index || count == 0) return;
+    uint64_t position = __atomic_fetch_add(&index->next, count, __ATOMIC_RELAXED);
+    time_segment_t* segment = segment_get(index, position / TIME_SEGMENT_ENTRIES);
+    for (size_t i = 0; i < count; i++, position++) {
+        if (i > 0 && position % TIME_SEGMENT_ENTRIES == 0) {
+            segment = segment_get(index, position / TIME_SEGMENT_ENTRIES);
+        }
+        const atom_t* atom = handles[i]->atom;
+        entry_write(segment, position, atom->slot, atom->creation_time, version);
+    }
+}
+
+void time_index_append(time_index_t* index, const atom_t* atom, uint64_t time, uint64_t version) {
+    uint64_t position = __atomic_fetch_add(&index->next, 1, __ATOMIC_RELAXED);
+    entry_write(segment_get(index, position / TIME_SEGMENT_ENTRIES), position, atom->slot, time, version);
+}
+
+void time_index_memory(time_index_t* index, memory_usage_t* usage) {
+    if (!index) return;
+    pthread_mutex_lock(&index->lock);
+    usage->requested += sizeof(time_index_t);
+    usage->allocated += malloc_usable_size(index);
+    for (time_directory_t* old = index->directory; old; old = old->previous) {
+        usage->requested += sizeof(time_directory_t) + old->capacity * sizeof(time_segment_t*);
+        usage->allocated += malloc_usable_size(old);
+    }
+    time_directory_t* directory = index->directory;
+    for (size_t i = 0; i < directory->capacity; i++) {
+        if (!directory->segments[i]) continue;
+        usage->count++;
+        usage->requested += sizeof(time_segment_t);
+        usage->allocated += malloc_usable_size(directory->segments[i]);
+    }
+    pthread_mutex_unlock(&index->lock);
+}
+
+/*
+ * Walk the log from `*position`, keeping atoms whose entry at a time in
+ * [from, to) is their latest change (or their creation, if `created`).
+ * Range queries skip segments outside the range and entries still being
+ * written; cursors stop at the first such entry so it is not lost.
+ */
+typedef struct {
+    uint64_t from;
+    uint64_t to;
+    bool created;
+    bool cursor;
+} log_filter_t;
+
+static size_t log_scan(atomspace_t* space, uint64_t* position, const log_filter_t* filter,
+                       atom_handle_t** out, size_t max) {
+    time_index_t* index = (time_index_t*)space->time_index;
+    size_t slot_count = 0;
+    atom_handle_t* const* slots = atomspace_scan_slots(space, &slot_count);
+    time_directory_t* directory = __atomic_load_n(&index->directory, __ATOMIC_ACQUIRE);
+    uint64_t end = __atomic_load_n(&index->next, __ATOMIC_ACQUIRE);
+    uint64_t first = __atomic_load_n(&index->first, __ATOMIC_ACQUIRE);
+    uint64_t at = *position > first ? *position : first;
+    size_t count = 0;
+
+    while (at < end && count < max) {
+        uint64_t number = at / TIME_SEGMENT_ENTRIES;
+        uint64_t segment_end = (number + 1) * TIME_SEGMENT_ENTRIES;
+        if (segment_end > end) segment_end = end;
+        time_segment_t* segment = number < directory->capacity ?
+            __atomic_load_n(&directory->segments[number], __ATOMIC_ACQUIRE) : NULL;
+        if (!segment) {
+            if (filter->cursor) break;
+            at = segment_end;
+            continue;
+        }
+        if (!filter->cursor && (__atomic_load_n(&segment->max_time, __ATOMIC_RELAXED) < filter->from ||
+                                __atomic_load_n(&segment->min_time, __ATOMIC_RELAXED) >= filter->to)) {
+            at = segment_end;
+            continue;
+        }
+
+        for (; at < segment_end && count < max; at++) {
+            const time_entry_t* entry = &segment->entries[at % TIME_SEGMENT_ENTRIES];
+            uint64_t version = __atomic_load_n(&entry->version, __ATOMIC_ACQUIRE);
+            if (entry->slot == TIME_NO_SLOT) continue;
+            if (!version || entry->slot >= slot_count) {
+                if (filter->cursor) goto done;
+                continue;
+            }
+            if (entry->time < filter->from || entry->time >= filter->to) continue;
+            atom_handle_t* handle = slots[entry->slot];
+            if (!handle || !atom_visible_at(handle->atom, MVCC_LATEST)) continue;
+            uint64_t latest = filter->created ? handle->atom->create_version :
+                              __atomic_load_n(&handle->atom->value_version, __ATOMIC_RELAXED);
+            if (version == latest) out[count++] = handle;
+        }
+    }
+done:
+    *position = at;
+    return count;
+}
+
+size_t atomspace_created_between(atomspace_t* space, uint64_t from, uint64_t to,
+                                 atom_handle_t** out, size_t max) {
+    if (!space || !out) return 0;
+    log_filter_t filter = { from, to, true, false };
+    uint64_t position = 0;
+    return log_scan(space, &position, &filter, out, max);
+}
+
+size_t atomspace_changed_between(atomspace_t* space, uint64_t from, uint64_t to,
+                                 atom_handle_t** out, size_t max) {
+    if (!space || !out) return 0;
+    log_filter_t filter = { from, to, false, false };
+    uint64_t position = 0;
+    return log_scan(space, &position, &filter, out, max);
+}
+
+size_t atomspace_changes_since(atomspace_t* space, uint64_t* cursor, atom_handle_t** out, size_t max) {
+    if (!space || !cursor || !out) return 0;
+    log_filter_t filter = { 0, UINT64_MAX, false, true };
+    return log_scan(space, cursor, &filter, out, max);
+}
+
+uint64_t atomspace_time_position(atomspace_t* space) {
+    if (!space) return 0;
+    return __atomic_load_n(&((time_index_t*)space->time_index)->next, __ATOMIC_ACQUIRE);
+}
+
+size_t atomspace_time_trim(atomspace_t* space, uint64_t before) {
+    if (!space) return 0;
+    time_index_t* index = (time_index_t*)space->time_index;
+    size_t dropped = 0;
+
+    pthread_mutex_lock(&index->lock);
+    time_directory_t* directory = index->directory;
+    uint64_t end = __atomic_load_n(&index->next, __ATOMIC_ACQUIRE);
+    /* Retired after unlocking: reclamation may publish, which allocates segments under this lock */
+    size_t most = (end - index->first) / TIME_SEGMENT_ENTRIES;
+    time_segment_t** trimmed = most ? malloc(most * sizeof(time_segment_t*)) : NULL;
+    while (trimmed && index->first + TIME_SEGMENT_ENTRIES <= end) {
+        uint64_t number = index->first / TIME_SEGMENT_ENTRIES;
+        time_segment_t* segment = number < directory->capacity ? directory->segments[number] : NULL;
+        if (!segment || __atomic_load_n(&segment->max_time, __ATOMIC_RELAXED) >= before) break;
+
+        /* Only whole segments whose appenders are done */
+        bool written = true;
+        for (size_t i = 0; i < TIME_SEGMENT_ENTRIES && written; i++) {
+            written = __atomic_load_n(&segment->entries[i].version, __ATOMIC_ACQUIRE) != 0;
+        }
+        if (!written || __atomic_load_n(&segment->max_time, __ATOMIC_RELAXED) >= before) break;
+
+        __atomic_store_n(&directory->segments[number], NULL, __ATOMIC_RELEASE);
+        __atomic_store_n(&index->first, index->first + TIME_SEGMENT_ENTRIES, __ATOMIC_RELEASE);
+        trimmed[dropped / TIME_SEGMENT_ENTRIES] = segment;
+        dropped += TIME_SEGMENT_ENTRIES;
+    }
+    pthread_mutex_unlock(&index->lock);
+
+    for (size_t i = 0; i < dropped / TIME_SEGMENT_ENTRIES; i++) epoch_retire(trimmed[i], free);
+    free(trimmed);
+    return dropped;
+}
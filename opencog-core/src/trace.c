@@ -0,0 +1,239 @@
+/*
+ * OpenCog Event Tracing
+ * Per-thread lock-free binary trace rings with Chrome trace export
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include "../include/trace.h"
+
+#define DEFAULT_RING_EVENTS 65536
+
+volatile bool trace_active = false;
+
+/* Single-producer ring owned by one thread; head only ever grows */
+typedef struct trace_ring {
+    trace_record_t* records;
+    size_t capacity;              /* Power of two */
+    uint64_t head;                /* Records ever written */
+    uint32_t tid;
+    bool in_use;
+    struct trace_ring* next;
+} trace_ring_t;
+
+static pthread_mutex_t ring_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static trace_ring_t* ring_registry = NULL;
+static size_t ring_capacity = DEFAULT_RING_EVENTS;
+static pthread_key_t ring_key;
+static pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+static __thread trace_ring_t* local_ring = NULL;
+
+static const char* event_names[TRACE_EVENT_COUNT] = {
+    "atom_create", "query", "msg_send", "msg_receive", "heartbeat", "consensus",
+    "txn_commit"
+};
+
+static void ring_thread_exit(void* arg) {
+    trace_ring_t* ring = (trace_ring_t*)arg;
+    pthread_mutex_lock(&ring_registry_lock);
+    ring->in_use = false;
+    pthread_mutex_unlock(&ring_registry_lock);
+}
+
+static void make_ring_key(void) {
+    pthread_key_create(&ring_key, ring_thread_exit);
+}
+
+/* Rings of exited threads are reused; their old records stay until overwritten */
+static trace_ring_t* thread_ring(void) {
+    if (local_ring) return local_ring;
+
+    pthread_once(&ring_key_once, make_ring_key);
+    pthread_mutex_lock(&ring_registry_lock);
+
+    trace_ring_t* ring = ring_registry;
+    while (ring && (ring->in_use || ring->capacity != ring_capacity)) {
+        ring = ring->next;
+    }
+    if (!ring) {
+        ring = calloc(1, sizeof(trace_ring_t));
+        ring->records = calloc(ring_capacity, sizeof(trace_record_t));
+        ring->capacity = ring_capacity;
+        ring->next = ring_registry;
+        ring_registry = ring;
+    }
+    ring->in_use = true;
+    ring->tid = (uint32_t)syscall(SYS_gettid);
+
+    pthread_mutex_unlock(&ring_registry_lock);
+    pthread_setspecific(ring_key, ring);
+    local_ring = ring;
+    return ring;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void trace_record(trace_event_t event, char phase, uint64_t arg0, uint64_t arg1) {
+    trace_ring_t* ring = thread_ring();
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    trace_record_t* record = &ring->records[head & (ring->capacity - 1)];
+
+    record->timestamp_ns = now_ns();
+    record->arg0 = arg0;
+    record->arg1 = arg1;
+    record->tid = ring->tid;
+    record->event = (uint16_t)event;
+    record->phase = (uint8_t)phase;
+    record->reserved = 0;
+
+    /* Publish the record to concurrent dumps */
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/* Ring control */
+int trace_start(size_t events_per_thread) {
+    size_t capacity = 1;
+    size_t wanted = events_per_thread ? events_per_thread : DEFAULT_RING_EVENTS;
+    while (capacity < wanted) capacity <<= 1;
+
+    pthread_mutex_lock(&ring_registry_lock);
+    ring_capacity = capacity;
+    pthread_mutex_unlock(&ring_registry_lock);
+
+    /* Threads that already own a ring keep its original size */
+    trace_active = true;
+    return 0;
+}
+
+void trace_stop(void) {
+    trace_active = false;
+}
+
+uint64_t trace_dropped(void) {
+    uint64_t dropped = 0;
+    pthread_mutex_lock(&ring_registry_lock);
+    for (trace_ring_t* ring = ring_registry; ring; ring = ring->next) {
+        uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (head > ring->capacity) dropped += head - ring->capacity;
+    }
+    pthread_mutex_unlock(&ring_registry_lock);
+    return dropped;
+}
+
+/* Copy the live window of a ring, discarding records overwritten during the copy */
+static size_t copy_ring(trace_ring_t* ring, trace_record_t* out) {
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t first = head > ring->capacity ? head - ring->capacity : 0;
+
+    for (uint64_t i = first; i < head; i++) {
+        out[i - first] = ring->records[i & (ring->capacity - 1)];
+    }
+
+    uint64_t after = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t valid_from = after > ring->capacity ? after - ring->capacity : 0;
+    if (valid_from <= first) return (size_t)(head - first);
+
+    size_t skip = (size_t)(valid_from - first);
+    if (skip >= head - first) return 0;
+    memmove(out, out + skip, sizeof(trace_record_t) * (size_t)(head - first - skip));
+    return (size_t)(head - first - skip);
+}
+
+int trace_dump(const char* path) {
+    FILE* out = fopen(path, "wb");
+    if (!out) return -1;
+
+    trace_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic));
+    header.version = 1;
+    header.record_size = sizeof(trace_record_t);
+    header.pid = (uint32_t)getpid();
+    fwrite(&header, sizeof(header), 1, out);
+
+    pthread_mutex_lock(&ring_registry_lock);
+    for (trace_ring_t* ring = ring_registry; ring; ring = ring->next) {
+        trace_record_t* copy = malloc(sizeof(trace_record_t) * ring->capacity);
+        size_t count = copy_ring(ring, copy);
+        fwrite(copy, sizeof(trace_record_t), count, out);
+        header.record_count += count;
+        free(copy);
+    }
+    pthread_mutex_unlock(&ring_registry_lock);
+
+    /* Rewrite the header with the final record count */
+    fseek(out, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, out);
+    int status = ferror(out) ? -1 : 0;
+    fclose(out);
+    return status;
+}
+
+const char* trace_event_name(trace_event_t event) {
+    return ((unsigned)event < TRACE_EVENT_COUNT) ? event_names[event] : "unknown";
+}
+
+/* Chrome trace export; ties keep file order so begin/end pairs stay nested */
+typedef struct {
+    trace_record_t record;
+    size_t seq;
+} ordered_record_t;
+
+static int compare_records(const void* a, const void* b) {
+    const ordered_record_t* x = (const ordered_record_t*)a;
+    const ordered_record_t* y = (const ordered_record_t*)b;
+    if (x->record.timestamp_ns != y->record.timestamp_ns) {
+        return (x->record.timestamp_ns > y->record.timestamp_ns) ? 1 : -1;
+    }
+    return (x->seq > y->seq) - (x->seq < y->seq);
+}
+
+long trace_convert_chrome(const char* path, FILE* out) {
+    FILE* in = fopen(path, "rb");
+    if (!in) return -1;
+
+    trace_file_header_t header;
+    if (fread(&header, sizeof(header), 1, in) != 1 ||
+        memcmp(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.record_size != sizeof(trace_record_t)) {
+        fclose(in);
+        return -1;
+    }
+
+    ordered_record_t* records = malloc(sizeof(ordered_record_t) * (header.record_count ? header.record_count : 1));
+    size_t count = 0;
+    while (count < header.record_count &&
+           fread(&records[count].record, sizeof(trace_record_t), 1, in) == 1) {
+        records[count].seq = count;
+        count++;
+    }
+    fclose(in);
+    qsort(records, count, sizeof(ordered_record_t), compare_records);
+
+    uint64_t origin = count ? records[0].record.timestamp_ns : 0;
+    fprintf(out, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    for (size_t i = 0; i < count; i++) {
+        trace_record_t* r = &records[i].record;
+        char phase = (r->phase == TRACE_PHASE_BEGIN || r->phase == TRACE_PHASE_END) ? (char)r->phase : 'i';
+        fprintf(out, "  {\"name\": \"%s\", \"cat\": \"opencog\", \"ph\": \"%c\", \"ts\": %.3f, "
+                "\"pid\": %u, \"tid\": %u%s\"args\": {\"arg0\": %llu, \"arg1\": %llu}}%s\n",
+                trace_event_name((trace_event_t)r->event), phase,
+                (double)(r->timestamp_ns - origin) / 1000.0, header.pid, r->tid,
+                phase == 'i' ? ", \"s\": \"t\", " : ", ",
+                (unsigned long long)r->arg0, (unsigned long long)r->arg1,
+                (i + 1 < count) ? "," : "");
+    }
+    fprintf(out, "]}\n");
+
+    free(records);
+    return (long)count;
+}
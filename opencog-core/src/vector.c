@@ -0,0 +1,794 @@
+/*
+ * OpenCog Vector Values
+ * Per-dimension vector storage with an HNSW nearest-neighbour index
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <malloc.h>
+#include <pthread.h>
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+#include "../include/vector.h"
+#include "../include/mvcc.h"
+#include "../include/lockprof.h"
+
+#define VECTOR_ALIGN 8                /* Floats per padded block; rows start on 32 bytes */
+#define VECTOR_MAX_LEVEL 16
+#define VECTOR_MIN_CAPACITY 64
+
+LOCKPROF_SITE(vector_read_site, "vector.class.read");
+LOCKPROF_SITE(vector_write_site, "vector.class.write");
+
+/* All vectors of one dimension and their graph */
+typedef struct {
+    uint32_t dim;
+    uint32_t stride;              /* dim rounded up to VECTOR_ALIGN */
+    vector_index_config_t config;
+    double level_mult;            /* 1 / ln(m) */
+    pthread_rwlock_t lock;        /* Searches read, inserts and detaches write */
+
+    float* data;                  /* capacity rows of stride floats, zero padded */
+    float* inv_norms;             /* 1 / |row| for cosine, 0 for zero rows */
+    atom_handle_t** atoms;        /* Owner of each row, NULL once detached */
+    uint8_t* levels;
+    uint32_t* links;              /* Level 0: per row a count and up to 2m neighbours */
+    uint32_t** upper;             /* Levels 1 .. level: a count and up to m neighbours each */
+    size_t count;
+    size_t capacity;
+    size_t live;
+    uint32_t entry;
+    int max_level;                /* -1 while empty */
+    uint64_t rng;
+} vector_class_t;
+
+struct vector_index {
+    pthread_mutex_t lock;         /* Class creation */
+    vector_class_t* classes[VECTOR_MAX_CLASSES];
+    size_t class_count;
+};
+
+/* A row and its distance to the query */
+typedef struct {
+    float distance;
+    uint32_t row;
+} vector_hit_t;
+
+typedef struct {
+    vector_hit_t* items;
+    size_t count;
+    size_t capacity;
+} hit_heap_t;
+
+/* Per-thread search buffers, reused across queries */
+typedef struct {
+    uint32_t* visited;            /* visited[row] == tag marks rows seen by this search */
+    size_t visited_capacity;
+    uint32_t tag;
+    hit_heap_t candidates;        /* Nearest first */
+    hit_heap_t results;           /* Farthest first, bounded by ef */
+    float* query;                 /* Padded copy of the query */
+    size_t query_capacity;
+} search_scratch_t;
+
+static pthread_key_t scratch_key;
+static pthread_once_t scratch_key_once = PTHREAD_ONCE_INIT;
+static __thread search_scratch_t* local_scratch = NULL;
+
+static void scratch_thread_exit(void* arg) {
+    search_scratch_t* scratch = (search_scratch_t*)arg;
+    free(scratch->visited);
+    free(scratch->candidates.items);
+    free(scratch->results.items);
+    free(scratch->query);
+    free(scratch);
+}
+
+static void make_scratch_key(void) {
+    pthread_key_create(&scratch_key, scratch_thread_exit);
+}
+
+static search_scratch_t* thread_scratch(void) {
+    if (local_scratch) return local_scratch;
+    pthread_once(&scratch_key_once, make_scratch_key);
+    local_scratch = calloc(1, sizeof(search_scratch_t));
+    pthread_setspecific(scratch_key, local_scratch);
+    return local_scratch;
+}
+
+/* Distance kernels; lengths are multiples of VECTOR_ALIGN */
+#if defined(__AVX2__) && defined(__FMA__)
+static inline float hsum256(__m256 v) {
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+    return _mm_cvtss_f32(sum);
+}
+
+static inline float kernel_dot(const float* a, const float* b, size_t n) {
+    __m256 s0 = _mm256_setzero_ps();
+    __m256 s1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), s0);
+        s1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), s1);
+    }
+    if (i < n) s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), s0);
+    return hsum256(_mm256_add_ps(s0, s1));
+}
+
+static inline float kernel_l2(const float* a, const float* b, size_t n) {
+    __m256 s0 = _mm256_setzero_ps();
+    __m256 s1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+        s0 = _mm256_fmadd_ps(d0, d0, s0);
+        s1 = _mm256_fmadd_ps(d1, d1, s1);
+    }
+    if (i < n) {
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        s0 = _mm256_fmadd_ps(d0, d0, s0);
+    }
+    return hsum256(_mm256_add_ps(s0, s1));
+}
+#else
+/* One accumulator per lane so the compiler can vectorize without reassociating */
+static inline float kernel_dot(const float* a, const float* b, size_t n) {
+    float sum[VECTOR_ALIGN] = {0};
+    for (size_t i = 0; i < n; i += VECTOR_ALIGN) {
+        for (size_t j = 0; j < VECTOR_ALIGN; j++) sum[j] += a[i + j] * b[i + j];
+    }
+    float total = 0.0f;
+    for (size_t j = 0; j < VECTOR_ALIGN; j++) total += sum[j];
+    return total;
+}
+
+static inline float kernel_l2(const float* a, const float* b, size_t n) {
+    float sum[VECTOR_ALIGN] = {0};
+    for (size_t i = 0; i < n; i += VECTOR_ALIGN) {
+        for (size_t j = 0; j < VECTOR_ALIGN; j++) {
+            float d = a[i + j] - b[i + j];
+            sum[j] += d * d;
+        }
+    }
+    float total = 0.0f;
+    for (size_t j = 0; j < VECTOR_ALIGN; j++) total += sum[j];
+    return total;
+}
+#endif
+
+static inline const float* row_data(const vector_class_t* c, uint32_t row) {
+    return c->data + (size_t)row * c->stride;
+}
+
+static inline float distance_to(const vector_class_t* c, const float* query, float query_inv, uint32_t row) {
+    if (c->config.metric == VECTOR_METRIC_COSINE) {
+        return 1.0f - kernel_dot(query, row_data(c, row), c->stride) * query_inv * c->inv_norms[row];
+    }
+    return kernel_l2(query, row_data(c, row), c->stride);
+}
+
+static inline float row_distance(const vector_class_t* c, uint32_t a, uint32_t b) {
+    return distance_to(c, row_data(c, a), c->inv_norms[a], b);
+}
+
+static inline uint32_t* links_at(const vector_class_t* c, uint32_t row, int level) {
+    if (level == 0) return c->links + (size_t)row * (1 + 2 * c->config.m);
+    return c->upper[row] + (size_t)(level - 1) * (1 + c->config.m);
+}
+
+/* Rows a search may return: attached to an atom that is not removed */
+static inline bool row_live(const vector_class_t* c, uint32_t row) {
+    atom_handle_t* handle = c->atoms[row];
+    return handle && atom_visible_at(handle->atom, MVCC_LATEST);
+}
+
+/* Heaps; `max` orders farthest first */
+static inline bool hit_before(vector_hit_t a, vector_hit_t b, bool max) {
+    return max ? a.distance > b.distance : a.distance < b.distance;
+}
+
+static void heap_push(hit_heap_t* heap, vector_hit_t hit, bool max) {
+    if (heap->count == heap->capacity) {
+        heap->capacity = heap->capacity ? heap->capacity * 2 : 64;
+        heap->items = realloc(heap->items, heap->capacity * sizeof(vector_hit_t));
+    }
+    size_t i = heap->count++;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!hit_before(hit, heap->items[parent], max)) break;
+        heap->items[i] = heap->items[parent];
+        i = parent;
+    }
+    heap->items[i] = hit;
+}
+
+static void heap_pop(hit_heap_t* heap, bool max) {
+    vector_hit_t last = heap->items[--heap->count];
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= heap->count) break;
+        if (child + 1 < heap->count && hit_before(heap->items[child + 1], heap->items[child], max)) child++;
+        if (!hit_before(heap->items[child], last, max)) break;
+        heap->items[i] = heap->items[child];
+        i = child;
+    }
+    if (heap->count) heap->items[i] = last;
+}
+
+static int hit_compare(const void* a, const void* b) {
+    float da = ((const vector_hit_t*)a)->distance;
+    float db = ((const vector_hit_t*)b)->distance;
+    return (da > db) - (da < db);
+}
+
+/* Start a search over `rows` rows; returns the tag that marks them visited */
+static uint32_t scratch_begin(search_scratch_t* s, size_t rows) {
+    if (s->visited_capacity < rows) {
+        size_t capacity = s->visited_capacity ? s->visited_capacity : VECTOR_MIN_CAPACITY;
+        while (capacity < rows) capacity *= 2;
+        s->visited = realloc(s->visited, capacity * sizeof(uint32_t));
+        memset(s->visited + s->visited_capacity, 0, (capacity - s->visited_capacity) * sizeof(uint32_t));
+        s->visited_capacity = capacity;
+    }
+    if (++s->tag == 0) {
+        memset(s->visited, 0, s->visited_capacity * sizeof(uint32_t));
+        s->tag = 1;
+    }
+    s->candidates.count = 0;
+    s->results.count = 0;
+    return s->tag;
+}
+
+/* Walk down from the entry point to `level` + 1, keeping the single nearest row */
+static uint32_t greedy_descend(const vector_class_t* c, const float* query, float query_inv, int level) {
+    uint32_t current = c->entry;
+    float best = distance_to(c, query, query_inv, current);
+    for (int l = c->max_level; l > level; l--) {
+        bool moved = true;
+        while (moved) {
+            moved = false;
+            const uint32_t* links = links_at(c, current, l);
+            for (uint32_t i = 0; i < links[0]; i++) {
+                float d = distance_to(c, query, query_inv, links[1 + i]);
+                if (d < best) {
+                    best = d;
+                    current = links[1 + i];
+                    moved = true;
+                }
+            }
+        }
+    }
+    return current;
+}
+
+/*
+ * Best-first search of one level from `entry`, leaving the `ef` nearest rows
+ * in s->results. Tombstones are expanded but, with `live_only`, not kept.
+ */
+static void search_level(const vector_class_t* c, search_scratch_t* s, const float* query,
+                         float query_inv, uint32_t entry, size_t ef, int level, bool live_only) {
+    uint32_t tag = scratch_begin(s, c->count);
+    vector_hit_t start = { distance_to(c, query, query_inv, entry), entry };
+    s->visited[entry] = tag;
+    heap_push(&s->candidates, start, false);
+    if (!live_only || row_live(c, entry)) heap_push(&s->results, start, true);
+
+    while (s->candidates.count) {
+        vector_hit_t nearest = s->candidates.items[0];
+        if (s->results.count >= ef && nearest.distance > s->results.items[0].distance) break;
+        heap_pop(&s->candidates, false);
+
+        const uint32_t* links = links_at(c, nearest.row, level);
+        uint32_t n = links[0];
+        for (uint32_t i = 0; i < n; i++) {
+            if (i + 1 < n) __builtin_prefetch(row_data(c, links[2 + i]));
+            uint32_t row = links[1 + i];
+            if (s->visited[row] == tag) continue;
+            s->visited[row] = tag;
+
+            float d = distance_to(c, query, query_inv, row);
+            if (s->results.count < ef || d < s->results.items[0].distance) {
+                vector_hit_t hit = { d, row };
+                heap_push(&s->candidates, hit, false);
+                if (!live_only || row_live(c, row)) {
+                    heap_push(&s->results, hit, true);
+                    if (s->results.count > ef) heap_pop(&s->results, true);
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Neighbour selection heuristic: sorted by distance, a candidate is kept
+ * only if it is closer to the base row than to every neighbour kept so far,
+ * which spreads links across directions instead of one dense cluster.
+ */
+static size_t select_neighbors(const vector_class_t* c, vector_hit_t* hits, size_t n, size_t m,
+                               uint32_t* out) {
+    qsort(hits, n, sizeof(vector_hit_t), hit_compare);
+    size_t kept = 0;
+    for (size_t i = 0; i < n && kept < m; i++) {
+        bool keep = true;
+        for (size_t j = 0; j < kept && keep; j++) {
+            keep = row_distance(c, hits[i].row, out[j]) >= hits[i].distance;
+        }
+        if (keep) out[kept++] = hits[i].row;
+    }
+    return kept;
+}
+
+/* Link `row` to its selected neighbours and back, pruning neighbours that overflow */
+static void connect_row(vector_class_t* c, uint32_t row, int level, const uint32_t* neighbors, size_t n) {
+    size_t max = level ? c->config.m : 2 * c->config.m;
+    uint32_t* links = links_at(c, row, level);
+    links[0] = (uint32_t)n;
+    memcpy(links + 1, neighbors, n * sizeof(uint32_t));
+
+    for (size_t i = 0; i < n; i++) {
+        uint32_t* back = links_at(c, neighbors[i], level);
+        bool linked = false;
+        for (uint32_t j = 0; j < back[0] && !linked; j++) linked = back[1 + j] == row;
+        if (linked) continue;
+        if (back[0] < max) {
+            back[1 + back[0]++] = row;
+            continue;
+        }
+        vector_hit_t hits[2 * VECTOR_MAX_M + 1];
+        for (uint32_t j = 0; j < back[0]; j++) {
+            hits[j].row = back[1 + j];
+            hits[j].distance = row_distance(c, neighbors[i], back[1 + j]);
+        }
+        hits[max].row = row;
+        hits[max].distance = row_distance(c, neighbors[i], row);
+        back[0] = (uint32_t)select_neighbors(c, hits, max + 1, max, back + 1);
+    }
+}
+
+static int random_level(vector_class_t* c) {
+    /* splitmix64, mapped to (0, 1] */
+    uint64_t z = (c->rng += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    double u = (double)((z >> 11) + 1) * 0x1.0p-53;
+    int level = (int)(-log(u) * c->level_mult);
+    return level < VECTOR_MAX_LEVEL ? level : VECTOR_MAX_LEVEL;
+}
+
+static int class_reserve(vector_class_t* c, size_t rows) {
+    if (rows <= c->capacity) return 0;
+    size_t capacity = c->capacity ? c->capacity * 2 : VECTOR_MIN_CAPACITY;
+    while (capacity < rows) capacity *= 2;
+
+    float* data = aligned_alloc(VECTOR_ALIGN * sizeof(float), capacity * c->stride * sizeof(float));
+    float* inv_norms = realloc(c->inv_norms, capacity * sizeof(float));
+    if (inv_norms) c->inv_norms = inv_norms;
+    atom_handle_t** atoms = realloc(c->atoms, capacity * sizeof(atom_handle_t*));
+    if (atoms) c->atoms = atoms;
+    uint8_t* levels = realloc(c->levels, capacity);
+    if (levels) c->levels = levels;
+    uint32_t* links = realloc(c->links, capacity * (1 + 2 * c->config.m) * sizeof(uint32_t));
+    if (links) c->links = links;
+    uint32_t** upper = realloc(c->upper, capacity * sizeof(uint32_t*));
+    if (upper) c->upper = upper;
+    if (!data || !inv_norms || !atoms || !levels || !links || !upper) {
+        free(data);
+        return -1;
+    }
+
+    if (c->count) memcpy(data, c->data, c->count * c->stride * sizeof(float));
+    free(c->data);
+    c->data = data;
+    c->capacity = capacity;
+    return 0;
+}
+
+/* Copy `values` into a row, zero padded, and cache its inverse norm */
+static void row_store(vector_class_t* c, uint32_t row, const float* values) {
+    float* data = c->data + (size_t)row * c->stride;
+    memcpy(data, values, c->dim * sizeof(float));
+    memset(data + c->dim, 0, (c->stride - c->dim) * sizeof(float));
+    float norm = sqrtf(kernel_dot(data, data, c->stride));
+    c->inv_norms[row] = norm > 0.0f ? 1.0f / norm : 0.0f;
+}
+
+/*
+ * Choose `row`'s neighbours on levels `level` .. 0 by searching from the
+ * entry point. A row being relinked may be reached through its own stale
+ * links, so it is dropped from the candidates before selection.
+ */
+static void row_link(vector_class_t* c, uint32_t row, int level) {
+    search_scratch_t* s = thread_scratch();
+    const float* data = row_data(c, row);
+    float inv = c->inv_norms[row];
+    uint32_t current = greedy_descend(c, data, inv, level);
+    for (int l = level < c->max_level ? level : c->max_level; l >= 0; l--) {
+        search_level(c, s, data, inv, current, c->config.ef_construction, l, false);
+        size_t kept = 0;
+        for (size_t i = 0; i < s->results.count; i++) {
+            if (s->results.items[i].row != row) s->results.items[kept++] = s->results.items[i];
+        }
+        if (kept == 0) continue;
+        uint32_t neighbors[VECTOR_MAX_M];
+        size_t n = select_neighbors(c, s->results.items, kept, c->config.m, neighbors);
+        current = s->results.items[0].row;
+        connect_row(c, row, l, neighbors, n);
+    }
+}
+
+/* Append a row for `handle` and link it into the graph; the caller holds the write lock */
+static int class_insert(vector_class_t* c, atom_handle_t* handle, const float* values, uint32_t* row_out) {
+    if (class_reserve(c, c->count + 1) != 0) return -1;
+    int level = random_level(c);
+    uint32_t* upper = NULL;
+    if (level > 0) {
+        upper = calloc((size_t)level * (1 + c->config.m), sizeof(uint32_t));
+        if (!upper) return -1;
+    }
+
+    uint32_t row = (uint32_t)c->count;
+    row_store(c, row, values);
+    c->atoms[row] = handle;
+    c->levels[row] = (uint8_t)level;
+    c->upper[row] = upper;
+    links_at(c, row, 0)[0] = 0;
+    c->count++;
+    c->live++;
+    *row_out = row;
+
+    if (c->max_level < 0) {
+        c->entry = row;
+        c->max_level = level;
+        return 0;
+    }
+
+    row_link(c, row, level);
+    if (level > c->max_level) {
+        c->entry = row;
+        c->max_level = level;
+    }
+    return 0;
+}
+
+/*
+ * Overwrite a live row with new values and relink it at its level; the
+ * caller holds the write lock. Neighbours that linked to the old values
+ * keep their links, which stay valid edges for search to walk.
+ */
+static void class_update(vector_class_t* c, uint32_t row, const float* values) {
+    row_store(c, row, values);
+    if (c->count > 1) row_link(c, row, c->levels[row]);
+}
+
+static void class_destroy(vector_class_t* c) {
+    for (size_t i = 0; i < c->count; i++) free(c->upper[i]);
+    free(c->data);
+    free(c->inv_norms);
+    free(c->atoms);
+    free(c->levels);
+    free(c->links);
+    free(c->upper);
+    pthread_rwlock_destroy(&c->lock);
+    free(c);
+}
+
+/* Index */
+void vector_index_config_default(vector_index_config_t* config) {
+    if (!config) return;
+    config->metric = VECTOR_METRIC_COSINE;
+    config->m = 16;
+    config->ef_construction = 100;
+    config->ef_search = 64;
+    config->seed = 0x5EED;
+}
+
+static bool config_valid(const vector_index_config_t* config) {
+    return (config->metric == VECTOR_METRIC_L2 || config->metric == VECTOR_METRIC_COSINE) &&
+           config->m >= 2 && config->m <= VECTOR_MAX_M && config->ef_construction > 0;
+}
+
+static void class_configure(vector_class_t* c, const vector_index_config_t* config) {
+    c->config = *config;
+    if (c->config.ef_search == 0) c->config.ef_search = c->config.ef_construction;
+    c->level_mult = 1.0 / log((double)c->config.m);
+    c->rng = c->config.seed;
+}
+
+vector_index_t* vector_index_create(void) {
+    vector_index_t* index = calloc(1, sizeof(vector_index_t));
+    if (index) pthread_mutex_init(&index->lock, NULL);
+    return index;
+}
+
+void vector_index_destroy(vector_index_t* index) {
+    if (!index) return;
+    for (size_t i = 0; i < index->class_count; i++) class_destroy(index->classes[i]);
+    pthread_mutex_destroy(&index->lock);
+    free(index);
+}
+
+/* Class number (1-based, as stored in atoms) of a dimension, 0 if none */
+static uint32_t class_find(vector_index_t* index, uint32_t dim) {
+    size_t count = __atomic_load_n(&index->class_count, __ATOMIC_ACQUIRE);
+    for (size_t i = 0; i < count; i++) {
+        if (index->classes[i]->dim == dim) return (uint32_t)i + 1;
+    }
+    return 0;
+}
+
+static uint32_t class_get(vector_index_t* index, uint32_t dim) {
+    uint32_t found = class_find(index, dim);
+    if (found || dim == 0 || dim > VECTOR_MAX_DIM) return found;
+
+    pthread_mutex_lock(&index->lock);
+    found = class_find(index, dim);
+    if (!found && index->class_count < VECTOR_MAX_CLASSES) {
+        vector_class_t* c = calloc(1, sizeof(vector_class_t));
+        if (c) {
+            vector_index_config_t config;
+            vector_index_config_default(&config);
+            c->dim = dim;
+            c->stride = (dim + VECTOR_ALIGN - 1) / VECTOR_ALIGN * VECTOR_ALIGN;
+            c->max_level = -1;
+            class_configure(c, &config);
+            pthread_rwlock_init(&c->lock, NULL);
+            index->classes[index->class_count] = c;
+            __atomic_store_n(&index->class_count, index->class_count + 1, __ATOMIC_RELEASE);
+            found = (uint32_t)index->class_count;
+        }
+    }
+    pthread_mutex_unlock(&index->lock);
+    return found;
+}
+
+/* Tombstone the atom's row; the caller holds the class's write lock */
+static void class_detach_locked(vector_class_t* c, atom_t* atom) {
+    c->atoms[atom->vector_row] = NULL;
+    c->live--;
+    __atomic_store_n(&atom->vector_class, 0, __ATOMIC_RELEASE);
+}
+
+static bool detach(vector_index_t* index, atom_handle_t* handle) {
+    atom_t* atom = handle->atom;
+    uint32_t number = __atomic_load_n(&atom->vector_class, __ATOMIC_ACQUIRE);
+    if (!number) return false;
+    vector_class_t* c = index->classes[number - 1];
+    uint64_t held = lockprof_wrlock(&c->lock, &vector_write_site);
+    bool attached = atom->vector_class == number;
+    if (attached) class_detach_locked(c, atom);
+    lockprof_rwlock_unlock(&c->lock, &vector_write_site, held);
+    return attached;
+}
+
+void vector_index_detach(vector_index_t* index, atom_handle_t* handle) {
+    if (index && handle) detach(index, handle);
+}
+
+void vector_index_memory(vector_index_t* index, memory_usage_t* usage) {
+    if (!index) return;
+    size_t count = __atomic_load_n(&index->class_count, __ATOMIC_ACQUIRE);
+    for (size_t i = 0; i < count; i++) {
+        vector_class_t* c = index->classes[i];
+        uint64_t held = lockprof_rdlock(&c->lock, &vector_read_site);
+        size_t row_bytes = c->stride * sizeof(float) + sizeof(float) + sizeof(atom_handle_t*) +
+                           sizeof(uint8_t) + (1 + 2 * c->config.m) * sizeof(uint32_t) + sizeof(uint32_t*);
+        usage->count += c->count;
+        usage->requested += c->count * row_bytes;
+        usage->allocated += malloc_usable_size(c->data) + malloc_usable_size(c->inv_norms) +
+                            malloc_usable_size(c->atoms) + malloc_usable_size(c->levels) +
+                            malloc_usable_size(c->links) + malloc_usable_size(c->upper);
+        for (size_t r = 0; r < c->count; r++) {
+            if (!c->upper[r]) continue;
+            usage->requested += (size_t)c->levels[r] * (1 + c->config.m) * sizeof(uint32_t);
+            usage->allocated += malloc_usable_size(c->upper[r]);
+        }
+        lockprof_rwlock_unlock(&c->lock, &vector_read_site, held);
+    }
+}
+
+/* Attaching */
+int atomspace_vector_configure(atomspace_t* space, uint32_t dim, const vector_index_config_t* config) {
+    if (!space || !config || !config_valid(config)) return -1;
+    uint32_t number = class_get((vector_index_t*)space->vector_index, dim);
+    if (!number) return -1;
+    vector_class_t* c = ((vector_index_t*)space->vector_index)->classes[number - 1];
+
+    uint64_t held = lockprof_wrlock(&c->lock, &vector_write_site);
+    int result = c->count == 0 ? 0 : -1;
+    if (result == 0) class_configure(c, config);
+    lockprof_rwlock_unlock(&c->lock, &vector_write_site, held);
+    return result;
+}
+
+int atom_set_vector(atomspace_t* space, atom_handle_t* handle, const float* values, uint32_t dim) {
+    if (!space || !handle || !values) return -1;
+    vector_index_t* index = (vector_index_t*)space->vector_index;
+    atom_t* atom = handle->atom;
+    /* Only atoms published in this space; staged and removed atoms have no row to keep */
+    if (atomspace_get_atom(space, handle->id) != handle) return -1;
+    uint32_t number = class_get(index, dim);
+    if (!number) return -1;
+
+    uint32_t current = __atomic_load_n(&atom->vector_class, __ATOMIC_ACQUIRE);
+    if (current && current != number) detach(index, handle);
+
+    vector_class_t* c = index->classes[number - 1];
+    uint64_t held = lockprof_wrlock(&c->lock, &vector_write_site);
+    /* Same dimension: reuse the row, so replacing a vector does not grow the class */
+    if (atom->vector_class == number) {
+        class_update(c, atom->vector_row, values);
+        lockprof_rwlock_unlock(&c->lock, &vector_write_site, held);
+        return 0;
+    }
+    uint32_t row;
+    int result = class_insert(c, handle, values, &row);
+    if (result == 0) {
+        atom->vector_row = row;
+        __atomic_store_n(&atom->vector_class, number, __ATOMIC_RELEASE);
+    }
+    lockprof_rwlock_unlock(&c->lock, &vector_write_site, held);
+    return result;
+}
+
+int atom_clear_vector(atomspace_t* space, atom_handle_t* handle) {
+    if (!space || !handle) return -1;
+    return detach((vector_index_t*)space->vector_index, handle) ? 0 : -1;
+}
+
+uint32_t atom_get_vector(atomspace_t* space, atom_handle_t* handle, float* out, uint32_t capacity) {
+    if (!space || !handle) return 0;
+    vector_index_t* index = (vector_index_t*)space->vector_index;
+    atom_t* atom = handle->atom;
+    uint32_t number = __atomic_load_n(&atom->vector_class, __ATOMIC_ACQUIRE);
+    if (!number) return 0;
+
+    vector_class_t* c = index->classes[number - 1];
+    uint32_t dim = 0;
+    uint64_t held = lockprof_rdlock(&c->lock, &vector_read_site);
+    if (atom->vector_class == number) {
+        dim = c->dim;
+        if (out) memcpy(out, row_data(c, atom->vector_row), (dim < capacity ? dim : capacity) * sizeof(float));
+    }
+    lockprof_rwlock_unlock(&c->lock, &vector_read_site, held);
+    return dim;
+}
+
+size_t atomspace_vector_count(atomspace_t* space, uint32_t dim) {
+    if (!space) return 0;
+    vector_index_t* index = (vector_index_t*)space->vector_index;
+    uint32_t number = class_find(index, dim);
+    return number ? __atomic_load_n(&index->classes[number - 1]->live, __ATOMIC_RELAXED) : 0;
+}
+
+/* Searching */
+
+/* Padded copy of `query` and its inverse norm */
+static const float* prepare_query(const vector_class_t* c, search_scratch_t* s, const float* query,
+                                  float* inv) {
+    if (s->query_capacity < c->stride) {
+        free(s->query);
+        s->query = aligned_alloc(VECTOR_ALIGN * sizeof(float), c->stride * sizeof(float));
+        s->query_capacity = c->stride;
+    }
+    memcpy(s->query, query, c->dim * sizeof(float));
+    memset(s->query + c->dim, 0, (c->stride - c->dim) * sizeof(float));
+    float norm = sqrtf(kernel_dot(s->query, s->query, c->stride));
+    *inv = norm > 0.0f ? 1.0f / norm : 0.0f;
+    return s->query;
+}
+
+/* Sorted matches from s->results, skipping `exclude`; the caller holds the read lock */
+static size_t collect_matches(const vector_class_t* c, search_scratch_t* s, size_t k,
+                              const atom_handle_t* exclude, vector_match_t* out) {
+    qsort(s->results.items, s->results.count, sizeof(vector_hit_t), hit_compare);
+    size_t n = 0;
+    for (size_t i = 0; i < s->results.count && n < k; i++) {
+        atom_handle_t* handle = c->atoms[s->results.items[i].row];
+        if (handle == exclude) continue;
+        out[n].atom = handle;
+        out[n].distance = s->results.items[i].distance;
+        n++;
+    }
+    return n;
+}
+
+static size_t class_search(const vector_class_t* c, search_scratch_t* s, const float* query,
+                           size_t k, size_t ef, const atom_handle_t* exclude, vector_match_t* out) {
+    if (c->max_level < 0 || k == 0) return 0;
+    if (ef == 0) ef = c->config.ef_search;
+    if (ef < k) ef = k;
+    float inv;
+    const float* padded = prepare_query(c, s, query, &inv);
+    uint32_t entry = greedy_descend(c, padded, inv, 0);
+    search_level(c, s, padded, inv, entry, ef, 0, true);
+    return collect_matches(c, s, k, exclude, out);
+}
+
+static vector_class_t* search_class(atomspace_t* space, uint32_t dim) {
+    if (!space) return NULL;
+    vector_index_t* index = (vector_index_t*)space->vector_index;
+    uint32_t number = class_find(index, dim);
+    return number ? index->classes[number - 1] : NULL;
+}
+
+size_t atomspace_vector_search(atomspace_t* space, const float* query, uint32_t dim,
+                               size_t k, size_t ef, vector_match_t* out) {
+    vector_class_t* c = search_class(space, dim);
+    if (!c || !query || !out) return 0;
+    search_scratch_t* s = thread_scratch();
+    uint64_t held = lockprof_rdlock(&c->lock, &vector_read_site);
+    size_t n = class_search(c, s, query, k, ef, NULL, out);
+    lockprof_rwlock_unlock(&c->lock, &vector_read_site, held);
+    return n;
+}
+
+size_t atomspace_vector_similar(atomspace_t* space, atom_handle_t* handle, size_t k, size_t ef,
+                                vector_match_t* out) {
+    if (!space || !handle || !out || k == 0) return 0;
+    vector_index_t* index = (vector_index_t*)space->vector_index;
+    atom_t* atom = handle->atom;
+    uint32_t number = __atomic_load_n(&atom->vector_class, __ATOMIC_ACQUIRE);
+    if (!number) return 0;
+
+    vector_class_t* c = index->classes[number - 1];
+    search_scratch_t* s = thread_scratch();
+    size_t n = 0;
+    uint64_t held = lockprof_rdlock(&c->lock, &vector_read_site);
+    if (atom->vector_class == number) {
+        /* The atom is its own nearest match; widen by one and drop it */
+        size_t wide = ef ? ef : c->config.ef_search;
+        if (wide < k + 1) wide = k + 1;
+        n = class_search(c, s, row_data(c, atom->vector_row), k, wide, handle, out);
+    }
+    lockprof_rwlock_unlock(&c->lock, &vector_read_site, held);
+    return n;
+}
+
+size_t atomspace_vector_search_batch(atomspace_t* space, const float* queries, size_t query_count,
+                                     uint32_t dim, size_t k, size_t ef, vector_match_t* out,
+                                     size_t* counts) {
+    if (counts) memset(counts, 0, query_count * sizeof(size_t));
+    vector_class_t* c = search_class(space, dim);
+    if (!c || !queries || !out || !counts) return 0;
+
+    search_scratch_t* s = thread_scratch();
+    size_t total = 0;
+    uint64_t held = lockprof_rdlock(&c->lock, &vector_read_site);
+    for (size_t q = 0; q < query_count; q++) {
+        if (q + 1 < query_count) __builtin_prefetch(queries + (q + 1) * dim);
+        counts[q] = class_search(c, s, queries + q * dim, k, ef, NULL, out + q * k);
+        total += counts[q];
+    }
+    lockprof_rwlock_unlock(&c->lock, &vector_read_site, held);
+    return total;
+}
+
+size_t atomspace_vector_search_exact(atomspace_t* space, const float* query, uint32_t dim,
+                                     size_t k, vector_match_t* out) {
+    vector_class_t* c = search_class(space, dim);
+    if (!c || !query || !out || k == 0) return 0;
+
+    search_scratch_t* s = thread_scratch();
+    uint64_t held = lockprof_rdlock(&c->lock, &vector_read_site);
+    float inv;
+    const float* padded = prepare_query(c, s, query, &inv);
+    s->results.count = 0;
+    /* Rows stream through in order; only rows that would enter the top k touch their atom */
+    for (uint32_t row = 0; row < c->count; row++) {
+        vector_hit_t hit = { distance_to(c, padded, inv, row), row };
+        if (s->results.count == k && hit.distance >= s->results.items[0].distance) continue;
+        if (!row_live(c, row)) continue;
+        if (s->results.count == k) heap_pop(&s->results, true);
+        heap_push(&s->results, hit, true);
+    }
+    size_t n = collect_matches(c, s, k, NULL, out);
+    lockprof_rwlock_unlock(&c->lock, &vector_read_site, held);
+    return n;
+}
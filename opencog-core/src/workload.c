@@ -0,0 +1,331 @@
+/*
+ * OpenCog Synthetic Workload Generator
+ * Reproducible scale-free knowledge graphs for benchmarks and load tests
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../include/workload.h"
+
+/* Keyword and name used for each atom type in emitted text and type specs */
+static const char* type_keywords[WORKLOAD_TYPE_COUNT] = {
+    "concept", "predicate", "link", "node", "variable", "eval", "exec", "custom",
+    "and", "or", "not", "implies", "equivalent"
+};
+
+static const char* type_names[WORKLOAD_TYPE_COUNT] = {
+    "concept", "predicate", "link", "node", "variable", "evaluation", "execution", "custom",
+    "and", "or", "not", "implication", "equivalence"
+};
+
+/* Generator state shared by the in-memory and text back ends */
+typedef struct {
+    const workload_config_t* config;
+    uint64_t rng;
+    double popularity_exponent;        /* Zipf exponent derived from degree_exponent */
+    double node_type_total;
+    double link_type_total;
+    double arity_total;
+    uint64_t nodes;
+    uint64_t links;
+} generator_t;
+
+/* One generated atom; targets are creation ranks within the node or link sequence */
+typedef struct {
+    bool is_link;
+    atom_type_t type;
+    uint64_t name_rank;
+    size_t arity;
+    uint64_t targets[WORKLOAD_MAX_ARITY];
+    bool target_is_link[WORKLOAD_MAX_ARITY];
+    double strength;
+    double confidence;
+} generated_atom_t;
+
+static uint64_t next_random(generator_t* gen) {
+    uint64_t z = (gen->rng += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static double next_uniform(generator_t* gen) {
+    return (double)(next_random(gen) >> 11) * 0x1.0p-53;
+}
+
+/* Sample a 0-based rank in [0, n) with P(r) ~ (r + 1)^(-exponent), by inverse CDF */
+static uint64_t sample_power_law(generator_t* gen, uint64_t n, double exponent) {
+    double u = next_uniform(gen);
+    double x;
+
+    if (fabs(exponent - 1.0) < 1e-9) {
+        x = pow((double)n + 1.0, u);
+    } else {
+        double e = 1.0 - exponent;
+        x = pow(1.0 + u * (pow((double)n + 1.0, e) - 1.0), 1.0 / e);
+    }
+
+    uint64_t rank = (uint64_t)x;
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+    return rank - 1;
+}
+
+static atom_type_t sample_type(generator_t* gen, bool link) {
+    double total = link ? gen->link_type_total : gen->node_type_total;
+    if (total <= 0.0) return link ? ATOM_TYPE_LINK : ATOM_TYPE_CONCEPT;
+
+    double pick = next_uniform(gen) * total;
+    atom_type_t last = link ? ATOM_TYPE_LINK : ATOM_TYPE_CONCEPT;
+    for (int t = 0; t < WORKLOAD_TYPE_COUNT; t++) {
+        if (workload_is_link_type((atom_type_t)t) != link || gen->config->type_weights[t] <= 0.0) continue;
+        last = (atom_type_t)t;
+        pick -= gen->config->type_weights[t];
+        if (pick < 0.0) break;
+    }
+    return last;
+}
+
+static size_t sample_arity(generator_t* gen) {
+    double pick = next_uniform(gen) * gen->arity_total;
+    size_t last = 2;
+    for (size_t a = 1; a <= WORKLOAD_MAX_ARITY; a++) {
+        if (gen->config->arity_weights[a] <= 0.0) continue;
+        last = a;
+        pick -= gen->config->arity_weights[a];
+        if (pick < 0.0) break;
+    }
+    return last;
+}
+
+static int generator_init(generator_t* gen, const workload_config_t* config) {
+    if (!config || config->degree_exponent <= 1.0 ||
+        config->link_fraction < 0.0 || config->link_fraction >= 1.0 ||
+        config->name_vocabulary == 0) {
+        return -1;
+    }
+
+    memset(gen, 0, sizeof(*gen));
+    gen->config = config;
+    gen->rng = config->seed;
+    gen->popularity_exponent = 1.0 / (config->degree_exponent - 1.0);
+
+    for (int t = 0; t < WORKLOAD_TYPE_COUNT; t++) {
+        if (config->type_weights[t] <= 0.0) continue;
+        if (workload_is_link_type((atom_type_t)t)) {
+            gen->link_type_total += config->type_weights[t];
+        } else {
+            gen->node_type_total += config->type_weights[t];
+        }
+    }
+    for (size_t a = 1; a <= WORKLOAD_MAX_ARITY; a++) {
+        if (config->arity_weights[a] > 0.0) gen->arity_total += config->arity_weights[a];
+    }
+    return gen->arity_total > 0.0 ? 0 : -1;
+}
+
+static void generator_next(generator_t* gen, generated_atom_t* out) {
+    const workload_config_t* config = gen->config;
+
+    /* Links need something to point at, so the stream always starts with a node */
+    out->is_link = gen->nodes > 0 && next_uniform(gen) < config->link_fraction;
+    out->type = sample_type(gen, out->is_link);
+    out->strength = next_uniform(gen);
+    out->confidence = next_uniform(gen);
+    out->arity = 0;
+
+    if (!out->is_link) {
+        out->name_rank = sample_power_law(gen, config->name_vocabulary, config->name_exponent);
+        gen->nodes++;
+        return;
+    }
+
+    out->arity = sample_arity(gen);
+    for (size_t i = 0; i < out->arity; i++) {
+        bool nested = gen->links > 0 && next_uniform(gen) < config->nesting_probability;
+        uint64_t pool = nested ? gen->links : gen->nodes;
+        out->target_is_link[i] = nested;
+        out->targets[i] = sample_power_law(gen, pool, gen->popularity_exponent);
+    }
+    gen->links++;
+}
+
+static void stats_record(workload_stats_t* stats, const generated_atom_t* atom) {
+    if (!stats) return;
+
+    stats->type_counts[atom->type]++;
+    if (!atom->is_link) {
+        stats->nodes++;
+        return;
+    }
+    stats->links++;
+    stats->edges += atom->arity;
+    for (size_t i = 0; i < atom->arity; i++) {
+        stats->nested_edges += atom->target_is_link[i];
+    }
+}
+
+/* Configuration */
+void workload_config_default(workload_config_t* config) {
+    memset(config, 0, sizeof(*config));
+    config->seed = 1;
+    config->atom_count = 1000000;
+    config->link_fraction = 0.6;
+    config->degree_exponent = 2.1;
+    config->arity_weights[2] = 0.6;
+    config->arity_weights[3] = 0.3;
+    config->arity_weights[4] = 0.1;
+    config->nesting_probability = 0.2;
+    config->name_vocabulary = 100000;
+    config->name_exponent = 1.0;
+    config->type_weights[ATOM_TYPE_CONCEPT] = 0.6;
+    config->type_weights[ATOM_TYPE_PREDICATE] = 0.25;
+    config->type_weights[ATOM_TYPE_NODE] = 0.1;
+    config->type_weights[ATOM_TYPE_VARIABLE] = 0.05;
+    config->type_weights[ATOM_TYPE_LINK] = 0.3;
+    config->type_weights[ATOM_TYPE_EVALUATION] = 0.6;
+    config->type_weights[ATOM_TYPE_EXECUTION] = 0.1;
+    config->name_prefix = "entity";
+}
+
+int workload_parse_arity(workload_config_t* config, const char* spec) {
+    double weights[WORKLOAD_MAX_ARITY + 1] = {0};
+    const char* p = spec;
+
+    while (p && *p) {
+        char* end;
+        long arity = strtol(p, &end, 10);
+        if (end == p || *end != ':' || arity < 1 || arity > WORKLOAD_MAX_ARITY) return -1;
+        p = end + 1;
+        double weight = strtod(p, &end);
+        if (end == p || weight < 0.0) return -1;
+        weights[arity] = weight;
+        p = (*end == ',') ? end + 1 : end;
+        if (*end && *end != ',') return -1;
+    }
+
+    memcpy(config->arity_weights, weights, sizeof(weights));
+    return 0;
+}
+
+int workload_parse_types(workload_config_t* config, const char* spec) {
+    double weights[WORKLOAD_TYPE_COUNT] = {0};
+    const char* p = spec;
+
+    while (p && *p) {
+        const char* colon = strchr(p, ':');
+        if (!colon) return -1;
+
+        int type = -1;
+        size_t len = (size_t)(colon - p);
+        for (int t = 0; t < WORKLOAD_TYPE_COUNT; t++) {
+            if ((strlen(type_names[t]) == len && strncmp(type_names[t], p, len) == 0) ||
+                (strlen(type_keywords[t]) == len && strncmp(type_keywords[t], p, len) == 0)) {
+                type = t;
+                break;
+            }
+        }
+        if (type < 0) return -1;
+
+        char* end;
+        double weight = strtod(colon + 1, &end);
+        if (end == colon + 1 || weight < 0.0 || (*end && *end != ',')) return -1;
+        weights[type] = weight;
+        p = (*end == ',') ? end + 1 : end;
+    }
+
+    memcpy(config->type_weights, weights, sizeof(weights));
+    return 0;
+}
+
+bool workload_is_link_type(atom_type_t type) {
+    return atom_type_valid(type) && atom_type_is_a(type, ATOM_TYPE_LINK);
+}
+
+/* In-memory back end */
+int workload_generate(atomspace_t* space, const workload_config_t* config, workload_stats_t* stats) {
+    generator_t gen;
+    if (!space || generator_init(&gen, config) != 0) return -1;
+    if (stats) memset(stats, 0, sizeof(*stats));
+
+    const char* prefix = config->name_prefix ? config->name_prefix : "entity";
+    size_t node_capacity = 1024;
+    size_t link_capacity = 1024;
+    atom_handle_t** nodes = malloc(sizeof(atom_handle_t*) * node_capacity);
+    atom_handle_t** links = malloc(sizeof(atom_handle_t*) * link_capacity);
+    char name[128];
+    int status = 0;
+
+    for (uint64_t i = 0; i < config->atom_count; i++) {
+        generated_atom_t atom;
+        generator_next(&gen, &atom);
+        atom_handle_t* handle;
+
+        if (atom.is_link) {
+            atom_handle_t* outgoing[WORKLOAD_MAX_ARITY];
+            for (size_t k = 0; k < atom.arity; k++) {
+                outgoing[k] = atom.target_is_link[k] ? links[atom.targets[k]] : nodes[atom.targets[k]];
+            }
+            handle = atom_create_link(space, atom.type, outgoing, atom.arity);
+            if (gen.links > link_capacity) {
+                link_capacity *= 2;
+                links = realloc(links, sizeof(atom_handle_t*) * link_capacity);
+            }
+            links[gen.links - 1] = handle;
+        } else {
+            snprintf(name, sizeof(name), "%s_%llu", prefix, (unsigned long long)atom.name_rank);
+            handle = atom_create(space, atom.type, name);
+            if (gen.nodes > node_capacity) {
+                node_capacity *= 2;
+                nodes = realloc(nodes, sizeof(atom_handle_t*) * node_capacity);
+            }
+            nodes[gen.nodes - 1] = handle;
+        }
+
+        if (!handle) {
+            status = -1;
+            break;
+        }
+        atom_set_tv(handle, atom.strength, atom.confidence);
+        stats_record(stats, &atom);
+    }
+
+    free(nodes);
+    free(links);
+    return status;
+}
+
+/* Text back end */
+int workload_emit_text(FILE* out, const workload_config_t* config, workload_stats_t* stats) {
+    generator_t gen;
+    if (!out || generator_init(&gen, config) != 0) return -1;
+    if (stats) memset(stats, 0, sizeof(*stats));
+
+    const char* prefix = config->name_prefix ? config->name_prefix : "entity";
+    fprintf(out, "# OpenCog synthetic workload: seed=%llu atoms=%llu links=%.3f exponent=%.3f\n",
+            (unsigned long long)config->seed, (unsigned long long)config->atom_count,
+            config->link_fraction, config->degree_exponent);
+
+    for (uint64_t i = 0; i < config->atom_count; i++) {
+        generated_atom_t atom;
+        generator_next(&gen, &atom);
+
+        if (atom.is_link) {
+            fprintf(out, "%s l%llu (", type_keywords[atom.type], (unsigned long long)(gen.links - 1));
+            for (size_t k = 0; k < atom.arity; k++) {
+                fprintf(out, "%s%c%llu", k ? ", " : "", atom.target_is_link[k] ? 'l' : 'n',
+                        (unsigned long long)atom.targets[k]);
+            }
+            fputc(')', out);
+        } else {
+            fprintf(out, "%s n%llu \"%s_%llu\"", type_keywords[atom.type],
+                    (unsigned long long)(gen.nodes - 1), prefix, (unsigned long long)atom.name_rank);
+        }
+        fprintf(out, " [truth: %.4f, %.4f];\n", atom.strength, atom.confidence);
+        stats_record(stats, &atom);
+    }
+
+    return ferror(out) ? -1 : 0;
+}
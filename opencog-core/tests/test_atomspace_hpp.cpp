@@ -0,0 +1,221 @@
+/*
+ * OpenCog C++ API Test Suite
+ * Tests for the header-only RAII layer (atomspace.hpp)
+ */
+
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "../include/atomspace.hpp"
+#include "../include/where.hpp"
+#include "../include/epoch.h"
+
+using namespace opencog;
+
+/* Test counters */
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) \
+    printf("Running test: %s...", #name); \
+    if (test_##name()) { \
+        printf(" PASSED\n"); \
+        tests_passed++; \
+    } else { \
+        printf(" FAILED\n"); \
+        tests_failed++; \
+    }
+
+/* Handles cost what the C API's pointers cost */
+static_assert(sizeof(Atom) == sizeof(atom_handle_t*), "Atom is one pointer");
+static_assert(sizeof(AtomRef) == sizeof(atom_handle_t*), "AtomRef is one pointer");
+static_assert(std::is_trivially_copyable<Atom>::value, "Atom is passed in registers");
+static_assert(!std::is_copy_constructible<AtomRef>::value, "AtomRef is move-only");
+static_assert(std::is_nothrow_move_constructible<AtomRef>::value, "AtomRef moves without retaining");
+
+int test_create_and_access() {
+    AtomSpace space(2);
+    Atom cat = space.add_node(ATOM_TYPE_CONCEPT, "cat");
+    Atom animal = space.add_node(ATOM_TYPE_CONCEPT, std::string("animal"));
+    Atom link = space.add_link(ATOM_TYPE_LINK, { cat, animal });
+    cat.set_tv(0.8, 0.9);
+
+    int ok = cat && cat.name() == "cat" && cat.type() == ATOM_TYPE_CONCEPT;
+    ok = ok && cat.tv().strength == 0.8 && space.find(cat.id()) == cat;
+    ok = ok && link.arity() == 2 && link.outgoing()[1] == animal && link.name().empty();
+
+    std::vector<Atom> targets(link.outgoing().begin(), link.outgoing().end());
+    ok = ok && targets.size() == 2 && targets[0] == cat;
+    
+    /* Span iterators take the full set of random access operators */
+    AtomSpan out = link.outgoing();
+    AtomSpan::iterator it = out.end();
+    it--;
+    ok = ok && out.end() > out.begin() && out.begin() <= it && it >= out.begin() && !(it > out.end());
+    ok = ok && *it == animal && *(1 + out.begin()) == animal && *(out.end() - 2) == cat &&
+         (it -= 1) == out.begin();
+
+    /* Long outgoing sets go through the heap path */
+    std::vector<Atom> many(20, animal);
+    ok = ok && space.add_link(ATOM_TYPE_LINK, many).arity() == 20;
+    ok = ok && space.size() == 4;
+    return ok;
+}
+
+int test_atomref_ownership() {
+    AtomSpace space;
+    Atom dog = space.add_node(ATOM_TYPE_CONCEPT, "dog");
+    uint32_t base = dog.handle()->ref_count;
+
+    AtomRef ref = AtomRef::retain(dog);
+    int ok = dog.handle()->ref_count == base + 1;
+
+    /* Moves hand the reference over; the count does not change */
+    AtomRef moved = std::move(ref);
+    std::vector<AtomRef> refs;
+    refs.push_back(std::move(moved));
+    ok = ok && !ref && !moved && dog.handle()->ref_count == base + 1;
+
+    AtomRef copy = refs[0].clone();
+    ok = ok && dog.handle()->ref_count == base + 2 && copy->name() == "dog";
+    copy.reset();
+    ok = ok && dog.handle()->ref_count == base + 1;
+
+    /* A held reference outlives removal from the space */
+    ok = ok && space.remove(dog);
+    epoch_synchronize();
+    ok = ok && refs[0]->name() == "dog";
+    refs.clear();
+
+    /* adopt() takes over the references of retaining C queries */
+    Atom cat = space.add_node(ATOM_TYPE_CONCEPT, "cat");
+    size_t count = 0;
+    atom_handle_t** results = atomspace_get_atoms_by_name(space.get(), "cat", &count);
+    {
+        AtomRef adopted = AtomRef::adopt(results[0]);
+        ok = ok && count == 1 && cat.handle()->ref_count == base + 1;
+    }
+    free(results);
+    ok = ok && cat.handle()->ref_count == base;
+    return ok;
+}
+
+int test_typed_queries() {
+    AtomSpace space;
+    std::vector<Atom> nodes;
+    for (int i = 0; i < 100; i++) {
+        atom_type_t type = i % 4 == 0 ? ATOM_TYPE_PREDICATE : ATOM_TYPE_CONCEPT;
+        nodes.push_back(space.add_node(type, "n" + std::to_string(i % 10)));
+        nodes.back().set_tv(i / 100.0, 0.5);
+    }
+    space.remove(nodes[1]);
+
+    ReadSection read(space);
+    QueryResult concepts = space.by_type(read, ATOM_TYPE_CONCEPT);
+    int ok = concepts.size() == 74;
+    ok = ok && space.by_name(read, "n4").size() == 10;
+
+    QueryResult moved = std::move(concepts);
+    ok = ok && concepts.empty() && moved.size() == 74;
+
+    size_t strong = space.count_if(read, [](Atom a) { return a.tv().strength >= 0.5; });
+    ok = ok && strong == 50;
+
+    size_t seen = 0;
+    for (Atom a : space.match(read, [](Atom a) { return a.type() == ATOM_TYPE_PREDICATE; })) {
+        ok = ok && a.type() == ATOM_TYPE_PREDICATE;
+        seen++;
+    }
+    ok = ok && seen == 25;
+
+    size_t all = 0;
+    space.for_each(read, [&](Atom) { all++; });
+    ok = ok && all == 99 && std::distance(space.atoms(read).begin(), space.atoms(read).end()) == 99;
+    return ok;
+}
+
+int test_snapshot_queries() {
+    AtomSpace space;
+    Atom a = space.add_node(ATOM_TYPE_CONCEPT, "a");
+    Atom b = space.add_node(ATOM_TYPE_CONCEPT, "b");
+    a.set_tv(0.5, 0.5);
+
+    int ok = 1;
+    {
+        Snapshot snapshot(space);
+        space.add_node(ATOM_TYPE_CONCEPT, "c");
+        space.remove(b);
+        a.set_tv(0.9, 0.9);
+
+        ok = ok && snapshot.by_type(ATOM_TYPE_CONCEPT).size() == 2;
+        ok = ok && snapshot.atoms().count() == 2;
+        ok = ok && snapshot.count_if([&](Atom x) { return snapshot.tv(x).strength == 0.5; }) == 1;
+        ok = ok && snapshot.by_name("c").empty();
+
+        ReadSection read(space);
+        ok = ok && space.atoms(read).count() == 2 && space.by_name(read, "b").empty();
+    }
+    epoch_synchronize();
+    ok = ok && epoch_pending() == 0;
+    return ok;
+}
+
+int test_where_filters() {
+    AtomSpace space;
+    std::vector<Atom> nodes;
+    for (int i = 0; i < 40; i++) {
+        atom_type_t type = i % 2 ? ATOM_TYPE_PREDICATE : ATOM_TYPE_CONCEPT;
+        nodes.push_back(space.add_node(type, (i < 20 ? "cat" : "dog") + std::to_string(i % 5)));
+        nodes.back().set_tv(i / 40.0, 0.9);
+        nodes.back().set_av(static_cast<int16_t>(i), 0, 0);
+    }
+    for (int i = 0; i < 10; i++) space.add_link(ATOM_TYPE_LINK, { nodes[i], nodes[i + 1] });
+    space.add_link(ATOM_TYPE_EVALUATION, { nodes[0], nodes[1], nodes[2] });
+
+    /* And<> runs the cheaper filter first whatever the written order */
+    static_assert(decltype(where::name("x") && where::type<ATOM_TYPE_LINK>())::cost == where::COST_NAME, "");
+
+    ReadSection read(space);
+    int ok = space.count_if(read, where::type<ATOM_TYPE_LINK>() && where::arity(2)) == 10;
+    ok = ok && space.count_if(read, where::types({ ATOM_TYPE_LINK, ATOM_TYPE_EVALUATION })) == 11;
+    ok = ok && space.count_if(read, where::is_a(ATOM_TYPE_LINK)) == 11 &&
+         space.by_types(read, atom_type_subtypes(ATOM_TYPE_NODE)).size() == 40;
+    ok = ok && space.count_if(read, where::name("cat3") && where::type(ATOM_TYPE_PREDICATE)) == 2;
+    ok = ok && space.count_if(read, where::name_prefix("dog")) == 20;
+    ok = ok && space.count_if(read, where::type<ATOM_TYPE_CONCEPT>() && where::tv_at_least(0.5)) == 10;
+    ok = ok && space.count_if(read, where::tv_at_least(0.0, 0.95)) == 0;
+    ok = ok && space.count_if(read, where::sti_at_least(30) || where::arity(3)) == 11;
+    ok = ok && space.count_if(read, !where::type<ATOM_TYPE_LINK>() &&
+                                    where::atom_if([](Atom a) { return !a.name().empty() && a.name().back() == '0'; })) == 8;
+
+    auto strong_nodes = where::arity(0) && where::tv_at_least(0.9);
+    QueryResult strong = space.match(read, strong_nodes).collect();
+    ok = ok && strong.size() == 4 && strong[0] == nodes[36];
+
+    /* Value filters read the snapshot's version, not the latest values */
+    Snapshot snapshot(space);
+    for (Atom a : nodes) a.set_tv(1.0, 1.0);
+    ok = ok && snapshot.count_if(strong_nodes) == 4;
+    ok = ok && space.count_if(read, strong_nodes) == 40;
+    return ok;
+}
+
+int main() {
+    printf("OpenCog C++ API Test Suite\n");
+    printf("==========================\n\n");
+
+    TEST(create_and_access);
+    TEST(atomref_ownership);
+    TEST(typed_queries);
+    TEST(snapshot_queries);
+    TEST(where_filters);
+
+    printf("\n");
+    printf("==========================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("Total tests:  %d\n", tests_passed + tests_failed);
+
+    return (tests_failed == 0) ? 0 : 1;
+}
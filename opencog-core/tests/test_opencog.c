@@ -6,9 +6,30 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <assert.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
 #include "../include/atom.h"
 #include "../include/distributed.h"
+#include "../include/workload.h"
+#include "../include/stats.h"
+#include "../include/lockprof.h"
+#include "../include/trace.h"
+#include "../include/memstats.h"
+#include "../include/epoch.h"
+#include "../include/mvcc.h"
+#include "../include/changefeed.h"
+#include "../include/vector.h"
+#include "../include/nameindex.h"
+#include "../include/csr.h"
+#include "../include/graph.h"
+#include "../include/timeindex.h"
+#include "../include/querycache.h"
+#include "../include/server.h"
+#include "../include/client.h"
 
 /* Test counters */
 static int tests_passed = 0;
@@ -186,6 +207,1593 @@ int test_atom_query_by_name() {
     return 1;
 }
 
+typedef struct {
+    atomspace_t* space;
+    atom_handle_t** handles;
+    size_t count;
+} id_worker_t;
+
+static void* create_atoms_worker(void* arg) {
+    id_worker_t* worker = (id_worker_t*)arg;
+    for (size_t i = 0; i < worker->count; i++) {
+        worker->handles[i] = atom_create(worker->space, ATOM_TYPE_CONCEPT, "Parallel");
+    }
+    return NULL;
+}
+
+static int compare_ids(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+int test_atom_ids() {
+    if (atomspace_create(ATOM_ID_MAX_NODE + 1) != NULL) return 0;
+    
+    atomspace_t* space = atomspace_create(7);
+    if (!space) return 0;
+    
+    enum { THREADS = 4, PER_THREAD = 3000 };
+    atom_handle_t** handles = malloc(sizeof(atom_handle_t*) * THREADS * PER_THREAD);
+    pthread_t threads[THREADS];
+    id_worker_t workers[THREADS];
+    for (int t = 0; t < THREADS; t++) {
+        workers[t].space = space;
+        workers[t].handles = handles + t * PER_THREAD;
+        workers[t].count = PER_THREAD;
+        pthread_create(&threads[t], NULL, create_atoms_worker, &workers[t]);
+    }
+    for (int t = 0; t < THREADS; t++) pthread_join(threads[t], NULL);
+    
+    /* Every ID carries the node and is unique; every atom is indexed */
+    uint64_t* ids = malloc(sizeof(uint64_t) * THREADS * PER_THREAD);
+    int ok = space->atom_count == THREADS * PER_THREAD;
+    for (size_t i = 0; i < THREADS * PER_THREAD; i++) {
+        ids[i] = handles[i]->id;
+        ok = ok && ATOM_ID_NODE(ids[i]) == 7 && ATOM_ID_SEQUENCE(ids[i]) != 0 &&
+             atomspace_get_atom(space, ids[i]) == handles[i];
+    }
+    qsort(ids, THREADS * PER_THREAD, sizeof(uint64_t), compare_ids);
+    for (size_t i = 1; i < THREADS * PER_THREAD; i++) {
+        ok = ok && ids[i] != ids[i - 1];
+    }
+    
+    free(ids);
+    free(handles);
+    atomspace_destroy(space);
+    return ok;
+}
+
+int test_borrowed_queries() {
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t* a = atom_create(space, ATOM_TYPE_CONCEPT, "a");
+    atom_handle_t* b = atom_create(space, ATOM_TYPE_CONCEPT, "b");
+    atom_handle_t* pair[] = { a, b };
+    atom_handle_t* link = atom_create_link(space, ATOM_TYPE_LINK, pair, 2);
+    
+    /* Borrowed results leave reference counts untouched */
+    size_t count = 0;
+    atomspace_read_begin(space);
+    atom_handle_t** results = atomspace_get_atoms_by_type_borrowed(space, ATOM_TYPE_CONCEPT, &count);
+    int ok = count == 2 && a->ref_count == 2 && b->ref_count == 2;
+    free(results);
+    results = atomspace_get_atoms_by_name_borrowed(space, "b", &count);
+    ok = ok && count == 1 && results[0] == b;
+    free(results);
+    
+    /* Targets of a live link cannot be removed; a removed atom outlives the read section */
+    ok = ok && atomspace_remove_atom(space, a) == -1;
+    atom_retain(link);
+    ok = ok && atomspace_remove_atom(space, link) == 0;
+    ok = ok && atomspace_remove_atom(space, link) == -1;
+    ok = ok && a->atom->incoming_count == 0 && atomspace_get_atom(space, link->id) == NULL;
+    epoch_synchronize();
+    ok = ok && epoch_pending() == 1 && link->ref_count == 2;
+    atomspace_read_end(space);
+    
+    epoch_synchronize();
+    ok = ok && epoch_pending() == 0 && link->ref_count == 1;
+    atom_release(link);
+    
+    results = atomspace_get_atoms_by_type_borrowed(space, ATOM_TYPE_LINK, &count);
+    ok = ok && count == 0 && space->total_atoms_deleted == 1;
+    free(results);
+    
+    atomspace_memory_t mem;
+    atomspace_memory_usage(space, &mem, 0);
+    ok = ok && mem.categories[MEMORY_ATOMS].count == 2 && mem.categories[MEMORY_OUTGOING].count == 0;
+    
+    atomspace_destroy(space);
+    return ok;
+}
+
+int test_deep_release() {
+    /* A chain deep enough to overflow the stack if released recursively */
+    enum { DEPTH = 1000000 };
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t* tail = atom_create(space, ATOM_TYPE_CONCEPT, "root");
+    for (int i = 0; i < DEPTH; i++) {
+        tail = atom_create_link(space, ATOM_TYPE_LINK, &tail, 1);
+    }
+    
+    /* An outside reference keeps the chain alive past the space */
+    atom_retain(tail);
+    atomspace_destroy(space);
+    int ok = tail->ref_count == 1 && tail->atom->outgoing_count == 1;
+    atom_release(tail);
+    
+    /* Without outside references destroy frees everything directly */
+    space = atomspace_create(1);
+    atom_handle_t* a = atom_create(space, ATOM_TYPE_CONCEPT, "a");
+    atom_handle_t* pair[] = { a, a };
+    atom_create_link(space, ATOM_TYPE_LINK, pair, 2);
+    ok = ok && a->ref_count == 3 && a->atom->incoming_count == 2;
+    atomspace_destroy(space);
+    return ok;
+}
+
+int test_snapshot_isolation() {
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t* a = atom_create(space, ATOM_TYPE_CONCEPT, "a");
+    atom_handle_t* b = atom_create(space, ATOM_TYPE_CONCEPT, "b");
+    atom_set_tv(a, 0.5, 0.5);
+    
+    atomspace_snapshot_t* snapshot = atomspace_snapshot_begin(space);
+    
+    /* Changes after the snapshot: a new atom, a removal and two TV updates */
+    atom_create(space, ATOM_TYPE_CONCEPT, "c");
+    atomspace_remove_atom(space, b);
+    atom_set_tv(a, 0.7, 0.7);
+    atom_set_tv(a, 0.9, 0.9);
+    
+    size_t count = 0;
+    atom_handle_t** results = atomspace_snapshot_get_atoms_by_type(snapshot, ATOM_TYPE_CONCEPT, &count);
+    int ok = count == 2 && results[0] == a && results[1] == b;
+    free(results);
+    ok = ok && atomspace_snapshot_get_tv(snapshot, a).strength == 0.5;
+    ok = ok && atom_get_tv(a).strength == 0.9;
+    
+    /* Latest queries see the new state */
+    results = atomspace_get_atoms_by_type_borrowed(space, ATOM_TYPE_CONCEPT, &count);
+    ok = ok && count == 2 && results[0] == a && results[1] != b;
+    free(results);
+    
+    atomspace_memory_t mem;
+    atomspace_memory_usage(space, &mem, 0);
+    ok = ok && mem.categories[MEMORY_VERSIONS].count == 2;
+    atomspace_snapshot_end(snapshot);
+    
+    /* Once the snapshot is gone its history and the removed atom are freed */
+    epoch_synchronize();
+    atomspace_memory_usage(space, &mem, 0);
+    ok = ok && mem.categories[MEMORY_VERSIONS].count <= 1 && epoch_pending() == 0;
+    
+    atomspace_destroy(space);
+    return ok;
+}
+
+typedef struct {
+    atomspace_t* space;
+    size_t count;
+} ingest_arg_t;
+
+static void* snapshot_ingest_worker(void* arg) {
+    ingest_arg_t* ingest = (ingest_arg_t*)arg;
+    for (size_t i = 0; i < ingest->count; i++) {
+        atom_handle_t* atom = atom_create(ingest->space, ATOM_TYPE_CONCEPT, "ingest");
+        atom_set_tv(atom, 0.5, 0.5);
+    }
+    return NULL;
+}
+
+int test_snapshot_concurrent() {
+    atomspace_t* space = atomspace_create(1);
+    ingest_arg_t ingest = { space, 50000 };
+    pthread_t writer;
+    pthread_create(&writer, NULL, snapshot_ingest_worker, &ingest);
+    
+    /* Scans race with array growth; each must see a stable prefix */
+    int ok = 1;
+    size_t previous = 0;
+    for (int round = 0; round < 200; round++) {
+        atomspace_snapshot_t* snapshot = atomspace_snapshot_begin(space);
+        size_t first = 0, second = 0;
+        atom_handle_t** results = atomspace_snapshot_get_atoms_by_type(snapshot, ATOM_TYPE_CONCEPT, &first);
+        free(results);
+        results = atomspace_snapshot_get_atoms_by_type(snapshot, ATOM_TYPE_CONCEPT, &second);
+        for (size_t i = 0; i < second; i++) {
+            ok = ok && results[i]->atom->create_version <= snapshot->version;
+        }
+        free(results);
+        ok = ok && first == second && second >= previous;
+        previous = second;
+        atomspace_snapshot_end(snapshot);
+        
+        /* Memory reports race with the same growth */
+        atomspace_memory_t mem;
+        ok = ok && atomspace_memory_usage(space, &mem, 0) == 0 && mem.categories[MEMORY_ATOM_INDEX].count >= 1;
+    }
+    
+    pthread_join(writer, NULL);
+    ok = ok && space->atom_count == ingest.count;
+    atomspace_destroy(space);
+    return ok;
+}
+
+typedef struct {
+    atomspace_t* space;
+    int done;
+    size_t seen;
+} remove_scan_arg_t;
+
+/* Touch every atom a reader can reach; freed atoms show up under ASan */
+static void* remove_scan_worker(void* arg) {
+    remove_scan_arg_t* scan = (remove_scan_arg_t*)arg;
+    atom_handle_t* out[64];
+    while (!__atomic_load_n(&scan->done, __ATOMIC_ACQUIRE)) {
+        atomspace_read_begin(scan->space);
+        size_t count = 0;
+        atom_handle_t* const* slots = atomspace_scan_slots(scan->space, &count);
+        for (size_t i = 0; i < count; i++) {
+            atom_handle_t* handle = slots[i];
+            if (handle && atom_visible_at(handle->atom, MVCC_LATEST)) scan->seen += handle->atom->type;
+        }
+        size_t named = atomspace_name_prefix(scan->space, "r", out, 64);
+        for (size_t i = 0; i < named; i++) scan->seen += out[i]->atom->name[0] == 'r';
+        uint64_t cursor = 0;
+        size_t changed = atomspace_changes_since(scan->space, &cursor, out, 64);
+        for (size_t i = 0; i < changed; i++) scan->seen += out[i]->atom->outgoing_count;
+        atomspace_read_end(scan->space);
+    }
+    return NULL;
+}
+
+int test_remove_concurrent() {
+    enum { ATOMS = 20000, READERS = 3 };
+    atomspace_t* space = atomspace_create(1);
+    static atom_handle_t* atoms[ATOMS];
+    char name[32];
+    for (int i = 0; i < ATOMS; i++) {
+        snprintf(name, sizeof(name), "r%d", i);
+        atoms[i] = atom_create(space, ATOM_TYPE_CONCEPT, name);
+    }
+    
+    /* Removals race with slot, name and change log scans */
+    remove_scan_arg_t scans[READERS];
+    pthread_t readers[READERS];
+    for (int t = 0; t < READERS; t++) {
+        scans[t] = (remove_scan_arg_t){ space, 0, 0 };
+        pthread_create(&readers[t], NULL, remove_scan_worker, &scans[t]);
+    }
+    int ok = 1;
+    for (int i = 0; i < ATOMS; i++) {
+        ok = ok && atomspace_remove_atom(space, atoms[i]) == 0;
+        if (i % 256 == 0) epoch_reclaim();
+    }
+    for (int t = 0; t < READERS; t++) {
+        __atomic_store_n(&scans[t].done, 1, __ATOMIC_RELEASE);
+        pthread_join(readers[t], NULL);
+    }
+    
+    epoch_synchronize();
+    size_t count = 0;
+    atom_handle_t** results = atomspace_get_atoms_by_type_borrowed(space, ATOM_TYPE_CONCEPT, &count);
+    ok = ok && count == 0 && epoch_pending() == 0 && space->total_atoms_deleted == ATOMS;
+    free(results);
+    atomspace_destroy(space);
+    return ok;
+}
+
+int test_transactions() {
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t* existing = atom_create(space, ATOM_TYPE_CONCEPT, "existing");
+    atomspace_snapshot_t* before = atomspace_snapshot_begin(space);
+    
+    /* Stage two nodes, a link over them and the existing atom, and TVs */
+    atomspace_txn_t* txn = atomspace_txn_begin(space);
+    atom_handle_t* a = atomspace_txn_create(txn, ATOM_TYPE_CONCEPT, "a");
+    atom_handle_t* b = atomspace_txn_create(txn, ATOM_TYPE_CONCEPT, "b");
+    atom_handle_t* outgoing[] = { a, b, existing };
+    atom_handle_t* link = atomspace_txn_create_link(txn, ATOM_TYPE_LINK, outgoing, 3);
+    atomspace_txn_set_tv(txn, a, 0.3, 0.3);
+    atomspace_txn_set_tv(txn, existing, 0.6, 0.6);
+    
+    /* Nothing is visible before commit */
+    int ok = space->atom_count == 1 && atomspace_get_atom(space, a->id) == NULL &&
+             atom_get_tv(existing).strength == 1.0;
+    ok = ok && atomspace_txn_commit(txn) == 0;
+    
+    size_t count = 0;
+    atom_handle_t** results = atomspace_get_atoms_by_type_borrowed(space, ATOM_TYPE_CONCEPT, &count);
+    ok = ok && count == 3 && atomspace_get_atom(space, link->id) == link;
+    free(results);
+    ok = ok && atom_get_tv(a).strength == 0.3 && atom_get_tv(existing).strength == 0.6;
+    ok = ok && existing->atom->incoming_count == 1 && a->atom->incoming[0] == link;
+    ok = ok && a->atom->create_version == link->atom->create_version &&
+               a->atom->create_version == existing->atom->value_version;
+    
+    /* The older snapshot sees none of it */
+    results = atomspace_snapshot_get_atoms_by_type(before, ATOM_TYPE_CONCEPT, &count);
+    ok = ok && count == 1 && results[0] == existing;
+    free(results);
+    ok = ok && atomspace_snapshot_get_tv(before, existing).strength == 1.0;
+    atomspace_snapshot_end(before);
+    epoch_synchronize();
+    
+    /* Abort drops staged atoms and their references */
+    atomspace_memory_t mem;
+    atomspace_memory_usage(space, &mem, 0);
+    uint64_t names = mem.categories[MEMORY_NAMES].count;
+    txn = atomspace_txn_begin(space);
+    atom_handle_t* c = atomspace_txn_create(txn, ATOM_TYPE_CONCEPT, "c");
+    atom_handle_t* pair[] = { c, existing };
+    atomspace_txn_create_link(txn, ATOM_TYPE_LINK, pair, 2);
+    atomspace_txn_set_tv(txn, existing, 0.1, 0.1);
+    atomspace_txn_abort(txn);
+    atomspace_memory_usage(space, &mem, 0);
+    ok = ok && space->atom_count == 4 && existing->ref_count == 2 &&
+         atom_get_tv(existing).strength == 0.6 && mem.categories[MEMORY_NAMES].count == names;
+    
+    atomspace_destroy(space);
+    return ok;
+}
+
+typedef struct {
+    atomspace_t* space;
+    atom_handle_t* atoms[3];
+    int seed;
+} value_writer_arg_t;
+
+/* Single writes to atoms[0], or transactions giving atoms[1] and [2] one value */
+static void* value_writer(void* arg) {
+    value_writer_arg_t* writer = (value_writer_arg_t*)arg;
+    for (int i = 1; i <= 20000; i++) {
+        double value = (double)(writer->seed * 100000 + i) / 1e7;
+        if (writer->seed < 2) {
+            atom_set_tv(writer->atoms[0], value, value);
+            continue;
+        }
+        atomspace_txn_t* txn = atomspace_txn_begin(writer->space);
+        atomspace_txn_set_tv(txn, writer->atoms[2], value, value);
+        atomspace_txn_set_tv(txn, writer->atoms[1], value, value);
+        atomspace_txn_commit(txn);
+    }
+    return NULL;
+}
+
+int test_value_writers() {
+    atomspace_t* space = atomspace_create(1);
+    value_writer_arg_t args[3];
+    pthread_t writers[3];
+    atom_handle_t* a = atom_create(space, ATOM_TYPE_CONCEPT, "a");
+    atom_handle_t* b = atom_create(space, ATOM_TYPE_CONCEPT, "b");
+    atom_handle_t* c = atom_create(space, ATOM_TYPE_CONCEPT, "c");
+    atom_set_tv(a, 0, 0);
+    for (int t = 0; t < 3; t++) {
+        args[t] = (value_writer_arg_t){ space, { a, b, c }, t };
+        pthread_create(&writers[t], NULL, value_writer, &args[t]);
+    }
+    
+    /* Versions only rise; snapshots see whole pairs and whole transactions, twice over */
+    int ok = 1;
+    uint64_t last = 0;
+    truth_value_t tv, again;
+    attention_value_t av;
+    for (int round = 0; round < 2000000; round++) {
+        uint64_t version = atom_read_values_at(a->atom, MVCC_LATEST, &tv, &av);
+        ok = ok && version >= last && tv.strength == tv.confidence;
+        last = version;
+        if (round % 64) continue;
+        
+        atomspace_snapshot_t* snapshot = atomspace_snapshot_begin(space);
+        ok = ok && atom_read_values_at(a->atom, snapshot->version, &tv, &av) <= snapshot->version;
+        truth_value_t first = atomspace_snapshot_get_tv(snapshot, b);
+        sched_yield();
+        again = atomspace_snapshot_get_tv(snapshot, a);
+        ok = ok && again.strength == tv.strength;
+        again = atomspace_snapshot_get_tv(snapshot, c);
+        ok = ok && again.strength == first.strength && again.confidence == first.confidence;
+        atomspace_snapshot_end(snapshot);
+    }
+    for (int t = 0; t < 3; t++) pthread_join(writers[t], NULL);
+    
+    /* With every writer done, the horizon covers all writes and history can go */
+    epoch_synchronize();
+    atomspace_memory_t mem;
+    atomspace_memory_usage(space, &mem, 0);
+    ok = ok && mvcc_horizon() >= a->atom->value_version && mem.categories[MEMORY_VERSIONS].count <= 3;
+    atomspace_destroy(space);
+    return ok;
+}
+
+int test_batch_create() {
+    atomspace_t* space = atomspace_create(3);
+    const char* names[] = { "a", "b", NULL, "d" };
+    atom_handle_t* nodes[4];
+    int ok = atom_create_batch(space, ATOM_TYPE_CONCEPT, names, 4, nodes) == 4;
+    ok = ok && atom_create_batch(space, ATOM_TYPE_CONCEPT, names, 0, nodes) == 0;
+    
+    /* IDs are consecutive within the batch and every atom is indexed */
+    for (size_t i = 0; i < 4; i++) {
+        ok = ok && ATOM_ID_NODE(nodes[i]->id) == 3 && nodes[i]->id == nodes[0]->id + i &&
+             atomspace_get_atom(space, nodes[i]->id) == nodes[i];
+    }
+    ok = ok && strcmp(nodes[3]->atom->name, "d") == 0 && nodes[2]->atom->name == NULL;
+    
+    /* Two links: (a b) and (d), plus an empty one */
+    atom_handle_t* outgoing[] = { nodes[0], nodes[1], nodes[3] };
+    size_t arities[] = { 2, 1, 0 };
+    atom_handle_t* links[3];
+    ok = ok && atom_create_link_batch(space, ATOM_TYPE_LINK, outgoing, arities, 3, links) == 3;
+    ok = ok && links[0]->atom->outgoing_count == 2 && links[1]->atom->outgoing[0] == nodes[3] &&
+         links[2]->atom->outgoing == NULL && nodes[0]->ref_count == 2 &&
+         nodes[3]->atom->incoming[0] == links[1];
+    
+    atomspace_memory_t mem;
+    atomspace_memory_usage(space, &mem, 0);
+    ok = ok && mem.categories[MEMORY_ATOMS].count == 7 && mem.categories[MEMORY_NAMES].count == 3 &&
+         mem.categories[MEMORY_NAMES].requested == 6 && mem.categories[MEMORY_OUTGOING].count == 2;
+    
+    /* Atoms of a batch are freed one by one; an outside reference keeps its chunk */
+    ok = ok && atomspace_remove_atom(space, links[1]) == 0;
+    epoch_synchronize();
+    atomspace_memory_usage(space, &mem, 0);
+    ok = ok && mem.categories[MEMORY_OUTGOING].count == 1 && nodes[3]->ref_count == 1;
+    atom_retain(nodes[2]);
+    atomspace_destroy(space);
+    ok = ok && nodes[2]->ref_count == 1 && nodes[2]->atom->name == NULL;
+    atom_release(nodes[2]);
+    return ok;
+}
+
+int test_type_hierarchy() {
+    int ok = atom_type_is_a(ATOM_TYPE_IMPLICATION, ATOM_TYPE_LINK) &&
+             atom_type_is_a(ATOM_TYPE_CONCEPT, ATOM_TYPE_NODE) &&
+             !atom_type_is_a(ATOM_TYPE_AND, ATOM_TYPE_NODE) &&
+             atom_type_parent(ATOM_TYPE_LINK) == -1 &&
+             atom_type_lookup("equivalence") == ATOM_TYPE_EQUIVALENCE;
+    
+    /* Registered types inherit every ancestor's set */
+    int inheritance = atom_type_register("inheritance", ATOM_TYPE_IMPLICATION);
+    int intensional = atom_type_register("intensional_inheritance", (atom_type_t)inheritance);
+    ok = ok && inheritance >= ATOM_TYPE_COUNT && intensional == inheritance + 1;
+    ok = ok && atom_type_register("inheritance", ATOM_TYPE_LINK) == -1 &&
+         atom_type_register("orphan", (atom_type_t)(ATOM_TYPE_MAX - 1)) == -1;
+    ok = ok && atom_type_is_a((atom_type_t)intensional, ATOM_TYPE_IMPLICATION) &&
+         atom_type_is_a((atom_type_t)intensional, ATOM_TYPE_LINK) &&
+         !atom_type_is_a((atom_type_t)inheritance, (atom_type_t)intensional) &&
+         strcmp(atom_type_name((atom_type_t)intensional), "intensional_inheritance") == 0;
+    ok = ok && atom_type_subtypes(ATOM_TYPE_IMPLICATION) ==
+         (ATOM_TYPE_BIT(ATOM_TYPE_IMPLICATION) | ATOM_TYPE_BIT(inheritance) | ATOM_TYPE_BIT(intensional));
+    
+    /* Unknown types are rejected instead of indexed */
+    atomspace_t* space = atomspace_create(1);
+    ok = ok && atom_create(space, (atom_type_t)(ATOM_TYPE_MAX - 1), "x") == NULL &&
+         atom_create(space, (atom_type_t)ATOM_TYPE_MAX, "x") == NULL;
+    
+    atom_handle_t* a = atom_create(space, ATOM_TYPE_CONCEPT, "a");
+    atom_handle_t* b = atom_create(space, ATOM_TYPE_PREDICATE, "b");
+    atom_handle_t* pair[] = { a, b };
+    atom_create_link(space, ATOM_TYPE_AND, pair, 2);
+    atom_create_link(space, ATOM_TYPE_IMPLICATION, pair, 2);
+    atom_handle_t* isa = atom_create_link(space, (atom_type_t)inheritance, pair, 2);
+    atom_create_link(space, (atom_type_t)intensional, pair, 2);
+    
+    /* "T or any subtype" unions the buckets of T's descendants */
+    size_t count = 0;
+    atom_handle_t** atoms = atomspace_get_atoms_by_types_borrowed(space, atom_type_subtypes(ATOM_TYPE_LINK), &count);
+    ok = ok && count == 4;
+    free(atoms);
+    atoms = atomspace_get_atoms_by_types_borrowed(space, atom_type_subtypes(ATOM_TYPE_IMPLICATION), &count);
+    ok = ok && count == 3;
+    free(atoms);
+    atoms = atomspace_get_atoms_by_type_borrowed(space, (atom_type_t)inheritance, &count);
+    ok = ok && count == 1 && atoms[0] == isa;
+    free(atoms);
+    
+    atomspace_snapshot_t* snapshot = atomspace_snapshot_begin(space);
+    ok = ok && atomspace_remove_atom(space, isa) == 0;
+    atoms = atomspace_get_atoms_by_types(space, atom_type_subtypes(ATOM_TYPE_IMPLICATION), &count);
+    ok = ok && count == 2;
+    for (size_t i = 0; i < count; i++) atom_release(atoms[i]);
+    free(atoms);
+    atoms = atomspace_snapshot_get_atoms_by_types(snapshot, atom_type_subtypes(ATOM_TYPE_NODE), &count);
+    ok = ok && count == 2;
+    free(atoms);
+    atomspace_snapshot_end(snapshot);
+    
+    /* Reclaiming the removed atom clears its bucket slot */
+    epoch_synchronize();
+    atoms = atomspace_get_atoms_by_type_borrowed(space, (atom_type_t)inheritance, &count);
+    ok = ok && count == 0;
+    free(atoms);
+    atomspace_destroy(space);
+    return ok;
+}
+
+static float test_random_unit(uint64_t* state) {
+    *state = *state * 6364136223846793005ull + 1442695040888963407ull;
+    return (float)(*state >> 40) / (float)(1 << 24) - 0.5f;
+}
+
+int test_vector_search() {
+    enum { ATOMS = 2000, DIM = 20, K = 10, QUERIES = 50 };
+    atomspace_t* space = atomspace_create(1);
+    vector_index_config_t config;
+    vector_index_config_default(&config);
+    config.metric = VECTOR_METRIC_L2;
+    int ok = atomspace_vector_configure(space, DIM, &config) == 0;
+    config.m = 1;
+    ok = ok && atomspace_vector_configure(space, DIM, &config) == -1;
+    
+    uint64_t rng = 7;
+    static float values[ATOMS][DIM];
+    atom_handle_t* atoms[ATOMS];
+    char name[32];
+    for (int i = 0; i < ATOMS; i++) {
+        snprintf(name, sizeof(name), "v%d", i);
+        atoms[i] = atom_create(space, ATOM_TYPE_CONCEPT, name);
+        for (int d = 0; d < DIM; d++) values[i][d] = test_random_unit(&rng);
+        ok = ok && atom_set_vector(space, atoms[i], values[i], DIM) == 0;
+    }
+    config.m = 16;
+    ok = ok && atomspace_vector_configure(space, DIM, &config) == -1;
+    ok = ok && atomspace_vector_count(space, DIM) == ATOMS;
+    
+    float copy[DIM];
+    ok = ok && atom_get_vector(space, atoms[5], copy, DIM) == DIM && memcmp(copy, values[5], sizeof(copy)) == 0;
+    
+    /* An atom's own vector finds it first; similar() leaves it out */
+    vector_match_t matches[K];
+    ok = ok && atomspace_vector_search(space, values[42], DIM, K, 0, matches) == K &&
+         matches[0].atom == atoms[42] && matches[0].distance == 0.0f;
+    ok = ok && atomspace_vector_similar(space, atoms[42], K, 0, matches) == K &&
+         matches[0].atom != atoms[42] && matches[0].distance <= matches[K - 1].distance;
+    
+    /* Approximate answers against the exact scan, batched */
+    static float queries[QUERIES][DIM];
+    for (int q = 0; q < QUERIES; q++) {
+        for (int d = 0; d < DIM; d++) queries[q][d] = test_random_unit(&rng);
+    }
+    static vector_match_t batch[QUERIES * K];
+    size_t counts[QUERIES];
+    ok = ok && atomspace_vector_search_batch(space, &queries[0][0], QUERIES, DIM, K, 0, batch, counts) ==
+               QUERIES * K;
+    size_t found = 0;
+    for (int q = 0; q < QUERIES; q++) {
+        vector_match_t exact[K];
+        ok = ok && atomspace_vector_search_exact(space, queries[q], DIM, K, exact) == K;
+        for (int i = 0; i < K; i++) {
+            for (int j = 0; j < K; j++) found += batch[q * K + j].atom == exact[i].atom;
+        }
+    }
+    ok = ok && found >= QUERIES * K * 9 / 10;
+    
+    /* Replacing a vector reuses its row and relinks it under the new values */
+    atomspace_memory_t mem;
+    atomspace_memory_usage(space, &mem, 0);
+    uint64_t rows = mem.categories[MEMORY_VECTORS].count;
+    size_t moved = 0;
+    for (int i = 100; i < 200; i++) {
+        for (int d = 0; d < DIM; d++) values[i][d] = test_random_unit(&rng);
+        ok = ok && atom_set_vector(space, atoms[i], values[i], DIM) == 0;
+    }
+    for (int i = 100; i < 200; i++) {
+        moved += atomspace_vector_search(space, values[i], DIM, 1, 0, matches) == 1 && matches[0].atom == atoms[i];
+    }
+    atomspace_memory_usage(space, &mem, 0);
+    ok = ok && moved >= 95 && mem.categories[MEMORY_VECTORS].count == rows &&
+         atomspace_vector_count(space, DIM) == ATOMS;
+    
+    /* Removed and cleared atoms stop matching at once */
+    ok = ok && atomspace_remove_atom(space, atoms[42]) == 0 && atom_clear_vector(space, atoms[43]) == 0;
+    ok = ok && atom_clear_vector(space, atoms[43]) == -1 && atom_get_vector(space, atoms[43], copy, DIM) == 0;
+    ok = ok && atomspace_vector_search(space, values[42], DIM, K, 0, matches) == K &&
+         matches[0].atom != atoms[42];
+    ok = ok && atomspace_vector_search_exact(space, values[43], DIM, 1, matches) == 1 &&
+         matches[0].atom != atoms[43];
+    epoch_synchronize();
+    ok = ok && atomspace_vector_count(space, DIM) == ATOMS - 2;
+    
+    /* A vector of another dimension moves the atom to that class */
+    float small[3] = { 1.0f, 0.0f, 0.0f };
+    ok = ok && atom_set_vector(space, atoms[7], small, 3) == 0 &&
+         atomspace_vector_count(space, DIM) == ATOMS - 3 && atomspace_vector_count(space, 3) == 1;
+    ok = ok && atomspace_vector_search(space, small, 3, K, 0, matches) == 1 && matches[0].atom == atoms[7] &&
+         matches[0].distance < 1e-6f;
+    ok = ok && atom_set_vector(space, atoms[8], small, 0) == -1;
+    
+    atomspace_memory_usage(space, &mem, 0);
+    ok = ok && mem.categories[MEMORY_VECTORS].count == ATOMS + 1 &&
+         mem.categories[MEMORY_VECTORS].requested >= (ATOMS + 1) * DIM * sizeof(float);
+    atomspace_destroy(space);
+    return ok;
+}
+
+int test_name_index() {
+    atomspace_t* space = atomspace_create(1);
+    const char* names[] = { "cat", "car", "cart", "care", "dog", "dot", "Cat", "cat", "c*t" };
+    enum { NAMES = sizeof(names) / sizeof(names[0]) };
+    atom_handle_t* atoms[NAMES];
+    for (int i = 0; i < NAMES; i++) atoms[i] = atom_create(space, ATOM_TYPE_CONCEPT, names[i]);
+    atom_handle_t* link = atom_create_link(space, ATOM_TYPE_LINK, atoms, 2);
+    
+    /* Results come in byte order, atoms of one name in creation order */
+    atom_handle_t* out[16];
+    atomspace_read_begin(space);
+    int ok = atomspace_name_prefix(space, "car", out, 16) == 3 &&
+             out[0] == atoms[1] && out[1] == atoms[3] && out[2] == atoms[2];
+    ok = ok && atomspace_name_prefix(space, "ca", out, 2) == 2 && out[0] == atoms[1];
+    ok = ok && atomspace_name_prefix(space, "", out, 16) == NAMES && out[0] == atoms[6];
+    ok = ok && atomspace_name_prefix(space, "cab", out, 16) == 0;
+    ok = ok && atomspace_name_prefix(space, "carts", out, 16) == 0;
+    
+    ok = ok && atomspace_name_glob(space, "ca?", out, 16) == 3 &&
+         out[0] == atoms[1] && out[1] == atoms[0] && out[2] == atoms[7];
+    ok = ok && atomspace_name_glob(space, "c*t", out, 16) == 4 && out[0] == atoms[8] && out[1] == atoms[2];
+    ok = ok && atomspace_name_glob(space, "[cC]at", out, 16) == 3 && out[0] == atoms[6];
+    ok = ok && atomspace_name_glob(space, "[!a-c]o*", out, 16) == 2 && out[0] == atoms[4];
+    ok = ok && atomspace_name_glob(space, "c\\*t", out, 16) == 1 && out[0] == atoms[8];
+    ok = ok && atomspace_name_glob(space, "*", out, 16) == NAMES;
+    ok = ok && atomspace_name_glob(space, "[ca", out, 16) == 0;
+    
+    name_match_t matches[16];
+    ok = ok && atomspace_name_fuzzy(space, "cat", 1, matches, 16) == 6 &&
+         matches[0].atom == atoms[0] && matches[1].atom == atoms[7] && matches[1].distance == 0 &&
+         matches[2].atom == atoms[6] && matches[3].atom == atoms[8] && matches[4].atom == atoms[1] &&
+         matches[5].atom == atoms[2] && matches[5].distance == 1;
+    ok = ok && atomspace_name_fuzzy(space, "dat", 2, matches, 16) == 8 && matches[0].distance == 1;
+    ok = ok && atomspace_name_fuzzy(space, "cat", 0, matches, 1) == 1 && matches[0].atom == atoms[0];
+    atomspace_read_end(space);
+    
+    /* Removed atoms drop out at once and leave the trie when reclaimed */
+    ok = ok && atomspace_remove_atom(space, link) == 0 && atomspace_remove_atom(space, atoms[0]) == 0 &&
+         atomspace_remove_atom(space, atoms[4]) == 0 && atomspace_remove_atom(space, atoms[5]) == 0;
+    atomspace_read_begin(space);
+    ok = ok && atomspace_name_prefix(space, "cat", out, 16) == 1 && out[0] == atoms[7];
+    atomspace_read_end(space);
+    atomspace_memory_t mem;
+    atomspace_memory_usage(space, &mem, 0);
+    uint64_t nodes = mem.categories[MEMORY_NAME_INDEX].count;
+    epoch_synchronize();
+    atomspace_memory_usage(space, &mem, 0);
+    ok = ok && mem.categories[MEMORY_NAME_INDEX].count < nodes;
+    atomspace_read_begin(space);
+    ok = ok && atomspace_name_prefix(space, "do", out, 16) == 0 && atomspace_name_prefix(space, "", out, 16) == NAMES - 3;
+    ok = ok && atomspace_name_fuzzy(space, "cat", 0, matches, 16) == 1 && matches[0].atom == atoms[7];
+    atomspace_read_end(space);
+    
+    /* Exact lookups go through the trie, snapshots included */
+    atomspace_snapshot_t* snapshot = atomspace_snapshot_begin(space);
+    atom_handle_t* later = atom_create(space, ATOM_TYPE_CONCEPT, "car");
+    size_t count = 0;
+    atom_handle_t** results = atomspace_snapshot_get_atoms_by_name(snapshot, "car", &count);
+    ok = ok && count == 1 && results[0] == atoms[1];
+    free(results);
+    atomspace_snapshot_end(snapshot);
+    results = atomspace_get_atoms_by_name(space, "car", &count);
+    ok = ok && count == 2 && results[1] == later;
+    for (size_t i = 0; i < count; i++) atom_release(results[i]);
+    free(results);
+    
+    atomspace_destroy(space);
+    return ok;
+}
+
+static bool csr_equal(const atomspace_csr_t* a, const atomspace_csr_t* b) {
+    size_t v = a->vertex_count, e = a->edge_count;
+    return a->vertex_count == b->vertex_count && a->edge_count == b->edge_count &&
+           memcmp(a->ids, b->ids, v * sizeof(uint64_t)) == 0 &&
+           memcmp(a->out_offsets, b->out_offsets, (v + 1) * sizeof(uint64_t)) == 0 &&
+           memcmp(a->out_edges, b->out_edges, e * sizeof(uint32_t)) == 0 &&
+           memcmp(a->in_offsets, b->in_offsets, (v + 1) * sizeof(uint64_t)) == 0 &&
+           memcmp(a->in_edges, b->in_edges, e * sizeof(uint32_t)) == 0;
+}
+
+int test_csr_snapshot() {
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t* a = atom_create(space, ATOM_TYPE_CONCEPT, "a");
+    atom_handle_t* b = atom_create(space, ATOM_TYPE_CONCEPT, "b");
+    atom_handle_t* c = atom_create(space, ATOM_TYPE_PREDICATE, "c");
+    atom_handle_t* d = atom_create(space, ATOM_TYPE_CONCEPT, "d");
+    atom_handle_t* pair[2] = { a, b };
+    atom_handle_t* ab = atom_create_link(space, ATOM_TYPE_LINK, pair, 2);
+    pair[0] = b;
+    pair[1] = c;
+    atom_handle_t* bc = atom_create_link(space, ATOM_TYPE_EVALUATION, pair, 2);
+    atom_handle_t* triple[3] = { ab, c, c };
+    atom_handle_t* nest = atom_create_link(space, ATOM_TYPE_LINK, triple, 3);
+    atom_set_tv(a, 0.75, 0.5);
+    atom_retain(d);
+    int ok = atomspace_remove_atom(space, d) == 0;
+    
+    /* Vertices in creation order without the removed atom; repeated members repeat edges */
+    atomspace_csr_t* csr = atomspace_csr_build(space, CSR_WITH_TYPES | CSR_WITH_TV, 1);
+    ok = ok && csr && csr->vertex_count == 6 && csr->edge_count == 7;
+    ok = ok && atomspace_csr_vertex(csr, a) == 0 && atomspace_csr_vertex(csr, ab) == 3 &&
+         atomspace_csr_vertex(csr, nest) == 5 && atomspace_csr_vertex(csr, d) == CSR_NO_VERTEX;
+    ok = ok && csr->ids[4] == bc->id && csr->types[2] == ATOM_TYPE_PREDICATE && csr->types[4] == ATOM_TYPE_EVALUATION;
+    ok = ok && csr->strengths[0] == 0.75f && csr->confidences[0] == 0.5f;
+    ok = ok && atomspace_csr_out_degree(csr, 0) == 0 && atomspace_csr_out_degree(csr, 5) == 3 &&
+         csr->out_edges[csr->out_offsets[5]] == 3 && csr->out_edges[csr->out_offsets[5] + 2] == 2;
+    ok = ok && atomspace_csr_in_degree(csr, 2) == 3 && csr->in_edges[csr->in_offsets[2]] == 4 &&
+         csr->in_edges[csr->in_offsets[2] + 1] == 5 && csr->in_edges[csr->in_offsets[2] + 2] == 5;
+    ok = ok && atomspace_csr_in_degree(csr, 3) == 1 && csr->in_edges[csr->in_offsets[3]] == 5;
+    
+    /* The view is a copy: later writes do not reach it */
+    atom_create_link(space, ATOM_TYPE_LINK, pair, 2);
+    atom_set_tv(a, 0.25, 0.5);
+    ok = ok && csr->edge_count == 7 && csr->strengths[0] == 0.75f;
+    atomspace_csr_free(csr);
+    atom_release(d);
+    ok = ok && atomspace_csr_build(space, 0x80, 1) == NULL;
+    atomspace_destroy(space);
+    
+    /* A graph big enough to split: any thread count gives the same arrays */
+    enum { NODES = 40000, LINKS = 80000 };
+    space = atomspace_create(1);
+    static atom_handle_t* atoms[NODES + LINKS];
+    uint64_t rng = 11;
+    for (int i = 0; i < NODES; i++) atoms[i] = atom_create(space, ATOM_TYPE_CONCEPT, NULL);
+    for (int i = 0; i < LINKS; i++) {
+        atom_handle_t* members[3];
+        size_t arity = 2 + (size_t)(test_random_unit(&rng) > 0.0f);
+        for (size_t k = 0; k < arity; k++) {
+            members[k] = atoms[(size_t)((test_random_unit(&rng) + 0.5f) * (NODES + i)) % (NODES + i)];
+        }
+        atoms[NODES + i] = atom_create_link(space, ATOM_TYPE_LINK, members, arity);
+    }
+    size_t removed = 0;
+    for (int i = NODES + LINKS - 1; i >= NODES; i -= 7) {
+        removed += atomspace_remove_atom(space, atoms[i]) == 0;
+        atoms[i] = NULL;
+    }
+    
+    atomspace_csr_t* serial = atomspace_csr_build(space, 0, 1);
+    atomspace_csr_t* parallel = atomspace_csr_build(space, 0, 8);
+    ok = ok && serial && parallel && serial->vertex_count == NODES + LINKS - removed &&
+         csr_equal(serial, parallel) && parallel->in_offsets[parallel->vertex_count] == parallel->edge_count;
+    for (int i = 0; ok && i < NODES + LINKS; i++) {
+        if (!atoms[i]) continue;
+        uint32_t v = atomspace_csr_vertex(parallel, atoms[i]);
+        if (v == CSR_NO_VERTEX) continue;
+        ok = atomspace_csr_in_degree(parallel, v) == atoms[i]->atom->incoming_count &&
+             atomspace_csr_out_degree(parallel, v) == atoms[i]->atom->outgoing_count;
+        for (uint64_t e = parallel->in_offsets[v]; ok && e + 1 < parallel->in_offsets[v + 1]; e++) {
+            ok = parallel->in_edges[e] <= parallel->in_edges[e + 1];
+        }
+    }
+    atomspace_csr_free(serial);
+    atomspace_csr_free(parallel);
+    atomspace_destroy(space);
+    return ok;
+}
+
+/* Plain queue BFS over both directions, for checking graph_bfs */
+static void reference_bfs(const atomspace_csr_t* csr, uint32_t source, uint32_t* depth, uint32_t* queue) {
+    for (uint32_t v = 0; v < csr->vertex_count; v++) depth[v] = GRAPH_UNREACHED;
+    size_t head = 0, tail = 0;
+    depth[source] = 0;
+    queue[tail++] = source;
+    while (head < tail) {
+        uint32_t u = queue[head++];
+        const uint64_t* offsets[2] = { csr->out_offsets, csr->in_offsets };
+        const uint32_t* edges[2] = { csr->out_edges, csr->in_edges };
+        for (int l = 0; l < 2; l++) {
+            for (uint64_t e = offsets[l][u]; e < offsets[l][u + 1]; e++) {
+                if (depth[edges[l][e]] != GRAPH_UNREACHED) continue;
+                depth[edges[l][e]] = depth[u] + 1;
+                queue[tail++] = edges[l][e];
+            }
+        }
+    }
+}
+
+int test_graph_algorithms() {
+    /* a-b-c chained through two links, d-e through a third, f alone */
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t* nodes[6];
+    for (int i = 0; i < 6; i++) nodes[i] = atom_create(space, ATOM_TYPE_CONCEPT, NULL);
+    atom_handle_t* pair[2] = { nodes[0], nodes[1] };
+    atom_create_link(space, ATOM_TYPE_LINK, pair, 2);
+    pair[0] = nodes[1];
+    pair[1] = nodes[2];
+    atom_create_link(space, ATOM_TYPE_LINK, pair, 2);
+    pair[0] = nodes[3];
+    pair[1] = nodes[4];
+    atom_create_link(space, ATOM_TYPE_LINK, pair, 2);
+    atomspace_csr_t* csr = atomspace_csr_build(space, 0, 1);
+    int ok = csr && csr->vertex_count == 9;
+    if (!ok) {
+        atomspace_destroy(space);
+        return 0;
+    }
+    
+    uint32_t depth[9], parent[9], path[9];
+    uint32_t source = 0;
+    ok = graph_bfs(csr, &source, 1, UINT32_MAX, GRAPH_BOTH, 1, depth, parent) == 5;
+    ok = ok && depth[6] == 1 && depth[1] == 2 && depth[7] == 3 && depth[2] == 4 &&
+         depth[3] == GRAPH_UNREACHED && parent[0] == 0 && parent[2] == 7;
+    ok = ok && graph_bfs(csr, &source, 1, 2, GRAPH_BOTH, 1, depth, NULL) == 3 && depth[7] == GRAPH_UNREACHED;
+    ok = ok && graph_bfs(csr, &source, 1, UINT32_MAX, GRAPH_IN, 1, depth, NULL) == 2 && depth[6] == 1;
+    source = 7;
+    ok = ok && graph_bfs(csr, &source, 1, UINT32_MAX, GRAPH_OUT, 1, depth, NULL) == 3 && depth[2] == 1;
+    
+    ok = ok && graph_shortest_path(csr, 0, 2, GRAPH_BOTH, 1, path, 9) == 5 &&
+         path[0] == 0 && path[1] == 6 && path[2] == 1 && path[3] == 7 && path[4] == 2;
+    ok = ok && graph_shortest_path(csr, 0, 2, GRAPH_OUT, 1, path, 9) == 0;
+    ok = ok && graph_shortest_path(csr, 0, 3, GRAPH_BOTH, 1, path, 9) == 0;
+    path[2] = 99;
+    ok = ok && graph_shortest_path(csr, 0, 2, GRAPH_BOTH, 1, path, 2) == 5 && path[1] == 6 && path[2] == 99;
+    
+    uint32_t component[9];
+    ok = ok && graph_components(csr, 1, component) == 3;
+    ok = ok && component[2] == 0 && component[7] == 0 && component[4] == 3 && component[8] == 3 && component[5] == 5;
+    
+    float rank[9];
+    ok = ok && graph_pagerank(csr, GRAPH_BOTH, NULL, 1, rank) > 1;
+    float sum = 0.0f;
+    for (int v = 0; v < 9; v++) sum += rank[v];
+    ok = ok && fabsf(sum - 1.0f) < 1e-4f && fabsf(rank[0] - rank[2]) < 1e-5f && rank[1] > rank[0];
+    
+    /* Write-back skips atoms removed since the view was built */
+    atom_retain(nodes[5]);
+    ok = ok && atomspace_remove_atom(space, nodes[5]) == 0;
+    ok = ok && graph_write_back(space, csr, rank, 1000.0f, GRAPH_FIELD_STI) == 8 &&
+         atom_get_av(nodes[1]).sti == (int16_t)lrintf(rank[1] * 1000.0f);
+    ok = ok && graph_write_back(space, csr, rank, 100.0f, GRAPH_FIELD_STRENGTH) == 8 &&
+         atom_get_tv(nodes[1]).strength == 1.0 && atom_get_tv(nodes[1]).confidence == 0.0;
+    atom_release(nodes[5]);
+    atomspace_csr_free(csr);
+    atomspace_destroy(space);
+    
+    /* A graph big enough to split and to go bottom up: results match a plain BFS and any thread count */
+    enum { NODES = 30000, LINKS = 40000 };
+    space = atomspace_create(1);
+    static atom_handle_t* atoms[NODES];
+    uint64_t rng = 5;
+    for (int i = 0; i < NODES; i++) atoms[i] = atom_create(space, ATOM_TYPE_CONCEPT, NULL);
+    for (int i = 0; i < LINKS; i++) {
+        atom_handle_t* members[2];
+        for (int k = 0; k < 2; k++) members[k] = atoms[(size_t)((test_random_unit(&rng) + 0.5f) * NODES) % NODES];
+        atom_create_link(space, ATOM_TYPE_LINK, members, 2);
+    }
+    csr = atomspace_csr_build(space, 0, 1);
+    uint32_t count = csr ? csr->vertex_count : 0;
+    uint32_t* expected = malloc(count * sizeof(uint32_t));
+    uint32_t* scratch = malloc(count * sizeof(uint32_t));
+    uint32_t* serial = malloc(count * sizeof(uint32_t));
+    uint32_t* parallel = malloc(count * sizeof(uint32_t));
+    uint32_t* parents = malloc(count * sizeof(uint32_t));
+    float* serial_rank = malloc(count * sizeof(float));
+    float* parallel_rank = malloc(count * sizeof(float));
+    ok = ok && csr && expected && scratch && serial && parallel && parents && serial_rank && parallel_rank;
+    
+    if (ok) {
+        reference_bfs(csr, 0, expected, scratch);
+        source = 0;
+        size_t reached = graph_bfs(csr, &source, 1, UINT32_MAX, GRAPH_BOTH, 1, serial, NULL);
+        ok = reached > count / 2 && graph_bfs(csr, &source, 1, UINT32_MAX, GRAPH_BOTH, 8, parallel, parents) == reached;
+        ok = ok && memcmp(expected, serial, count * sizeof(uint32_t)) == 0 &&
+             memcmp(expected, parallel, count * sizeof(uint32_t)) == 0;
+        for (uint32_t v = 1; ok && v < count; v++) {
+            ok = parallel[v] == GRAPH_UNREACHED || parallel[parents[v]] + 1 == parallel[v];
+        }
+        
+        size_t components = graph_components(csr, 1, serial);
+        ok = ok && components > 1 && graph_components(csr, 8, parallel) == components &&
+             memcmp(serial, parallel, count * sizeof(uint32_t)) == 0;
+        for (uint32_t v = 0; ok && v < count; v++) {
+            for (uint64_t e = csr->out_offsets[v]; ok && e < csr->out_offsets[v + 1]; e++) {
+                ok = serial[csr->out_edges[e]] == serial[v] && serial[v] <= v;
+            }
+            ok = ok && (serial[v] == v || (expected[v] == GRAPH_UNREACHED) == (expected[serial[v]] == GRAPH_UNREACHED));
+        }
+        
+        graph_pagerank(csr, GRAPH_IN, NULL, 1, serial_rank);
+        graph_pagerank(csr, GRAPH_IN, NULL, 8, parallel_rank);
+        double total = 0.0;
+        for (uint32_t v = 0; ok && v < count; v++) {
+            total += parallel_rank[v];
+            ok = fabsf(serial_rank[v] - parallel_rank[v]) < 1e-6f;
+        }
+        ok = ok && fabs(total - 1.0) < 1e-3;
+    }
+    free(expected);
+    free(scratch);
+    free(serial);
+    free(parallel);
+    free(parents);
+    free(serial_rank);
+    free(parallel_rank);
+    atomspace_csr_free(csr);
+    atomspace_destroy(space);
+    return ok;
+}
+
+int test_time_index() {
+    enum { ATOMS = 5000 };
+    atomspace_t* space = atomspace_create(1);
+    static atom_handle_t* atoms[ATOMS];
+    uint64_t start = (uint64_t)time(NULL);
+    uint64_t cursor = atomspace_time_position(space);
+    for (int i = 0; i < ATOMS; i++) atoms[i] = atom_create(space, ATOM_TYPE_CONCEPT, NULL);
+    uint64_t end = (uint64_t)time(NULL) + 1;
+    atom_handle_t** out = malloc((ATOMS + 1) * sizeof(atom_handle_t*));
+    
+    atomspace_read_begin(space);
+    int ok = atomspace_created_between(space, start, end, out, ATOMS) == ATOMS &&
+             out[0] == atoms[0] && out[ATOMS - 1] == atoms[ATOMS - 1];
+    ok = ok && atomspace_created_between(space, end, UINT64_MAX, out, ATOMS) == 0 &&
+         atomspace_created_between(space, 0, start, out, ATOMS) == 0;
+    ok = ok && cursor == 0 && atomspace_changes_since(space, &cursor, out, 100) == 100 &&
+         cursor == 100 && out[99] == atoms[99];
+    ok = ok && atomspace_changes_since(space, &cursor, out, ATOMS) == ATOMS - 100 && cursor == ATOMS;
+    atomspace_read_end(space);
+    
+    /* Each atom is reported once, at its latest change */
+    atom_set_tv(atoms[10], 0.5, 0.5);
+    atom_set_av(atoms[20], 5, 0, 0);
+    atom_set_tv(atoms[10], 0.25, 0.5);
+    atomspace_read_begin(space);
+    ok = ok && atomspace_changes_since(space, &cursor, out, ATOMS) == 2 &&
+         out[0] == atoms[20] && out[1] == atoms[10];
+    ok = ok && atomspace_changes_since(space, &cursor, out, ATOMS) == 0;
+    ok = ok && atomspace_changed_between(space, start, UINT64_MAX, out, ATOMS) == ATOMS &&
+         out[ATOMS - 2] == atoms[20] && out[ATOMS - 1] == atoms[10];
+    ok = ok && atomspace_created_between(space, start, UINT64_MAX, out, ATOMS) == ATOMS && out[10] == atoms[10];
+    atomspace_read_end(space);
+    
+    /* A transaction logs one entry per atom, at its version */
+    atomspace_txn_t* txn = atomspace_txn_begin(space);
+    atom_handle_t* staged = atomspace_txn_create(txn, ATOM_TYPE_CONCEPT, "staged");
+    atomspace_txn_set_tv(txn, staged, 0.5, 0.5);
+    atomspace_txn_set_tv(txn, atoms[40], 0.5, 0.5);
+    atomspace_txn_set_av(txn, atoms[40], 1, 0, 0);
+    ok = ok && atomspace_txn_commit(txn) == 0;
+    ok = ok && atomspace_remove_atom(space, atoms[30]) == 0;
+    atomspace_read_begin(space);
+    ok = ok && atomspace_changes_since(space, &cursor, out, ATOMS) == 2 &&
+         out[0] == staged && out[1] == atoms[40];
+    ok = ok && atomspace_changed_between(space, 0, UINT64_MAX, out, ATOMS + 1) == ATOMS;
+    atomspace_read_end(space);
+    
+    /* Trimming drops only whole segments older than the cutoff */
+    ok = ok && atomspace_time_trim(space, start) == 0;
+    ok = ok && atomspace_time_trim(space, UINT64_MAX) == TIME_SEGMENT_ENTRIES;
+    atomspace_read_begin(space);
+    ok = ok && atomspace_created_between(space, 0, UINT64_MAX, out, ATOMS) == ATOMS + 1 - TIME_SEGMENT_ENTRIES;
+    ok = ok && atomspace_changed_between(space, 0, UINT64_MAX, out, ATOMS) == ATOMS + 4 - TIME_SEGMENT_ENTRIES;
+    atomspace_read_end(space);
+    atomspace_memory_t mem;
+    atomspace_memory_usage(space, &mem, 0);
+    ok = ok && mem.categories[MEMORY_TIME_INDEX].count == 1;
+    
+    free(out);
+    atomspace_destroy(space);
+    return ok;
+}
+
+static bool confident_atom(atom_handle_t* atom, void* user_data) {
+    (void)user_data;
+    return atom_get_tv(atom).confidence > 0.5;
+}
+
+int test_query_cache() {
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t* a = atom_create(space, ATOM_TYPE_CONCEPT, "a");
+    atom_create(space, ATOM_TYPE_CONCEPT, "b");
+    atom_create(space, ATOM_TYPE_PREDICATE, "p");
+    
+    /* Hits share the first result */
+    atomspace_read_begin(space);
+    const query_result_t* concepts = atomspace_cached_by_type(space, ATOM_TYPE_CONCEPT);
+    const query_result_t* named = atomspace_cached_by_name(space, "a");
+    int ok = concepts->count == 2 && concepts->atoms[0] == a && named->count == 1 && named->atoms[0] == a;
+    ok = ok && atomspace_cached_by_type(space, ATOM_TYPE_CONCEPT) == concepts &&
+         atomspace_cached_by_name(space, "a") == named;
+    atomspace_read_end(space);
+    
+    /* Mutations invalidate only the queries they touch */
+    atom_create(space, ATOM_TYPE_PREDICATE, "q");
+    atomspace_read_begin(space);
+    ok = ok && atomspace_cached_by_type(space, ATOM_TYPE_CONCEPT) == concepts &&
+         atomspace_cached_by_name(space, "a") == named;
+    atomspace_read_end(space);
+    atom_handle_t* a2 = atom_create(space, ATOM_TYPE_CONCEPT, "a");
+    atomspace_read_begin(space);
+    concepts = atomspace_cached_by_type(space, ATOM_TYPE_CONCEPT);
+    named = atomspace_cached_by_name(space, "a");
+    ok = ok && concepts->count == 3 && named->count == 2;
+    atomspace_read_end(space);
+    ok = ok && atomspace_remove_atom(space, a2) == 0;
+    atomspace_read_begin(space);
+    ok = ok && atomspace_cached_by_type(space, ATOM_TYPE_CONCEPT)->count == 2 &&
+         atomspace_cached_by_name(space, "a")->count == 1 &&
+         atomspace_cached_by_types(space, ATOM_TYPE_BIT(ATOM_TYPE_CONCEPT) | ATOM_TYPE_BIT(ATOM_TYPE_PREDICATE))->count == 4;
+    atomspace_read_end(space);
+    
+    /* Patterns see value writes */
+    atomspace_read_begin(space);
+    const query_result_t* confident = atomspace_cached_match(space, confident_atom, NULL);
+    ok = ok && confident->count == 0 && atomspace_cached_match(space, confident_atom, NULL) == confident;
+    atomspace_read_end(space);
+    atom_set_tv(a, 0.9, 0.8);
+    atomspace_read_begin(space);
+    confident = atomspace_cached_match(space, confident_atom, NULL);
+    ok = ok && confident->count == 1 && confident->atoms[0] == a;
+    atomspace_read_end(space);
+    
+    query_cache_stats_t stats;
+    atomspace_query_cache_stats(space, &stats);
+    ok = ok && stats.hits == 5 && stats.misses == 9 && stats.invalidations == 5 && stats.entries == 4 &&
+         stats.hit_ratio > 0.35 && stats.hit_ratio < 0.36;
+    atomspace_memory_t mem;
+    atomspace_memory_usage(space, &mem, 0);
+    ok = ok && mem.categories[MEMORY_QUERY_CACHE].count == 4;
+    
+    /* A byte budget of one result evicts the others; no entries disables */
+    ok = ok && atomspace_query_cache_configure(space, 16, 1) == 0;
+    atomspace_read_begin(space);
+    ok = ok && atomspace_cached_by_name(space, "a")->count == 1;
+    atomspace_read_end(space);
+    atomspace_query_cache_stats(space, &stats);
+    ok = ok && stats.entries == 0;
+    ok = ok && atomspace_query_cache_configure(space, 16, 4096) == 0;
+    atomspace_read_begin(space);
+    atomspace_cached_by_name(space, "a");
+    atomspace_cached_by_name(space, "b");
+    atomspace_read_end(space);
+    atomspace_query_cache_stats(space, &stats);
+    ok = ok && stats.entries == 2 && stats.bytes > 0;
+    ok = ok && atomspace_query_cache_configure(space, 16, 0) == -1 &&
+         atomspace_query_cache_configure(space, 0, 0) == 0;
+    atomspace_read_begin(space);
+    const query_result_t* first = atomspace_cached_by_name(space, "a");
+    ok = ok && first->count == 1 && first->atoms[0] == a;
+    atomspace_cached_by_name(space, "a");
+    atomspace_read_end(space);
+    atomspace_query_cache_stats(space, &stats);
+    ok = ok && stats.entries == 0 && stats.bytes == 0;
+    
+    atomspace_destroy(space);
+    return ok;
+}
+
+int test_changefeed() {
+    if (changefeed_start(1024) != 0) return 0;
+    atomspace_t* space = atomspace_create(1);
+    changefeed_subscription_t* all = changefeed_subscribe(NULL);
+    change_filter_t updates = { 1u << CHANGE_UPDATE, 1u << ATOM_TYPE_CONCEPT, NULL, 0 };
+    changefeed_subscription_t* concept_updates = changefeed_subscribe(&updates);
+    change_filter_t named = { 0, 0, "b", 0 };
+    changefeed_subscription_t* by_name = changefeed_subscribe(&named);
+    
+    atom_handle_t* a = atom_create(space, ATOM_TYPE_CONCEPT, "a");
+    const char* names[] = { "b", "c" };
+    atom_handle_t* batch[2];
+    atom_create_batch(space, ATOM_TYPE_PREDICATE, names, 2, batch);
+    atom_set_tv(a, 0.25, 0.5);
+    atom_set_tv(batch[0], 0.75, 0.5);
+    atomspace_remove_atom(space, batch[0]);
+    
+    change_event_t events[16];
+    size_t count = changefeed_poll(all, events, 16);
+    int ok = count == 6 && events[0].kind == CHANGE_CREATE && events[0].atom_id == a->id &&
+             strcmp(events[1].name, "b") == 0 && events[2].sequence == events[0].sequence + 2 &&
+             events[3].kind == CHANGE_UPDATE && events[3].tv.strength == 0.25 &&
+             events[5].kind == CHANGE_DELETE && events[5].version > events[4].version;
+    ok = ok && changefeed_poll(all, events, 16) == 0;
+    
+    count = changefeed_poll(concept_updates, events, 16);
+    ok = ok && count == 1 && events[0].atom_id == a->id;
+    count = changefeed_poll(by_name, events, 16);
+    ok = ok && count == 3 && events[0].kind == CHANGE_CREATE && events[2].kind == CHANGE_DELETE;
+    
+    /* Another space with the same node ID: events say which space they came from */
+    atomspace_t* other = atomspace_create(1);
+    change_filter_t own = { 0, 0, NULL, space->space_id };
+    changefeed_subscription_t* own_space = changefeed_subscribe(&own);
+    atom_handle_t* twin = atom_create(other, ATOM_TYPE_CONCEPT, "a");
+    atomspace_txn_t* txn = atomspace_txn_begin(space);
+    atomspace_txn_create(txn, ATOM_TYPE_CONCEPT, "d");
+    atomspace_txn_set_tv(txn, a, 0.5, 0.5);
+    atomspace_txn_set_av(txn, batch[1], 1, 0, 0);
+    ok = ok && other->space_id != space->space_id && twin->id != 0 && atomspace_txn_commit(txn) == 0;
+    count = changefeed_poll(all, events, 16);
+    ok = ok && count == 4 && events[0].space_id == other->space_id && events[1].space_id == space->space_id;
+    /* A commit's events are consecutive: creates, then updates with the written values */
+    ok = ok && events[1].kind == CHANGE_CREATE && events[2].atom_id == a->id && events[2].tv.strength == 0.5 &&
+         events[3].av.sti == 1 && events[3].sequence == events[1].sequence + 2 &&
+         events[1].version == events[3].version;
+    count = changefeed_poll(own_space, events, 16);
+    ok = ok && count == 3 && events[0].kind == CHANGE_CREATE && strcmp(events[0].name, "d") == 0;
+    changefeed_unsubscribe(own_space);
+    atomspace_destroy(other);
+    changefeed_poll(concept_updates, events, 16);
+    changefeed_poll(by_name, events, 16);
+    
+    /* A subscriber that falls behind by more than the log loses the oldest events */
+    for (int i = 0; i < 1500; i++) atom_set_tv(a, 0.5, 0.5);
+    size_t received = 0;
+    while ((count = changefeed_poll(all, events, 16)) > 0) received += count;
+    ok = ok && received == 1024 && changefeed_dropped(all) == 1500 - 1024;
+    
+    changefeed_stop();
+    atom_set_tv(a, 0.1, 0.1);
+    ok = ok && changefeed_poll(all, events, 16) == 0;
+    
+    changefeed_unsubscribe(all);
+    changefeed_unsubscribe(concept_updates);
+    changefeed_unsubscribe(by_name);
+    epoch_synchronize();
+    atomspace_destroy(space);
+    return ok;
+}
+
+static void* run_server(void* arg) {
+    server_run((server_t*)arg);
+    return NULL;
+}
+
+int test_server_roundtrip() {
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/opencog-test-%d.sock", (int)getpid());
+    atomspace_t* space = atomspace_create(1);
+    server_config_t config = { path, 2, 1024, 0 };
+    server_t* server = server_create(space, &config);
+    if (!server) return 0;
+    pthread_t thread;
+    pthread_create(&thread, NULL, run_server, server);
+    
+    client_t* client = client_connect(path);
+    client_t* watcher = client_connect(path);
+    int ok = client && watcher && client_ping(client) == 0;
+    change_filter_t filter = { 1u << CHANGE_UPDATE, 0, NULL, 0 };
+    ok = ok && client_subscribe(watcher, 7, &filter) == 0;
+    
+    uint64_t cat = client_create_node(client, ATOM_TYPE_CONCEPT, "cat");
+    uint64_t animal = client_create_node(client, ATOM_TYPE_CONCEPT, "animal");
+    uint64_t pair[2] = { cat, animal };
+    uint64_t isa = client_create_link(client, ATOM_TYPE_LINK, pair, 2);
+    uint64_t missing[2] = { cat, 12345 };
+    ok = ok && cat && animal && isa && atomspace_get_atom(space, isa) != NULL;
+    ok = ok && client_create_link(client, ATOM_TYPE_LINK, missing, 2) == 0;
+    
+    truth_value_t tv;
+    ok = ok && client_set_tv(client, isa, 0.9, 0.8) == 0 && client_get_tv(client, isa, &tv) == 0 &&
+         tv.strength == 0.9 && tv.confidence == 0.8;
+    
+    size_t count;
+    uint64_t* ids = client_query_type(client, ATOM_TYPE_CONCEPT, &count);
+    ok = ok && ids && count == 2;
+    free(ids);
+    ids = client_query_name(client, "animal", &count);
+    ok = ok && ids && count == 1 && ids[0] == animal;
+    free(ids);
+    uint64_t pattern[2] = { 0, animal };
+    ids = client_match(client, ATOM_TYPE_LINK, pattern, 2, &count);
+    ok = ok && ids && count == 1 && ids[0] == isa;
+    free(ids);
+    
+    /* Pipelined: many requests, one flush, replies in order */
+    uint32_t first = 0, last = 0;
+    for (int i = 0; i < 1000; i++) {
+        last = client_send(client, (uint32_t)i % 3, PROTO_OP_GET, &cat, sizeof(cat));
+        if (i == 0) first = last;
+    }
+    ok = ok && client_flush(client) == 0;
+    for (uint32_t tag = first; ok && tag <= last; tag++) {
+        proto_header_t reply;
+        const void* data;
+        proto_atom_t atom;
+        ok = client_recv(client, &reply, &data) == 0 && reply.tag == tag &&
+             reply.stream == (tag - first) % 3 && reply.status == PROTO_OK;
+        memcpy(&atom, data, sizeof(atom));
+        ok = ok && atom.id == cat && atom.name_length == 3 &&
+             memcmp((const char*)data + sizeof(atom), "cat", 3) == 0;
+    }
+    
+    ok = ok && client_remove(client, animal) != 0 && client_remove(client, isa) == 0;
+    ok = ok && client_get_tv(client, isa, &tv) != 0;
+    
+    /* The TV update reached the subscriber on its stream */
+    proto_header_t event_header;
+    const void* data;
+    ok = ok && client_recv(watcher, &event_header, &data) == 0 &&
+         event_header.op == PROTO_OP_EVENT && event_header.stream == 7 &&
+         event_header.length == sizeof(change_event_t);
+    if (ok) {
+        change_event_t event;
+        memcpy(&event, data, sizeof(event));
+        ok = event.kind == CHANGE_UPDATE && event.atom_id == isa && event.tv.strength == 0.9;
+    }
+    
+    client_close(watcher);
+    client_close(client);
+    server_stop(server);
+    pthread_join(thread, NULL);
+    server_stats_t stats;
+    server_stats(server, &stats);
+    ok = ok && stats.connections == 2 && stats.requests >= 1000 && stats.events == 1;
+    server_destroy(server);
+    ok = ok && access(path, F_OK) != 0 && !changefeed_is_active();
+    epoch_synchronize();
+    atomspace_destroy(space);
+    return ok;
+}
+
+int test_server_split_reply() {
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/opencog-test-%d-split.sock", (int)getpid());
+    atomspace_t* space = atomspace_create(1);
+    /* 8 IDs per frame */
+    server_config_t config = { path, 1, 0, 64 };
+    server_t* server = server_create(space, &config);
+    if (!server) return 0;
+    pthread_t thread;
+    pthread_create(&thread, NULL, run_server, server);
+    
+    atom_handle_t* hub = atom_create(space, ATOM_TYPE_CONCEPT, "hub");
+    for (int i = 0; i < 99; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "n%d", i);
+        atom_handle_t* pair[2] = { atom_create(space, ATOM_TYPE_CONCEPT, name), hub };
+        atom_create_link(space, ATOM_TYPE_LINK, pair, 2);
+    }
+    
+    client_t* client = client_connect(path);
+    int ok = client != NULL;
+    size_t count = 0;
+    uint64_t* ids = ok ? client_query_type(client, ATOM_TYPE_CONCEPT, &count) : NULL;
+    ok = ok && ids && count == 100;
+    for (size_t i = 0; ok && i < count; i++) {
+        atom_handle_t* handle = atomspace_get_atom(space, ids[i]);
+        ok = handle && handle->atom->type == ATOM_TYPE_CONCEPT;
+        for (size_t j = 0; ok && j < i; j++) ok = ids[j] != ids[i];
+    }
+    free(ids);
+    uint64_t pattern[2] = { 0, hub->id };
+    ids = ok ? client_match(client, ATOM_TYPE_LINK, pattern, 2, &count) : NULL;
+    ok = ok && ids && count == 99;
+    free(ids);
+    ids = ok ? client_query_name(client, "hub", &count) : NULL;
+    ok = ok && ids && count == 1 && ids[0] == hub->id;
+    free(ids);
+    
+    /* 100 IDs arrive as 13 frames on the request's stream and tag, all but the last flagged */
+    uint8_t type = ATOM_TYPE_CONCEPT;
+    uint32_t tag = ok ? client_send(client, 5, PROTO_OP_QUERY_TYPE, &type, 1) : 0;
+    ok = ok && client_flush(client) == 0;
+    int frames = 0;
+    size_t total = 0;
+    proto_header_t reply;
+    reply.flags = PROTO_FLAG_MORE;
+    while (ok && (reply.flags & PROTO_FLAG_MORE)) {
+        ok = client_recv(client, &reply, NULL) == 0 && reply.tag == tag && reply.stream == 5 &&
+             reply.status == PROTO_OK && reply.length <= 64;
+        total += reply.length / sizeof(uint64_t);
+        frames++;
+    }
+    ok = ok && frames == 13 && total == 100;
+    
+    client_close(client);
+    server_stop(server);
+    pthread_join(thread, NULL);
+    server_destroy(server);
+    epoch_synchronize();
+    atomspace_destroy(space);
+    return ok;
+}
+
+int test_atomspace_stats() {
+    atomspace_t* space = atomspace_create(1);
+    if (!space) return 0;
+    
+    atomspace_stats_reset();
+    atom_handle_t* a = atom_create(space, ATOM_TYPE_CONCEPT, "A");
+    atom_handle_t* b = atom_create(space, ATOM_TYPE_CONCEPT, "B");
+    atom_handle_t* outgoing[2] = { a, b };
+    atom_create_link(space, ATOM_TYPE_LINK, outgoing, 2);
+    atom_set_tv(a, 0.5, 0.5);
+    atomspace_get_atom(space, b->id);
+    const char* names[3] = { "D", "E", "F" };
+    atom_handle_t* batch[3];
+    atom_create_batch(space, ATOM_TYPE_CONCEPT, names, 3, batch);
+    
+    atomspace_stats_t stats;
+    if (atomspace_stats(space, &stats) != 0) {
+        atomspace_destroy(space);
+        return 0;
+    }
+    
+    int ok = stats.atom_count == 6 && stats.total_atoms_created == 6 &&
+             stats.total_atoms_deleted == 0;
+    
+    /* Operation histograms are only populated in instrumented builds */
+    if (stats.enabled) {
+        /* A batch is one sample of its own op, not one create per atom */
+        ok = ok && stats.ops[STATS_OP_CREATE].count == 3 &&
+             stats.ops[STATS_OP_CREATE_BATCH].count == 1 &&
+             stats.ops[STATS_OP_TV_UPDATE].count == 1 &&
+             stats.ops[STATS_OP_LOOKUP].count == 1 &&
+             stats.ops[STATS_OP_CREATE].p50_ns <= stats.ops[STATS_OP_CREATE].max_ns;
+    } else {
+        ok = ok && stats.ops[STATS_OP_CREATE].count == 0 && stats.ops[STATS_OP_CREATE_BATCH].count == 0;
+    }
+    
+    /* Removed atoms leave their slots behind but no longer count as live */
+    atom_handle_t* c = atom_create(space, ATOM_TYPE_CONCEPT, "C");
+    ok = ok && atomspace_remove_atom(space, c) == 0 && atomspace_stats(space, &stats) == 0 &&
+         stats.atom_count == 6 && stats.total_atoms_created == 7 && stats.total_atoms_deleted == 1;
+    
+    atomspace_destroy(space);
+    return ok;
+}
+
+/* Lock Profiler Tests */
+
+LOCKPROF_SITE(test_lock_site, "test.contended_mutex");
+static pthread_mutex_t test_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void* contend_test_lock(void* arg) {
+    (void)arg;
+    uint64_t held = lockprof_mutex_lock(&test_lock, &test_lock_site);
+    /* Hold long enough to cover the wakeup delay counted in the wait */
+    usleep(2000);
+    lockprof_mutex_unlock(&test_lock, &test_lock_site, held);
+    return NULL;
+}
+
+static const lockprof_stats_t* find_lock_site(lockprof_stats_t* sites, size_t count, const char* name) {
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(sites[i].name, name) == 0) return &sites[i];
+    }
+    return NULL;
+}
+
+int test_lock_profiler() {
+    lockprof_reset();
+    lockprof_set_enabled(true);
+    
+    /* Hold the lock while a second thread blocks on it */
+    uint64_t held = lockprof_mutex_lock(&test_lock, &test_lock_site);
+    pthread_t thread;
+    pthread_create(&thread, NULL, contend_test_lock, NULL);
+    usleep(20000);
+    lockprof_mutex_unlock(&test_lock, &test_lock_site, held);
+    pthread_join(thread, NULL);
+    
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t* atom = atom_create(space, ATOM_TYPE_CONCEPT, "Profiled");
+    atomspace_get_atom(space, atom->id);
+    
+    lockprof_set_enabled(false);
+    atom_create(space, ATOM_TYPE_CONCEPT, "Unprofiled");
+    
+    lockprof_stats_t sites[64];
+    size_t count = lockprof_snapshot(sites, 64);
+    const lockprof_stats_t* contended = find_lock_site(sites, count, "test.contended_mutex");
+    const lockprof_stats_t* hash_write = find_lock_site(sites, count, "atomspace.hash_table.write");
+    const lockprof_stats_t* hash_read = find_lock_site(sites, count, "atomspace.hash_table.read");
+    
+    int ok = contended && contended->acquisitions == 2 && contended->contended == 1 &&
+             contended->wait_ns > 0 && contended->hold_ns >= contended->wait_ns &&
+             hash_write && hash_write->acquisitions == 1 &&
+             hash_read && hash_read->acquisitions == 1 &&
+             sites[0].wait_ns >= sites[count - 1].wait_ns;
+    
+    atomspace_destroy(space);
+    return ok;
+}
+
+/* Tracing Tests */
+
+int test_trace_ring() {
+    char path[] = "/tmp/opencog_trace_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return 0;
+    close(fd);
+    
+    trace_start(1024);
+    atomspace_t* space = atomspace_create(1);
+    atom_create(space, ATOM_TYPE_CONCEPT, "Traced");
+    size_t count = 0;
+    atom_handle_t** results = atomspace_get_atoms_by_type(space, ATOM_TYPE_CONCEPT, &count);
+    trace_stop();
+    
+    /* Not recorded once the ring is stopped */
+    atom_create(space, ATOM_TYPE_CONCEPT, "Untraced");
+    
+    int ok = trace_dump(path) == 0;
+    
+    FILE* json = tmpfile();
+    long events = json ? trace_convert_chrome(path, json) : -1;
+    char buffer[4096] = {0};
+    if (json) {
+        rewind(json);
+        size_t n = fread(buffer, 1, sizeof(buffer) - 1, json);
+        buffer[n] = '\0';
+        fclose(json);
+    }
+    
+    /* This thread wrote one create plus a query begin/end pair */
+    ok = ok && events >= 3 && strstr(buffer, "\"traceEvents\"") &&
+         strstr(buffer, "\"name\": \"atom_create\"") &&
+         strstr(buffer, "\"ph\": \"B\"") && strstr(buffer, "\"ph\": \"E\"");
+    
+    for (size_t i = 0; i < count; i++) {
+        atom_release(results[i]);
+    }
+    free(results);
+    atomspace_destroy(space);
+    unlink(path);
+    return ok;
+}
+
+int test_memory_accounting() {
+    atomspace_t* space = atomspace_create(1);
+    if (!space) return 0;
+    
+    atom_handle_t* a = atom_create(space, ATOM_TYPE_CONCEPT, "alpha");
+    atom_handle_t* b = atom_create(space, ATOM_TYPE_PREDICATE, "beta");
+    atom_handle_t* outgoing[2] = { a, b };
+    atom_create_link(space, ATOM_TYPE_EVALUATION, outgoing, 2);
+    
+    atomspace_memory_t mem;
+    if (atomspace_memory_usage(space, &mem, MEMORY_INCLUDE_HEAP) != 0) {
+        atomspace_destroy(space);
+        return 0;
+    }
+    
+    memory_usage_t* names = &mem.categories[MEMORY_NAMES];
+    memory_usage_t* incoming = &mem.categories[MEMORY_INCOMING];
+    int ok = mem.categories[MEMORY_ATOMS].count == 3 &&
+             mem.categories[MEMORY_ATOMS].requested == 3 * sizeof(atom_t) &&
+             names->count == 2 && names->requested == strlen("alpha") + strlen("beta") + 2 &&
+             names->allocated >= names->requested &&
+             mem.categories[MEMORY_OUTGOING].requested == 2 * sizeof(atom_handle_t*) &&
+             incoming->count == 2 && incoming->requested == 2 * sizeof(atom_handle_t*) &&
+             mem.by_type[ATOM_TYPE_CONCEPT].count == 1 &&
+             mem.by_type[ATOM_TYPE_EVALUATION].count == 1 &&
+             mem.by_type[ATOM_TYPE_LINK].count == 0 &&
+             mem.total.allocated >= mem.total.requested &&
+             mem.slack == mem.total.allocated - mem.total.requested &&
+             mem.has_heap && mem.fragmentation >= 0.0 && mem.fragmentation <= 1.0;
+    
+    /* Per-type bytes add up to the per-atom subsystems plus hash entries */
+    uint64_t by_type = 0;
+    for (int t = 0; t < ATOM_TYPE_COUNT; t++) by_type += mem.by_type[t].requested;
+    uint64_t per_atom = 0;
+    for (int c = MEMORY_ATOMS; c <= MEMORY_INCOMING; c++) per_atom += mem.categories[c].requested;
+    ok = ok && by_type > per_atom &&
+         by_type < per_atom + mem.categories[MEMORY_HASH_TABLE].requested;
+    
+    atomspace_destroy(space);
+    return ok;
+}
+
+/* Workload Generator Tests */
+
+int test_workload_reproducible() {
+    workload_config_t config;
+    workload_config_default(&config);
+    config.seed = 42;
+    config.atom_count = 2000;
+    
+    atomspace_t* first = atomspace_create(1);
+    atomspace_t* second = atomspace_create(1);
+    workload_stats_t stats1, stats2;
+    
+    if (workload_generate(first, &config, &stats1) != 0 ||
+        workload_generate(second, &config, &stats2) != 0) {
+        atomspace_destroy(first);
+        atomspace_destroy(second);
+        return 0;
+    }
+    
+    int ok = first->atom_count == config.atom_count &&
+             stats1.nodes + stats1.links == config.atom_count &&
+             memcmp(&stats1, &stats2, sizeof(stats1)) == 0 &&
+             stats1.links > 0 && stats1.nested_edges > 0;
+    
+    /* Same seed must give the same atoms in the same order */
+    for (size_t i = 0; ok && i < first->atom_count; i++) {
+        atom_t* a = first->atoms[i]->atom;
+        atom_t* b = second->atoms[i]->atom;
+        ok = a->type == b->type && a->outgoing_count == b->outgoing_count &&
+             ((!a->name && !b->name) || (a->name && b->name && strcmp(a->name, b->name) == 0));
+    }
+    
+    atomspace_destroy(first);
+    atomspace_destroy(second);
+    return ok;
+}
+
+int test_workload_emit_text() {
+    workload_config_t config;
+    workload_config_default(&config);
+    config.atom_count = 500;
+    if (workload_parse_arity(&config, "2:1,3:1") != 0) return 0;
+    if (workload_parse_arity(&config, "9:1") == 0) return 0;
+    
+    FILE* out = tmpfile();
+    if (!out) return 0;
+    
+    workload_stats_t stats;
+    if (workload_emit_text(out, &config, &stats) != 0) {
+        fclose(out);
+        return 0;
+    }
+    
+    /* One header line plus one statement per atom; the first atom is node n0 */
+    rewind(out);
+    size_t lines = 0;
+    int c;
+    while ((c = fgetc(out)) != EOF) {
+        if (c == '\n') lines++;
+    }
+    rewind(out);
+    char line[256];
+    char keyword[32];
+    double strength, confidence;
+    int ok = fgets(line, sizeof(line), out) && line[0] == '#' && fgets(line, sizeof(line), out) &&
+             sscanf(line, "%31s n0 \"%*[^\"]\" [truth: %lf, %lf];", keyword, &strength, &confidence) == 3 &&
+             strength >= 0.0 && strength <= 1.0 && confidence >= 0.0 && confidence <= 1.0;
+    fclose(out);
+    
+    return ok && lines == config.atom_count + 1 && stats.nodes + stats.links == config.atom_count;
+}
+
+#ifdef OPENCOG_PARSER
+/* Parser Tests */
+
+int parse_cognitive_grammar(const char* input, void* space);
+
+static atom_handle_t* only_atom(atomspace_t* space, atom_type_t type, const char* name) {
+    size_t count;
+    atom_handle_t* found = NULL;
+    int matches = 0;
+    atom_handle_t** atoms = atomspace_get_atoms_by_name(space, name, &count);
+    for (size_t i = 0; i < count; i++) {
+        if (atoms[i]->atom->type == type) {
+            found = atoms[i];
+            matches++;
+        }
+        atom_release(atoms[i]);
+    }
+    free(atoms);
+    return matches == 1 ? found : NULL;
+}
+
+int test_parser_links() {
+    atomspace_t* space = atomspace_create(1);
+    atom_handle_t* cat = atom_create(space, ATOM_TYPE_CONCEPT, "cat");
+    
+    /* Names resolve to the atoms already in the space, whichever statement mentions them */
+    int ok = parse_cognitive_grammar("concept dog; rule chases: cat and dog; rule chases: not cat;", space) == 0;
+    atom_handle_t* dog = only_atom(space, ATOM_TYPE_CONCEPT, "dog");
+    atom_handle_t* chases = only_atom(space, ATOM_TYPE_PREDICATE, "chases");
+    ok = ok && only_atom(space, ATOM_TYPE_CONCEPT, "cat") == cat && dog && chases;
+    
+    size_t count;
+    atom_handle_t** evals = atomspace_get_atoms_by_type(space, ATOM_TYPE_EVALUATION, &count);
+    ok = ok && count == 2;
+    for (size_t i = 0; ok && i < count; i++) {
+        atom_t* eval = evals[i]->atom;
+        atom_t* body = eval->outgoing[1]->atom;
+        ok = eval->outgoing_count == 2 && eval->outgoing[0] == chases && body->outgoing[0] == cat;
+        ok = ok && (i == 0 ? body->type == ATOM_TYPE_AND && body->outgoing[1] == dog
+                           : body->type == ATOM_TYPE_NOT && body->outgoing_count == 1);
+    }
+    for (size_t i = 0; i < count; i++) atom_release(evals[i]);
+    free(evals);
+    
+    atomspace_destroy(space);
+    return ok;
+}
+#endif
+
 /* Distributed System Tests */
 
 int test_distributed_context_create() {
@@ -226,6 +1834,66 @@ int test_node_management() {
     return 1;
 }
 
+int test_message_routing() {
+    /* Node IDs unlikely to collide with other runs on the same host */
+    uint32_t a_id = 900000 + (uint32_t)(getpid() % 50000) * 2;
+    uint32_t b_id = a_id + 1;
+    distributed_ctx_t* a = distributed_create(a_id, "localhost", 5010);
+    distributed_ctx_t* b = distributed_create(b_id, "localhost", 5011);
+    if (!a || !b || !a->mq || !b->mq) {
+        distributed_destroy(a);
+        distributed_destroy(b);
+        return 0;
+    }
+    distributed_add_node(a, b_id, "localhost", 5011);
+    
+    char payload[] = "routed";
+    message_t msg = { MSG_TYPE_ATOM_UPDATE, a_id, b_id, 42, sizeof(payload), payload };
+    int ok = distributed_send_message(a, &msg) == 0;
+    
+    /* Delivered to the destination's queue, not the sender's */
+    message_t* stray = distributed_receive_message(a, 0);
+    message_t* in = distributed_receive_message(b, 0);
+    ok = ok && !stray && in && in->source_node == a_id && in->timestamp == 42 &&
+         strcmp((char*)in->payload, "routed") == 0;
+    
+    /* Unknown destinations are rejected */
+    msg.dest_node = b_id + 1;
+    ok = ok && distributed_send_message(a, &msg) != 0;
+    
+    distributed_free_message(stray);
+    distributed_free_message(in);
+    distributed_destroy(a);
+    distributed_destroy(b);
+    return ok;
+}
+
+int test_queue_scope() {
+    uint32_t id = 950000 + (uint32_t)(getpid() % 50000);
+    char scope[32];
+    snprintf(scope, sizeof(scope), "test%d", (int)getpid());
+    distributed_ctx_t* shared = distributed_create(id, "localhost", 5012);
+    distributed_set_queue_scope(scope);
+    distributed_ctx_t* scoped = distributed_create(id, "localhost", 5013);
+    
+    /* The same node ID names a different queue inside the scope */
+    int ok = shared && scoped && shared->mq && scoped->mq && shared->mq->mq_id != scoped->mq->mq_id;
+    char payload[] = "scoped";
+    message_t msg = { MSG_TYPE_ATOM_UPDATE, id, id, 7, sizeof(payload), payload };
+    ok = ok && distributed_send_message(scoped, &msg) == 0;
+    message_t* stray = distributed_receive_message(shared, 0);
+    message_t* in = distributed_receive_message(scoped, 0);
+    ok = ok && !stray && in && in->timestamp == 7;
+    distributed_free_message(stray);
+    distributed_free_message(in);
+    
+    distributed_destroy(scoped);
+    ok = ok && distributed_remove_node_queue(id) != 0;
+    distributed_set_queue_scope(NULL);
+    distributed_destroy(shared);
+    return ok;
+}
+
 int test_shared_memory() {
     shared_memory_t* shm = shared_memory_create(4096);
     if (!shm) return 0;
@@ -267,14 +1935,54 @@ int main(int argc, char** argv) {
     TEST(link_creation);
     TEST(atom_query_by_type);
     TEST(atom_query_by_name);
+    TEST(atom_ids);
+    TEST(borrowed_queries);
+    TEST(deep_release);
+    TEST(snapshot_isolation);
+    TEST(snapshot_concurrent);
+    TEST(remove_concurrent);
+    TEST(transactions);
+    TEST(value_writers);
+    TEST(batch_create);
+    TEST(type_hierarchy);
+    TEST(vector_search);
+    TEST(name_index);
+    TEST(csr_snapshot);
+    TEST(graph_algorithms);
+    TEST(time_index);
+    TEST(query_cache);
+    TEST(changefeed);
+    TEST(server_roundtrip);
+    TEST(server_split_reply);
+    TEST(atomspace_stats);
+    TEST(lock_profiler);
+    TEST(trace_ring);
+    TEST(memory_accounting);
+    
+    printf("\n");
+    
+    /* Workload generator tests */
+    printf("Workload Generator Tests:\n");
+    TEST(workload_reproducible);
+    TEST(workload_emit_text);
+    
+    printf("\n");
+    
+#ifdef OPENCOG_PARSER
+    /* Cognitive grammar tests */
+    printf("Parser Tests:\n");
+    TEST(parser_links);
     
     printf("\n");
+#endif
     
     /* Distributed system tests */
     printf("Distributed System Tests:\n");
     TEST(distributed_context_create);
     TEST(node_management);
     TEST(shared_memory);
+    TEST(message_routing);
+    TEST(queue_scope);
     
     printf("\n");
     printf("=======================\n");
@@ -0,0 +1,337 @@
+/*
+ * OpenCog AtomSpace Load Generator
+ * Drives an AtomSpace server with pipelined requests and reports throughput and tail latency
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "../include/client.h"
+
+typedef enum {
+    LOAD_PING,
+    LOAD_GET,
+    LOAD_SET_TV,
+    LOAD_CREATE,
+    LOAD_QUERY_NAME,
+    LOAD_MATCH,
+    LOAD_KIND_COUNT
+} load_kind_t;
+
+static const char* kind_names[LOAD_KIND_COUNT] = {
+    "ping", "get", "set_tv", "create", "query_name", "match"
+};
+
+typedef struct {
+    const char* path;
+    int connections;
+    int depth;                        /* Requests in flight per connection */
+    double seconds;
+    uint64_t keys;                    /* Nodes preloaded as request targets */
+    double mix[LOAD_KIND_COUNT];      /* Cumulative, normalised to 1 */
+} load_config_t;
+
+typedef struct {
+    const load_config_t* config;
+    const uint64_t* ids;
+    uint64_t seed;
+    uint64_t* latencies;              /* ns per completed request */
+    size_t count;
+    size_t capacity;
+    uint64_t errors;
+    int failed;
+} load_worker_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* splitmix64 */
+static uint64_t next_random(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* Parse "get:0.7,set_tv:0.2,create:0.1" into cumulative weights */
+static int parse_mix(load_config_t* config, const char* spec) {
+    double weights[LOAD_KIND_COUNT] = { 0 };
+    char* copy = strdup(spec);
+    char* save = NULL;
+    int result = 0;
+
+    for (char* item = strtok_r(copy, ",", &save); item; item = strtok_r(NULL, ",", &save)) {
+        char* colon = strchr(item, ':');
+        if (!colon) { result = -1; break; }
+        *colon = '\0';
+        int kind = -1;
+        for (int k = 0; k < LOAD_KIND_COUNT; k++) {
+            if (strcasecmp(item, kind_names[k]) == 0) kind = k;
+        }
+        double weight = atof(colon + 1);
+        if (kind < 0 || weight < 0.0) { result = -1; break; }
+        weights[kind] = weight;
+    }
+    free(copy);
+
+    double total = 0.0;
+    for (int k = 0; k < LOAD_KIND_COUNT; k++) total += weights[k];
+    if (result != 0 || total <= 0.0) return -1;
+
+    double running = 0.0;
+    for (int k = 0; k < LOAD_KIND_COUNT; k++) {
+        running += weights[k] / total;
+        config->mix[k] = running;
+    }
+    return 0;
+}
+
+static void send_request(client_t* client, load_worker_t* worker) {
+    const load_config_t* config = worker->config;
+    double draw = (double)(next_random(&worker->seed) >> 11) / 9007199254740992.0;
+    int kind = 0;
+    while (kind < LOAD_KIND_COUNT - 1 && draw >= config->mix[kind]) kind++;
+
+    uint64_t key = next_random(&worker->seed) % config->keys;
+    uint64_t id = worker->ids[key];
+    char payload[64];
+
+    switch (kind) {
+        case LOAD_GET:
+            client_send(client, 0, PROTO_OP_GET, &id, sizeof(id));
+            break;
+        case LOAD_SET_TV: {
+            proto_set_tv_t set = { id, (double)(key % 100) / 100.0, 0.9 };
+            client_send(client, 0, PROTO_OP_SET_TV, &set, sizeof(set));
+            break;
+        }
+        case LOAD_CREATE: {
+            int length = snprintf(payload + sizeof(proto_create_node_t),
+                                  sizeof(payload) - sizeof(proto_create_node_t), "load_%llu",
+                                  (unsigned long long)next_random(&worker->seed));
+            proto_create_node_t node = { ATOM_TYPE_CONCEPT, 0, (uint16_t)length };
+            memcpy(payload, &node, sizeof(node));
+            client_send(client, 0, PROTO_OP_CREATE_NODE, payload, (uint32_t)(sizeof(node) + length));
+            break;
+        }
+        case LOAD_QUERY_NAME: {
+            int length = snprintf(payload, sizeof(payload), "key_%llu", (unsigned long long)key);
+            client_send(client, 0, PROTO_OP_QUERY_NAME, payload, (uint32_t)length);
+            break;
+        }
+        case LOAD_MATCH: {
+            proto_create_link_t link = { ATOM_TYPE_LINK, { 0, 0, 0 }, 2 };
+            uint64_t any = 0;
+            memcpy(payload, &link, sizeof(link));
+            memcpy(payload + sizeof(link), &id, sizeof(id));
+            memcpy(payload + sizeof(link) + sizeof(id), &any, sizeof(any));
+            client_send(client, 0, PROTO_OP_MATCH, payload, sizeof(link) + 2 * sizeof(uint64_t));
+            break;
+        }
+        default:
+            client_send(client, 0, PROTO_OP_PING, NULL, 0);
+            break;
+    }
+}
+
+static void record_latency(load_worker_t* worker, uint64_t ns) {
+    if (worker->count == worker->capacity) {
+        worker->capacity = worker->capacity ? worker->capacity * 2 : 65536;
+        worker->latencies = realloc(worker->latencies, worker->capacity * sizeof(uint64_t));
+    }
+    worker->latencies[worker->count++] = ns;
+}
+
+/* Closed loop: keep `depth` requests in flight; replies arrive in send order */
+static void* worker_run(void* arg) {
+    load_worker_t* worker = (load_worker_t*)arg;
+    const load_config_t* config = worker->config;
+    client_t* client = client_connect(config->path);
+    if (!client) {
+        worker->failed = 1;
+        return NULL;
+    }
+
+    uint64_t* sent_at = calloc((size_t)config->depth, sizeof(uint64_t));
+    size_t head = 0, tail = 0, in_flight = 0;
+    uint64_t deadline = now_ns() + (uint64_t)(config->seconds * 1e9);
+    bool sending = true;
+
+    while (sending || in_flight > 0) {
+        if (sending) {
+            uint64_t now = now_ns();
+            while (in_flight < (size_t)config->depth) {
+                send_request(client, worker);
+                sent_at[tail] = now;
+                tail = (tail + 1) % (size_t)config->depth;
+                in_flight++;
+            }
+            if (client_flush(client) != 0) {
+                worker->failed = 1;
+                break;
+            }
+        }
+
+        proto_header_t reply;
+        if (client_recv(client, &reply, NULL) != 0) {
+            worker->failed = 1;
+            break;
+        }
+        uint64_t now = now_ns();
+        record_latency(worker, now - sent_at[head]);
+        head = (head + 1) % (size_t)config->depth;
+        in_flight--;
+        if (reply.status != PROTO_OK && reply.status != PROTO_ERR_REFUSED) worker->errors++;
+        if (now >= deadline) sending = false;
+    }
+
+    free(sent_at);
+    client_close(client);
+    return NULL;
+}
+
+/* Create the target nodes key_0 .. key_{keys-1} with pipelined requests */
+static uint64_t* preload_keys(const load_config_t* config) {
+    client_t* client = client_connect(config->path);
+    if (!client) return NULL;
+
+    uint64_t* ids = malloc(config->keys * sizeof(uint64_t));
+    char payload[64];
+    size_t received = 0;
+    for (uint64_t sent = 0; received < config->keys;) {
+        for (int i = 0; i < 1024 && sent < config->keys; i++, sent++) {
+            int length = snprintf(payload + sizeof(proto_create_node_t),
+                                  sizeof(payload) - sizeof(proto_create_node_t), "key_%llu",
+                                  (unsigned long long)sent);
+            proto_create_node_t node = { ATOM_TYPE_CONCEPT, 0, (uint16_t)length };
+            memcpy(payload, &node, sizeof(node));
+            client_send(client, 0, PROTO_OP_CREATE_NODE, payload, (uint32_t)(sizeof(node) + length));
+        }
+        if (client_flush(client) != 0) break;
+        for (; received < sent; received++) {
+            proto_header_t reply;
+            const void* data;
+            if (client_recv(client, &reply, &data) != 0 || reply.status != PROTO_OK) break;
+            memcpy(&ids[received], data, sizeof(uint64_t));
+        }
+        if (received < sent) break;
+    }
+
+    client_close(client);
+    if (received < config->keys) {
+        free(ids);
+        return NULL;
+    }
+    return ids;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_us(const uint64_t* sorted, size_t count, double pct) {
+    if (count == 0) return 0.0;
+    size_t index = (size_t)(pct / 100.0 * (double)(count - 1));
+    return (double)sorted[index] / 1000.0;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -s PATH      server socket (default " PROTO_DEFAULT_PATH ")\n"
+            "  -c CONNS     connections, one thread each (default 4)\n"
+            "  -d DEPTH     requests in flight per connection (default 16)\n"
+            "  -t SECONDS   run time (default 5)\n"
+            "  -k KEYS      nodes preloaded as request targets (default 10000)\n"
+            "  -m SPEC      request mix, e.g. get:0.7,set_tv:0.25,create:0.05\n"
+            "               (kinds: ping, get, set_tv, create, query_name, match)\n",
+            prog);
+}
+
+int main(int argc, char** argv) {
+    load_config_t config = { PROTO_DEFAULT_PATH, 4, 16, 5.0, 10000, { 0 } };
+    parse_mix(&config, "get:0.7,set_tv:0.25,create:0.05");
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:c:d:t:k:m:h")) != -1) {
+        switch (opt) {
+            case 's': config.path = optarg; break;
+            case 'c': config.connections = atoi(optarg); break;
+            case 'd': config.depth = atoi(optarg); break;
+            case 't': config.seconds = atof(optarg); break;
+            case 'k': config.keys = strtoull(optarg, NULL, 10); break;
+            case 'm':
+                if (parse_mix(&config, optarg) != 0) {
+                    fprintf(stderr, "Invalid request mix: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (config.connections < 1 || config.depth < 1 || config.keys < 1 || config.seconds <= 0.0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    uint64_t* ids = preload_keys(&config);
+    if (!ids) {
+        fprintf(stderr, "Cannot preload keys through %s\n", config.path);
+        return 1;
+    }
+
+    load_worker_t* workers = calloc((size_t)config.connections, sizeof(load_worker_t));
+    pthread_t* threads = calloc((size_t)config.connections, sizeof(pthread_t));
+    uint64_t start = now_ns();
+    for (int i = 0; i < config.connections; i++) {
+        workers[i].config = &config;
+        workers[i].ids = ids;
+        workers[i].seed = 0x5EEDULL + (uint64_t)i;
+        pthread_create(&threads[i], NULL, worker_run, &workers[i]);
+    }
+
+    size_t total = 0;
+    uint64_t errors = 0;
+    int failed = 0;
+    for (int i = 0; i < config.connections; i++) {
+        pthread_join(threads[i], NULL);
+        total += workers[i].count;
+        errors += workers[i].errors;
+        failed += workers[i].failed;
+    }
+    double elapsed = (double)(now_ns() - start) / 1e9;
+
+    uint64_t* all = malloc((total ? total : 1) * sizeof(uint64_t));
+    size_t offset = 0;
+    for (int i = 0; i < config.connections; i++) {
+        memcpy(all + offset, workers[i].latencies, workers[i].count * sizeof(uint64_t));
+        offset += workers[i].count;
+        free(workers[i].latencies);
+    }
+    qsort(all, total, sizeof(uint64_t), compare_u64);
+
+    printf("connections:  %d x depth %d\n", config.connections, config.depth);
+    printf("requests:     %zu in %.2f s (%llu errors, %d failed connections)\n",
+           total, elapsed, (unsigned long long)errors, failed);
+    printf("throughput:   %.0f requests/s\n", elapsed > 0.0 ? (double)total / elapsed : 0.0);
+    printf("latency (us): p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+           percentile_us(all, total, 50.0), percentile_us(all, total, 90.0),
+           percentile_us(all, total, 99.0), percentile_us(all, total, 99.9),
+           total ? (double)all[total - 1] / 1000.0 : 0.0);
+
+    free(all);
+    free(threads);
+    free(workers);
+    free(ids);
+    return failed ? 1 : 0;
+}
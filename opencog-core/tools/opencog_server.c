@@ -0,0 +1,93 @@
+/*
+ * OpenCog AtomSpace Server Daemon
+ * Hosts an AtomSpace on a Unix domain socket until interrupted
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include "../include/atom.h"
+#include "../include/server.h"
+#include "../include/workload.h"
+
+static server_t* running_server = NULL;
+
+static void handle_signal(int sig) {
+    (void)sig;
+    server_stop(running_server);
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -s PATH      socket path (default " PROTO_DEFAULT_PATH ")\n"
+            "  -t THREADS   event loop threads (default 1)\n"
+            "  -n NODE      node ID of the hosted AtomSpace (default 1)\n"
+            "  -f EVENTS    change feed capacity for subscribers (default 65536)\n"
+            "  -g ATOMS     preload a generated workload of ATOMS atoms\n",
+            prog);
+}
+
+int main(int argc, char** argv) {
+    server_config_t config = { NULL, 1, 0, 0 };
+    uint32_t node_id = 1;
+    uint64_t preload = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:t:n:f:g:h")) != -1) {
+        switch (opt) {
+            case 's': config.path = optarg; break;
+            case 't': config.threads = atoi(optarg); break;
+            case 'n': node_id = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'f': config.feed_capacity = strtoull(optarg, NULL, 10); break;
+            case 'g': preload = strtoull(optarg, NULL, 10); break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    atomspace_t* space = atomspace_create(node_id);
+    if (preload > 0) {
+        workload_config_t workload;
+        workload_config_default(&workload);
+        workload.atom_count = preload;
+        workload_stats_t stats;
+        if (workload_generate(space, &workload, &stats) != 0) {
+            fprintf(stderr, "Workload generation failed\n");
+            atomspace_destroy(space);
+            return 1;
+        }
+        fprintf(stderr, "Preloaded %llu nodes, %llu links\n",
+                (unsigned long long)stats.nodes, (unsigned long long)stats.links);
+    }
+
+    running_server = server_create(space, &config);
+    if (!running_server) {
+        perror("server_create");
+        atomspace_destroy(space);
+        return 1;
+    }
+
+    struct sigaction action = { .sa_handler = handle_signal };
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    fprintf(stderr, "Serving on %s with %d thread(s)\n",
+            config.path ? config.path : PROTO_DEFAULT_PATH, config.threads > 0 ? config.threads : 1);
+    int result = server_run(running_server);
+
+    server_stats_t stats;
+    server_stats(running_server, &stats);
+    fprintf(stderr, "connections: %llu\nrequests:    %llu\nevents:      %llu\n"
+            "bytes in:    %llu\nbytes out:   %llu\n",
+            (unsigned long long)stats.connections, (unsigned long long)stats.requests,
+            (unsigned long long)stats.events, (unsigned long long)stats.bytes_in,
+            (unsigned long long)stats.bytes_out);
+
+    server_destroy(running_server);
+    atomspace_destroy(space);
+    return result == 0 ? 0 : 1;
+}
@@ -0,0 +1,30 @@
+/*
+ * OpenCog Trace Converter
+ * Converts binary trace dumps (trace_dump) to Chrome trace / Perfetto JSON
+ */
+
+#include <stdio.h>
+#include "../include/trace.h"
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: %s trace.bin [trace.json]\n", argv[0]);
+        return 1;
+    }
+
+    FILE* out = (argc == 3) ? fopen(argv[2], "w") : stdout;
+    if (!out) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    long count = trace_convert_chrome(argv[1], out);
+    if (out != stdout) fclose(out);
+
+    if (count < 0) {
+        fprintf(stderr, "%s: not a readable OpenCog trace file\n", argv[1]);
+        return 1;
+    }
+    fprintf(stderr, "Converted %ld events\n", count);
+    return 0;
+}